@@ -0,0 +1,255 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "buffer.h"
+#include "threads.h"
+#include "adjust.h"
+
+// colors are adjusted in blocks of this size, the only scratch memory used
+#define COLOR_ADJUST_BLOCK 256
+
+static const char *color_adjust_names[COLOR_ADJUST_COUNT] = {
+	"hue", "saturation", "value", "luminance", "red", "green", "blue", "alpha"
+};
+
+static int
+color_adjust_any(cAdjust *adjust, int first, int last)
+{
+	for (int i = first; i <= last; i++) {
+		if (adjust->op[i] != COLOR_ADJUST_NONE) return 1;
+	}
+	return 0;
+}
+
+static void
+color_adjust_parse(cAdjust *adjust, int attribute, VALUE spec)
+{
+	VALUE op    = Qnil;
+	VALUE value = spec;
+	// hue, saturation, value and luminance are 0..1, channels and alpha 0..255
+	float scale = attribute >= COLOR_ADJUST_RED ? 255 : 1;
+
+	if (TYPE(spec) == T_ARRAY) {
+		if (RARRAY_LEN(spec) != 2) {
+			rb_raise(rb_eArgError, "Invalid adjustment for %s, must be [operator, value]", color_adjust_names[attribute]);
+		}
+		op    = RARRAY_PTR(spec)[0];
+		value = RARRAY_PTR(spec)[1];
+	}
+	if (op == ID2SYM(rb_intern("map"))) {
+		// packed native floats, entry i is the result for i/steps
+		Check_Type(value, T_STRING);
+		long steps = RSTRING_LEN(value)/(long)sizeof(float)-1;
+		if (steps < 1) {
+			rb_raise(rb_eArgError, "Invalid map for %s, needs at least 2 entries", color_adjust_names[attribute]);
+		}
+		adjust->op[attribute]    = COLOR_ADJUST_MAP;
+		adjust->lut[attribute]   = (float *)RSTRING_PTR(value);
+		adjust->steps[attribute] = steps;
+		return;
+	}
+	float number = NUM2DBL(value);
+	if (NIL_P(op) || op == ID2SYM(rb_intern("+"))) {
+		adjust->op[attribute]    = COLOR_ADJUST_ADD;
+		adjust->value[attribute] = number/scale;
+	} else if (op == ID2SYM(rb_intern("-"))) {
+		adjust->op[attribute]    = COLOR_ADJUST_ADD;
+		adjust->value[attribute] = -number/scale;
+	} else if (op == ID2SYM(rb_intern("*"))) {
+		adjust->op[attribute]    = COLOR_ADJUST_MULTIPLY;
+		adjust->value[attribute] = number;
+	} else if (op == ID2SYM(rb_intern("/"))) {
+		if (number == 0) rb_raise(rb_eZeroDivError, "divided by 0");
+		adjust->op[attribute]    = COLOR_ADJUST_MULTIPLY;
+		adjust->value[attribute] = 1/number;
+	} else if (op == ID2SYM(rb_intern("set"))) {
+		adjust->op[attribute]    = COLOR_ADJUST_SET;
+		adjust->value[attribute] = number/scale;
+	} else {
+		rb_raise(rb_eArgError, "Unknown operator for %s, must be :+, :-, :*, :/, :set or :map", color_adjust_names[attribute]);
+	}
+}
+
+/*
+ * Reads a hash of adjustments, e.g. { :hue => 0.1, :saturation => [:*, 1.2] },
+ * and resolves the conversions for buffers of model.
+ */
+extern void
+color_adjust_compile(cAdjust *adjust, int model, VALUE spec)
+{
+	Check_Type(spec, T_HASH);
+	memset(adjust, 0, sizeof(cAdjust));
+	VALUE keys = rb_funcall(spec, rb_intern("keys"), 0);
+	for (long i = 0; i < RARRAY_LEN(keys); i++) {
+		VALUE key = RARRAY_PTR(keys)[i];
+		int   attribute;
+		for (attribute = 0; attribute < COLOR_ADJUST_COUNT; attribute++) {
+			if (key == ID2SYM(rb_intern(color_adjust_names[attribute]))) break;
+		}
+		if (attribute == COLOR_ADJUST_COUNT) {
+			VALUE inspect = rb_inspect(key);
+			rb_raise(rb_eArgError, "Unknown attribute %s", RSTRING_PTR(inspect));
+		}
+		color_adjust_parse(adjust, attribute, rb_hash_aref(spec, key));
+	}
+	adjust->model = model;
+	color_converter_resolve(&adjust->decode, model, COLOR_MODEL_RGBF);
+	color_converter_resolve(&adjust->encode, COLOR_MODEL_RGBF, model);
+}
+
+static inline float
+color_adjust_apply(cAdjust *adjust, int attribute, float current)
+{
+	float value = adjust->value[attribute];
+	switch(adjust->op[attribute]) {
+		case COLOR_ADJUST_ADD:      return current+value;
+		case COLOR_ADJUST_MULTIPLY: return current*value;
+		case COLOR_ADJUST_SET:      return value;
+		case COLOR_ADJUST_MAP:      return adjust->lut[attribute][(long)(color_unitf(current)*adjust->steps[attribute]+0.5f)];
+	}
+	return current;
+}
+
+static inline float
+color_adjust_hue(float hue)
+{
+	hue = fmodf(hue, 1);
+	return hue < 0 ? hue+1 : hue;
+}
+
+/*
+ * Applies all adjustments to length float colors, in the order
+ * hue/saturation/value (HSV), luminance (HSL), red/green/blue, alpha.
+ */
+extern void
+color_adjust_rgbf(cAdjust *adjust, cRGBF *colors, long length)
+{
+	int *op = adjust->op;
+
+	if (color_adjust_any(adjust, COLOR_ADJUST_HUE, COLOR_ADJUST_VALUE)) {
+		for (long i = 0; i < length; i++) {
+			cHSV  hsv;
+			float alpha = colors[i].alpha;
+			color_convert_rgbf_to_hsv(&colors[i], &hsv);
+			hsv.h = color_adjust_hue(color_adjust_apply(adjust, COLOR_ADJUST_HUE, hsv.h));
+			hsv.s = color_unitf(color_adjust_apply(adjust, COLOR_ADJUST_SATURATION, hsv.s));
+			hsv.v = color_unitf(color_adjust_apply(adjust, COLOR_ADJUST_VALUE, hsv.v));
+			color_convert_hsv_to_rgbf(&hsv, &colors[i]);
+			colors[i].alpha = alpha;
+		}
+	}
+	if (op[COLOR_ADJUST_LUMINANCE] != COLOR_ADJUST_NONE) {
+		for (long i = 0; i < length; i++) {
+			cHSL  hsl;
+			float alpha = colors[i].alpha;
+			color_convert_rgbf_to_hsl(&colors[i], &hsl);
+			hsl.l = color_unitf(color_adjust_apply(adjust, COLOR_ADJUST_LUMINANCE, hsl.l));
+			color_convert_hsl_to_rgbf(&hsl, &colors[i]);
+			colors[i].alpha = alpha;
+		}
+	}
+	// the struct is 4 floats, so channel c of color i is at [i*4+c]
+	for (int c = 0; c < 4; c++) {
+		int    attribute = COLOR_ADJUST_RED+c;
+		float *channel   = &colors[0].r+c;
+		float  operand   = adjust->value[attribute];
+		switch(op[attribute]) {
+			case COLOR_ADJUST_ADD:
+				for (long i = 0; i < length; i++) channel[i*4] = color_unitf(channel[i*4]+operand);
+				break;
+			case COLOR_ADJUST_MULTIPLY:
+				for (long i = 0; i < length; i++) channel[i*4] = color_unitf(channel[i*4]*operand);
+				break;
+			case COLOR_ADJUST_SET:
+				for (long i = 0; i < length; i++) channel[i*4] = operand;
+				break;
+			case COLOR_ADJUST_MAP:
+				for (long i = 0; i < length; i++) channel[i*4] = color_adjust_apply(adjust, attribute, channel[i*4]);
+				break;
+		}
+	}
+}
+
+/*
+ * Adjusts elements from...to of adjust->from into adjust->to, block by
+ * block. Both may point to the same data.
+ */
+extern void
+color_adjust_run(cAdjust *adjust, long from, long to)
+{
+	cRGBF  block[COLOR_ADJUST_BLOCK];
+	size_t size = color_model_size(adjust->model);
+	for (long start = from; start < to; start += COLOR_ADJUST_BLOCK) {
+		long length = to-start < COLOR_ADJUST_BLOCK ? to-start : COLOR_ADJUST_BLOCK;
+		color_converter_run_buffer(&adjust->decode, adjust->from+start*size, (char *)block, length);
+		color_adjust_rgbf(adjust, block, length);
+		color_converter_run_buffer(&adjust->encode, (char *)block, adjust->to+start*size, length);
+	}
+}
+
+static void
+color_adjust_slice(void *adjust, long from, long to)
+{
+	color_adjust_run((cAdjust *)adjust, from, to);
+}
+
+static VALUE
+color_buffer_adjust(int argc, VALUE *argv, VALUE self, int in_place)
+{
+	cAdjust adjust;
+	cBuffer *result;
+	VALUE spec, options, rb_result = self;
+	rb_scan_args(argc, argv, "11", &spec, &options);
+	cBuffer *buffer = color_buffer_get(self, -1);
+	int threads     = color_threads_get(options);
+	color_adjust_compile(&adjust, buffer->model, spec);
+	if (in_place) {
+		result = buffer;
+	} else {
+		rb_result = color_buffer_new(buffer->model, buffer->length, &result);
+	}
+	COLOR_STAT_KERNEL(COLOR_KERNEL_ADJUST, buffer->length);
+	adjust.from = buffer->data;
+	adjust.to   = result->data;
+	color_parallel(color_adjust_slice, &adjust, buffer->length, threads);
+	return rb_result;
+}
+
+/*
+ *  call-seq:
+ *     buffer.adjust(adjustments[, options]) -> buffer
+ *
+ *  Applies the edits of Color::Mixer to every color of a buffer, in one
+ *  pass and without intermediate buffers. Attributes are :hue, :saturation,
+ *  :value, :luminance (0..1, hue wraps around), :red, :green, :blue and
+ *  :alpha (0..255). A Numeric is added, an array [operator, value] supports
+ *  the operators :+, :-, :*, :/ and :set. [:map, table] looks the attribute
+ *  up in a String of packed floats (0..1 each), see Color::Buffer::Lazy.
+ *  Edits apply in the order HSV,
+ *  luminance, channels, alpha. With :threads => n the buffer is split over
+ *  n native threads.
+ *
+ *  Example:
+ *    sprites.adjust(:hue => 0.1, :saturation => [:*, 1.2], :luminance => -0.05, :alpha => [:set, 0])
+ */
+extern VALUE
+rb_color_buffer_adjust(int argc, VALUE *argv, VALUE self)
+{
+	return color_buffer_adjust(argc, argv, self, 0);
+}
+
+/*
+ *  call-seq:
+ *     buffer.adjust!(adjustments[, options]) -> buffer
+ *
+ *  Like Color::Buffer#adjust, but modifies this buffer.
+ */
+extern VALUE
+rb_color_buffer_adjust_bang(int argc, VALUE *argv, VALUE self)
+{
+	COLOR_CHECK_FROZEN(self);
+	return color_buffer_adjust(argc, argv, self, 1);
+}
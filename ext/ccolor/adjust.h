@@ -0,0 +1,37 @@
+enum {
+	COLOR_ADJUST_HUE,
+	COLOR_ADJUST_SATURATION,
+	COLOR_ADJUST_VALUE,
+	COLOR_ADJUST_LUMINANCE,
+	COLOR_ADJUST_RED,
+	COLOR_ADJUST_GREEN,
+	COLOR_ADJUST_BLUE,
+	COLOR_ADJUST_ALPHA,
+	COLOR_ADJUST_COUNT
+};
+
+enum {
+	COLOR_ADJUST_NONE,
+	COLOR_ADJUST_ADD,
+	COLOR_ADJUST_MULTIPLY,
+	COLOR_ADJUST_SET,
+	COLOR_ADJUST_MAP
+};
+
+typedef struct _cAdjust {
+	int        op[COLOR_ADJUST_COUNT];    // COLOR_ADJUST_NONE/ADD/MULTIPLY/SET/MAP
+	float      value[COLOR_ADJUST_COUNT]; // operand, in 0..1 units
+	float     *lut[COLOR_ADJUST_COUNT];   // lookup table of COLOR_ADJUST_MAP
+	long       steps[COLOR_ADJUST_COUNT]; // lookup table has steps+1 entries
+	int        model;                     // model of the buffer
+	cConverter decode;                    // model -> RGBF
+	cConverter encode;                    // RGBF -> model
+	char      *from;
+	char      *to;
+} cAdjust;
+
+extern void color_adjust_compile(cAdjust *adjust, int model, VALUE spec);
+extern void color_adjust_rgbf(cAdjust *adjust, cRGBF *colors, long length);
+extern void color_adjust_run(cAdjust *adjust, long from, long to);
+extern VALUE rb_color_buffer_adjust(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_buffer_adjust_bang(int argc, VALUE *argv, VALUE self);
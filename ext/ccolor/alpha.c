@@ -0,0 +1,105 @@
+#include <ruby.h>
+#include "color.h"
+#include "buffer.h"
+#include "dispatch.h"
+#include "alpha.h"
+
+// the COLOR_ALPHA_* flags of +options+, nil keeps the flag of +alpha+
+static int
+color_alpha_mode_get(VALUE options, int alpha)
+{
+	VALUE premultiplied = Qnil, opacity = Qnil;
+	if (!NIL_P(options)) {
+		Check_Type(options, T_HASH);
+		premultiplied = rb_hash_aref(options, ID2SYM(rb_intern("premultiplied")));
+		opacity       = rb_hash_aref(options, ID2SYM(rb_intern("opacity")));
+	}
+	if (!NIL_P(premultiplied)) {
+		alpha = RTEST(premultiplied) ? alpha|COLOR_ALPHA_PREMULTIPLIED : alpha & ~COLOR_ALPHA_PREMULTIPLIED;
+	}
+	if (!NIL_P(opacity)) {
+		alpha = RTEST(opacity) ? alpha|COLOR_ALPHA_OPACITY : alpha & ~COLOR_ALPHA_OPACITY;
+	}
+	return alpha;
+}
+
+/*
+ *  call-seq:
+ *     buffer.with_alpha(options) -> buffer
+ *
+ *  A copy of this RGB buffer with its alpha stored differently, options
+ *  not given keep the current mode:
+ *  :premultiplied:: if true, red, green and blue are scaled by the
+ *                   opacity, as most compositors and GPUs expect
+ *  :opacity:: if true, alpha is the opacity (255 is opaque) like in most
+ *             image formats, else the transparency like in Color::RGB
+ *  Elements read and written with [] and each are still in straight
+ *  transparency, so only the data changes. Premultiplied buffers blend
+ *  without a division per pixel, see #blend. Other kernels need the
+ *  default mode: <code>buffer.with_alpha(:premultiplied => false, :opacity => false)</code>.
+ *
+ *  Example:
+ *    texture = buffer.with_alpha(:premultiplied => true, :opacity => true).data
+ */
+extern VALUE
+rb_color_buffer_with_alpha(int argc, VALUE *argv, VALUE self)
+{
+	cBuffer *result;
+	VALUE options;
+	rb_scan_args(argc, argv, "01", &options);
+	cBuffer *buffer = color_buffer_get_alpha(self, COLOR_MODEL_RGB, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	int alpha       = color_alpha_mode_get(options, buffer->alpha);
+	VALUE rb_buffer = color_buffer_new(COLOR_MODEL_RGB, buffer->length, &result);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_ALPHA, buffer->length);
+	color_kernels->alpha_rgb((cRGB *)buffer->data, (cRGB *)result->data, buffer->length, buffer->alpha, alpha);
+	result->alpha = alpha;
+	return rb_buffer;
+}
+
+/*
+ *  call-seq:
+ *     buffer.with_alpha!(options) -> buffer
+ *
+ *  Same as #with_alpha, but changes this buffer.
+ */
+extern VALUE
+rb_color_buffer_with_alpha_bang(int argc, VALUE *argv, VALUE self)
+{
+	VALUE options;
+	COLOR_CHECK_FROZEN(self);
+	rb_scan_args(argc, argv, "01", &options);
+	cBuffer *buffer = color_buffer_get_alpha(self, COLOR_MODEL_RGB, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	int alpha       = color_alpha_mode_get(options, buffer->alpha);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_ALPHA, buffer->length);
+	color_kernels->alpha_rgb((cRGB *)buffer->data, (cRGB *)buffer->data, buffer->length, buffer->alpha, alpha);
+	buffer->alpha = alpha;
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     buffer.premultiplied? -> true/false
+ *
+ *  Whether red, green and blue in #data are scaled by the opacity, see
+ *  #with_alpha.
+ */
+extern VALUE
+rb_color_buffer_premultiplied_p(VALUE self)
+{
+	cBuffer *buffer = color_buffer_get_alpha(self, -1, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	return buffer->alpha & COLOR_ALPHA_PREMULTIPLIED ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *     buffer.opacity? -> true/false
+ *
+ *  Whether alpha in #data is the opacity (255 is opaque) instead of the
+ *  transparency, see #with_alpha.
+ */
+extern VALUE
+rb_color_buffer_opacity_p(VALUE self)
+{
+	cBuffer *buffer = color_buffer_get_alpha(self, -1, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	return buffer->alpha & COLOR_ALPHA_OPACITY ? Qtrue : Qfalse;
+}
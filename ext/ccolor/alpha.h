@@ -0,0 +1,4 @@
+extern VALUE rb_color_buffer_with_alpha(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_buffer_with_alpha_bang(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_buffer_premultiplied_p(VALUE self);
+extern VALUE rb_color_buffer_opacity_p(VALUE self);
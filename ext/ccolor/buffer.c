@@ -0,0 +1,409 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "buffer.h"
+#include "linear.h"
+#include "dispatch.h"
+
+static void
+color_buffer_free(cBuffer *buffer)
+{
+	if (buffer->data) xfree(buffer->data);
+	xfree(buffer);
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_buffer__allocate(VALUE class)
+{
+	cBuffer *buffer;
+	VALUE rb_buffer = COLOR_MAKE_STRUCT(class, cBuffer, NULL, color_buffer_free, buffer);
+	buffer->model  = COLOR_MODEL_RGB;
+	buffer->alpha  = 0;
+	buffer->length = 0;
+	buffer->data   = NULL;
+	return rb_buffer;
+}
+
+static void
+color_buffer_resize(cBuffer *buffer, int model, long length)
+{
+	if (length < 0) {
+		rb_raise(rb_eArgError, "Invalid length, must be positive");
+	}
+	long size = color_size_mul(length, color_model_size(model));
+	if (size == LONG_MAX) {
+		rb_raise(rb_eArgError, "Invalid size, too large");
+	}
+	if (buffer->data) xfree(buffer->data);
+	buffer->model  = model;
+	buffer->alpha  = 0;
+	buffer->length = length;
+	buffer->data   = ALLOC_N(char, size+1);
+	memset(buffer->data, 0, size);
+}
+
+/*
+ * Creates a new, zero filled buffer, *ptr is set to its struct.
+ */
+extern VALUE
+color_buffer_new(int model, long length, cBuffer **ptr)
+{
+	VALUE rb_buffer = rb_color_buffer__allocate(rb_cBuffer);
+	COLOR_GET_STRUCT(rb_buffer, cBuffer, *ptr);
+	color_buffer_resize(*ptr, model, length);
+	return rb_buffer;
+}
+
+/*
+ * The struct of element index, raises IndexError if out of bounds.
+ * Negative indices count from the end.
+ */
+extern void *
+color_buffer_at(cBuffer *buffer, long index)
+{
+	if (index < 0) index += buffer->length;
+	if (index < 0 || index >= buffer->length) {
+		rb_raise(rb_eIndexError, "index %ld out of buffer", index);
+	}
+	return buffer->data + index*color_model_size(buffer->model);
+}
+
+/*
+ * The struct of a Color::Buffer, raises TypeError unless it holds +model+
+ * colors (-1 accepts any model) with straight transparency, the alpha mode
+ * all kernels but those in alpha.c expect.
+ */
+extern cBuffer *
+color_buffer_get(VALUE rb_buffer, int model)
+{
+	return color_buffer_get_alpha(rb_buffer, model, 0);
+}
+
+/*
+ * Same as color_buffer_get, also accepting the COLOR_ALPHA_* flags in
+ * +alpha+.
+ */
+extern cBuffer *
+color_buffer_get_alpha(VALUE rb_buffer, int model, int alpha)
+{
+	cBuffer *buffer;
+	if (CLASS_OF(rb_buffer) != rb_cBuffer) {
+		rb_raise(rb_eTypeError, "Expected a Color::Buffer");
+	}
+	COLOR_GET_STRUCT(rb_buffer, cBuffer, buffer);
+	if (model >= 0 && buffer->model != model) {
+		VALUE inspect = rb_inspect(color_model_class(model));
+		rb_raise(rb_eTypeError, "Expected a buffer of %s", RSTRING_PTR(inspect));
+	}
+	if (buffer->alpha & ~alpha) {
+		rb_raise(rb_eTypeError, "Expected a buffer with straight transparency, see Color::Buffer#with_alpha");
+	}
+	return buffer;
+}
+
+/*
+ * Copies a color into ptr, coercing it into model if necessary, see
+ * color_coerce.
+ */
+extern void
+color_buffer_store(int model, void *ptr, VALUE color)
+{
+	cAny tmp;
+	memcpy(ptr, color_coerce(color, model, &tmp, COLOR_COERCE_STORE), color_model_size(model));
+}
+
+/*
+ *  call-seq:
+ *     Color::Buffer.new(model[, length])
+ *
+ *  Create a buffer of +length+ colors of +model+, which is a color class
+ *  (Color::RGB) or a symbol (:rgb). All values are zero, for RGB that is
+ *  opaque black.
+ */
+extern VALUE
+rb_color_buffer_initialize(int argc, VALUE *argv, VALUE self)
+{
+	cBuffer *buffer;
+	VALUE model, length;
+	COLOR_GET_STRUCT(self, cBuffer, buffer);
+	rb_scan_args(argc, argv, "11", &model, &length);
+	color_buffer_resize(buffer, color_model_get(model), NIL_P(length) ? 0 : NUM2LONG(length));
+	return self;
+}
+
+/*
+ * :nodoc:
+ */
+extern VALUE
+rb_color_buffer_initialize_copy(VALUE self, VALUE original)
+{
+	cBuffer *buffer1, *buffer2;
+	COLOR_GET_STRUCT(self, cBuffer, buffer1);
+	COLOR_GET_STRUCT(original, cBuffer, buffer2);
+	color_buffer_resize(buffer1, buffer2->model, buffer2->length);
+	memcpy(buffer1->data, buffer2->data, buffer2->length*color_model_size(buffer2->model));
+	buffer1->alpha = buffer2->alpha;
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     Color::Buffer.from(array[, model]) -> buffer
+ *
+ *  Create a buffer from an array of colors. If +model+ is not given, the class
+ *  of the first color is used. Colors of other classes are coerced.
+ */
+extern VALUE
+rb_color_buffer__from(int argc, VALUE *argv, VALUE class)
+{
+	cBuffer *buffer;
+	VALUE colors, model;
+	rb_scan_args(argc, argv, "11", &colors, &model);
+	Check_Type(colors, T_ARRAY);
+	long length = RARRAY_LEN(colors);
+	if (NIL_P(model)) {
+		model = length > 0 ? CLASS_OF(RARRAY_PTR(colors)[0]) : rb_cRGB;
+	}
+	VALUE rb_buffer = color_buffer_new(color_model_get(model), length, &buffer);
+	size_t size     = color_model_size(buffer->model);
+	for (long i = 0; i < length; i++) {
+		color_buffer_store(buffer->model, buffer->data + i*size, RARRAY_PTR(colors)[i]);
+	}
+	return rb_buffer;
+}
+
+/*
+ *  call-seq:
+ *     buffer.model -> class
+ *
+ *  The color class of all elements in this buffer.
+ */
+extern VALUE
+rb_color_buffer_model(VALUE self)
+{
+	cBuffer *buffer;
+	COLOR_GET_STRUCT(self, cBuffer, buffer);
+	return color_model_class(buffer->model);
+}
+
+/*
+ *  call-seq:
+ *     buffer.length -> fixnum
+ *     buffer.size   -> fixnum
+ *
+ *  The number of colors in this buffer.
+ */
+extern VALUE
+rb_color_buffer_length(VALUE self)
+{
+	cBuffer *buffer;
+	COLOR_GET_STRUCT(self, cBuffer, buffer);
+	return LONG2NUM(buffer->length);
+}
+
+// copies an element into a color, in straight transparency
+static inline void
+color_buffer_load(cBuffer *buffer, void *color, const void *ptr)
+{
+	if (buffer->alpha) {
+		color_kernels->alpha_rgb((const cRGB *)ptr, (cRGB *)color, 1, buffer->alpha, 0);
+	} else {
+		memcpy(color, ptr, color_model_size(buffer->model));
+	}
+}
+
+/*
+ *  call-seq:
+ *     buffer[index] -> color
+ *
+ *  The color at +index+, an instance of buffer.model.
+ */
+extern VALUE
+rb_color_buffer_aref(VALUE self, VALUE index)
+{
+	cBuffer *buffer;
+	void *color;
+	COLOR_GET_STRUCT(self, cBuffer, buffer);
+	void *ptr      = color_buffer_at(buffer, NUM2LONG(index));
+	VALUE rb_color = color_model_new(buffer->model, &color);
+	color_buffer_load(buffer, color, ptr);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     buffer[index] = color
+ *
+ *  Stores a color at +index+, colors of other classes are coerced.
+ */
+extern VALUE
+rb_color_buffer_aset(VALUE self, VALUE index, VALUE color)
+{
+	cBuffer *buffer;
+	COLOR_CHECK_FROZEN(self);
+	COLOR_GET_STRUCT(self, cBuffer, buffer);
+	void *ptr = color_buffer_at(buffer, NUM2LONG(index));
+	color_buffer_store(buffer->model, ptr, color);
+	if (buffer->alpha) {
+		color_kernels->alpha_rgb((cRGB *)ptr, (cRGB *)ptr, 1, 0, buffer->alpha);
+	}
+	return color;
+}
+
+/*
+ *  call-seq:
+ *     buffer.each { |color| ... } -> buffer
+ *
+ *  Yields every color in this buffer.
+ */
+extern VALUE
+rb_color_buffer_each(VALUE self)
+{
+	cBuffer *buffer;
+	void *color;
+	COLOR_GET_STRUCT(self, cBuffer, buffer);
+	size_t size = color_model_size(buffer->model);
+	for (long i = 0; i < buffer->length; i++) {
+		VALUE rb_color = color_model_new(buffer->model, &color);
+		color_buffer_load(buffer, color, buffer->data + i*size);
+		rb_yield(rb_color);
+	}
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     buffer.data -> string
+ *
+ *  The packed structs of this buffer as binary String.
+ */
+extern VALUE
+rb_color_buffer_data(VALUE self)
+{
+	cBuffer *buffer;
+	COLOR_GET_STRUCT(self, cBuffer, buffer);
+	return rb_str_new(buffer->data, buffer->length*color_model_size(buffer->model));
+}
+
+/*
+ *  call-seq:
+ *     buffer.convert(model[, options]) -> buffer
+ *
+ *  A new buffer with all colors converted to +model+. Options are the same
+ *  as for Color::Converter::new, e.g. :rounding => :dither.
+ *  See Color::Converter for repeated conversions.
+ */
+extern VALUE
+rb_color_buffer_convert(int argc, VALUE *argv, VALUE self)
+{
+	cBuffer *from, *to;
+	cConverter conv;
+	VALUE model, options;
+	rb_scan_args(argc, argv, "11", &model, &options);
+	from = color_buffer_get(self, -1);
+	color_converter_resolve(&conv, from->model, color_model_get(model));
+	color_converter_options(&conv, options);
+	VALUE rb_buffer = color_buffer_new(conv.to, from->length, &to);
+	color_converter_run_buffer(&conv, from->data, to->data, from->length);
+	return rb_buffer;
+}
+
+/*
+ *  call-seq:
+ *     buffer.interpolate(other[, pos[, options]]) -> buffer
+ *
+ *  Element wise Color::RGB#interpolate of two RGB buffers of equal length.
+ *  Supports <code>:space => :linear</code>.
+ */
+extern VALUE
+rb_color_buffer_interpolate(int argc, VALUE *argv, VALUE self)
+{
+	cBuffer *result;
+	VALUE other, r_pos, options;
+	rb_scan_args(argc, argv, "12", &other, &r_pos, &options);
+	cBuffer *buffer1 = color_buffer_get(self, COLOR_MODEL_RGB);
+	cBuffer *buffer2 = color_buffer_get(other, COLOR_MODEL_RGB);
+	float pos        = NIL_P(r_pos) ? 0.5f : NUM2DBL(r_pos);
+	int space        = color_space_get(options);
+	if (buffer1->length != buffer2->length) {
+		rb_raise(rb_eArgError, "Buffers differ in length");
+	}
+	VALUE rb_buffer = color_buffer_new(COLOR_MODEL_RGB, buffer1->length, &result);
+	cRGB *from = (cRGB *)buffer1->data, *to = (cRGB *)buffer2->data, *out = (cRGB *)result->data;
+	COLOR_STAT_KERNEL(COLOR_KERNEL_INTERPOLATE, buffer1->length);
+	if (space == COLOR_SPACE_SRGB && pos >= 0 && pos <= 1) {
+		color_kernels->interpolate_rgb(from, to, out, buffer1->length, pos);
+		return rb_buffer;
+	}
+	for (long i = 0; i < buffer1->length; i++) {
+		color_rgb_interpolate_in(&from[i], &to[i], &out[i], pos, space);
+	}
+	return rb_buffer;
+}
+
+/*
+ *  call-seq:
+ *     buffer.blend(overlay[, options]) -> buffer
+ *
+ *  Element wise Color::RGB#blend of two RGB buffers of equal length, the
+ *  overlay is put on top of this buffer. Options:
+ *  :alpha:: use this alpha (0..255) for all overlay colors instead of
+ *          their own
+ *  :using:: :interpolate (default), :multiply or :negative_multiply
+ *  :space:: :srgb (default) or :linear
+ *
+ *  Premultiplied buffers (see #with_alpha) of the same alpha mode are
+ *  composited with source over instead, the result has their alpha mode
+ *  and its alpha is the combined coverage. No options are supported then.
+ */
+extern VALUE
+rb_color_buffer_blend(int argc, VALUE *argv, VALUE self)
+{
+	cBuffer *result;
+	VALUE other, options, r_alpha = Qnil, using = Qnil;
+	rb_scan_args(argc, argv, "11", &other, &options);
+	cBuffer *buffer1 = color_buffer_get_alpha(self, COLOR_MODEL_RGB, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	cBuffer *buffer2 = color_buffer_get_alpha(other, COLOR_MODEL_RGB, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	if (buffer1->alpha != buffer2->alpha) {
+		rb_raise(rb_eTypeError, "Buffers differ in their alpha mode");
+	}
+	if (buffer1->alpha && !(buffer1->alpha & COLOR_ALPHA_PREMULTIPLIED)) {
+		color_buffer_get(self, COLOR_MODEL_RGB);
+	}
+	if (!NIL_P(options)) {
+		Check_Type(options, T_HASH);
+		if (buffer1->alpha) {
+			rb_raise(rb_eArgError, "Premultiplied buffers are blended without options");
+		}
+		r_alpha = rb_hash_aref(options, ID2SYM(rb_intern("alpha")));
+		using   = rb_hash_aref(options, ID2SYM(rb_intern("using")));
+	}
+	int mode      = color_blend_mode_get(using);
+	int space     = color_space_get(options);
+	float opacity = color_blend_opacity_get(r_alpha);
+	if (buffer1->length != buffer2->length) {
+		rb_raise(rb_eArgError, "Buffers differ in length");
+	}
+	VALUE rb_buffer = color_buffer_new(COLOR_MODEL_RGB, buffer1->length, &result);
+	cRGB *color = (cRGB *)buffer1->data, *with = (cRGB *)buffer2->data, *out = (cRGB *)result->data;
+	COLOR_STAT_KERNEL(COLOR_KERNEL_BLEND, buffer1->length);
+	if (buffer1->alpha) {
+		result->alpha = buffer1->alpha;
+		color_kernels->composite_rgb(color, with, out, buffer1->length, buffer1->alpha);
+		return rb_buffer;
+	}
+	if (mode == COLOR_BLEND_INTERPOLATE && space == COLOR_SPACE_SRGB) {
+		color_kernels->blend_rgb(color, with, out, buffer1->length, opacity);
+		return rb_buffer;
+	}
+	for (long i = 0; i < buffer1->length; i++) {
+		color_rgb_blend(&color[i], &with[i], &out[i], opacity < 0 ? (255-with[i].alpha)/255.0f : opacity, mode, space);
+	}
+	return rb_buffer;
+}
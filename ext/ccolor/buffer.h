@@ -0,0 +1,18 @@
+extern VALUE color_buffer_new(int model, long length, cBuffer **ptr);
+extern void *color_buffer_at(cBuffer *buffer, long index);
+extern cBuffer *color_buffer_get(VALUE rb_buffer, int model);
+extern cBuffer *color_buffer_get_alpha(VALUE rb_buffer, int model, int alpha);
+extern void color_buffer_store(int model, void *ptr, VALUE color);
+extern VALUE rb_color_buffer__allocate(VALUE class);
+extern VALUE rb_color_buffer__from(int argc, VALUE *argv, VALUE class);
+extern VALUE rb_color_buffer_initialize(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_buffer_initialize_copy(VALUE self, VALUE original);
+extern VALUE rb_color_buffer_model(VALUE self);
+extern VALUE rb_color_buffer_length(VALUE self);
+extern VALUE rb_color_buffer_aref(VALUE self, VALUE index);
+extern VALUE rb_color_buffer_aset(VALUE self, VALUE index, VALUE color);
+extern VALUE rb_color_buffer_each(VALUE self);
+extern VALUE rb_color_buffer_data(VALUE self);
+extern VALUE rb_color_buffer_convert(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_buffer_interpolate(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_buffer_blend(int argc, VALUE *argv, VALUE self);
@@ -2,6 +2,7 @@
 #include <math.h>
 #include "color.h"
 #include "tools.h"
+#include "convert.h"
 #include "rgb.h"
 #include "hsv.h"
 #include "hsl.h"
@@ -15,7 +16,7 @@ extern VALUE
 rb_color_cmyk__allocate(VALUE class)
 {
 	cCMYK *color;
-	VALUE rb_color = Data_Make_Struct(class, cCMYK, NULL, free, color);
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cCMYK, color);
 	color->c     = 0;
 	color->m     = 0;
 	color->y     = 0;
@@ -35,8 +36,9 @@ rb_color_cmyk__allocate(VALUE class)
 extern VALUE
 rb_color_cmyk_initialize(int argc, VALUE *argv, VALUE self)
 {
+	COLOR_CHECK_FROZEN(self);
 	cCMYK *color;
-	Data_Get_Struct(self, cCMYK, color);
+	COLOR_GET_STRUCT(self, cCMYK, color);
 	VALUE cyan, magenta, yellow, key, alpha;
 	rb_scan_args(argc, argv, "41", &cyan, &magenta, &yellow, &key, &alpha);
 
@@ -69,7 +71,7 @@ rb_color_cmyk_initialize(int argc, VALUE *argv, VALUE self)
 	color->k     = k;
 	color->alpha = a;
 
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -78,11 +80,12 @@ rb_color_cmyk_initialize(int argc, VALUE *argv, VALUE self)
 extern VALUE
 rb_color_cmyk_initialize_copy(VALUE self, VALUE original)
 {
+	COLOR_CHECK_FROZEN(self);
 	cCMYK *color1, *color2;
-	Data_Get_Struct(self, cCMYK, color1);
-	Data_Get_Struct(original, cCMYK, color2);
+	COLOR_GET_STRUCT(self, cCMYK, color1);
+	COLOR_GET_STRUCT(original, cCMYK, color2);
 	*color1 = *color2;
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -95,7 +98,7 @@ extern VALUE
 rb_color_cmyk_cyan(VALUE self)
 {
 	cCMYK *color;
-	Data_Get_Struct(self, cCMYK, color);
+	COLOR_GET_STRUCT(self, cCMYK, color);
 	return CHR2FIX(color->c);
 }
 
@@ -109,7 +112,7 @@ extern VALUE
 rb_color_cmyk_magenta(VALUE self)
 {
 	cCMYK *color;
-	Data_Get_Struct(self, cCMYK, color);
+	COLOR_GET_STRUCT(self, cCMYK, color);
 	return CHR2FIX(color->m);
 }
 
@@ -123,7 +126,7 @@ extern VALUE
 rb_color_cmyk_yellow(VALUE self)
 {
 	cCMYK *color;
-	Data_Get_Struct(self, cCMYK, color);
+	COLOR_GET_STRUCT(self, cCMYK, color);
 	return CHR2FIX(color->y);
 }
 
@@ -138,7 +141,7 @@ extern VALUE
 rb_color_cmyk_key(VALUE self)
 {
 	cCMYK *color;
-	Data_Get_Struct(self, cCMYK, color);
+	COLOR_GET_STRUCT(self, cCMYK, color);
 	return CHR2FIX(color->k);
 }
 
@@ -153,7 +156,7 @@ extern VALUE
 rb_color_cmyk_alpha(VALUE self)
 {
 	cCMYK *color;
-	Data_Get_Struct(self, cCMYK, color);
+	COLOR_GET_STRUCT(self, cCMYK, color);
 	return CHR2FIX(color->alpha);
 }
 
@@ -166,10 +169,11 @@ rb_color_cmyk_alpha(VALUE self)
 extern VALUE
 rb_color_cmyk_add(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cCMYK *color1, *color2, *color3;
-	Data_Get_Struct(self, cCMYK, color1);
-	Data_Get_Struct(other, cCMYK, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cCMYK, cCMYK, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cCMYK, color1);
+	color2 = color_coerce(other, COLOR_MODEL_CMYK, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cCMYK, cCMYK, color3);
 	color3->c     = color_cap(CHR2LONG(color1->c) + CHR2LONG(color2->c), 0, 255);
 	color3->m     = color_cap(CHR2LONG(color1->m) + CHR2LONG(color2->m), 0, 255);
 	color3->y     = color_cap(CHR2LONG(color1->y) + CHR2LONG(color2->y), 0, 255);
@@ -187,10 +191,11 @@ rb_color_cmyk_add(VALUE self, VALUE other)
 extern VALUE
 rb_color_cmyk_sub(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cCMYK *color1, *color2, *color3;
-	Data_Get_Struct(self, cCMYK, color1);
-	Data_Get_Struct(other, cCMYK, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cCMYK, cCMYK, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cCMYK, color1);
+	color2 = color_coerce(other, COLOR_MODEL_CMYK, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cCMYK, cCMYK, color3);
 	color3->c     = color_cap(CHR2LONG(color1->c) - CHR2LONG(color2->c), 0, 255);
 	color3->m     = color_cap(CHR2LONG(color1->m) - CHR2LONG(color2->m), 0, 255);
 	color3->y     = color_cap(CHR2LONG(color1->y) - CHR2LONG(color2->y), 0, 255);
@@ -210,8 +215,9 @@ rb_color_cmyk_to_rgb(VALUE self)
 {
 	cCMYK *cmyk;
 	cRGB *rgb;
-	Data_Get_Struct(self, cCMYK, cmyk);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, rgb);
+	COLOR_GET_STRUCT(self, cCMYK, cmyk);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, rgb);
+	COLOR_STAT_CONVERT(COLOR_MODEL_CMYK, COLOR_MODEL_RGB, 1);
 	color_convert_cmyk_to_rgb(cmyk, rgb);
 	return rb_color;
 }
@@ -227,8 +233,9 @@ rb_color_cmyk_to_gray(VALUE self)
 {
 	cCMYK *cmyk;
 	cGray *gray;
-	Data_Get_Struct(self, cCMYK, cmyk);
-	VALUE rb_color = Data_Make_Struct(rb_cGray, cGray, NULL, free, gray);
+	COLOR_GET_STRUCT(self, cCMYK, cmyk);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cGray, cGray, gray);
+	COLOR_STAT_CONVERT(COLOR_MODEL_CMYK, COLOR_MODEL_GRAY, 1);
 	color_convert_cmyk_to_gray(cmyk, gray);
 	return rb_color;
 }
@@ -245,9 +252,10 @@ rb_color_cmyk_to_gray(VALUE self)
 extern VALUE
 rb_color_cmyk_distance(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cCMYK *color1, *color2;
-	Data_Get_Struct(self, cCMYK, color1);
-	Data_Get_Struct(other, cCMYK, color2);
+	COLOR_GET_STRUCT(self, cCMYK, color1);
+	color2 = color_coerce(other, COLOR_MODEL_CMYK, &tmp, COLOR_COERCE_DISTANCE);
 	return rb_float_new(sqrtf((
 		powf(CHR2FLOAT(color1->c) - CHR2FLOAT(color2->c), 2) +
 		powf(CHR2FLOAT(color1->m) - CHR2FLOAT(color2->m), 2) +
@@ -271,8 +279,8 @@ rb_color_cmyk_eql(VALUE self, VALUE other)
 		return Qfalse;
 	}
 	cCMYK *color1, *color2;
-	Data_Get_Struct(self, cCMYK, color1);
-	Data_Get_Struct(other, cCMYK, color2);
+	COLOR_GET_STRUCT(self, cCMYK, color1);
+	COLOR_GET_STRUCT(other, cCMYK, color2);
 	return (
 		color1->c     == color2->c &&
 		color1->m     == color2->m &&
@@ -293,7 +301,7 @@ extern VALUE
 rb_color_cmyk_hash(VALUE self)
 {
 	cCMYK *color;
-	Data_Get_Struct(self, cCMYK, color);
+	COLOR_GET_STRUCT(self, cCMYK, color);
 
 	return INT2FIX(
 		(8) ^
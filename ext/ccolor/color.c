@@ -7,6 +7,30 @@
 #include "hsl.h"
 #include "cmyk.h"
 #include "gray.h"
+#include "rgb16.h"
+#include "rgbf.h"
+#include "ycbcr.h"
+#include "convert.h"
+#include "buffer.h"
+#include "linear.h"
+#include "quantize.h"
+#include "adjust.h"
+#include "lazy.h"
+#include "contrast.h"
+#include "sort.h"
+#include "stats.h"
+#include "dispatch.h"
+#include "palette.h"
+#include "css.h"
+#include "export.h"
+#include "term.h"
+#include "packed.h"
+#include "planar.h"
+#include "alpha.h"
+#include "statistics.h"
+#include "diff.h"
+#include "named.h"
+#include "gradient.h"
 
 VALUE rb_mColor;
 VALUE rb_cRGB;
@@ -14,8 +38,43 @@ VALUE rb_cHSV;
 VALUE rb_cHSL;
 VALUE rb_cCMYK;
 VALUE rb_cGray;
+VALUE rb_cRGB16;
+VALUE rb_cRGBF;
+VALUE rb_cYCbCr;
 VALUE rb_cXYZ;
+VALUE rb_cBuffer;
+VALUE rb_cConverter;
+VALUE rb_cPalette;
+VALUE rb_cStats;
+VALUE rb_cGradient;
+VALUE rb_mCSS;
+VALUE rb_mExport;
+VALUE rb_cNamed;
+VALUE rb_cTerm;
+VALUE rb_cTermWriter;
 
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+// see COLOR_MAKE_VALUE
+const rb_data_type_t color_value_type = {
+	"Color value",
+	{ NULL, RUBY_TYPED_DEFAULT_FREE, NULL, NULL, { NULL } },
+	NULL, NULL,
+	RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_FROZEN_SHAREABLE
+};
+
+/*
+ * The struct of a typed or plain data object, see COLOR_GET_STRUCT in
+ * color.h.
+ */
+extern void *
+color_data_get(VALUE obj)
+{
+	if (!RB_TYPE_P(obj, T_DATA)) {
+		rb_raise(rb_eTypeError, "wrong argument type %s (expected Data)", rb_obj_classname(obj));
+	}
+	return COLOR_DATA_PTR(obj);
+}
+#endif
 
 /*
  *  call-seq:
@@ -30,8 +89,18 @@ rb_color__native(VALUE class)
 }
 
 void
-Init_ccolor()
+Init_ccolor(void)
 {
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+	rb_ext_ractor_safe(1);
+#endif
+	color_linear_init();
+	color_statistics_init();
+	color_dispatch_init();
+	color_coerce_init();
+	color_css_init();
+	color_export_init();
+
 	rb_mColor = rb_define_module("Color");
 	rb_cRGB   = rb_define_class_under(rb_mColor, "RGB",  rb_cObject);
 	rb_cHSV   = rb_define_class_under(rb_mColor, "HSV",  rb_cObject);
@@ -39,14 +108,41 @@ Init_ccolor()
 	rb_cXYZ   = rb_define_class_under(rb_mColor, "XYZ",  rb_cObject);
 	rb_cCMYK  = rb_define_class_under(rb_mColor, "CMYK", rb_cObject);
 	rb_cGray  = rb_define_class_under(rb_mColor, "Gray", rb_cObject);
+	rb_cRGB16 = rb_define_class_under(rb_mColor, "RGB16", rb_cObject);
+	rb_cRGBF  = rb_define_class_under(rb_mColor, "RGBF",  rb_cObject);
+	rb_cYCbCr = rb_define_class_under(rb_mColor, "YCbCr", rb_cObject);
+	rb_cBuffer    = rb_define_class_under(rb_mColor, "Buffer",    rb_cObject);
+	rb_cConverter = rb_define_class_under(rb_mColor, "Converter", rb_cObject);
+	rb_cPalette   = rb_define_class_under(rb_mColor, "Palette",   rb_cObject);
+	rb_cStats     = rb_define_class_under(rb_mColor, "Stats",     rb_cObject);
+	rb_cGradient  = rb_define_class_under(rb_mColor, "Gradient",  rb_cObject);
+	rb_mCSS       = rb_define_module_under(rb_mColor, "CSS");
+	rb_mExport    = rb_define_module_under(rb_mColor, "Export");
+	rb_cNamed      = rb_define_class_under(rb_mColor, "Named",  rb_cObject);
+	rb_cTerm       = rb_define_class_under(rb_mColor, "Term",   rb_cObject);
+	rb_cTermWriter = rb_define_class_under(rb_cTerm,  "Writer", rb_cObject);
 
 	rb_define_singleton_method(rb_mColor, "native?", rb_color__native, 0);
+	rb_define_singleton_method(rb_mColor, "stats", rb_color__stats, 0);
+	rb_define_singleton_method(rb_mColor, "reset_stats", rb_color__reset_stats, 0);
+	rb_define_singleton_method(rb_mColor, "simd_level", rb_color__simd_level, 0);
+	rb_define_singleton_method(rb_mColor, "simd_level=", rb_color__set_simd_level, 1);
+	rb_define_singleton_method(rb_mColor, "simd_levels", rb_color__simd_levels, 0);
 
 	rb_define_alloc_func(rb_cRGB,  rb_color_rgb__allocate);
 	rb_define_alloc_func(rb_cHSV,  rb_color_hsv__allocate);
 	rb_define_alloc_func(rb_cHSL,  rb_color_hsl__allocate);
 	rb_define_alloc_func(rb_cCMYK, rb_color_cmyk__allocate);
 	rb_define_alloc_func(rb_cGray, rb_color_gray__allocate);
+	rb_define_alloc_func(rb_cRGB16, rb_color_rgb16__allocate);
+	rb_define_alloc_func(rb_cRGBF,  rb_color_rgbf__allocate);
+	rb_define_alloc_func(rb_cYCbCr, rb_color_ycbcr__allocate);
+	rb_define_alloc_func(rb_cBuffer,    rb_color_buffer__allocate);
+	rb_define_alloc_func(rb_cConverter, rb_color_converter__allocate);
+	rb_define_alloc_func(rb_cPalette,   rb_color_palette__allocate);
+	rb_define_alloc_func(rb_cStats,     rb_color_stats__allocate);
+	rb_define_alloc_func(rb_cGradient,  rb_color_gradient__allocate);
+	rb_define_alloc_func(rb_cTermWriter, rb_color_term_writer__allocate);
 
 	rb_define_singleton_method(rb_cRGB, "from_int", rb_color_rgb__from_int, 1);
 
@@ -61,8 +157,11 @@ Init_ccolor()
 	rb_define_method(rb_cRGB, "closest",     rb_color_rgb_closest,     1);
 	rb_define_method(rb_cRGB, "complement",  rb_color_rgb_complement,  0);
 	rb_define_method(rb_cRGB, "distance",    rb_color_rgb_distance,    1);
-	rb_define_method(rb_cRGB, "interpolate", rb_color_rgb_interpolate, 2);
-	rb_define_method(rb_cRGB, "sequence",    rb_color_rgb_sequence,    2);
+	rb_define_method(rb_cRGB, "interpolate", rb_color_rgb_interpolate, -1);
+	rb_define_method(rb_cRGB, "sequence",    rb_color_rgb_sequence,    -1);
+	rb_define_method(rb_cRGB, "blend",       rb_color_rgb_blend,       -1);
+	rb_define_method(rb_cRGB, "relative_luminance", rb_color_rgb_relative_luminance, 0);
+	rb_define_method(rb_cRGB, "contrast",    rb_color_rgb_contrast,    1);
 	rb_define_method(rb_cRGB, "hash",        rb_color_rgb_hash,        0);
 	rb_define_method(rb_cRGB, "eql?",        rb_color_rgb_eql,         1);
 	rb_define_alias(rb_cRGB, "==", "eql?");
@@ -71,6 +170,9 @@ Init_ccolor()
 	rb_define_method(rb_cRGB, "to_hsl",      rb_color_rgb_to_hsl,  0);
 	rb_define_method(rb_cRGB, "to_cmyk",     rb_color_rgb_to_cmyk, 0);
 	rb_define_method(rb_cRGB, "to_gray",     rb_color_rgb_to_gray, 0);
+	rb_define_method(rb_cRGB, "to_rgb16",    rb_color_rgb_to_rgb16, 0);
+	rb_define_method(rb_cRGB, "to_rgbf",     rb_color_rgb_to_rgbf, 0);
+	rb_define_method(rb_cRGB, "to_ycbcr",    rb_color_rgb_to_ycbcr, 0);
 
 	rb_define_method(rb_cHSV, "initialize",      rb_color_hsv_initialize, -1);
 	rb_define_method(rb_cHSV, "initialize_copy", rb_color_hsv_initialize_copy, 1);
@@ -86,6 +188,8 @@ Init_ccolor()
 	rb_define_method(rb_cHSV, "eql?",       rb_color_hsv_eql, 1);
 	rb_define_alias(rb_cHSV, "==", "eql?");
 	rb_define_method(rb_cHSV, "to_rgb",     rb_color_hsv_to_rgb, 0);
+	rb_define_method(rb_cHSV, "to_rgb16",   rb_color_hsv_to_rgb16, 0);
+	rb_define_method(rb_cHSV, "to_rgbf",    rb_color_hsv_to_rgbf, 0);
 
 	rb_define_method(rb_cHSL, "initialize",      rb_color_hsl_initialize, -1);
 	rb_define_method(rb_cHSL, "initialize_copy", rb_color_hsl_initialize_copy, 1);
@@ -101,6 +205,8 @@ Init_ccolor()
 	rb_define_method(rb_cHSL, "eql?",       rb_color_hsl_eql, 1);
 	rb_define_alias(rb_cHSL, "==", "eql?");
 	rb_define_method(rb_cHSL, "to_rgb",     rb_color_hsl_to_rgb, 0);
+	rb_define_method(rb_cHSL, "to_rgb16",   rb_color_hsl_to_rgb16, 0);
+	rb_define_method(rb_cHSL, "to_rgbf",    rb_color_hsl_to_rgbf, 0);
 
 	rb_define_method(rb_cCMYK, "initialize",      rb_color_cmyk_initialize, -1);
 	rb_define_method(rb_cCMYK, "initialize_copy", rb_color_cmyk_initialize_copy, 1);
@@ -129,8 +235,157 @@ Init_ccolor()
 	rb_define_method(rb_cGray, "distance", rb_color_gray_distance, 1);
 	rb_define_method(rb_cGray, "to_rgb",   rb_color_gray_to_rgb, 0);
 	rb_define_method(rb_cGray, "to_cmyk",  rb_color_gray_to_cmyk, 0);
-	rb_define_method(rb_cGray, "to_i",     rb_color_gray_to_i, 0);
+	rb_define_method(rb_cGray, "to_i",     rb_color_gray_to_i, -1);
 	rb_define_method(rb_cGray, "eql?",     rb_color_gray_eql, 1);
 	rb_define_alias(rb_cGray, "==", "eql?");
 	rb_define_method(rb_cGray, "hash",     rb_color_gray_hash, 0);
+
+	rb_define_method(rb_cRGB16, "initialize",      rb_color_rgb16_initialize, -1);
+	rb_define_method(rb_cRGB16, "initialize_copy", rb_color_rgb16_initialize_copy, 1);
+	rb_define_method(rb_cRGB16, "red",      rb_color_rgb16_red, 0);
+	rb_define_method(rb_cRGB16, "green",    rb_color_rgb16_green, 0);
+	rb_define_method(rb_cRGB16, "blue",     rb_color_rgb16_blue, 0);
+	rb_define_method(rb_cRGB16, "alpha",    rb_color_rgb16_alpha, 0);
+	rb_define_method(rb_cRGB16, "distance", rb_color_rgb16_distance, 1);
+	rb_define_method(rb_cRGB16, "hash",     rb_color_rgb16_hash, 0);
+	rb_define_method(rb_cRGB16, "eql?",     rb_color_rgb16_eql, 1);
+	rb_define_alias(rb_cRGB16, "==", "eql?");
+	rb_define_method(rb_cRGB16, "to_rgb",   rb_color_rgb16_to_rgb, 0);
+	rb_define_method(rb_cRGB16, "to_rgbf",  rb_color_rgb16_to_rgbf, 0);
+	rb_define_method(rb_cRGB16, "to_hsv",   rb_color_rgb16_to_hsv, 0);
+	rb_define_method(rb_cRGB16, "to_hsl",   rb_color_rgb16_to_hsl, 0);
+
+	rb_define_method(rb_cRGBF, "initialize",      rb_color_rgbf_initialize, -1);
+	rb_define_method(rb_cRGBF, "initialize_copy", rb_color_rgbf_initialize_copy, 1);
+	rb_define_method(rb_cRGBF, "red",      rb_color_rgbf_red, 0);
+	rb_define_method(rb_cRGBF, "green",    rb_color_rgbf_green, 0);
+	rb_define_method(rb_cRGBF, "blue",     rb_color_rgbf_blue, 0);
+	rb_define_method(rb_cRGBF, "alpha",    rb_color_rgbf_alpha, 0);
+	rb_define_method(rb_cRGBF, "distance", rb_color_rgbf_distance, 1);
+	rb_define_method(rb_cRGBF, "hash",     rb_color_rgbf_hash, 0);
+	rb_define_method(rb_cRGBF, "eql?",     rb_color_rgbf_eql, 1);
+	rb_define_alias(rb_cRGBF, "==", "eql?");
+	rb_define_method(rb_cRGBF, "to_rgb",   rb_color_rgbf_to_rgb, 0);
+	rb_define_method(rb_cRGBF, "to_rgb16", rb_color_rgbf_to_rgb16, 0);
+	rb_define_method(rb_cRGBF, "to_hsv",   rb_color_rgbf_to_hsv, 0);
+	rb_define_method(rb_cRGBF, "to_hsl",   rb_color_rgbf_to_hsl, 0);
+
+	rb_define_method(rb_cYCbCr, "initialize",      rb_color_ycbcr_initialize, -1);
+	rb_define_method(rb_cYCbCr, "initialize_copy", rb_color_ycbcr_initialize_copy, 1);
+	rb_define_method(rb_cYCbCr, "y",        rb_color_ycbcr_y, 0);
+	rb_define_alias(rb_cYCbCr, "luma", "y");
+	rb_define_method(rb_cYCbCr, "cb",       rb_color_ycbcr_cb, 0);
+	rb_define_method(rb_cYCbCr, "cr",       rb_color_ycbcr_cr, 0);
+	rb_define_method(rb_cYCbCr, "alpha",    rb_color_ycbcr_alpha, 0);
+	rb_define_method(rb_cYCbCr, "distance", rb_color_ycbcr_distance, 1);
+	rb_define_method(rb_cYCbCr, "hash",     rb_color_ycbcr_hash, 0);
+	rb_define_method(rb_cYCbCr, "eql?",     rb_color_ycbcr_eql, 1);
+	rb_define_alias(rb_cYCbCr, "==", "eql?");
+	rb_define_method(rb_cYCbCr, "to_rgb",   rb_color_ycbcr_to_rgb, 0);
+
+	rb_define_singleton_method(rb_cBuffer, "from", rb_color_buffer__from, -1);
+	rb_define_singleton_method(rb_cBuffer, "unpack", rb_color_buffer__unpack, -1);
+	rb_define_singleton_method(rb_cBuffer, "repack", rb_color_buffer__repack, -1);
+	rb_define_singleton_method(rb_cBuffer, "from_planar", rb_color_buffer__from_planar, -1);
+	rb_define_method(rb_cBuffer, "initialize",      rb_color_buffer_initialize, -1);
+	rb_define_method(rb_cBuffer, "initialize_copy", rb_color_buffer_initialize_copy, 1);
+	rb_define_method(rb_cBuffer, "model",   rb_color_buffer_model, 0);
+	rb_define_method(rb_cBuffer, "length",  rb_color_buffer_length, 0);
+	rb_define_alias(rb_cBuffer, "size", "length");
+	rb_define_method(rb_cBuffer, "[]",      rb_color_buffer_aref, 1);
+	rb_define_method(rb_cBuffer, "[]=",     rb_color_buffer_aset, 2);
+	rb_define_method(rb_cBuffer, "each",    rb_color_buffer_each, 0);
+	rb_define_method(rb_cBuffer, "data",    rb_color_buffer_data, 0);
+	rb_define_method(rb_cBuffer, "pack",    rb_color_buffer_pack, -1);
+	rb_define_method(rb_cBuffer, "to_planar", rb_color_buffer_to_planar, -1);
+	rb_define_method(rb_cBuffer, "with_alpha",  rb_color_buffer_with_alpha, -1);
+	rb_define_method(rb_cBuffer, "with_alpha!", rb_color_buffer_with_alpha_bang, -1);
+	rb_define_method(rb_cBuffer, "premultiplied?", rb_color_buffer_premultiplied_p, 0);
+	rb_define_method(rb_cBuffer, "opacity?",       rb_color_buffer_opacity_p, 0);
+	rb_define_method(rb_cBuffer, "convert", rb_color_buffer_convert, -1);
+	rb_define_method(rb_cBuffer, "interpolate", rb_color_buffer_interpolate, -1);
+	rb_define_method(rb_cBuffer, "blend",       rb_color_buffer_blend, -1);
+	rb_define_method(rb_cBuffer, "diff",        rb_color_buffer_diff, -1);
+	rb_define_method(rb_cBuffer, "quantize",    rb_color_buffer_quantize, -1);
+	rb_define_method(rb_cBuffer, "adjust",      rb_color_buffer_adjust, -1);
+	rb_define_method(rb_cBuffer, "adjust!",     rb_color_buffer_adjust_bang, -1);
+	rb_define_method(rb_cBuffer, "_pipeline",   rb_color_buffer_pipeline, -1);
+	rb_define_method(rb_cBuffer, "relative_luminance", rb_color_buffer_relative_luminance, 0);
+	rb_define_method(rb_cBuffer, "contrast_matrix",    rb_color_buffer_contrast_matrix, 1);
+	rb_define_method(rb_cBuffer, "best_foreground",    rb_color_buffer_best_foreground, 1);
+	rb_define_method(rb_cBuffer, "order",       rb_color_buffer_order, -1);
+	rb_define_method(rb_cBuffer, "permute",     rb_color_buffer_permute, 1);
+	rb_define_method(rb_cBuffer, "sort_by_key", rb_color_buffer_sort_by_key, -1);
+
+	rb_define_method(rb_cConverter, "initialize",     rb_color_converter_initialize, 1);
+	rb_define_method(rb_cConverter, "from",           rb_color_converter_from, 0);
+	rb_define_method(rb_cConverter, "to",             rb_color_converter_to, 0);
+	rb_define_method(rb_cConverter, "steps",          rb_color_converter_steps, 0);
+	rb_define_method(rb_cConverter, "convert",        rb_color_converter_convert, 1);
+	rb_define_method(rb_cConverter, "convert_many",   rb_color_converter_convert_many, 1);
+	rb_define_method(rb_cConverter, "convert_buffer", rb_color_converter_convert_buffer, 1);
+
+	rb_define_method(rb_cPalette, "initialize",      rb_color_palette_initialize, 1);
+	rb_define_method(rb_cPalette, "initialize_copy", rb_color_palette_initialize_copy, 1);
+	rb_define_method(rb_cPalette, "size",         rb_color_palette_size, 0);
+	rb_define_alias(rb_cPalette, "length", "size");
+	rb_define_method(rb_cPalette, "[]",           rb_color_palette_aref, 1);
+	rb_define_method(rb_cPalette, "to_a",         rb_color_palette_to_a, 0);
+	rb_define_method(rb_cPalette, "nearest",      rb_color_palette_nearest, 1);
+	rb_define_method(rb_cPalette, "closest",      rb_color_palette_closest, 1);
+	rb_define_method(rb_cPalette, "indices",      rb_color_palette_indices, -1);
+	rb_define_method(rb_cPalette, "compile",      rb_color_palette_compile, -1);
+	rb_define_method(rb_cPalette, "compiled?",    rb_color_palette_compiled, 0);
+	rb_define_method(rb_cPalette, "compile_info", rb_color_palette_compile_info, 0);
+
+	rb_define_singleton_method(rb_cStats, "_load", rb_color_stats__load, 1);
+	rb_define_method(rb_cStats, "initialize",      rb_color_stats_initialize, -1);
+	rb_define_method(rb_cStats, "initialize_copy", rb_color_stats_initialize_copy, 1);
+	rb_define_method(rb_cStats, "add",        rb_color_stats_add, 1);
+	rb_define_alias(rb_cStats, "<<", "add");
+	rb_define_method(rb_cStats, "merge",      rb_color_stats_merge, 1);
+	rb_define_method(rb_cStats, "merge!",     rb_color_stats_merge_bang, 1);
+	rb_define_method(rb_cStats, "count",      rb_color_stats_count, 0);
+	rb_define_method(rb_cStats, "mean",       rb_color_stats_mean, 0);
+	rb_define_method(rb_cStats, "variance",   rb_color_stats_variance, 0);
+	rb_define_method(rb_cStats, "min",        rb_color_stats_min, 0);
+	rb_define_method(rb_cStats, "max",        rb_color_stats_max, 0);
+	rb_define_method(rb_cStats, "hue",        rb_color_stats_hue, 0);
+	rb_define_method(rb_cStats, "hue_concentration", rb_color_stats_hue_concentration, 0);
+	rb_define_method(rb_cStats, "luminance",  rb_color_stats_luminance, 0);
+	rb_define_method(rb_cStats, "top",        rb_color_stats_top, -1);
+	rb_define_method(rb_cStats, "_dump",      rb_color_stats_dump, 1);
+
+	rb_define_singleton_method(rb_cGradient, "[]",        rb_color_gradient_s_colormap, 1);
+	rb_define_singleton_method(rb_cGradient, "colormaps", rb_color_gradient_s_colormaps, 0);
+	rb_define_method(rb_cGradient, "initialize",      rb_color_gradient_initialize, 1);
+	rb_define_method(rb_cGradient, "initialize_copy", rb_color_gradient_initialize_copy, 1);
+	rb_define_method(rb_cGradient, "size",  rb_color_gradient_size, 0);
+	rb_define_method(rb_cGradient, "stops", rb_color_gradient_stops, 0);
+	rb_define_method(rb_cGradient, "at",    rb_color_gradient_at, 1);
+	rb_define_method(rb_cGradient, "reverse",  rb_color_gradient_reverse, 0);
+	rb_define_method(rb_cGradient, "discrete", rb_color_gradient_discrete, 1);
+	rb_define_method(rb_cGradient, "bake",  rb_color_gradient_bake, -1);
+	rb_define_method(rb_cGradient, "apply", rb_color_gradient_apply, -1);
+
+	rb_define_singleton_method(rb_mCSS, "parse",       rb_color_css__parse, 1);
+	rb_define_singleton_method(rb_mCSS, "format",      rb_color_css__format, -1);
+	rb_define_singleton_method(rb_mCSS, "cache_size",  rb_color_css__cache_size, 0);
+	rb_define_singleton_method(rb_mCSS, "cache_size=", rb_color_css__set_cache_size, 1);
+	rb_define_singleton_method(rb_mCSS, "cache_info",  rb_color_css__cache_info, 0);
+	rb_define_singleton_method(rb_mCSS, "clear_cache", rb_color_css__clear_cache, 0);
+
+	rb_define_singleton_method(rb_mExport, "css",  rb_color_export__css, -1);
+	rb_define_singleton_method(rb_mExport, "json", rb_color_export__json, -1);
+	rb_define_singleton_method(rb_mExport, "csv",  rb_color_export__csv, -1);
+
+	rb_define_singleton_method(rb_cNamed, "_names", rb_color_named__names, 0);
+
+	rb_define_method(rb_cTermWriter, "initialize", rb_color_term_writer_initialize, -1);
+	rb_define_method(rb_cTermWriter, "write",      rb_color_term_writer_write, -1);
+	rb_define_method(rb_cTermWriter, "<<",         rb_color_term_writer_append, 1);
+	rb_define_method(rb_cTermWriter, "reset",      rb_color_term_writer_reset, 0);
+	rb_define_method(rb_cTermWriter, "flush",      rb_color_term_writer_flush, 0);
+	rb_define_method(rb_cTermWriter, "to",         rb_color_term_writer_to, 0);
+	rb_define_method(rb_cTermWriter, "depth",      rb_color_term_writer_depth, 0);
 }
@@ -1,6 +1,9 @@
 #define CHR2LONG(x) (long)((x)&0xff)
 #define CHR2FLOAT(x) (((float)((x)&0xff))/255)
 #define FLOAT2CHR(x) (((unsigned char)(roundf((x)*255)))&0xff)
+#define SHORT2FLOAT(x) (((float)((x)&0xffff))/65535)
+#define FLOAT2SHORT(x) (((unsigned short)(roundf((x)*65535)))&0xffff)
+#define SHORT2CHR(x) ((unsigned char)((((x)&0xffff)*255+32767)/65535))
 #define IN_DELTA(x,y) (fabsf((x)-(y)) < 0.0001)
 
 extern VALUE rb_mColor;
@@ -9,7 +12,20 @@ extern VALUE rb_cHSV;
 extern VALUE rb_cHSL;
 extern VALUE rb_cCMYK;
 extern VALUE rb_cGray;
+extern VALUE rb_cRGB16;
+extern VALUE rb_cRGBF;
+extern VALUE rb_cYCbCr;
 extern VALUE rb_cXYZ;
+extern VALUE rb_cBuffer;
+extern VALUE rb_cConverter;
+extern VALUE rb_cPalette;
+extern VALUE rb_cStats;
+extern VALUE rb_cGradient;
+extern VALUE rb_mCSS;
+extern VALUE rb_mExport;
+extern VALUE rb_cNamed;
+extern VALUE rb_cTerm;
+extern VALUE rb_cTermWriter;
 
 typedef struct _cRGB {
 	unsigned char r;     // red
@@ -45,4 +61,187 @@ typedef struct _cGray {
 	unsigned char alpha; // transparency, 0 = opaque, 255 = transparent
 } cGray;
 
-extern VALUE rb_color__native(VALUE class);
\ No newline at end of file
+typedef struct _cRGB16 {
+	unsigned short r;     // red
+	unsigned short g;     // green
+	unsigned short b;     // blue
+	unsigned short alpha; // transparency, 0 = opaque, 65535 = transparent
+} cRGB16;
+
+typedef struct _cRGBF {
+	float r;             // red (0..1, may exceed 1 for HDR content)
+	float g;             // green (0..1, may exceed 1 for HDR content)
+	float b;             // blue (0..1, may exceed 1 for HDR content)
+	float alpha;         // transparency, 0 = opaque, 1 = transparent
+} cRGBF;
+
+typedef struct _cYCbCr {
+	unsigned char y;     // luma
+	unsigned char cb;    // blue difference, 128 is neutral
+	unsigned char cr;    // red difference, 128 is neutral
+	unsigned char alpha; // transparency, 0 = opaque, 255 = transparent
+} cYCbCr;
+
+// color models known to the native conversion table
+enum {
+	COLOR_MODEL_RGB,
+	COLOR_MODEL_HSV,
+	COLOR_MODEL_HSL,
+	COLOR_MODEL_CMYK,
+	COLOR_MODEL_GRAY,
+	COLOR_MODEL_RGB16,
+	COLOR_MODEL_RGBF,
+	COLOR_MODEL_YCBCR,
+	COLOR_MODEL_COUNT
+};
+
+typedef union _cAny {
+	cRGB  rgb;
+	cHSV  hsv;
+	cHSL  hsl;
+	cCMYK cmyk;
+	cGray gray;
+	cRGB16 rgb16;
+	cRGBF rgbf;
+	cYCbCr ycbcr;
+} cAny;
+
+// how float and 16 bit buffers are reduced to 8 bit
+enum {
+	COLOR_ROUND_NEAREST,
+	COLOR_ROUND_FLOOR,
+	COLOR_ROUND_DITHER
+};
+
+typedef void (*color_convert_fn)(void *from, void *to);
+
+typedef struct _cConverter {
+	int from;                                 // source model
+	int to;                                   // target model
+	int steps;                                // number of kernels in fn
+	color_convert_fn fn[COLOR_MODEL_COUNT];   // resolved route
+	int rounding;                             // COLOR_ROUND_*, for buffers to RGB
+	long width;                               // row width for dithering
+} cConverter;
+
+// how the alpha of RGB buffers is stored, the default (0) is straight
+// transparency like in cRGB
+enum {
+	COLOR_ALPHA_PREMULTIPLIED = 1, // red, green and blue are scaled by the opacity
+	COLOR_ALPHA_OPACITY       = 2  // alpha is the opacity, 255 = opaque
+};
+
+typedef struct _cBuffer {
+	int   model;         // model of all elements
+	int   alpha;         // COLOR_ALPHA_* flags
+	long  length;        // number of elements
+	char *data;          // packed structs of the model
+} cBuffer;
+
+#define COLOR_PALETTE_MAX 256
+
+// a palette as planes of floats for the nearest color search, entries
+// past size are NaN up to the next multiple of 16, so they never match
+typedef struct _cPalette {
+	long  size;
+	float r[COLOR_PALETTE_MAX];
+	float g[COLOR_PALETTE_MAX];
+	float b[COLOR_PALETTE_MAX];
+	float alpha[COLOR_PALETTE_MAX];
+} cPalette;
+
+// cells over RGB (and alpha, when the entries differ in it) holding the
+// entries that can be nearest to some color of the cell, see palette.c
+typedef struct _cPaletteGrid {
+	int resolution;            // cells per channel, 16 or 32, 0 when not compiled
+	int shift;                 // channel >> shift is the cell
+	int alpha_cells;           // 1 when all entries share their alpha, else 4
+	unsigned int  *offsets;    // per cell, start in candidates, one more at the end
+	unsigned char *candidates; // entry indices, ascending per cell
+	long   total;              // number of candidates
+	int    most;               // largest number of candidates of a cell
+	double seconds;            // time spent compiling
+} cPaletteGrid;
+
+// a Color::Palette
+typedef struct _cColorPalette {
+	cRGB         colors[COLOR_PALETTE_MAX];
+	cPalette     planes;
+	cPaletteGrid grid;
+} cColorPalette;
+
+extern VALUE rb_color__native(VALUE class);
+
+// instrumentation, compiled in with --enable-stats, see stats.c
+enum {
+	COLOR_KERNEL_CLOSEST,
+	COLOR_KERNEL_QUANTIZE,
+	COLOR_KERNEL_ADJUST,
+	COLOR_KERNEL_PIPELINE,
+	COLOR_KERNEL_BLEND,
+	COLOR_KERNEL_INTERPOLATE,
+	COLOR_KERNEL_LUMINANCE,
+	COLOR_KERNEL_CONTRAST,
+	COLOR_KERNEL_BEST_FOREGROUND,
+	COLOR_KERNEL_SORT,
+	COLOR_KERNEL_PERMUTE,
+	COLOR_KERNEL_PALETTE,
+	COLOR_KERNEL_PACK,
+	COLOR_KERNEL_PLANAR,
+	COLOR_KERNEL_ALPHA,
+	COLOR_KERNEL_STATISTICS,
+	COLOR_KERNEL_DIFF,
+	COLOR_KERNEL_GRADIENT,
+	COLOR_KERNEL_COUNT
+};
+
+enum {
+	COLOR_COERCE_CLOSEST,
+	COLOR_COERCE_BLEND,
+	COLOR_COERCE_CONTRAST,
+	COLOR_COERCE_STORE,
+	COLOR_COERCE_ARITHMETIC,
+	COLOR_COERCE_DISTANCE,
+	COLOR_COERCE_INTERPOLATE,
+	COLOR_COERCE_FORMAT,
+	COLOR_COERCE_COUNT
+};
+
+#ifdef COLOR_STATS
+extern void color_stats_alloc(VALUE class);
+extern void color_stats_convert(int from, int to, long elements);
+extern void color_stats_kernel(int kernel, long elements);
+extern void color_stats_coerce(int site);
+#define COLOR_STAT_ALLOC(class) color_stats_alloc(class)
+#define COLOR_STAT_CONVERT(from, to, elements) color_stats_convert(from, to, elements)
+#define COLOR_STAT_KERNEL(kernel, elements) color_stats_kernel(kernel, elements)
+#define COLOR_STAT_COERCE(site) color_stats_coerce(site)
+#else
+#define COLOR_STAT_ALLOC(class) ((void)0)
+#define COLOR_STAT_CONVERT(from, to, elements) ((void)0)
+#define COLOR_STAT_KERNEL(kernel, elements) ((void)0)
+#define COLOR_STAT_COERCE(site) ((void)0)
+#endif
+
+// Data_Make_Struct, counting the allocation
+#define COLOR_MAKE_STRUCT(class, type, mark, free, ptr) \
+	(COLOR_STAT_ALLOC(class), Data_Make_Struct(class, type, mark, free, ptr))
+
+// colors and converters never change once initialized, they are frozen by
+// initialize (allocate must not freeze, dup would fail) or when made in C,
+// and where ruby has ractors they are typed data shareable between them
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+extern const rb_data_type_t color_value_type;
+extern void *color_data_get(VALUE obj);
+#define COLOR_ALLOC_VALUE(class, type, ptr) \
+	(COLOR_STAT_ALLOC(class), TypedData_Make_Struct(class, type, &color_value_type, ptr))
+#define COLOR_DATA_PTR(obj) (RTYPEDDATA_P(obj) ? RTYPEDDATA_DATA(obj) : DATA_PTR(obj))
+// Data_Get_Struct, but ruby's rejects typed data and this one takes both
+#define COLOR_GET_STRUCT(obj, type, sval) ((sval) = (type *)color_data_get(obj))
+#else
+#define COLOR_ALLOC_VALUE(class, type, ptr) COLOR_MAKE_STRUCT(class, type, NULL, free, ptr)
+#define COLOR_DATA_PTR(obj) DATA_PTR(obj)
+#define COLOR_GET_STRUCT(obj, type, sval) Data_Get_Struct(obj, type, sval)
+#endif
+#define COLOR_MAKE_VALUE(class, type, ptr) rb_obj_freeze(COLOR_ALLOC_VALUE(class, type, ptr))
+#define COLOR_CHECK_FROZEN(obj) if (OBJ_FROZEN(obj)) rb_error_frozen(rb_obj_classname(obj))
@@ -0,0 +1,217 @@
+#include <ruby.h>
+#include "color.h"
+#include "colormaps.h"
+
+// The perceptually uniform colormaps of matplotlib (viridis, magma, inferno
+// and plasma by Nathaniel J. Smith and Stefan van der Walt, cividis by
+// Jamie R. Nuñez, Christopher R. Anderton and Ryan S. Renslow, CC0) and
+// Google's turbo (Anton Mikhailov, Apache 2.0), 256 entries each as
+// 0xRRGGBB, rounded from their float tables. Kept in the read only data of
+// the library, see Color::Gradient.[]
+const cColormap color_colormaps[] = {
+	{ "viridis", {
+		0x440154, 0x440256, 0x450457, 0x450559, 0x46075A, 0x46085C, 0x460A5D, 0x460B5E,
+		0x470D60, 0x470E61, 0x471063, 0x471164, 0x471365, 0x481467, 0x481668, 0x481769,
+		0x48186A, 0x481A6C, 0x481B6D, 0x481C6E, 0x481D6F, 0x481F70, 0x482071, 0x482173,
+		0x482374, 0x482475, 0x482576, 0x482677, 0x482878, 0x482979, 0x472A7A, 0x472C7A,
+		0x472D7B, 0x472E7C, 0x472F7D, 0x46307E, 0x46327E, 0x46337F, 0x463480, 0x453581,
+		0x453781, 0x453882, 0x443983, 0x443A83, 0x443B84, 0x433D84, 0x433E85, 0x423F85,
+		0x424086, 0x424186, 0x414287, 0x414487, 0x404588, 0x404688, 0x3F4788, 0x3F4889,
+		0x3E4989, 0x3E4A89, 0x3E4C8A, 0x3D4D8A, 0x3D4E8A, 0x3C4F8A, 0x3C508B, 0x3B518B,
+		0x3B528B, 0x3A538B, 0x3A548C, 0x39558C, 0x39568C, 0x38588C, 0x38598C, 0x375A8C,
+		0x375B8D, 0x365C8D, 0x365D8D, 0x355E8D, 0x355F8D, 0x34608D, 0x34618D, 0x33628D,
+		0x33638D, 0x32648E, 0x32658E, 0x31668E, 0x31678E, 0x31688E, 0x30698E, 0x306A8E,
+		0x2F6B8E, 0x2F6C8E, 0x2E6D8E, 0x2E6E8E, 0x2E6F8E, 0x2D708E, 0x2D718E, 0x2C718E,
+		0x2C728E, 0x2C738E, 0x2B748E, 0x2B758E, 0x2A768E, 0x2A778E, 0x2A788E, 0x29798E,
+		0x297A8E, 0x297B8E, 0x287C8E, 0x287D8E, 0x277E8E, 0x277F8E, 0x27808E, 0x26818E,
+		0x26828E, 0x26828E, 0x25838E, 0x25848E, 0x25858E, 0x24868E, 0x24878E, 0x23888E,
+		0x23898E, 0x238A8D, 0x228B8D, 0x228C8D, 0x228D8D, 0x218E8D, 0x218F8D, 0x21908D,
+		0x21918C, 0x20928C, 0x20928C, 0x20938C, 0x1F948C, 0x1F958B, 0x1F968B, 0x1F978B,
+		0x1F988B, 0x1F998A, 0x1F9A8A, 0x1E9B8A, 0x1E9C89, 0x1E9D89, 0x1F9E89, 0x1F9F88,
+		0x1FA088, 0x1FA188, 0x1FA187, 0x1FA287, 0x20A386, 0x20A486, 0x21A585, 0x21A685,
+		0x22A785, 0x22A884, 0x23A983, 0x24AA83, 0x25AB82, 0x25AC82, 0x26AD81, 0x27AD81,
+		0x28AE80, 0x29AF7F, 0x2AB07F, 0x2CB17E, 0x2DB27D, 0x2EB37C, 0x2FB47C, 0x31B57B,
+		0x32B67A, 0x34B679, 0x35B779, 0x37B878, 0x38B977, 0x3ABA76, 0x3BBB75, 0x3DBC74,
+		0x3FBC73, 0x40BD72, 0x42BE71, 0x44BF70, 0x46C06F, 0x48C16E, 0x4AC16D, 0x4CC26C,
+		0x4EC36B, 0x50C46A, 0x52C569, 0x54C568, 0x56C667, 0x58C765, 0x5AC864, 0x5CC863,
+		0x5EC962, 0x60CA60, 0x63CB5F, 0x65CB5E, 0x67CC5C, 0x69CD5B, 0x6CCD5A, 0x6ECE58,
+		0x70CF57, 0x73D056, 0x75D054, 0x77D153, 0x7AD151, 0x7CD250, 0x7FD34E, 0x81D34D,
+		0x84D44B, 0x86D549, 0x89D548, 0x8BD646, 0x8ED645, 0x90D743, 0x93D741, 0x95D840,
+		0x98D83E, 0x9BD93C, 0x9DD93B, 0xA0DA39, 0xA2DA37, 0xA5DB36, 0xA8DB34, 0xAADC32,
+		0xADDC30, 0xB0DD2F, 0xB2DD2D, 0xB5DE2B, 0xB8DE29, 0xBADE28, 0xBDDF26, 0xC0DF25,
+		0xC2DF23, 0xC5E021, 0xC8E020, 0xCAE11F, 0xCDE11D, 0xD0E11C, 0xD2E21B, 0xD5E21A,
+		0xD8E219, 0xDAE319, 0xDDE318, 0xDFE318, 0xE2E418, 0xE5E419, 0xE7E419, 0xEAE51A,
+		0xECE51B, 0xEFE51C, 0xF1E51D, 0xF4E61E, 0xF6E620, 0xF8E621, 0xFBE723, 0xFDE725,
+	} },
+	{ "magma", {
+		0x000004, 0x010005, 0x010106, 0x010108, 0x020109, 0x02020B, 0x02020D, 0x03030F,
+		0x030312, 0x040414, 0x050416, 0x060518, 0x06051A, 0x07061C, 0x08071E, 0x090720,
+		0x0A0822, 0x0B0924, 0x0C0926, 0x0D0A29, 0x0E0B2B, 0x100B2D, 0x110C2F, 0x120D31,
+		0x130D34, 0x140E36, 0x150E38, 0x160F3B, 0x180F3D, 0x19103F, 0x1A1042, 0x1C1044,
+		0x1D1147, 0x1E1149, 0x20114B, 0x21114E, 0x221150, 0x241253, 0x251255, 0x271258,
+		0x29115A, 0x2A115C, 0x2C115F, 0x2D1161, 0x2F1163, 0x311165, 0x331067, 0x341069,
+		0x36106B, 0x38106C, 0x390F6E, 0x3B0F70, 0x3D0F71, 0x3F0F72, 0x400F74, 0x420F75,
+		0x440F76, 0x451077, 0x471078, 0x491078, 0x4A1079, 0x4C117A, 0x4E117B, 0x4F127B,
+		0x51127C, 0x52137C, 0x54137D, 0x56147D, 0x57157E, 0x59157E, 0x5A167E, 0x5C167F,
+		0x5D177F, 0x5F187F, 0x601880, 0x621980, 0x641A80, 0x651A80, 0x671B80, 0x681C81,
+		0x6A1C81, 0x6B1D81, 0x6D1D81, 0x6E1E81, 0x701F81, 0x721F81, 0x732081, 0x752181,
+		0x762181, 0x782281, 0x792282, 0x7B2382, 0x7C2382, 0x7E2482, 0x802582, 0x812581,
+		0x832681, 0x842681, 0x862781, 0x882781, 0x892881, 0x8B2981, 0x8C2981, 0x8E2A81,
+		0x902A81, 0x912B81, 0x932B80, 0x942C80, 0x962C80, 0x982D80, 0x992D80, 0x9B2E7F,
+		0x9C2E7F, 0x9E2F7F, 0xA02F7F, 0xA1307E, 0xA3307E, 0xA5317E, 0xA6317D, 0xA8327D,
+		0xAA337D, 0xAB337C, 0xAD347C, 0xAE347B, 0xB0357B, 0xB2357B, 0xB3367A, 0xB5367A,
+		0xB73779, 0xB83779, 0xBA3878, 0xBC3978, 0xBD3977, 0xBF3A77, 0xC03A76, 0xC23B75,
+		0xC43C75, 0xC53C74, 0xC73D73, 0xC83E73, 0xCA3E72, 0xCC3F71, 0xCD4071, 0xCF4070,
+		0xD0416F, 0xD2426F, 0xD3436E, 0xD5446D, 0xD6456C, 0xD8456C, 0xD9466B, 0xDB476A,
+		0xDC4869, 0xDE4968, 0xDF4A68, 0xE04C67, 0xE24D66, 0xE34E65, 0xE44F64, 0xE55064,
+		0xE75263, 0xE85362, 0xE95462, 0xEA5661, 0xEB5760, 0xEC5860, 0xED5A5F, 0xEE5B5E,
+		0xEF5D5E, 0xF05F5E, 0xF1605D, 0xF2625D, 0xF2645C, 0xF3655C, 0xF4675C, 0xF4695C,
+		0xF56B5C, 0xF66C5C, 0xF66E5C, 0xF7705C, 0xF7725C, 0xF8745C, 0xF8765C, 0xF9785D,
+		0xF9795D, 0xF97B5D, 0xFA7D5E, 0xFA7F5E, 0xFA815F, 0xFB835F, 0xFB8560, 0xFB8761,
+		0xFC8961, 0xFC8A62, 0xFC8C63, 0xFC8E64, 0xFC9065, 0xFD9266, 0xFD9467, 0xFD9668,
+		0xFD9869, 0xFD9A6A, 0xFD9B6B, 0xFE9D6C, 0xFE9F6D, 0xFEA16E, 0xFEA36F, 0xFEA571,
+		0xFEA772, 0xFEA973, 0xFEAA74, 0xFEAC76, 0xFEAE77, 0xFEB078, 0xFEB27A, 0xFEB47B,
+		0xFEB67C, 0xFEB77E, 0xFEB97F, 0xFEBB81, 0xFEBD82, 0xFEBF84, 0xFEC185, 0xFEC287,
+		0xFEC488, 0xFEC68A, 0xFEC88C, 0xFECA8D, 0xFECC8F, 0xFECD90, 0xFECF92, 0xFED194,
+		0xFED395, 0xFED597, 0xFED799, 0xFED89A, 0xFDDA9C, 0xFDDC9E, 0xFDDEA0, 0xFDE0A1,
+		0xFDE2A3, 0xFDE3A5, 0xFDE5A7, 0xFDE7A9, 0xFDE9AA, 0xFDEBAC, 0xFCECAE, 0xFCEEB0,
+		0xFCF0B2, 0xFCF2B4, 0xFCF4B6, 0xFCF6B8, 0xFCF7B9, 0xFCF9BB, 0xFCFBBD, 0xFCFDBF,
+	} },
+	{ "inferno", {
+		0x000004, 0x010005, 0x010106, 0x010108, 0x02010A, 0x02020C, 0x02020E, 0x030210,
+		0x040312, 0x040314, 0x050417, 0x060419, 0x07051B, 0x08051D, 0x09061F, 0x0A0722,
+		0x0B0724, 0x0C0826, 0x0D0829, 0x0E092B, 0x10092D, 0x110A30, 0x120A32, 0x140B34,
+		0x150B37, 0x160B39, 0x180C3C, 0x190C3E, 0x1B0C41, 0x1C0C43, 0x1E0C45, 0x1F0C48,
+		0x210C4A, 0x230C4C, 0x240C4F, 0x260C51, 0x280B53, 0x290B55, 0x2B0B57, 0x2D0B59,
+		0x2F0A5B, 0x310A5C, 0x320A5E, 0x340A5F, 0x360961, 0x380962, 0x390963, 0x3B0964,
+		0x3D0965, 0x3E0966, 0x400A67, 0x420A68, 0x440A68, 0x450A69, 0x470B6A, 0x490B6A,
+		0x4A0C6B, 0x4C0C6B, 0x4D0D6C, 0x4F0D6C, 0x510E6C, 0x520E6D, 0x540F6D, 0x550F6D,
+		0x57106E, 0x59106E, 0x5A116E, 0x5C126E, 0x5D126E, 0x5F136E, 0x61136E, 0x62146E,
+		0x64156E, 0x65156E, 0x67166E, 0x69166E, 0x6A176E, 0x6C186E, 0x6D186E, 0x6F196E,
+		0x71196E, 0x721A6E, 0x741A6E, 0x751B6E, 0x771C6D, 0x781C6D, 0x7A1D6D, 0x7C1D6D,
+		0x7D1E6D, 0x7F1E6C, 0x801F6C, 0x82206C, 0x84206B, 0x85216B, 0x87216B, 0x88226A,
+		0x8A226A, 0x8C2369, 0x8D2369, 0x8F2469, 0x902568, 0x922568, 0x932667, 0x952667,
+		0x972766, 0x982766, 0x9A2865, 0x9B2964, 0x9D2964, 0x9F2A63, 0xA02A63, 0xA22B62,
+		0xA32C61, 0xA52C60, 0xA62D60, 0xA82E5F, 0xA92E5E, 0xAB2F5E, 0xAD305D, 0xAE305C,
+		0xB0315B, 0xB1325A, 0xB3325A, 0xB43359, 0xB63458, 0xB73557, 0xB93556, 0xBA3655,
+		0xBC3754, 0xBD3853, 0xBF3952, 0xC03A51, 0xC13A50, 0xC33B4F, 0xC43C4E, 0xC63D4D,
+		0xC73E4C, 0xC83F4B, 0xCA404A, 0xCB4149, 0xCC4248, 0xCE4347, 0xCF4446, 0xD04545,
+		0xD24644, 0xD34743, 0xD44842, 0xD54A41, 0xD74B3F, 0xD84C3E, 0xD94D3D, 0xDA4E3C,
+		0xDB503B, 0xDD513A, 0xDE5238, 0xDF5337, 0xE05536, 0xE15635, 0xE25734, 0xE35933,
+		0xE45A31, 0xE55C30, 0xE65D2F, 0xE75E2E, 0xE8602D, 0xE9612B, 0xEA632A, 0xEB6429,
+		0xEB6628, 0xEC6726, 0xED6925, 0xEE6A24, 0xEF6C23, 0xEF6E21, 0xF06F20, 0xF1711F,
+		0xF1731D, 0xF2741C, 0xF3761B, 0xF37819, 0xF47918, 0xF57B17, 0xF57D15, 0xF67E14,
+		0xF68013, 0xF78212, 0xF78410, 0xF8850F, 0xF8870E, 0xF8890C, 0xF98B0B, 0xF98C0A,
+		0xF98E09, 0xFA9008, 0xFA9207, 0xFA9407, 0xFB9606, 0xFB9706, 0xFB9906, 0xFB9B06,
+		0xFB9D07, 0xFC9F07, 0xFCA108, 0xFCA309, 0xFCA50A, 0xFCA60C, 0xFCA80D, 0xFCAA0F,
+		0xFCAC11, 0xFCAE12, 0xFCB014, 0xFCB216, 0xFCB418, 0xFBB61A, 0xFBB81D, 0xFBBA1F,
+		0xFBBC21, 0xFBBE23, 0xFAC026, 0xFAC228, 0xFAC42A, 0xFAC62D, 0xF9C72F, 0xF9C932,
+		0xF9CB35, 0xF8CD37, 0xF8CF3A, 0xF7D13D, 0xF7D340, 0xF6D543, 0xF6D746, 0xF5D949,
+		0xF5DB4C, 0xF4DD4F, 0xF4DF53, 0xF4E156, 0xF3E35A, 0xF3E55D, 0xF2E661, 0xF2E865,
+		0xF2EA69, 0xF1EC6D, 0xF1ED71, 0xF1EF75, 0xF1F179, 0xF2F27D, 0xF2F482, 0xF3F586,
+		0xF3F68A, 0xF4F88E, 0xF5F992, 0xF6FA96, 0xF8FB9A, 0xF9FC9D, 0xFAFDA1, 0xFCFFA4,
+	} },
+	{ "plasma", {
+		0x0D0887, 0x100788, 0x130789, 0x16078A, 0x19068C, 0x1B068D, 0x1D068E, 0x20068F,
+		0x220690, 0x240691, 0x260591, 0x280592, 0x2A0593, 0x2C0594, 0x2E0595, 0x2F0596,
+		0x310597, 0x330597, 0x350498, 0x370499, 0x38049A, 0x3A049A, 0x3C049B, 0x3E049C,
+		0x3F049C, 0x41049D, 0x43039E, 0x44039E, 0x46039F, 0x48039F, 0x4903A0, 0x4B03A1,
+		0x4C02A1, 0x4E02A2, 0x5002A2, 0x5102A3, 0x5302A3, 0x5502A4, 0x5601A4, 0x5801A4,
+		0x5901A5, 0x5B01A5, 0x5C01A6, 0x5E01A6, 0x6001A6, 0x6100A7, 0x6300A7, 0x6400A7,
+		0x6600A7, 0x6700A8, 0x6900A8, 0x6A00A8, 0x6C00A8, 0x6E00A8, 0x6F00A8, 0x7100A8,
+		0x7201A8, 0x7401A8, 0x7501A8, 0x7701A8, 0x7801A8, 0x7A02A8, 0x7B02A8, 0x7D03A8,
+		0x7E03A8, 0x8004A8, 0x8104A7, 0x8305A7, 0x8405A7, 0x8606A6, 0x8707A6, 0x8808A6,
+		0x8A09A5, 0x8B0AA5, 0x8D0BA5, 0x8E0CA4, 0x8F0DA4, 0x910EA3, 0x920FA3, 0x9410A2,
+		0x9511A1, 0x9613A1, 0x9814A0, 0x99159F, 0x9A169F, 0x9C179E, 0x9D189D, 0x9E199D,
+		0xA01A9C, 0xA11B9B, 0xA21D9A, 0xA31E9A, 0xA51F99, 0xA62098, 0xA72197, 0xA82296,
+		0xAA2395, 0xAB2494, 0xAC2694, 0xAD2793, 0xAE2892, 0xB02991, 0xB12A90, 0xB22B8F,
+		0xB32C8E, 0xB42E8D, 0xB52F8C, 0xB6308B, 0xB7318A, 0xB83289, 0xBA3388, 0xBB3488,
+		0xBC3587, 0xBD3786, 0xBE3885, 0xBF3984, 0xC03A83, 0xC13B82, 0xC23C81, 0xC33D80,
+		0xC43E7F, 0xC5407E, 0xC6417D, 0xC7427C, 0xC8437B, 0xC9447A, 0xCA457A, 0xCB4679,
+		0xCC4778, 0xCC4977, 0xCD4A76, 0xCE4B75, 0xCF4C74, 0xD04D73, 0xD14E72, 0xD24F71,
+		0xD35171, 0xD45270, 0xD5536F, 0xD5546E, 0xD6556D, 0xD7566C, 0xD8576B, 0xD9586A,
+		0xDA5A6A, 0xDA5B69, 0xDB5C68, 0xDC5D67, 0xDD5E66, 0xDE5F65, 0xDE6164, 0xDF6263,
+		0xE06363, 0xE16462, 0xE26561, 0xE26660, 0xE3685F, 0xE4695E, 0xE56A5D, 0xE56B5D,
+		0xE66C5C, 0xE76E5B, 0xE76F5A, 0xE87059, 0xE97158, 0xE97257, 0xEA7457, 0xEB7556,
+		0xEB7655, 0xEC7754, 0xED7953, 0xED7A52, 0xEE7B51, 0xEF7C51, 0xEF7E50, 0xF07F4F,
+		0xF0804E, 0xF1814D, 0xF1834C, 0xF2844B, 0xF3854B, 0xF3874A, 0xF48849, 0xF48948,
+		0xF58B47, 0xF58C46, 0xF68D45, 0xF68F44, 0xF79044, 0xF79143, 0xF79342, 0xF89441,
+		0xF89540, 0xF9973F, 0xF9983E, 0xF99A3E, 0xFA9B3D, 0xFA9C3C, 0xFA9E3B, 0xFB9F3A,
+		0xFBA139, 0xFBA238, 0xFCA338, 0xFCA537, 0xFCA636, 0xFCA835, 0xFCA934, 0xFDAB33,
+		0xFDAC33, 0xFDAE32, 0xFDAF31, 0xFDB130, 0xFDB22F, 0xFDB42F, 0xFDB52E, 0xFEB72D,
+		0xFEB82C, 0xFEBA2C, 0xFEBB2B, 0xFEBD2A, 0xFEBE2A, 0xFEC029, 0xFDC229, 0xFDC328,
+		0xFDC527, 0xFDC627, 0xFDC827, 0xFDCA26, 0xFDCB26, 0xFCCD25, 0xFCCE25, 0xFCD025,
+		0xFCD225, 0xFBD324, 0xFBD524, 0xFBD724, 0xFAD824, 0xFADA24, 0xF9DC24, 0xF9DD25,
+		0xF8DF25, 0xF8E125, 0xF7E225, 0xF7E425, 0xF6E626, 0xF6E826, 0xF5E926, 0xF5EB27,
+		0xF4ED27, 0xF3EE27, 0xF3F027, 0xF2F227, 0xF1F426, 0xF1F525, 0xF0F724, 0xF0F921,
+	} },
+	{ "cividis", {
+		0x00224E, 0x00234F, 0x002451, 0x002553, 0x002554, 0x002656, 0x002758, 0x002859,
+		0x00285B, 0x00295D, 0x002A5F, 0x002A61, 0x002B62, 0x002C64, 0x002C66, 0x002D68,
+		0x002E6A, 0x002E6C, 0x002F6D, 0x00306F, 0x003070, 0x003170, 0x003171, 0x013271,
+		0x053371, 0x083370, 0x0C3470, 0x0F3570, 0x123570, 0x143670, 0x163770, 0x18376F,
+		0x1A386F, 0x1C396F, 0x1E3A6F, 0x203A6F, 0x213B6E, 0x233C6E, 0x243C6E, 0x263D6E,
+		0x273E6E, 0x293F6E, 0x2A3F6D, 0x2B406D, 0x2D416D, 0x2E416D, 0x2F426D, 0x31436D,
+		0x32436D, 0x33446D, 0x34456C, 0x35456C, 0x36466C, 0x38476C, 0x39486C, 0x3A486C,
+		0x3B496C, 0x3C4A6C, 0x3D4A6C, 0x3E4B6C, 0x3F4C6C, 0x404C6C, 0x414D6C, 0x424E6C,
+		0x434E6C, 0x444F6C, 0x45506C, 0x46516C, 0x47516C, 0x48526C, 0x49536C, 0x4A536C,
+		0x4B546C, 0x4C556C, 0x4D556C, 0x4E566C, 0x4F576C, 0x50576C, 0x51586D, 0x52596D,
+		0x535A6D, 0x545A6D, 0x555B6D, 0x555C6D, 0x565C6D, 0x575D6D, 0x585E6D, 0x595E6E,
+		0x5A5F6E, 0x5B606E, 0x5C616E, 0x5D616E, 0x5E626E, 0x5E636F, 0x5F636F, 0x60646F,
+		0x61656F, 0x62656F, 0x636670, 0x646770, 0x656870, 0x656870, 0x666970, 0x676A71,
+		0x686A71, 0x696B71, 0x6A6C71, 0x6B6D72, 0x6C6D72, 0x6C6E72, 0x6D6F72, 0x6E6F73,
+		0x6F7073, 0x707173, 0x717274, 0x727274, 0x727374, 0x737475, 0x747475, 0x757575,
+		0x767676, 0x777776, 0x777777, 0x787877, 0x797977, 0x7A7A78, 0x7B7A78, 0x7C7B78,
+		0x7D7C78, 0x7E7C78, 0x7E7D78, 0x7F7E78, 0x807F78, 0x817F78, 0x828079, 0x838179,
+		0x848279, 0x858279, 0x868379, 0x878478, 0x888578, 0x898578, 0x8A8678, 0x8B8778,
+		0x8C8878, 0x8D8878, 0x8E8978, 0x8F8A78, 0x908B78, 0x918B78, 0x928C78, 0x928D78,
+		0x938E78, 0x948E77, 0x958F77, 0x969077, 0x979177, 0x989277, 0x999277, 0x9A9376,
+		0x9B9476, 0x9C9576, 0x9D9576, 0x9E9676, 0x9F9775, 0xA09875, 0xA19975, 0xA29975,
+		0xA39A74, 0xA49B74, 0xA59C74, 0xA69C74, 0xA79D73, 0xA89E73, 0xA99F73, 0xAAA073,
+		0xABA072, 0xACA172, 0xADA272, 0xAEA371, 0xAFA471, 0xB0A571, 0xB1A570, 0xB3A670,
+		0xB4A76F, 0xB5A86F, 0xB6A96F, 0xB7A96E, 0xB8AA6E, 0xB9AB6D, 0xBAAC6D, 0xBBAD6D,
+		0xBCAE6C, 0xBDAE6C, 0xBEAF6B, 0xBFB06B, 0xC0B16A, 0xC1B26A, 0xC2B369, 0xC3B369,
+		0xC4B468, 0xC5B568, 0xC6B667, 0xC7B767, 0xC8B866, 0xC9B965, 0xCBB965, 0xCCBA64,
+		0xCDBB63, 0xCEBC63, 0xCFBD62, 0xD0BE62, 0xD1BF61, 0xD2C060, 0xD3C05F, 0xD4C15F,
+		0xD5C25E, 0xD6C35D, 0xD7C45C, 0xD9C55C, 0xDAC65B, 0xDBC75A, 0xDCC859, 0xDDC858,
+		0xDEC958, 0xDFCA57, 0xE0CB56, 0xE1CC55, 0xE2CD54, 0xE4CE53, 0xE5CF52, 0xE6D051,
+		0xE7D150, 0xE8D24F, 0xE9D34E, 0xEAD34C, 0xEBD44B, 0xEDD54A, 0xEED649, 0xEFD748,
+		0xF0D846, 0xF1D945, 0xF2DA44, 0xF3DB42, 0xF5DC41, 0xF6DD3F, 0xF7DE3E, 0xF8DF3C,
+		0xF9E03A, 0xFBE138, 0xFCE236, 0xFDE334, 0xFEE434, 0xFEE535, 0xFEE636, 0xFEE838,
+	} },
+	{ "turbo", {
+		0x30123B, 0x321543, 0x33184A, 0x341B51, 0x351E58, 0x36215F, 0x372466, 0x38276D,
+		0x392A73, 0x3A2D79, 0x3B2F80, 0x3C3286, 0x3D358B, 0x3E3891, 0x3F3B97, 0x3F3E9C,
+		0x4040A2, 0x4143A7, 0x4146AC, 0x4249B1, 0x424BB5, 0x434EBA, 0x4451BF, 0x4454C3,
+		0x4456C7, 0x4559CB, 0x455CCF, 0x455ED3, 0x4661D6, 0x4664DA, 0x4666DD, 0x4669E0,
+		0x466BE3, 0x476EE6, 0x4771E9, 0x4773EB, 0x4776EE, 0x4778F0, 0x477BF2, 0x467DF4,
+		0x4680F6, 0x4682F8, 0x4685FA, 0x4687FB, 0x458AFC, 0x458CFD, 0x448FFE, 0x4391FE,
+		0x4294FF, 0x4196FF, 0x4099FF, 0x3E9BFE, 0x3D9EFE, 0x3BA0FD, 0x3AA3FC, 0x38A5FB,
+		0x37A8FA, 0x35ABF8, 0x33ADF7, 0x31AFF5, 0x2FB2F4, 0x2EB4F2, 0x2CB7F0, 0x2AB9EE,
+		0x28BCEB, 0x27BEE9, 0x25C0E7, 0x23C3E4, 0x22C5E2, 0x20C7DF, 0x1FC9DD, 0x1ECBDA,
+		0x1CCDD8, 0x1BD0D5, 0x1AD2D2, 0x1AD4D0, 0x19D5CD, 0x18D7CA, 0x18D9C8, 0x18DBC5,
+		0x18DDC2, 0x18DEC0, 0x18E0BD, 0x19E2BB, 0x19E3B9, 0x1AE4B6, 0x1CE6B4, 0x1DE7B2,
+		0x1FE9AF, 0x20EAAC, 0x22EBAA, 0x25ECA7, 0x27EEA4, 0x2AEFA1, 0x2CF09E, 0x2FF19B,
+		0x32F298, 0x35F394, 0x38F491, 0x3CF58E, 0x3FF68A, 0x43F787, 0x46F884, 0x4AF880,
+		0x4EF97D, 0x52FA7A, 0x55FA76, 0x59FB73, 0x5DFC6F, 0x61FC6C, 0x65FD69, 0x69FD66,
+		0x6DFE62, 0x71FE5F, 0x75FE5C, 0x79FE59, 0x7DFF56, 0x80FF53, 0x84FF51, 0x88FF4E,
+		0x8BFF4B, 0x8FFF49, 0x92FF47, 0x96FE44, 0x99FE42, 0x9CFE40, 0x9FFD3F, 0xA1FD3D,
+		0xA4FC3C, 0xA7FC3A, 0xA9FB39, 0xACFB38, 0xAFFA37, 0xB1F936, 0xB4F836, 0xB7F735,
+		0xB9F635, 0xBCF534, 0xBEF434, 0xC1F334, 0xC3F134, 0xC6F034, 0xC8EF34, 0xCBED34,
+		0xCDEC34, 0xD0EA34, 0xD2E935, 0xD4E735, 0xD7E535, 0xD9E436, 0xDBE236, 0xDDE037,
+		0xDFDF37, 0xE1DD37, 0xE3DB38, 0xE5D938, 0xE7D739, 0xE9D539, 0xEBD339, 0xECD13A,
+		0xEECF3A, 0xEFCD3A, 0xF1CB3A, 0xF2C93A, 0xF4C73A, 0xF5C53A, 0xF6C33A, 0xF7C13A,
+		0xF8BE39, 0xF9BC39, 0xFABA39, 0xFBB838, 0xFBB637, 0xFCB336, 0xFCB136, 0xFDAE35,
+		0xFDAC34, 0xFEA933, 0xFEA732, 0xFEA431, 0xFEA130, 0xFE9E2F, 0xFE9B2D, 0xFE992C,
+		0xFE962B, 0xFE932A, 0xFE9029, 0xFD8D27, 0xFD8A26, 0xFC8725, 0xFC8423, 0xFB8122,
+		0xFB7E21, 0xFA7B1F, 0xF9781E, 0xF9751D, 0xF8721C, 0xF76F1A, 0xF66C19, 0xF56918,
+		0xF46617, 0xF36315, 0xF26014, 0xF15D13, 0xF05B12, 0xEF5811, 0xED5510, 0xEC530F,
+		0xEB500E, 0xEA4E0D, 0xE84B0C, 0xE7490C, 0xE5470B, 0xE4450A, 0xE2430A, 0xE14109,
+		0xDF3F08, 0xDD3D08, 0xDC3B07, 0xDA3907, 0xD83706, 0xD63506, 0xD43305, 0xD23105,
+		0xD02F05, 0xCE2D04, 0xCC2B04, 0xCA2A04, 0xC82803, 0xC52603, 0xC32503, 0xC12302,
+		0xBE2102, 0xBC2002, 0xB91E02, 0xB71D02, 0xB41B01, 0xB21A01, 0xAF1801, 0xAC1701,
+		0xA91601, 0xA71401, 0xA41301, 0xA11201, 0x9E1001, 0x9B0F01, 0x980E01, 0x950D01,
+		0x920B01, 0x8E0A01, 0x8B0902, 0x880802, 0x850702, 0x810602, 0x7E0502, 0x7A0403,
+	} },
+	{ NULL }
+};
@@ -0,0 +1,9 @@
+#define COLOR_COLORMAP_SIZE 256
+
+typedef struct _cColormap {
+	const char  *name;
+	unsigned int values[COLOR_COLORMAP_SIZE]; // 0xRRGGBB, evenly spaced from 0 to 1
+} cColormap;
+
+// terminated by an entry without name
+extern const cColormap color_colormaps[];
@@ -0,0 +1,125 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "buffer.h"
+#include "linear.h"
+#include "quantize.h"
+#include "contrast.h"
+
+extern void
+color_luminance_buffer(cRGB *colors, float *to, long length)
+{
+	for (long i = 0; i < length; i++) {
+		to[i] = color_rgb_luminance(&colors[i]);
+	}
+}
+
+/*
+ * Luminances of an RGB buffer or an array of colors, as string of packed
+ * floats (so the memory is managed by the GC).
+ */
+static VALUE
+color_luminance_of(VALUE rb_colors, long *length)
+{
+	VALUE luminances;
+	volatile VALUE colors = rb_colors;
+	if (CLASS_OF(colors) != rb_cBuffer) {
+		colors = rb_funcall(rb_cBuffer, rb_intern("from"), 2, colors, rb_cRGB);
+	} else if (color_buffer_get(colors, -1)->model != COLOR_MODEL_RGB) {
+		colors = rb_funcall(colors, rb_intern("convert"), 1, rb_cRGB);
+	}
+	cBuffer *buffer = color_buffer_get(colors, COLOR_MODEL_RGB);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_LUMINANCE, buffer->length);
+	luminances      = rb_str_new(NULL, buffer->length*sizeof(float));
+	color_luminance_buffer((cRGB *)buffer->data, (float *)RSTRING_PTR(luminances), buffer->length);
+	*length = buffer->length;
+	return luminances;
+}
+
+/*
+ *  call-seq:
+ *     buffer.relative_luminance -> string
+ *
+ *  The relative luminance of every color of an RGB buffer, see
+ *  Color::RGB#relative_luminance. Returns a binary String of native floats,
+ *  use <code>unpack("f*")</code> to get an Array.
+ */
+extern VALUE
+rb_color_buffer_relative_luminance(VALUE self)
+{
+	long length;
+	color_buffer_get(self, COLOR_MODEL_RGB);
+	return color_luminance_of(self, &length);
+}
+
+/*
+ *  call-seq:
+ *     buffer.contrast_matrix(backgrounds) -> string
+ *
+ *  The WCAG contrast ratio of every color of this RGB buffer against every
+ *  background (a buffer or an array of colors). Returns a binary String of
+ *  native floats, row i holds the ratios of color i, so the ratio against
+ *  background j is at index i*backgrounds.length+j.
+ *
+ *  Example:
+ *    ratios = palette.contrast_matrix(backgrounds).unpack("f*")
+ */
+extern VALUE
+rb_color_buffer_contrast_matrix(VALUE self, VALUE backgrounds)
+{
+	long rows, columns;
+	color_buffer_get(self, COLOR_MODEL_RGB);
+	// volatile keeps the strings visible to the GC while their data is used
+	volatile VALUE foreground = color_luminance_of(self, &rows);
+	volatile VALUE background = color_luminance_of(backgrounds, &columns);
+	VALUE matrix = rb_str_new(NULL, color_size_mul(color_size_mul(rows, columns), sizeof(float)));
+	float *fg        = (float *)RSTRING_PTR(foreground);
+	float *bg        = (float *)RSTRING_PTR(background);
+	float *out       = (float *)RSTRING_PTR(matrix);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_CONTRAST, rows*columns);
+	for (long i = 0; i < rows; i++) {
+		for (long j = 0; j < columns; j++) {
+			out[i*columns+j] = color_contrast(fg[i], bg[j]);
+		}
+	}
+	return matrix;
+}
+
+/*
+ *  call-seq:
+ *     buffer.best_foreground(candidates) -> string
+ *
+ *  For every background color of this RGB buffer, the index of the
+ *  candidate (up to 256 colors) with the highest contrast ratio. Returns a
+ *  binary String with one index per background, like Color::Buffer#quantize.
+ */
+extern VALUE
+rb_color_buffer_best_foreground(VALUE self, VALUE candidates)
+{
+	cRGB  palette[COLOR_PALETTE_MAX];
+	cBuffer *buffer = color_buffer_get(self, COLOR_MODEL_RGB);
+	long size       = color_palette_from(candidates, palette);
+	long darkest = 0, lightest = 0;
+	float luminance[COLOR_PALETTE_MAX];
+
+	// contrast only grows with the distance in luminance, so the best
+	// candidate is always the darkest or the lightest one
+	color_luminance_buffer(palette, luminance, size);
+	for (long i = 1; i < size; i++) {
+		if (luminance[i] < luminance[darkest])  darkest  = i;
+		if (luminance[i] > luminance[lightest]) lightest = i;
+	}
+	COLOR_STAT_KERNEL(COLOR_KERNEL_BEST_FOREGROUND, buffer->length);
+	VALUE indices      = rb_str_new(NULL, buffer->length);
+	unsigned char *out = (unsigned char *)RSTRING_PTR(indices);
+	cRGB *colors       = (cRGB *)buffer->data;
+	for (long i = 0; i < buffer->length; i++) {
+		float background = color_rgb_luminance(&colors[i]);
+		float dark       = color_contrast(luminance[darkest], background);
+		float light      = color_contrast(luminance[lightest], background);
+		out[i] = (unsigned char)(light > dark || (light == dark && lightest < darkest) ? lightest : darkest);
+	}
+	return indices;
+}
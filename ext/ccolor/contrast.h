@@ -0,0 +1,4 @@
+extern void color_luminance_buffer(cRGB *colors, float *to, long length);
+extern VALUE rb_color_buffer_relative_luminance(VALUE self);
+extern VALUE rb_color_buffer_contrast_matrix(VALUE self, VALUE backgrounds);
+extern VALUE rb_color_buffer_best_foreground(VALUE self, VALUE candidates);
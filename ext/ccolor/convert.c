@@ -0,0 +1,450 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "buffer.h"
+#include "depth.h"
+
+#define CONVERT(from, to) \
+	static void convert_##from##_to_##to(void *a, void *b) { color_convert_##from##_to_##to(a, b); }
+
+CONVERT(rgb,  hsv)
+CONVERT(rgb,  hsl)
+CONVERT(rgb,  cmyk)
+CONVERT(rgb,  gray)
+CONVERT(hsv,  rgb)
+CONVERT(hsl,  rgb)
+CONVERT(cmyk, rgb)
+CONVERT(cmyk, gray)
+CONVERT(gray, rgb)
+CONVERT(gray, cmyk)
+CONVERT(gray, hsv)
+CONVERT(gray, hsl)
+CONVERT(rgb,  rgb16)
+CONVERT(rgb,  rgbf)
+CONVERT(rgb16, rgb)
+CONVERT(rgb16, rgbf)
+CONVERT(rgb16, hsv)
+CONVERT(rgb16, hsl)
+CONVERT(rgbf, rgb)
+CONVERT(rgbf, rgb16)
+CONVERT(rgbf, hsv)
+CONVERT(rgbf, hsl)
+CONVERT(hsv,  rgb16)
+CONVERT(hsv,  rgbf)
+CONVERT(hsl,  rgb16)
+CONVERT(hsl,  rgbf)
+CONVERT(rgb,  ycbcr)
+CONVERT(ycbcr, rgb)
+
+// direct kernels, indexed [from][to]; routes are resolved over this graph
+static color_convert_fn color_convert_table[COLOR_MODEL_COUNT][COLOR_MODEL_COUNT] = {
+	/* RGB   */ { NULL, convert_rgb_to_hsv, convert_rgb_to_hsl, convert_rgb_to_cmyk, convert_rgb_to_gray, convert_rgb_to_rgb16, convert_rgb_to_rgbf, convert_rgb_to_ycbcr },
+	/* HSV   */ { convert_hsv_to_rgb, NULL, NULL, NULL, NULL, convert_hsv_to_rgb16, convert_hsv_to_rgbf, NULL },
+	/* HSL   */ { convert_hsl_to_rgb, NULL, NULL, NULL, NULL, convert_hsl_to_rgb16, convert_hsl_to_rgbf, NULL },
+	/* CMYK  */ { convert_cmyk_to_rgb, NULL, NULL, NULL, convert_cmyk_to_gray, NULL, NULL, NULL },
+	/* Gray  */ { convert_gray_to_rgb, convert_gray_to_hsv, convert_gray_to_hsl, convert_gray_to_cmyk, NULL, NULL, NULL, NULL },
+	/* RGB16 */ { convert_rgb16_to_rgb, convert_rgb16_to_hsv, convert_rgb16_to_hsl, NULL, NULL, NULL, convert_rgb16_to_rgbf, NULL },
+	/* RGBF  */ { convert_rgbf_to_rgb, convert_rgbf_to_hsv, convert_rgbf_to_hsl, NULL, NULL, convert_rgbf_to_rgb16, NULL, NULL },
+	/* YCbCr */ { convert_ycbcr_to_rgb, NULL, NULL, NULL, NULL, NULL, NULL, NULL },
+};
+
+static const size_t color_model_sizes[COLOR_MODEL_COUNT] = {
+	sizeof(cRGB),
+	sizeof(cHSV),
+	sizeof(cHSL),
+	sizeof(cCMYK),
+	sizeof(cGray),
+	sizeof(cRGB16),
+	sizeof(cRGBF),
+	sizeof(cYCbCr),
+};
+
+static const char *color_model_names[COLOR_MODEL_COUNT] = {
+	"rgb", "hsv", "hsl", "cmyk", "gray", "rgb16", "rgbf", "ycbcr"
+};
+
+extern size_t
+color_model_size(int model)
+{
+	return color_model_sizes[model];
+}
+
+extern VALUE
+color_model_class(int model)
+{
+	switch(model) {
+		case COLOR_MODEL_RGB:  return rb_cRGB;
+		case COLOR_MODEL_HSV:  return rb_cHSV;
+		case COLOR_MODEL_HSL:  return rb_cHSL;
+		case COLOR_MODEL_CMYK: return rb_cCMYK;
+		case COLOR_MODEL_GRAY: return rb_cGray;
+		case COLOR_MODEL_RGB16: return rb_cRGB16;
+		case COLOR_MODEL_RGBF:  return rb_cRGBF;
+		case COLOR_MODEL_YCBCR: return rb_cYCbCr;
+	}
+	return Qnil;
+}
+
+/*
+ * The model of a color class, -1 if the class has no native representation.
+ */
+extern int
+color_model_of(VALUE class)
+{
+	for (int model = 0; model < COLOR_MODEL_COUNT; model++) {
+		if (color_model_class(model) == class) return model;
+	}
+	return -1;
+}
+
+/*
+ * Accepts a color class or a symbol like :rgb, raises ArgumentError otherwise.
+ */
+extern int
+color_model_get(VALUE spec)
+{
+	int model = -1;
+	if (SYMBOL_P(spec)) {
+		const char *name = rb_id2name(SYM2ID(spec));
+		for (int i = 0; i < COLOR_MODEL_COUNT; i++) {
+			if (strcmp(name, color_model_names[i]) == 0) model = i;
+		}
+	} else {
+		model = color_model_of(spec);
+	}
+	if (model < 0) {
+		VALUE inspect = rb_inspect(spec);
+		rb_raise(rb_eArgError, "Unknown color model %s", RSTRING_PTR(inspect));
+	}
+	return model;
+}
+
+/*
+ * Allocates an instance of model, *ptr is set to its struct.
+ */
+extern VALUE
+color_model_new(int model, void **ptr)
+{
+	switch(model) {
+		case COLOR_MODEL_RGB:   return COLOR_MAKE_VALUE(rb_cRGB,   cRGB,   *ptr);
+		case COLOR_MODEL_HSV:   return COLOR_MAKE_VALUE(rb_cHSV,   cHSV,   *ptr);
+		case COLOR_MODEL_HSL:   return COLOR_MAKE_VALUE(rb_cHSL,   cHSL,   *ptr);
+		case COLOR_MODEL_CMYK:  return COLOR_MAKE_VALUE(rb_cCMYK,  cCMYK,  *ptr);
+		case COLOR_MODEL_GRAY:  return COLOR_MAKE_VALUE(rb_cGray,  cGray,  *ptr);
+		case COLOR_MODEL_RGB16: return COLOR_MAKE_VALUE(rb_cRGB16, cRGB16, *ptr);
+		case COLOR_MODEL_RGBF:  return COLOR_MAKE_VALUE(rb_cRGBF,  cRGBF,  *ptr);
+		case COLOR_MODEL_YCBCR: return COLOR_MAKE_VALUE(rb_cYCbCr, cYCbCr, *ptr);
+	}
+	rb_raise(rb_eArgError, "Unknown color model %d", model);
+	return Qnil;
+}
+
+/*
+ * Resolves the shortest chain of kernels leading from one model to another.
+ * Fused kernels (e.g. gray -> hsv) are plain edges in the table, so they are
+ * picked up automatically wherever they shorten the route.
+ */
+extern void
+color_converter_resolve(cConverter *conv, int from, int to)
+{
+	int previous[COLOR_MODEL_COUNT], queue[COLOR_MODEL_COUNT], route[COLOR_MODEL_COUNT];
+	int head = 0, tail = 0, steps = 0;
+
+	for (int i = 0; i < COLOR_MODEL_COUNT; i++) previous[i] = -1;
+	previous[from] = from;
+	queue[tail++]  = from;
+	while (head < tail && previous[to] < 0) {
+		int model = queue[head++];
+		for (int next = 0; next < COLOR_MODEL_COUNT; next++) {
+			if (previous[next] < 0 && color_convert_table[model][next]) {
+				previous[next] = model;
+				queue[tail++]  = next;
+			}
+		}
+	}
+	if (previous[to] < 0) {
+		rb_raise(rb_eArgError, "No conversion from %s to %s", color_model_names[from], color_model_names[to]);
+	}
+
+	for (int model = to; model != from; model = previous[model]) {
+		route[steps++] = model;
+	}
+	conv->from     = from;
+	conv->to       = to;
+	conv->steps    = steps;
+	conv->rounding = COLOR_ROUND_NEAREST;
+	conv->width    = 0;
+	for (int i = 0, model = from; i < steps; i++) {
+		int next   = route[steps-i-1];
+		conv->fn[i] = color_convert_table[model][next];
+		model       = next;
+	}
+}
+
+/*
+ * Runs a resolved route, intermediate results live on the stack.
+ */
+extern void
+color_converter_run(cConverter *conv, void *from, void *to)
+{
+	cAny tmp[2];
+	void *src = from;
+	int i;
+
+	if (conv->steps == 0) {
+		memcpy(to, from, color_model_size(conv->from));
+		return;
+	}
+	for (i = 0; i < conv->steps-1; i++) {
+		conv->fn[i](src, &tmp[i & 1]);
+		src = &tmp[i & 1];
+	}
+	conv->fn[i](src, to);
+}
+
+/*
+ * Reads :rounding and :width from an options hash (or nil).
+ */
+extern void
+color_converter_options(cConverter *conv, VALUE options)
+{
+	if (NIL_P(options)) return;
+	Check_Type(options, T_HASH);
+	VALUE width    = rb_hash_aref(options, ID2SYM(rb_intern("width")));
+	conv->rounding = color_rounding_get(rb_hash_aref(options, ID2SYM(rb_intern("rounding"))));
+	conv->width    = NIL_P(width) ? 0 : NUM2LONG(width);
+	if (conv->width < 0) {
+		rb_raise(rb_eArgError, "Invalid width, must be positive");
+	}
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_converter__allocate(VALUE class)
+{
+	cConverter *conv;
+	VALUE rb_conv = COLOR_ALLOC_VALUE(class, cConverter, conv);
+	conv->from     = COLOR_MODEL_RGB;
+	conv->to       = COLOR_MODEL_RGB;
+	conv->steps    = 0;
+	conv->rounding = COLOR_ROUND_NEAREST;
+	conv->width    = 0;
+	return rb_conv;
+}
+
+/*
+ *  call-seq:
+ *     Color::Converter.new(:from => model, :to => model[, :rounding => mode, :width => width])
+ *
+ *  Create a converter between two color models. Models can be given as
+ *  class (Color::CMYK) or as symbol (:cmyk). The chain of conversions is
+ *  resolved once, here.
+ *  When converting buffers of RGB16 or RGBF to RGB, +rounding+ may be :round
+ *  (default), :floor or :dither (4x4 ordered dither, +width+ is the row width
+ *  of the image).
+ */
+extern VALUE
+rb_color_converter_initialize(VALUE self, VALUE options)
+{
+	COLOR_CHECK_FROZEN(self);
+	cConverter *conv;
+	VALUE from, to;
+	COLOR_GET_STRUCT(self, cConverter, conv);
+	Check_Type(options, T_HASH);
+	from = rb_hash_aref(options, ID2SYM(rb_intern("from")));
+	to   = rb_hash_aref(options, ID2SYM(rb_intern("to")));
+	if (NIL_P(from) || NIL_P(to)) {
+		rb_raise(rb_eArgError, "Converter requires :from and :to");
+	}
+	color_converter_resolve(conv, color_model_get(from), color_model_get(to));
+	color_converter_options(conv, options);
+	return rb_obj_freeze(self);
+}
+
+/*
+ *  call-seq:
+ *     converter.from -> class
+ *
+ *  The color class this converter converts from.
+ */
+extern VALUE
+rb_color_converter_from(VALUE self)
+{
+	cConverter *conv;
+	COLOR_GET_STRUCT(self, cConverter, conv);
+	return color_model_class(conv->from);
+}
+
+/*
+ *  call-seq:
+ *     converter.to -> class
+ *
+ *  The color class this converter converts to.
+ */
+extern VALUE
+rb_color_converter_to(VALUE self)
+{
+	cConverter *conv;
+	COLOR_GET_STRUCT(self, cConverter, conv);
+	return color_model_class(conv->to);
+}
+
+/*
+ *  call-seq:
+ *     converter.steps -> fixnum
+ *
+ *  The number of conversion kernels run per color.
+ */
+extern VALUE
+rb_color_converter_steps(VALUE self)
+{
+	cConverter *conv;
+	COLOR_GET_STRUCT(self, cConverter, conv);
+	return INT2FIX(conv->steps);
+}
+
+static void *
+color_converter_source(cConverter *conv, VALUE color)
+{
+	if (CLASS_OF(color) != color_model_class(conv->from)) {
+		rb_raise(rb_eTypeError, "Expected %s, got %s",
+			rb_class2name(color_model_class(conv->from)), rb_obj_classname(color));
+	}
+	return COLOR_DATA_PTR(color);
+}
+
+// routes between all models, resolved once on load so ractors only read them
+static cConverter color_coerce_routes[COLOR_MODEL_COUNT][COLOR_MODEL_COUNT];
+
+extern void
+color_coerce_init(void)
+{
+	for (int from = 0; from < COLOR_MODEL_COUNT; from++) {
+		for (int to = 0; to < COLOR_MODEL_COUNT; to++) {
+			color_converter_resolve(&color_coerce_routes[from][to], from, to);
+		}
+	}
+}
+
+/*
+ * The struct of color in model. Colors of other native models are
+ * converted into *tmp without creating ruby objects, anything else goes
+ * through model.from in ruby and is copied into *tmp as well. Site is the
+ * COLOR_COERCE_* counted for the latter.
+ */
+extern void *
+color_coerce(VALUE color, int model, cAny *tmp, int site)
+{
+	VALUE class = color_model_class(model);
+	int from;
+
+	if (CLASS_OF(color) == class) return COLOR_DATA_PTR(color);
+	from = SPECIAL_CONST_P(color) ? -1 : color_model_of(CLASS_OF(color));
+	if (from >= 0) {
+		color_converter_run(&color_coerce_routes[from][model], COLOR_DATA_PTR(color), tmp);
+		return tmp;
+	}
+	COLOR_STAT_COERCE(site);
+	color = rb_funcall(class, rb_intern("from"), 1, color);
+	if (CLASS_OF(color) != class) {
+		rb_raise(rb_eTypeError, "Could not coerce into %s", rb_class2name(class));
+	}
+	memcpy(tmp, COLOR_DATA_PTR(color), color_model_size(model));
+	return tmp;
+}
+
+/*
+ *  call-seq:
+ *     converter.convert(color) -> color
+ *
+ *  Converts a single color.
+ */
+extern VALUE
+rb_color_converter_convert(VALUE self, VALUE color)
+{
+	cConverter *conv;
+	void *to;
+	COLOR_GET_STRUCT(self, cConverter, conv);
+	void *from     = color_converter_source(conv, color);
+	VALUE rb_color = color_model_new(conv->to, &to);
+	COLOR_STAT_CONVERT(conv->from, conv->to, 1);
+	color_converter_run(conv, from, to);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     converter.convert_many(array) -> array
+ *
+ *  Converts all colors in an array.
+ */
+extern VALUE
+rb_color_converter_convert_many(VALUE self, VALUE colors)
+{
+	cConverter *conv;
+	void *to;
+	COLOR_GET_STRUCT(self, cConverter, conv);
+	Check_Type(colors, T_ARRAY);
+	long length    = RARRAY_LEN(colors);
+	VALUE rb_array = rb_ary_new2(length);
+	COLOR_STAT_CONVERT(conv->from, conv->to, length);
+	for (long i = 0; i < length; i++) {
+		void *from     = color_converter_source(conv, RARRAY_PTR(colors)[i]);
+		VALUE rb_color = color_model_new(conv->to, &to);
+		color_converter_run(conv, from, to);
+		rb_ary_push(rb_array, rb_color);
+	}
+	return rb_array;
+}
+
+/*
+ *  call-seq:
+ *     converter.convert_buffer(buffer) -> buffer
+ *
+ *  Converts a Color::Buffer, returning a new buffer of the target model.
+ */
+extern VALUE
+rb_color_converter_convert_buffer(VALUE self, VALUE rb_buffer)
+{
+	cConverter *conv;
+	cBuffer *from, *to;
+	COLOR_GET_STRUCT(self, cConverter, conv);
+	from = color_buffer_get(rb_buffer, -1);
+	if (from->model != conv->from) {
+		rb_raise(rb_eTypeError, "Expected a buffer of %s, got %s",
+			rb_class2name(color_model_class(conv->from)), rb_class2name(color_model_class(from->model)));
+	}
+	VALUE rb_result = color_buffer_new(conv->to, from->length, &to);
+	color_converter_run_buffer(conv, from->data, to->data, from->length);
+	return rb_result;
+}
+
+extern void
+color_converter_run_buffer(cConverter *conv, char *from, char *to, long length)
+{
+	long width = conv->width > 0 ? conv->width : (length > 0 ? length : 1);
+	COLOR_STAT_CONVERT(conv->from, conv->to, length);
+	if (conv->from == COLOR_MODEL_RGBF && conv->to == COLOR_MODEL_RGB) {
+		color_quantize_rgbf((cRGBF*)from, (cRGB*)to, length, conv->rounding, width);
+		return;
+	}
+	if (conv->from == COLOR_MODEL_RGB16 && conv->to == COLOR_MODEL_RGB) {
+		color_quantize_rgb16((cRGB16*)from, (cRGB*)to, length, conv->rounding, width);
+		return;
+	}
+	if (conv->from == COLOR_MODEL_RGB && conv->to == COLOR_MODEL_RGBF) {
+		color_expand_rgb((cRGB*)from, (cRGBF*)to, length);
+		return;
+	}
+
+	size_t from_size = color_model_size(conv->from);
+	size_t to_size   = color_model_size(conv->to);
+	for (long i = 0; i < length; i++) {
+		color_converter_run(conv, from + i*from_size, to + i*to_size);
+	}
+}
@@ -0,0 +1,19 @@
+extern size_t color_model_size(int model);
+extern VALUE color_model_class(int model);
+extern int color_model_of(VALUE class);
+extern int color_model_get(VALUE spec);
+extern VALUE color_model_new(int model, void **ptr);
+extern void color_converter_resolve(cConverter *conv, int from, int to);
+extern void color_converter_options(cConverter *conv, VALUE options);
+extern void color_converter_run(cConverter *conv, void *from, void *to);
+extern void color_converter_run_buffer(cConverter *conv, char *from, char *to, long length);
+extern void color_coerce_init(void);
+extern void *color_coerce(VALUE color, int model, cAny *tmp, int site);
+extern VALUE rb_color_converter__allocate(VALUE class);
+extern VALUE rb_color_converter_initialize(VALUE self, VALUE options);
+extern VALUE rb_color_converter_from(VALUE self);
+extern VALUE rb_color_converter_to(VALUE self);
+extern VALUE rb_color_converter_steps(VALUE self);
+extern VALUE rb_color_converter_convert(VALUE self, VALUE color);
+extern VALUE rb_color_converter_convert_many(VALUE self, VALUE colors);
+extern VALUE rb_color_converter_convert_buffer(VALUE self, VALUE buffer);
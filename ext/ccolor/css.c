@@ -0,0 +1,985 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "color.h"
+#include "convert.h"
+#include "css.h"
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+#include <ruby/ractor.h>
+#endif
+
+#define COLOR_CSS_KEY_MAX 48        // longer inputs are parsed, but not cached
+#define COLOR_CSS_CACHE_SIZE 1024   // default capacity of the parse cache
+#define COLOR_CSS_CACHE_MAX 1048576
+
+typedef struct _cCssName {
+	const char  *name;
+	unsigned int rgb;   // 0xrrggbb
+} cCssName;
+
+// the named colors of CSS Color 4, sorted by name
+static const cCssName color_css_names[] = {
+	{ "aliceblue",            0xf0f8ff },
+	{ "antiquewhite",         0xfaebd7 },
+	{ "aqua",                 0x00ffff },
+	{ "aquamarine",           0x7fffd4 },
+	{ "azure",                0xf0ffff },
+	{ "beige",                0xf5f5dc },
+	{ "bisque",               0xffe4c4 },
+	{ "black",                0x000000 },
+	{ "blanchedalmond",       0xffebcd },
+	{ "blue",                 0x0000ff },
+	{ "blueviolet",           0x8a2be2 },
+	{ "brown",                0xa52a2a },
+	{ "burlywood",            0xdeb887 },
+	{ "cadetblue",            0x5f9ea0 },
+	{ "chartreuse",           0x7fff00 },
+	{ "chocolate",            0xd2691e },
+	{ "coral",                0xff7f50 },
+	{ "cornflowerblue",       0x6495ed },
+	{ "cornsilk",             0xfff8dc },
+	{ "crimson",              0xdc143c },
+	{ "cyan",                 0x00ffff },
+	{ "darkblue",             0x00008b },
+	{ "darkcyan",             0x008b8b },
+	{ "darkgoldenrod",        0xb8860b },
+	{ "darkgray",             0xa9a9a9 },
+	{ "darkgreen",            0x006400 },
+	{ "darkgrey",             0xa9a9a9 },
+	{ "darkkhaki",            0xbdb76b },
+	{ "darkmagenta",          0x8b008b },
+	{ "darkolivegreen",       0x556b2f },
+	{ "darkorange",           0xff8c00 },
+	{ "darkorchid",           0x9932cc },
+	{ "darkred",              0x8b0000 },
+	{ "darksalmon",           0xe9967a },
+	{ "darkseagreen",         0x8fbc8f },
+	{ "darkslateblue",        0x483d8b },
+	{ "darkslategray",        0x2f4f4f },
+	{ "darkslategrey",        0x2f4f4f },
+	{ "darkturquoise",        0x00ced1 },
+	{ "darkviolet",           0x9400d3 },
+	{ "deeppink",             0xff1493 },
+	{ "deepskyblue",          0x00bfff },
+	{ "dimgray",              0x696969 },
+	{ "dimgrey",              0x696969 },
+	{ "dodgerblue",           0x1e90ff },
+	{ "firebrick",            0xb22222 },
+	{ "floralwhite",          0xfffaf0 },
+	{ "forestgreen",          0x228b22 },
+	{ "fuchsia",              0xff00ff },
+	{ "gainsboro",            0xdcdcdc },
+	{ "ghostwhite",           0xf8f8ff },
+	{ "gold",                 0xffd700 },
+	{ "goldenrod",            0xdaa520 },
+	{ "gray",                 0x808080 },
+	{ "green",                0x008000 },
+	{ "greenyellow",          0xadff2f },
+	{ "grey",                 0x808080 },
+	{ "honeydew",             0xf0fff0 },
+	{ "hotpink",              0xff69b4 },
+	{ "indianred",            0xcd5c5c },
+	{ "indigo",               0x4b0082 },
+	{ "ivory",                0xfffff0 },
+	{ "khaki",                0xf0e68c },
+	{ "lavender",             0xe6e6fa },
+	{ "lavenderblush",        0xfff0f5 },
+	{ "lawngreen",            0x7cfc00 },
+	{ "lemonchiffon",         0xfffacd },
+	{ "lightblue",            0xadd8e6 },
+	{ "lightcoral",           0xf08080 },
+	{ "lightcyan",            0xe0ffff },
+	{ "lightgoldenrodyellow", 0xfafad2 },
+	{ "lightgray",            0xd3d3d3 },
+	{ "lightgreen",           0x90ee90 },
+	{ "lightgrey",            0xd3d3d3 },
+	{ "lightpink",            0xffb6c1 },
+	{ "lightsalmon",          0xffa07a },
+	{ "lightseagreen",        0x20b2aa },
+	{ "lightskyblue",         0x87cefa },
+	{ "lightslategray",       0x778899 },
+	{ "lightslategrey",       0x778899 },
+	{ "lightsteelblue",       0xb0c4de },
+	{ "lightyellow",          0xffffe0 },
+	{ "lime",                 0x00ff00 },
+	{ "limegreen",            0x32cd32 },
+	{ "linen",                0xfaf0e6 },
+	{ "magenta",              0xff00ff },
+	{ "maroon",               0x800000 },
+	{ "mediumaquamarine",     0x66cdaa },
+	{ "mediumblue",           0x0000cd },
+	{ "mediumorchid",         0xba55d3 },
+	{ "mediumpurple",         0x9370db },
+	{ "mediumseagreen",       0x3cb371 },
+	{ "mediumslateblue",      0x7b68ee },
+	{ "mediumspringgreen",    0x00fa9a },
+	{ "mediumturquoise",      0x48d1cc },
+	{ "mediumvioletred",      0xc71585 },
+	{ "midnightblue",         0x191970 },
+	{ "mintcream",            0xf5fffa },
+	{ "mistyrose",            0xffe4e1 },
+	{ "moccasin",             0xffe4b5 },
+	{ "navajowhite",          0xffdead },
+	{ "navy",                 0x000080 },
+	{ "oldlace",              0xfdf5e6 },
+	{ "olive",                0x808000 },
+	{ "olivedrab",            0x6b8e23 },
+	{ "orange",               0xffa500 },
+	{ "orangered",            0xff4500 },
+	{ "orchid",               0xda70d6 },
+	{ "palegoldenrod",        0xeee8aa },
+	{ "palegreen",            0x98fb98 },
+	{ "paleturquoise",        0xafeeee },
+	{ "palevioletred",        0xdb7093 },
+	{ "papayawhip",           0xffefd5 },
+	{ "peachpuff",            0xffdab9 },
+	{ "peru",                 0xcd853f },
+	{ "pink",                 0xffc0cb },
+	{ "plum",                 0xdda0dd },
+	{ "powderblue",           0xb0e0e6 },
+	{ "purple",               0x800080 },
+	{ "rebeccapurple",        0x663399 },
+	{ "red",                  0xff0000 },
+	{ "rosybrown",            0xbc8f8f },
+	{ "royalblue",            0x4169e1 },
+	{ "saddlebrown",          0x8b4513 },
+	{ "salmon",               0xfa8072 },
+	{ "sandybrown",           0xf4a460 },
+	{ "seagreen",             0x2e8b57 },
+	{ "seashell",             0xfff5ee },
+	{ "sienna",               0xa0522d },
+	{ "silver",               0xc0c0c0 },
+	{ "skyblue",              0x87ceeb },
+	{ "slateblue",            0x6a5acd },
+	{ "slategray",            0x708090 },
+	{ "slategrey",            0x708090 },
+	{ "snow",                 0xfffafa },
+	{ "springgreen",          0x00ff7f },
+	{ "steelblue",            0x4682b4 },
+	{ "tan",                  0xd2b48c },
+	{ "teal",                 0x008080 },
+	{ "thistle",              0xd8bfd8 },
+	{ "tomato",               0xff6347 },
+	{ "turquoise",            0x40e0d0 },
+	{ "violet",               0xee82ee },
+	{ "wheat",                0xf5deb3 },
+	{ "white",                0xffffff },
+	{ "whitesmoke",           0xf5f5f5 },
+	{ "yellow",               0xffff00 },
+	{ "yellowgreen",          0x9acd32 },
+};
+
+#define COLOR_CSS_NAMES ((long)(sizeof(color_css_names)/sizeof(cCssName)))
+
+// indices of color_css_names ordered by rgb, then by name, see Color::CSS.format(color, :name)
+static long color_css_by_rgb[COLOR_CSS_NAMES];
+
+// two lower case hex digits for every byte
+char color_css_hex[512];
+
+enum {
+	COLOR_CSS_NUMBER,
+	COLOR_CSS_PERCENT,
+	COLOR_CSS_ANGLE,    // in degrees
+	COLOR_CSS_NONE
+};
+
+typedef struct _cCssValue {
+	int    type;
+	double value;
+} cCssValue;
+
+typedef struct _cCssEntry {
+	VALUE  color;
+	unsigned int hash;
+	int    length;
+	long   newer;       // lru list, -1 at the ends
+	long   older;
+	long   chain;       // next entry of the bucket, -1 at the end
+	char   key[COLOR_CSS_KEY_MAX];
+} cCssEntry;
+
+// a bounded lru cache of parsed colors, keyed by the input bytes
+typedef struct _cCssCache {
+	long   capacity;
+	long   size;
+	long   mask;        // buckets-1
+	long   newest;
+	long   oldest;
+	long  *buckets;
+	cCssEntry *entries;
+	unsigned long hits;
+	unsigned long misses;
+} cCssCache;
+
+/* parser */
+
+static inline int
+color_css_space(int c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static inline const char *
+color_css_skip(const char *at, const char *end)
+{
+	while (at < end && color_css_space(*at)) at++;
+	return at;
+}
+
+static inline int
+color_css_hex_digit(int c)
+{
+	if (c >= '0' && c <= '9') return c-'0';
+	if (c >= 'a' && c <= 'f') return c-'a'+10;
+	if (c >= 'A' && c <= 'F') return c-'A'+10;
+	return -1;
+}
+
+// case insensitive match of a lower case word
+static int
+color_css_word(const char *at, const char *end, const char *word)
+{
+	long length = (long)strlen(word);
+	if (end-at < length) return 0;
+	for (long i = 0; i < length; i++) {
+		int c = at[i];
+		if (c >= 'A' && c <= 'Z') c += 'a'-'A';
+		if (c != word[i]) return 0;
+	}
+	return 1;
+}
+
+/*
+ * A CSS number: sign, digits, fraction and exponent. Returns the position
+ * after it, NULL if there is none.
+ */
+static const char *
+color_css_number(const char *at, const char *end, double *number)
+{
+	// digits are collected as an integer and scaled once, so "0.7" is the
+	// double nearest to 0.7, as it would be for strtod
+	double mantissa = 0, sign = 1;
+	int    digits = 0, power = 0;
+	if (at < end && (*at == '+' || *at == '-')) sign = *at++ == '-' ? -1 : 1;
+	while (at < end && *at >= '0' && *at <= '9') {
+		mantissa = mantissa*10+(*at++-'0');
+		digits++;
+	}
+	if (at+1 < end && *at == '.' && at[1] >= '0' && at[1] <= '9') {
+		at++;
+		while (at < end && *at >= '0' && *at <= '9') {
+			mantissa = mantissa*10+(*at++-'0');
+			digits++;
+			power--;
+		}
+	}
+	if (!digits) return NULL;
+	if (at < end && (*at == 'e' || *at == 'E')) {
+		const char *exponent = at+1;
+		int negative = 0, value = 0;
+		if (exponent < end && (*exponent == '+' || *exponent == '-')) negative = *exponent++ == '-';
+		if (exponent < end && *exponent >= '0' && *exponent <= '9') {
+			while (exponent < end && *exponent >= '0' && *exponent <= '9') {
+				if (value < 400) value = value*10+(*exponent-'0');
+				exponent++;
+			}
+			power += negative ? -value : value;
+			at = exponent;
+		}
+	}
+	*number = sign*(power < 0 ? mantissa/pow(10, -power) : mantissa*pow(10, power));
+	return at;
+}
+
+/*
+ * One argument of a color function, a number, a percentage, an angle or
+ * none. Returns the position after it, NULL if invalid.
+ */
+static const char *
+color_css_value(const char *at, const char *end, cCssValue *value)
+{
+	if (color_css_word(at, end, "none")) {
+		value->type  = COLOR_CSS_NONE;
+		value->value = 0;
+		return at+4;
+	}
+	if (!(at = color_css_number(at, end, &value->value))) return NULL;
+	value->type = COLOR_CSS_NUMBER;
+	if (at < end && *at == '%') {
+		value->type = COLOR_CSS_PERCENT;
+		return at+1;
+	}
+	if (color_css_word(at, end, "deg")) {
+		value->type = COLOR_CSS_ANGLE;
+		return at+3;
+	}
+	if (color_css_word(at, end, "grad")) {
+		value->type   = COLOR_CSS_ANGLE;
+		value->value *= 0.9;
+		return at+4;
+	}
+	if (color_css_word(at, end, "rad")) {
+		value->type   = COLOR_CSS_ANGLE;
+		value->value *= 180/3.14159265358979323846;
+		return at+3;
+	}
+	if (color_css_word(at, end, "turn")) {
+		value->type   = COLOR_CSS_ANGLE;
+		value->value *= 360;
+		return at+4;
+	}
+	return at;
+}
+
+/*
+ * The arguments of rgb(), rgba(), hsl() and hsla() from after the opening
+ * parenthesis to the end of the input, either the legacy comma separated
+ * form or the space separated one with an optional "/ alpha". Returns the
+ * number of arguments (3 or 4), 0 if invalid.
+ */
+static int
+color_css_arguments(const char *at, const char *end, cCssValue *values)
+{
+	int count = 0, legacy = 0;
+	at = color_css_skip(at, end);
+	while (count < 4) {
+		if (!(at = color_css_value(at, end, &values[count]))) return 0;
+		count++;
+		at = color_css_skip(at, end);
+		if (at >= end) return 0;
+		if (*at == ')') break;
+		if (count == 1) legacy = *at == ',';
+		if (legacy) {
+			if (*at != ',') return 0;
+			at = color_css_skip(at+1, end);
+		} else if (*at == '/') {
+			if (count != 3) return 0;
+			at = color_css_skip(at+1, end);
+		} else if (count == 3) {
+			return 0;
+		}
+	}
+	if (at >= end || *at != ')' || count < 3) return 0;
+	if (color_css_skip(at+1, end) != end) return 0;
+	if (legacy) {
+		for (int i = 0; i < count; i++) {
+			if (values[i].type == COLOR_CSS_NONE) return 0;
+		}
+	}
+	return count;
+}
+
+static inline double
+color_css_clamp(double value, double min, double max)
+{
+	return value > min ? (value < max ? value : max) : min;
+}
+
+static inline unsigned char
+color_css_byte(double value)
+{
+	return (unsigned char)floor(color_css_clamp(value, 0, 255)+0.5);
+}
+
+// css alpha is the opacity, ours the transparency
+static int
+color_css_alpha(cCssValue *value, unsigned char *alpha)
+{
+	double opacity;
+	switch(value->type) {
+		case COLOR_CSS_NUMBER:  opacity = value->value;     break;
+		case COLOR_CSS_PERCENT: opacity = value->value/100; break;
+		case COLOR_CSS_NONE:    opacity = 0;                break;
+		default: return 0;
+	}
+	*alpha = color_css_byte(255-color_css_clamp(opacity, 0, 1)*255);
+	return 1;
+}
+
+static int
+color_css_rgb(cCssValue *values, int count, cRGB *rgb)
+{
+	unsigned char *channel[3] = { &rgb->r, &rgb->g, &rgb->b };
+	for (int i = 0; i < 3; i++) {
+		switch(values[i].type) {
+			case COLOR_CSS_NUMBER:  *channel[i] = color_css_byte(values[i].value);         break;
+			case COLOR_CSS_PERCENT: *channel[i] = color_css_byte(values[i].value*255/100); break;
+			case COLOR_CSS_NONE:    *channel[i] = 0;                                       break;
+			default: return 0;
+		}
+	}
+	rgb->alpha = 0;
+	return count < 4 || color_css_alpha(&values[3], &rgb->alpha);
+}
+
+static int
+color_css_hsl(cCssValue *values, int count, cHSL *hsl)
+{
+	double hue = 0;
+	float *component[2] = { &hsl->s, &hsl->l };
+	switch(values[0].type) {
+		case COLOR_CSS_NUMBER:
+		case COLOR_CSS_ANGLE: hue = fmod(values[0].value, 360)/360; break;
+		case COLOR_CSS_NONE:  break;
+		default: return 0;
+	}
+	hsl->h = (float)(hue < 0 ? hue+1 : hue);
+	for (int i = 0; i < 2; i++) {
+		// the space separated form allows plain numbers, as percentages
+		switch(values[i+1].type) {
+			case COLOR_CSS_NUMBER:
+			case COLOR_CSS_PERCENT: *component[i] = (float)color_css_clamp(values[i+1].value/100, 0, 1); break;
+			case COLOR_CSS_NONE:    *component[i] = 0; break;
+			default: return 0;
+		}
+	}
+	hsl->alpha = 0;
+	return count < 4 || color_css_alpha(&values[3], &hsl->alpha);
+}
+
+static int
+color_css_hex_color(const char *at, long length, cRGB *rgb)
+{
+	int digit[8];
+	if (length != 3 && length != 4 && length != 6 && length != 8) return 0;
+	for (long i = 0; i < length; i++) {
+		if ((digit[i] = color_css_hex_digit(at[i])) < 0) return 0;
+	}
+	if (length <= 4) {
+		rgb->r     = digit[0]*17;
+		rgb->g     = digit[1]*17;
+		rgb->b     = digit[2]*17;
+		rgb->alpha = length == 4 ? 255-digit[3]*17 : 0;
+	} else {
+		rgb->r     = digit[0]*16+digit[1];
+		rgb->g     = digit[2]*16+digit[3];
+		rgb->b     = digit[4]*16+digit[5];
+		rgb->alpha = length == 8 ? 255-(digit[6]*16+digit[7]) : 0;
+	}
+	return 1;
+}
+
+static int
+color_css_compare_name(const void *key, const void *entry)
+{
+	return strcmp((const char *)key, ((const cCssName *)entry)->name);
+}
+
+static int
+color_css_named(const char *at, long length, cRGB *rgb)
+{
+	char name[24];
+	cCssName *found;
+	if (length < 1 || length >= (long)sizeof(name)) return 0;
+	for (long i = 0; i < length; i++) {
+		int c = at[i];
+		name[i] = c >= 'A' && c <= 'Z' ? c+'a'-'A' : c;
+	}
+	name[length] = 0;
+	if (!strcmp(name, "transparent")) {
+		rgb->r = rgb->g = rgb->b = 0;
+		rgb->alpha = 255;
+		return 1;
+	}
+	found = bsearch(name, color_css_names, COLOR_CSS_NAMES, sizeof(cCssName), color_css_compare_name);
+	if (!found) return 0;
+	rgb->r     = found->rgb >> 16;
+	rgb->g     = found->rgb >> 8 & 0xff;
+	rgb->b     = found->rgb & 0xff;
+	rgb->alpha = 0;
+	return 1;
+}
+
+/*
+ * Parses a CSS color in one pass over the input, into an RGB or, for hsl()
+ * and hsla(), an HSL color. Returns Qnil if the input is no valid color.
+ */
+extern VALUE
+color_css_parse(const char *at, long length)
+{
+	const char *end = at+length;
+	cCssValue values[4];
+	cRGB  rgb;
+	void *color;
+	int   count;
+
+	at = color_css_skip(at, end);
+	while (end > at && color_css_space(end[-1])) end--;
+	if (at >= end) return Qnil;
+	if (*at == '#') {
+		if (!color_css_hex_color(at+1, end-at-1, &rgb)) return Qnil;
+	} else if (color_css_word(at, end, "rgba(") || color_css_word(at, end, "rgb(")) {
+		at += at[3] == '(' ? 4 : 5;
+		if (!(count = color_css_arguments(at, end, values)) || !color_css_rgb(values, count, &rgb)) return Qnil;
+	} else if (color_css_word(at, end, "hsla(") || color_css_word(at, end, "hsl(")) {
+		cHSL hsl;
+		at += at[3] == '(' ? 4 : 5;
+		if (!(count = color_css_arguments(at, end, values)) || !color_css_hsl(values, count, &hsl)) return Qnil;
+		VALUE rb_color = color_model_new(COLOR_MODEL_HSL, &color);
+		*(cHSL *)color = hsl;
+		return rb_color;
+	} else if (!color_css_named(at, end-at, &rgb)) {
+		return Qnil;
+	}
+	VALUE rb_color = color_model_new(COLOR_MODEL_RGB, &color);
+	*(cRGB *)color = rgb;
+	return rb_color;
+}
+
+/* parse cache */
+
+static void
+color_css_cache_mark(void *ptr)
+{
+	cCssCache *cache = ptr;
+	for (long i = 0; i < cache->size; i++) {
+		rb_gc_mark(cache->entries[i].color);
+	}
+}
+
+static void
+color_css_cache_resize(cCssCache *cache, long capacity)
+{
+	long buckets = 1;
+	while (buckets < capacity*2) buckets <<= 1;
+	if (cache->entries) xfree(cache->entries);
+	if (cache->buckets) xfree(cache->buckets);
+	cache->capacity = capacity;
+	cache->size     = 0;
+	cache->mask     = buckets-1;
+	cache->newest   = -1;
+	cache->oldest   = -1;
+	cache->entries  = capacity ? ALLOC_N(cCssEntry, capacity) : NULL;
+	cache->buckets  = ALLOC_N(long, buckets);
+	for (long i = 0; i < buckets; i++) cache->buckets[i] = -1;
+}
+
+static void
+color_css_cache_free(void *ptr)
+{
+	cCssCache *cache = ptr;
+	if (cache->entries) xfree(cache->entries);
+	if (cache->buckets) xfree(cache->buckets);
+	xfree(cache);
+}
+
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+// every ractor has a cache of its own, colors are shareable but the lru
+// list is not
+static const struct rb_ractor_local_storage_type color_css_cache_type = {
+	color_css_cache_mark,
+	color_css_cache_free
+};
+static rb_ractor_local_key_t color_css_cache_key;
+#else
+static cCssCache *color_css_cache_main;
+static VALUE color_css_cache_holder;
+#endif
+
+static cCssCache *
+color_css_cache(void)
+{
+	cCssCache *cache;
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+	if ((cache = rb_ractor_local_storage_ptr(color_css_cache_key))) return cache;
+#else
+	if ((cache = color_css_cache_main)) return cache;
+#endif
+	cache = ALLOC(cCssCache);
+	memset(cache, 0, sizeof(cCssCache));
+	color_css_cache_resize(cache, COLOR_CSS_CACHE_SIZE);
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+	rb_ractor_local_storage_ptr_set(color_css_cache_key, cache);
+#else
+	color_css_cache_main   = cache;
+	color_css_cache_holder = Data_Wrap_Struct(rb_cObject, color_css_cache_mark, NULL, cache);
+	rb_global_variable(&color_css_cache_holder);
+#endif
+	return cache;
+}
+
+static void
+color_css_cache_unlink(cCssCache *cache, long index)
+{
+	cCssEntry *entry = &cache->entries[index];
+	if (entry->newer >= 0) cache->entries[entry->newer].older = entry->older;
+	else                   cache->newest = entry->older;
+	if (entry->older >= 0) cache->entries[entry->older].newer = entry->newer;
+	else                   cache->oldest = entry->newer;
+}
+
+static void
+color_css_cache_push(cCssCache *cache, long index)
+{
+	cCssEntry *entry = &cache->entries[index];
+	entry->newer = -1;
+	entry->older = cache->newest;
+	if (cache->newest >= 0) cache->entries[cache->newest].newer = index;
+	cache->newest = index;
+	if (cache->oldest < 0) cache->oldest = index;
+}
+
+// FNV-1a
+static inline unsigned int
+color_css_hash(const char *key, long length)
+{
+	unsigned int hash = 2166136261u;
+	for (long i = 0; i < length; i++) {
+		hash = (hash ^ (unsigned char)key[i])*16777619u;
+	}
+	return hash;
+}
+
+static VALUE
+color_css_cache_get(cCssCache *cache, const char *key, long length, unsigned int hash)
+{
+	for (long index = cache->buckets[hash & cache->mask]; index >= 0; index = cache->entries[index].chain) {
+		cCssEntry *entry = &cache->entries[index];
+		if (entry->hash == hash && entry->length == length && !memcmp(entry->key, key, length)) {
+			if (cache->newest != index) {
+				color_css_cache_unlink(cache, index);
+				color_css_cache_push(cache, index);
+			}
+			return entry->color;
+		}
+	}
+	return Qundef;
+}
+
+static void
+color_css_cache_set(cCssCache *cache, const char *key, long length, unsigned int hash, VALUE color)
+{
+	long index;
+	if (cache->size < cache->capacity) {
+		index = cache->size++;
+	} else {
+		// evict the least recently used entry
+		index = cache->oldest;
+		long *link = &cache->buckets[cache->entries[index].hash & cache->mask];
+		while (*link != index) link = &cache->entries[*link].chain;
+		*link = cache->entries[index].chain;
+		color_css_cache_unlink(cache, index);
+	}
+	cCssEntry *entry = &cache->entries[index];
+	entry->color  = color;
+	entry->hash   = hash;
+	entry->length = (int)length;
+	entry->chain  = cache->buckets[hash & cache->mask];
+	memcpy(entry->key, key, length);
+	cache->buckets[hash & cache->mask] = index;
+	color_css_cache_push(cache, index);
+}
+
+/* serializer */
+
+static char *
+color_css_integer(char *to, long value)
+{
+	char digits[24];
+	int  count = 0;
+	do {
+		digits[count++] = (char)('0'+value%10);
+		value /= 10;
+	} while (value);
+	while (count) *to++ = digits[--count];
+	return to;
+}
+
+// a non-negative value with up to 3 decimals, trailing zeros dropped
+static char *
+color_css_decimal(char *to, double value, int decimals)
+{
+	long scale = decimals == 3 ? 1000 : (decimals == 2 ? 100 : 10);
+	long fixed = (long)floor(value*scale+0.5);
+	to = color_css_integer(to, fixed/scale);
+	if (fixed%scale) {
+		long fraction = fixed%scale;
+		*to++ = '.';
+		for (long digit = scale/10; digit && fraction; digit /= 10) {
+			*to++    = (char)('0'+fraction/digit);
+			fraction = fraction%digit;
+		}
+	}
+	return to;
+}
+
+// the opacity, with 2 decimals unless it takes 3 to read back the same alpha
+static char *
+color_css_opacity(char *to, unsigned char alpha)
+{
+	double opacity = (255-alpha)/255.0;
+	double rounded = floor(opacity*100+0.5)/100;
+	return color_css_decimal(to, opacity, color_css_byte(255-rounded*255) == alpha ? 2 : 3);
+}
+
+static inline char *
+color_css_byte_hex(char *to, unsigned char value)
+{
+	*to++ = color_css_hex[value*2];
+	*to++ = color_css_hex[value*2+1];
+	return to;
+}
+
+static int
+color_css_compare_rgb(const void *a, const void *b)
+{
+	unsigned int rgb_a = color_css_names[*(const long *)a].rgb, rgb_b = color_css_names[*(const long *)b].rgb;
+	if (rgb_a != rgb_b) return rgb_a < rgb_b ? -1 : 1;
+	return *(const long *)a < *(const long *)b ? -1 : 1;
+}
+
+// the first name of the rgb value, NULL if it has none
+static const char *
+color_css_name_of(cRGB *rgb)
+{
+	unsigned int value = (unsigned int)rgb->r << 16 | rgb->g << 8 | rgb->b;
+	long low = 0, high = COLOR_CSS_NAMES;
+	if (rgb->alpha) return rgb->alpha == 255 && !value ? "transparent" : NULL;
+	while (low < high) {
+		long middle = (low+high)/2;
+		if (color_css_names[color_css_by_rgb[middle]].rgb < value) low = middle+1;
+		else                                                       high = middle;
+	}
+	return low < COLOR_CSS_NAMES && color_css_names[color_css_by_rgb[low]].rgb == value ? color_css_names[color_css_by_rgb[low]].name : NULL;
+}
+
+/*
+ * Writes the CSS form of a color to to (at least 64 bytes), returns the
+ * end. RGB forms take rgb, HSL forms hsl.
+ */
+extern char *
+color_css_format(char *to, int form, cRGB *rgb, cHSL *hsl)
+{
+	const char *name;
+	switch(form) {
+		case COLOR_CSS_NAME:
+			if ((name = color_css_name_of(rgb))) {
+				long length = (long)strlen(name);
+				memcpy(to, name, length);
+				return to+length;
+			}
+			// fall through
+		case COLOR_CSS_HEX:
+			*to++ = '#';
+			to = color_css_byte_hex(to, rgb->r);
+			to = color_css_byte_hex(to, rgb->g);
+			to = color_css_byte_hex(to, rgb->b);
+			if (rgb->alpha) to = color_css_byte_hex(to, 255-rgb->alpha);
+			return to;
+		case COLOR_CSS_RGB:
+		case COLOR_CSS_RGBA:
+			memcpy(to, form == COLOR_CSS_RGB ? "rgb(" : "rgba(", 5);
+			to += form == COLOR_CSS_RGB ? 4 : 5;
+			to = color_css_integer(to, rgb->r);
+			*to++ = form == COLOR_CSS_RGB ? ' ' : ',';
+			if (form == COLOR_CSS_RGBA) *to++ = ' ';
+			to = color_css_integer(to, rgb->g);
+			*to++ = form == COLOR_CSS_RGB ? ' ' : ',';
+			if (form == COLOR_CSS_RGBA) *to++ = ' ';
+			to = color_css_integer(to, rgb->b);
+			break;
+		default:
+			memcpy(to, form == COLOR_CSS_HSL ? "hsl(" : "hsla(", 5);
+			to += form == COLOR_CSS_HSL ? 4 : 5;
+			to = color_css_decimal(to, color_css_clamp(hsl->h, 0, 1)*360, 2);
+			if (form == COLOR_CSS_HSLA) *to++ = ',';
+			*to++ = ' ';
+			to = color_css_decimal(to, color_css_clamp(hsl->s, 0, 1)*100, 2);
+			*to++ = '%';
+			if (form == COLOR_CSS_HSLA) *to++ = ',';
+			*to++ = ' ';
+			to = color_css_decimal(to, color_css_clamp(hsl->l, 0, 1)*100, 2);
+			*to++ = '%';
+			break;
+	}
+	unsigned char alpha = color_css_form_hsl(form) ? hsl->alpha : rgb->alpha;
+	if (form == COLOR_CSS_RGBA || form == COLOR_CSS_HSLA) {
+		*to++ = ',';
+		*to++ = ' ';
+		to = color_css_opacity(to, alpha);
+	} else if (alpha) {
+		memcpy(to, " / ", 3);
+		to = color_css_opacity(to+3, alpha);
+	}
+	*to++ = ')';
+	return to;
+}
+
+/*
+ * Accepts :hex, :rgb, :rgba, :hsl, :hsla or :name, raises ArgumentError
+ * otherwise.
+ */
+extern int
+color_css_form_get(VALUE form)
+{
+	if (NIL_P(form) || form == ID2SYM(rb_intern("hex"))) return COLOR_CSS_HEX;
+	if (form == ID2SYM(rb_intern("rgb")))  return COLOR_CSS_RGB;
+	if (form == ID2SYM(rb_intern("rgba"))) return COLOR_CSS_RGBA;
+	if (form == ID2SYM(rb_intern("hsl")))  return COLOR_CSS_HSL;
+	if (form == ID2SYM(rb_intern("hsla"))) return COLOR_CSS_HSLA;
+	if (form == ID2SYM(rb_intern("name"))) return COLOR_CSS_NAME;
+	rb_raise(rb_eArgError, "Unknown form, must be :hex, :rgb, :rgba, :hsl, :hsla or :name");
+	return COLOR_CSS_HEX;
+}
+
+/*
+ * Whether the form is written from HSL rather than from RGB.
+ */
+extern int
+color_css_form_hsl(int form)
+{
+	return form == COLOR_CSS_HSL || form == COLOR_CSS_HSLA;
+}
+
+extern void
+color_css_init(void)
+{
+	for (int i = 0; i < 256; i++) {
+		color_css_hex[i*2]   = "0123456789abcdef"[i >> 4];
+		color_css_hex[i*2+1] = "0123456789abcdef"[i & 15];
+	}
+	for (long i = 0; i < COLOR_CSS_NAMES; i++) color_css_by_rgb[i] = i;
+	qsort(color_css_by_rgb, COLOR_CSS_NAMES, sizeof(long), color_css_compare_rgb);
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+	color_css_cache_key = rb_ractor_local_storage_ptr_newkey(&color_css_cache_type);
+#endif
+}
+
+/*
+ *  call-seq:
+ *     Color::CSS.parse(string) -> rgb or hsl
+ *
+ *  Parses a CSS Color 4 color: #rgb, #rgba, #rrggbb, #rrggbbaa, rgb(),
+ *  rgba(), hsl() and hsla() in the comma and in the space separated form
+ *  (with "/ alpha"), the named colors and transparent. hsl() and hsla()
+ *  give a Color::HSL, all others a Color::RGB. Raises ArgumentError for
+ *  anything else.
+ *  Results are kept in a bounded LRU cache keyed by the input, see
+ *  Color::CSS.cache_size.
+ */
+extern VALUE
+rb_color_css__parse(VALUE module, VALUE string)
+{
+	cCssCache *cache;
+	VALUE color;
+	StringValue(string);
+	const char *key = RSTRING_PTR(string);
+	long length     = RSTRING_LEN(string);
+	unsigned int hash = 0;
+
+	cache = color_css_cache();
+	if (cache->capacity && length <= COLOR_CSS_KEY_MAX) {
+		hash  = color_css_hash(key, length);
+		color = color_css_cache_get(cache, key, length, hash);
+		if (color != Qundef) {
+			cache->hits++;
+			return color;
+		}
+	}
+	cache->misses++;
+	color = color_css_parse(key, length);
+	if (NIL_P(color)) {
+		VALUE inspect = rb_inspect(string);
+		rb_raise(rb_eArgError, "Invalid CSS color %s", RSTRING_PTR(inspect));
+	}
+	if (cache->capacity && length <= COLOR_CSS_KEY_MAX) {
+		color_css_cache_set(cache, key, length, hash, color);
+	}
+	return color;
+}
+
+/*
+ *  call-seq:
+ *     Color::CSS.format(color, form=:hex) -> string
+ *
+ *  Writes a color of any model in CSS form:
+ *  :hex::  "#ff0099", "#ff009980" unless opaque
+ *  :rgb::  "rgb(255 0 153)", "rgb(255 0 153 / 0.5)" unless opaque
+ *  :rgba:: "rgba(255, 0, 153, 1)"
+ *  :hsl::  "hsl(324 100% 50%)", "hsl(324 100% 50% / 0.5)" unless opaque
+ *  :hsla:: "hsla(324, 100%, 50%, 1)"
+ *  :name:: "deeppink" if it is a named color, like :hex otherwise
+ *  Color::CSS.parse reads all forms back.
+ */
+extern VALUE
+rb_color_css__format(int argc, VALUE *argv, VALUE module)
+{
+	char  string[64];
+	cAny  tmp;
+	VALUE color, r_form;
+	rb_scan_args(argc, argv, "11", &color, &r_form);
+	int form = color_css_form_get(r_form);
+	if (color_css_form_hsl(form)) {
+		cHSL *hsl = color_coerce(color, COLOR_MODEL_HSL, &tmp, COLOR_COERCE_FORMAT);
+		return rb_str_new(string, color_css_format(string, form, NULL, hsl)-string);
+	}
+	cRGB *rgb = color_coerce(color, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_FORMAT);
+	return rb_str_new(string, color_css_format(string, form, rgb, NULL)-string);
+}
+
+/*
+ *  call-seq:
+ *     Color::CSS.cache_size -> integer
+ *
+ *  The capacity of the parse cache, 1024 by default. Each ractor has a
+ *  cache of its own.
+ */
+extern VALUE
+rb_color_css__cache_size(VALUE module)
+{
+	return LONG2NUM(color_css_cache()->capacity);
+}
+
+/*
+ *  call-seq:
+ *     Color::CSS.cache_size = integer
+ *
+ *  Sets the capacity of the parse cache and empties it, 0 disables it.
+ */
+extern VALUE
+rb_color_css__set_cache_size(VALUE module, VALUE size)
+{
+	long capacity = NUM2LONG(size);
+	if (capacity < 0 || capacity > COLOR_CSS_CACHE_MAX) {
+		rb_raise(rb_eArgError, "Invalid cache size, must be between 0 and %d", COLOR_CSS_CACHE_MAX);
+	}
+	color_css_cache_resize(color_css_cache(), capacity);
+	return size;
+}
+
+/*
+ *  call-seq:
+ *     Color::CSS.cache_info -> hash
+ *
+ *  The :capacity and :size of the parse cache and its :hits and :misses
+ *  since it was last resized or cleared.
+ */
+extern VALUE
+rb_color_css__cache_info(VALUE module)
+{
+	cCssCache *cache = color_css_cache();
+	VALUE info = rb_hash_new();
+	rb_hash_aset(info, ID2SYM(rb_intern("capacity")), LONG2NUM(cache->capacity));
+	rb_hash_aset(info, ID2SYM(rb_intern("size")),     LONG2NUM(cache->size));
+	rb_hash_aset(info, ID2SYM(rb_intern("hits")),     ULONG2NUM(cache->hits));
+	rb_hash_aset(info, ID2SYM(rb_intern("misses")),   ULONG2NUM(cache->misses));
+	return info;
+}
+
+/*
+ *  call-seq:
+ *     Color::CSS.clear_cache -> nil
+ *
+ *  Empties the parse cache and resets its counters.
+ */
+extern VALUE
+rb_color_css__clear_cache(VALUE module)
+{
+	cCssCache *cache = color_css_cache();
+	color_css_cache_resize(cache, cache->capacity);
+	cache->hits   = 0;
+	cache->misses = 0;
+	return Qnil;
+}
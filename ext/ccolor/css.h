@@ -0,0 +1,23 @@
+// the forms of Color::CSS.format
+enum {
+	COLOR_CSS_HEX,
+	COLOR_CSS_RGB,
+	COLOR_CSS_RGBA,
+	COLOR_CSS_HSL,
+	COLOR_CSS_HSLA,
+	COLOR_CSS_NAME
+};
+
+extern char color_css_hex[512];
+
+extern void color_css_init(void);
+extern VALUE color_css_parse(const char *at, long length);
+extern int color_css_form_get(VALUE form);
+extern int color_css_form_hsl(int form);
+extern char *color_css_format(char *to, int form, cRGB *rgb, cHSL *hsl);
+extern VALUE rb_color_css__parse(VALUE module, VALUE string);
+extern VALUE rb_color_css__format(int argc, VALUE *argv, VALUE module);
+extern VALUE rb_color_css__cache_size(VALUE module);
+extern VALUE rb_color_css__set_cache_size(VALUE module, VALUE size);
+extern VALUE rb_color_css__cache_info(VALUE module);
+extern VALUE rb_color_css__clear_cache(VALUE module);
@@ -0,0 +1,113 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "depth.h"
+#include "dispatch.h"
+
+// 4x4 ordered dither (Bayer) matrix
+static const unsigned char color_bayer4[4][4] = {
+	{  0,  8,  2, 10 },
+	{ 12,  4, 14,  6 },
+	{  3, 11,  1,  9 },
+	{ 15,  7, 13,  5 },
+};
+
+/*
+ * Accepts :round, :floor or :dither, raises ArgumentError otherwise.
+ */
+extern int
+color_rounding_get(VALUE spec)
+{
+	if (NIL_P(spec))                        return COLOR_ROUND_NEAREST;
+	if (spec == ID2SYM(rb_intern("round")))  return COLOR_ROUND_NEAREST;
+	if (spec == ID2SYM(rb_intern("floor")))  return COLOR_ROUND_FLOOR;
+	if (spec == ID2SYM(rb_intern("dither"))) return COLOR_ROUND_DITHER;
+	rb_raise(rb_eArgError, "Unknown rounding, must be :round, :floor or :dither");
+	return COLOR_ROUND_NEAREST;
+}
+
+static inline unsigned char
+color_quantize(float value, int rounding, float threshold)
+{
+	value = color_unitf(value)*255;
+	switch(rounding) {
+		case COLOR_ROUND_FLOOR:  return (unsigned char)value;
+		case COLOR_ROUND_DITHER: return (unsigned char)color_capf(floorf(value+threshold), 0, 255);
+	}
+	return (unsigned char)(value+0.5f);
+}
+
+/*
+ * The ordered dither threshold (0..1) of element index in rows of width.
+ */
+extern float
+color_dither_threshold(long index, long width)
+{
+	return (color_bayer4[(index/width)&3][(index%width)&3]+0.5f)/16;
+}
+
+/*
+ * Reduces float colors to 8 bit. Width is the row width used to place the
+ * dither matrix, it is ignored for other roundings.
+ */
+extern void
+color_quantize_rgbf(cRGBF *from, cRGB *to, long length, int rounding, long width)
+{
+	if (rounding != COLOR_ROUND_NEAREST) {
+		for (long i = 0; i < length; i++) {
+			float threshold = rounding == COLOR_ROUND_DITHER ? color_dither_threshold(i, width) : 0;
+			to[i].r     = color_quantize(from[i].r, rounding, threshold);
+			to[i].g     = color_quantize(from[i].g, rounding, threshold);
+			to[i].b     = color_quantize(from[i].b, rounding, threshold);
+			to[i].alpha = color_quantize(from[i].alpha, COLOR_ROUND_NEAREST, 0);
+		}
+		return;
+	}
+	color_kernels->quantize_rgbf(from, to, length);
+}
+
+/*
+ * Reduces 16 bit colors to 8 bit, see color_quantize_rgbf.
+ */
+extern void
+color_quantize_rgb16(cRGB16 *from, cRGB *to, long length, int rounding, long width)
+{
+	switch(rounding) {
+		case COLOR_ROUND_NEAREST:
+			for (long i = 0; i < length; i++) {
+				to[i].r     = SHORT2CHR(from[i].r);
+				to[i].g     = SHORT2CHR(from[i].g);
+				to[i].b     = SHORT2CHR(from[i].b);
+				to[i].alpha = SHORT2CHR(from[i].alpha);
+			}
+			break;
+		case COLOR_ROUND_FLOOR:
+			for (long i = 0; i < length; i++) {
+				to[i].r     = from[i].r/257;
+				to[i].g     = from[i].g/257;
+				to[i].b     = from[i].b/257;
+				to[i].alpha = SHORT2CHR(from[i].alpha);
+			}
+			break;
+		case COLOR_ROUND_DITHER:
+			for (long i = 0; i < length; i++) {
+				float threshold = color_dither_threshold(i, width);
+				to[i].r     = color_quantize(SHORT2FLOAT(from[i].r), rounding, threshold);
+				to[i].g     = color_quantize(SHORT2FLOAT(from[i].g), rounding, threshold);
+				to[i].b     = color_quantize(SHORT2FLOAT(from[i].b), rounding, threshold);
+				to[i].alpha = SHORT2CHR(from[i].alpha);
+			}
+			break;
+	}
+}
+
+/*
+ * Widens 8 bit colors to floats, same values as color_convert_rgb_to_rgbf.
+ */
+extern void
+color_expand_rgb(cRGB *from, cRGBF *to, long length)
+{
+	color_kernels->expand_rgb(from, to, length);
+}
@@ -0,0 +1,5 @@
+extern int color_rounding_get(VALUE spec);
+extern float color_dither_threshold(long index, long width);
+extern void color_quantize_rgbf(cRGBF *from, cRGB *to, long length, int rounding, long width);
+extern void color_quantize_rgb16(cRGB16 *from, cRGB *to, long length, int rounding, long width);
+extern void color_expand_rgb(cRGB *from, cRGBF *to, long length);
@@ -0,0 +1,267 @@
+#include <ruby.h>
+#include <math.h>
+#include <limits.h>
+#include <string.h>
+#include "color.h"
+#include "buffer.h"
+#include "dispatch.h"
+#include "threads.h"
+#include "diff.h"
+
+// pixels per step, the unit of the early exit and of the per thread results
+#define COLOR_DIFF_BLOCK 4096
+
+// the findings of one block
+typedef struct _cDiffBlock {
+	long compared;
+	long mismatches;
+	long left, top, right, bottom;
+} cDiffBlock;
+
+typedef struct _cDiff {
+	const cRGB *color;
+	const cRGB *with;
+	float      *distances; // NULL unless requested
+	cGray      *heatmap;   // NULL unless requested
+	cDiffBlock *blocks;
+	long  length;
+	long  width;
+	long  limit;           // 0 compares everything
+	volatile long found;   // mismatches so far, shared by the threads
+	int   metric;
+	int   threshold;       // in the integer distances of the metric
+	float scale;           // integer distance to 0..1
+} cDiff;
+
+static int
+color_diff_metric_get(VALUE spec)
+{
+	if (NIL_P(spec) || spec == ID2SYM(rb_intern("euclidean"))) return COLOR_DIFF_EUCLIDEAN;
+	if (spec == ID2SYM(rb_intern("max")))                       return COLOR_DIFF_MAX;
+	if (spec == ID2SYM(rb_intern("luma")))                      return COLOR_DIFF_LUMA;
+	rb_raise(rb_eArgError, "Unknown metric, must be :euclidean, :max or :luma");
+	return COLOR_DIFF_EUCLIDEAN;
+}
+
+/*
+ * The integer distances of the dispatch kernel are the sum of the squared
+ * channel differences, the largest channel difference and the difference
+ * in 256 * Y'. Returns the largest integer distance that is not above
+ * +threshold+ (0..1), -1 if every pixel is a mismatch.
+ */
+static int
+color_diff_threshold(int metric, double threshold, float *scale)
+{
+	double limit;
+	switch(metric) {
+		case COLOR_DIFF_MAX:
+			*scale = 1.0f/255;
+			limit  = threshold*255;
+			break;
+		case COLOR_DIFF_LUMA:
+			*scale = 1.0f/(255*256);
+			limit  = threshold*255*256;
+			break;
+		default:
+			*scale = 1.0f/510;
+			limit  = threshold < 0 ? -1 : threshold*threshold*510*510;
+			break;
+	}
+	if (limit < 0) return -1;
+	return limit >= INT_MAX ? INT_MAX : (int)floor(limit);
+}
+
+// widens the box of +block+ to the mismatches among raw, row by row
+static void
+color_diff_box(cDiff *diff, cDiffBlock *block, const int *raw, long start, long length)
+{
+	long end = start+length;
+	raw -= start;
+	while (start < end) {
+		long y       = start/diff->width;
+		long row_end = (y+1)*diff->width < end ? (y+1)*diff->width : end;
+		long first   = start, last = row_end-1;
+		while (first < row_end && raw[first] <= diff->threshold) first++;
+		if (first < row_end) {
+			while (raw[last] <= diff->threshold) last--;
+			if (first-y*diff->width < block->left) block->left = first-y*diff->width;
+			if (last-y*diff->width > block->right) block->right = last-y*diff->width;
+			if (y < block->top) block->top = y;
+			block->bottom = y;
+		}
+		start = row_end;
+	}
+}
+
+/*
+ * Compares the blocks starting in from...to, so every block belongs to
+ * exactly one thread. Stops before the next block once diff->limit
+ * mismatches are found, by any thread.
+ */
+static void
+color_diff_slice(void *ptr, long from, long to)
+{
+	cDiff *diff = ptr;
+	int    raw[COLOR_DIFF_BLOCK];
+	float  values[COLOR_DIFF_BLOCK];
+	for (long n = (from+COLOR_DIFF_BLOCK-1)/COLOR_DIFF_BLOCK; n*COLOR_DIFF_BLOCK < to; n++) {
+		cDiffBlock *block = &diff->blocks[n];
+		long start        = n*COLOR_DIFF_BLOCK;
+		long length       = diff->length-start < COLOR_DIFF_BLOCK ? diff->length-start : COLOR_DIFF_BLOCK;
+		long mismatches   = 0;
+		if (diff->limit > 0 && diff->found >= diff->limit) break;
+		color_kernels->diff_rgb(diff->color+start, diff->with+start, raw, length, diff->metric);
+		for (long i = 0; i < length; i++) mismatches += raw[i] > diff->threshold;
+		block->compared   = length;
+		block->mismatches = mismatches;
+		if (mismatches > 0) {
+			color_diff_box(diff, block, raw, start, length);
+			if (diff->limit > 0) __sync_fetch_and_add(&diff->found, mismatches);
+		}
+		if (diff->distances || diff->heatmap) {
+			float *out = diff->distances ? diff->distances+start : values;
+			if (diff->metric == COLOR_DIFF_EUCLIDEAN) {
+				for (long i = 0; i < length; i++) out[i] = sqrtf((float)raw[i])*diff->scale;
+			} else {
+				for (long i = 0; i < length; i++) out[i] = raw[i]*diff->scale;
+			}
+			if (diff->heatmap) {
+				cGray *heatmap = diff->heatmap+start;
+				for (long i = 0; i < length; i++) {
+					heatmap[i].white = (unsigned char)(out[i]*255+0.5f);
+					heatmap[i].alpha = 0;
+				}
+			}
+		}
+	}
+}
+
+/*
+ *  call-seq:
+ *     buffer.diff(other[, options]) -> hash
+ *
+ *  Compares two RGB buffers of equal length and alpha mode pixel by pixel,
+ *  e.g. two renders of the same image. Returns a Hash with
+ *  :mismatches:: the number of pixels farther apart than :threshold
+ *  :compared::   the number of pixels compared, less than the length
+ *                after an early exit
+ *  :complete::   whether all pixels were compared
+ *  :box::        [x, y, width, height] around all mismatches, nil if
+ *                there are none
+ *  :distances::  the distance of every pixel as binary String of native
+ *                floats (0..1), NaN for pixels not compared
+ *  :heatmap::    a Color::Gray buffer of the distances, white is the
+ *                largest distance (only with <code>:heatmap => true</code>)
+ *  Options:
+ *  :metric::     :euclidean (default, same as Color::RGB#distance), :max
+ *                (the largest channel difference) or :luma (the difference
+ *                in Y', ignores alpha)
+ *  :threshold::  distances above it are mismatches, defaults to 0
+ *  :limit::      stop early once this many mismatches were found, checked
+ *                every 4096 pixels, so more may be counted
+ *  :width::      row width of the image for :box, defaults to the buffer
+ *                length
+ *  :distances::  false skips the distances
+ *  :heatmap::    true adds the heatmap
+ *  :threads::    splits the buffers over n native threads
+ *
+ *  Example:
+ *    result = expected.diff(actual, :threshold => 0.02, :width => 1920, :distances => false)
+ *    fail "#{result[:mismatches]} pixels differ in #{result[:box].inspect}" if result[:mismatches] > 0
+ */
+extern VALUE
+rb_color_buffer_diff(int argc, VALUE *argv, VALUE self)
+{
+	cDiff diff;
+	VALUE other, options, r_metric = Qnil, r_threshold = Qnil, r_limit = Qnil, r_width = Qnil;
+	VALUE r_distances = Qnil, r_heatmap = Qnil, distances = Qnil, heatmap = Qnil;
+	rb_scan_args(argc, argv, "11", &other, &options);
+	cBuffer *buffer1 = color_buffer_get_alpha(self, COLOR_MODEL_RGB, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	cBuffer *buffer2 = color_buffer_get_alpha(other, COLOR_MODEL_RGB, COLOR_ALPHA_PREMULTIPLIED|COLOR_ALPHA_OPACITY);
+	if (buffer1->alpha != buffer2->alpha) {
+		rb_raise(rb_eTypeError, "Buffers differ in their alpha mode");
+	}
+	if (buffer1->length != buffer2->length) {
+		rb_raise(rb_eArgError, "Buffers differ in length");
+	}
+	int threads = color_threads_get(options);
+	if (!NIL_P(options)) {
+		r_metric    = rb_hash_aref(options, ID2SYM(rb_intern("metric")));
+		r_threshold = rb_hash_aref(options, ID2SYM(rb_intern("threshold")));
+		r_limit     = rb_hash_aref(options, ID2SYM(rb_intern("limit")));
+		r_width     = rb_hash_aref(options, ID2SYM(rb_intern("width")));
+		r_distances = rb_hash_aref(options, ID2SYM(rb_intern("distances")));
+		r_heatmap   = rb_hash_aref(options, ID2SYM(rb_intern("heatmap")));
+	}
+	diff.metric    = color_diff_metric_get(r_metric);
+	diff.threshold = color_diff_threshold(diff.metric, NIL_P(r_threshold) ? 0.0 : NUM2DBL(r_threshold), &diff.scale);
+	diff.limit     = NIL_P(r_limit) ? 0 : NUM2LONG(r_limit);
+	diff.width     = NIL_P(r_width) ? 0 : NUM2LONG(r_width);
+	if (diff.limit < 0) {
+		rb_raise(rb_eArgError, "Invalid limit, must be positive");
+	}
+	if (diff.width < 0) {
+		rb_raise(rb_eArgError, "Invalid width, must be positive");
+	}
+	if (diff.width == 0) diff.width = buffer1->length > 0 ? buffer1->length : 1;
+
+	diff.color     = (const cRGB *)buffer1->data;
+	diff.with      = (const cRGB *)buffer2->data;
+	diff.length    = buffer1->length;
+	diff.found     = 0;
+	diff.distances = NULL;
+	diff.heatmap   = NULL;
+	if (NIL_P(r_distances) || RTEST(r_distances)) {
+		distances      = rb_str_new(NULL, diff.length*sizeof(float));
+		diff.distances = (float *)RSTRING_PTR(distances);
+	}
+	if (RTEST(r_heatmap)) {
+		cBuffer *gray;
+		heatmap        = color_buffer_new(COLOR_MODEL_GRAY, diff.length, &gray);
+		diff.heatmap   = (cGray *)gray->data;
+	}
+	long blocks = (diff.length+COLOR_DIFF_BLOCK-1)/COLOR_DIFF_BLOCK;
+	diff.blocks = ALLOC_N(cDiffBlock, blocks+1);
+	for (long n = 0; n < blocks; n++) {
+		cDiffBlock empty = { 0, 0, LONG_MAX, LONG_MAX, -1, -1 };
+		diff.blocks[n]   = empty;
+	}
+	COLOR_STAT_KERNEL(COLOR_KERNEL_DIFF, diff.length);
+	color_parallel(color_diff_slice, &diff, diff.length, threads);
+
+	cDiffBlock total = { 0, 0, LONG_MAX, LONG_MAX, -1, -1 };
+	for (long n = 0; n < blocks; n++) {
+		cDiffBlock *block = &diff.blocks[n];
+		if (block->compared == 0) {
+			long start  = n*COLOR_DIFF_BLOCK;
+			long length = diff.length-start < COLOR_DIFF_BLOCK ? diff.length-start : COLOR_DIFF_BLOCK;
+			for (long i = 0; diff.distances && i < length; i++) diff.distances[start+i] = NAN;
+			if (diff.heatmap) memset(diff.heatmap+start, 0, length*sizeof(cGray));
+			continue;
+		}
+		total.compared   += block->compared;
+		total.mismatches += block->mismatches;
+		if (block->mismatches == 0) continue;
+		if (block->left < total.left)     total.left   = block->left;
+		if (block->top < total.top)       total.top    = block->top;
+		if (block->right > total.right)   total.right  = block->right;
+		if (block->bottom > total.bottom) total.bottom = block->bottom;
+	}
+	xfree(diff.blocks);
+
+	VALUE result = rb_hash_new();
+	VALUE box    = Qnil;
+	if (total.mismatches > 0) {
+		box = rb_ary_new3(4,
+			LONG2NUM(total.left), LONG2NUM(total.top),
+			LONG2NUM(total.right-total.left+1), LONG2NUM(total.bottom-total.top+1)
+		);
+	}
+	rb_hash_aset(result, ID2SYM(rb_intern("mismatches")), LONG2NUM(total.mismatches));
+	rb_hash_aset(result, ID2SYM(rb_intern("compared")),   LONG2NUM(total.compared));
+	rb_hash_aset(result, ID2SYM(rb_intern("complete")),   total.compared == diff.length ? Qtrue : Qfalse);
+	rb_hash_aset(result, ID2SYM(rb_intern("box")),        box);
+	if (!NIL_P(distances)) rb_hash_aset(result, ID2SYM(rb_intern("distances")), distances);
+	if (!NIL_P(heatmap))   rb_hash_aset(result, ID2SYM(rb_intern("heatmap")),   heatmap);
+	return result;
+}
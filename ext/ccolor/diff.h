@@ -0,0 +1 @@
+extern VALUE rb_color_buffer_diff(int argc, VALUE *argv, VALUE self);
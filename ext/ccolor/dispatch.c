@@ -0,0 +1,800 @@
+#include <ruby.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "color.h"
+#include "tools.h"
+#include "dispatch.h"
+#ifdef COLOR_SIMD_DISPATCH
+#include <immintrin.h>
+#define COLOR_TARGET(isa) __attribute__((target(isa)))
+#endif
+#ifdef __GNUC__
+#define COLOR_INLINE static inline __attribute__((always_inline))
+#else
+#define COLOR_INLINE static inline
+#endif
+
+/*
+ * Every level computes the exact same results, the generic kernels are the
+ * reference. The SSE2 level is what x86_64 compilers emit by default, the
+ * others are compiled with a target attribute and only called after cpuid
+ * confirmed them.
+ */
+
+static const char *color_simd_names[COLOR_SIMD_COUNT] = {
+	"none", "sse2", "avx2", "avx512"
+};
+
+// one table per level, all filled when the extension loads and never
+// written again. Switching levels only swaps the pointer, a word sized
+// store, so a kernel call in another thread or ractor sees either the old
+// or the new table, both complete.
+static cKernels color_kernel_levels[COLOR_SIMD_COUNT];
+const cKernels *volatile color_kernels = &color_kernel_levels[COLOR_SIMD_NONE];
+static int color_simd_supported = COLOR_SIMD_NONE;
+
+/* generic kernels */
+
+static void
+color_expand_rgb_generic(cRGB *from, cRGBF *to, long length)
+{
+	for (long i = 0; i < length; i++) {
+		color_convert_rgb_to_rgbf(&from[i], &to[i]);
+	}
+}
+
+static void
+color_quantize_rgbf_generic(cRGBF *from, cRGB *to, long length)
+{
+	for (long i = 0; i < length; i++) {
+		to[i].r     = (unsigned char)(color_unitf(from[i].r)*255+0.5f);
+		to[i].g     = (unsigned char)(color_unitf(from[i].g)*255+0.5f);
+		to[i].b     = (unsigned char)(color_unitf(from[i].b)*255+0.5f);
+		to[i].alpha = (unsigned char)(color_unitf(from[i].alpha)*255+0.5f);
+	}
+}
+
+static long
+color_nearest_generic(cPalette *palette, float r, float g, float b, float alpha)
+{
+	long  best     = 0;
+	float best_sum = INFINITY;
+	for (long i = 0; i < palette->size; i++) {
+		float dr  = r-palette->r[i];
+		float dg  = g-palette->g[i];
+		float db  = b-palette->b[i];
+		float da  = alpha-palette->alpha[i];
+		float sum = dr*dr+dg*dg+db*db+da*da;
+		if (sum < best_sum) {
+			best_sum = sum;
+			best     = i;
+		}
+	}
+	return best;
+}
+
+/*
+ * color_rgb_interpolate of one channel. For results in 0..1 rounding the
+ * float up from .5 in double is exactly roundf, and unlike roundf it
+ * vectorizes.
+ */
+COLOR_INLINE unsigned char
+color_interpolate_channel(unsigned char value1, unsigned char value2, float pos)
+{
+	double from  = CHR2FLOAT(value1);
+	double to    = CHR2FLOAT(value2);
+	float  value = (float)((from+(to-from)*pos)*255);
+	return (unsigned char)floor(value+0.5);
+}
+
+// pos must be within 0..1
+COLOR_INLINE void
+color_interpolate_rgb_body(cRGB *from, cRGB *to, cRGB *out, long length, float pos)
+{
+	unsigned char *a = (unsigned char *)from, *b = (unsigned char *)to, *o = (unsigned char *)out;
+	for (long i = 0; i < length*4; i++) {
+		o[i] = color_interpolate_channel(a[i], b[i], pos);
+	}
+}
+
+// opacity must be within 0..1, or negative to use the alpha of with
+COLOR_INLINE void
+color_blend_rgb_body(cRGB *color, cRGB *with, cRGB *out, long length, float opacity)
+{
+	for (long i = 0; i < length; i++) {
+		float pos    = opacity < 0 ? (255-with[i].alpha)/255.0f : opacity;
+		out[i].r     = color_interpolate_channel(color[i].r, with[i].r, pos);
+		out[i].g     = color_interpolate_channel(color[i].g, with[i].g, pos);
+		out[i].b     = color_interpolate_channel(color[i].b, with[i].b, pos);
+		out[i].alpha = color[i].alpha;
+	}
+}
+
+static void
+color_interpolate_rgb_generic(cRGB *from, cRGB *to, cRGB *out, long length, float pos)
+{
+	color_interpolate_rgb_body(from, to, out, length, pos);
+}
+
+static void
+color_blend_rgb_generic(cRGB *color, cRGB *with, cRGB *out, long length, float opacity)
+{
+	color_blend_rgb_body(color, with, out, length, opacity);
+}
+
+static void
+color_swizzle_generic(const unsigned char *from, unsigned char *to, long length, const cSwizzle *swizzle)
+{
+	for (long i = 0; i < length*4; i += 4) {
+		for (int k = 0; k < 4; k++) {
+			to[i+k] = (swizzle->order[k] < 0 ? 0 : from[i+swizzle->order[k]]) ^ swizzle->flip[k];
+		}
+	}
+}
+
+/*
+ * 5 and 6 bit fields are widened and narrowed with correct rounding,
+ * (v*527+23)>>6 is round(v*255/31), (v*259+33)>>6 round(v*255/63), the
+ * narrowing ones are the inverse (checked for every value). Only green has
+ * 6 bits, and only in 565.
+ */
+COLOR_INLINE void
+color_pack_rgb16_body(const cRGB *from, unsigned short *to, long length, int green_bits, int swap)
+{
+	for (long i = 0; i < length; i++) {
+		unsigned int r = (from[i].r*249+1014) >> 11;
+		unsigned int g = green_bits == 6 ? (from[i].g*253+505) >> 10 : (from[i].g*249+1014) >> 11;
+		unsigned int b = (from[i].b*249+1014) >> 11;
+		unsigned int v = r << (5+green_bits) | g << 5 | b;
+		to[i] = (unsigned short)(swap ? (v >> 8 | v << 8) : v);
+	}
+}
+
+COLOR_INLINE void
+color_unpack_rgb16_body(const unsigned short *from, cRGB *to, long length, int green_bits, int swap)
+{
+	for (long i = 0; i < length; i++) {
+		unsigned int v = from[i];
+		if (swap) v = (v >> 8 | v << 8) & 0xffff;
+		unsigned int r = v >> (5+green_bits) & 31, g = v >> 5 & ((1 << green_bits)-1), b = v & 31;
+		cRGB color = {
+			(unsigned char)((r*527+23) >> 6),
+			(unsigned char)(green_bits == 6 ? (g*259+33) >> 6 : (g*527+23) >> 6),
+			(unsigned char)((b*527+23) >> 6),
+			0
+		};
+		to[i] = color;
+	}
+}
+
+// no intrinsics, the scalar loop is auto-vectorized per level; constant
+// green_bits, so the compiler emits one vectorized loop each
+#define COLOR_RGB16_KERNELS(suffix, attributes) \
+	attributes static void \
+	color_pack_rgb16_##suffix(const cRGB *from, unsigned short *to, long length, int green_bits, int swap) \
+	{ \
+		if (green_bits == 6) color_pack_rgb16_body(from, to, length, 6, swap); \
+		else                 color_pack_rgb16_body(from, to, length, 5, swap); \
+	} \
+	attributes static void \
+	color_unpack_rgb16_##suffix(const unsigned short *from, cRGB *to, long length, int green_bits, int swap) \
+	{ \
+		if (green_bits == 6) color_unpack_rgb16_body(from, to, length, 6, swap); \
+		else                 color_unpack_rgb16_body(from, to, length, 5, swap); \
+	}
+
+COLOR_RGB16_KERNELS(generic, )
+
+COLOR_INLINE int
+color_clamp_int(int value, int max)
+{
+	return value < 0 ? 0 : (value > max ? max : value);
+}
+
+/*
+ * Y'CbCr rows, chroma at full width. Cb and Cr come out in 1/64 steps so
+ * averaging them for subsampling rounds only once.
+ */
+COLOR_INLINE void
+color_ycbcr_to_rgb_body(const unsigned char *y, const unsigned char *cb, const unsigned char *cr, cRGB *to, long length, const cYCbCrMatrix *matrix)
+{
+	int offset = matrix->y_offset, luma = matrix->luma;
+	int cr_r   = matrix->cr_r, cb_g = matrix->cb_g, cr_g = matrix->cr_g, cb_b = matrix->cb_b;
+	for (long i = 0; i < length; i++) {
+		int l = (y[i]-offset)*luma+(1 << 13), u = cb[i]-128, v = cr[i]-128;
+		cRGB color = {
+			(unsigned char)color_clamp_int((l+cr_r*v) >> 14, 255),
+			(unsigned char)color_clamp_int((l+cb_g*u+cr_g*v) >> 14, 255),
+			(unsigned char)color_clamp_int((l+cb_b*u) >> 14, 255),
+			0
+		};
+		to[i] = color;
+	}
+}
+
+COLOR_INLINE void
+color_rgb_to_ycbcr_body(const cRGB *from, unsigned char *y, unsigned short *cb, unsigned short *cr, long length, const cYCbCrMatrix *matrix)
+{
+	int yr = matrix->y[0], yg = matrix->y[1], yb = matrix->y[2];
+	int br = matrix->cb[0], bg = matrix->cb[1], bb = matrix->cb[2];
+	int rr = matrix->cr[0], rg = matrix->cr[1], rb = matrix->cr[2];
+	int offset = (matrix->y_offset << 14)+(1 << 13);
+	for (long i = 0; i < length; i++) {
+		int r = from[i].r, g = from[i].g, b = from[i].b;
+		y[i]  = (unsigned char)color_clamp_int((yr*r+yg*g+yb*b+offset) >> 14, 255);
+		cb[i] = (unsigned short)color_clamp_int((br*r+bg*g+bb*b+(128 << 14)+(1 << 7)) >> 8, 255*64);
+		cr[i] = (unsigned short)color_clamp_int((rr*r+rg*g+rb*b+(128 << 14)+(1 << 7)) >> 8, 255*64);
+	}
+}
+
+#define COLOR_YCBCR_KERNELS(suffix, attributes) \
+	attributes static void \
+	color_ycbcr_to_rgb_##suffix(const unsigned char *y, const unsigned char *cb, const unsigned char *cr, cRGB *to, long length, const cYCbCrMatrix *matrix) \
+	{ \
+		color_ycbcr_to_rgb_body(y, cb, cr, to, length, matrix); \
+	} \
+	attributes static void \
+	color_rgb_to_ycbcr_##suffix(const cRGB *from, unsigned char *y, unsigned short *cb, unsigned short *cr, long length, const cYCbCrMatrix *matrix) \
+	{ \
+		color_rgb_to_ycbcr_body(from, y, cb, cr, length, matrix); \
+	}
+
+COLOR_YCBCR_KERNELS(generic, )
+
+// round(a*b/255) for bytes a and b, exact
+COLOR_INLINE int
+color_mul255(int a, int b)
+{
+	int t = a*b+128;
+	return (t+(t >> 8)) >> 8;
+}
+
+/*
+ * Between the COLOR_ALPHA_* modes of RGB buffers, see alpha.c. Only one of
+ * the loops runs, each is simple enough to be vectorized. Unpremultiplying
+ * divides in float, fully transparent colors stay as they are (black).
+ */
+COLOR_INLINE void
+color_alpha_rgb_body(const cRGB *from, cRGB *to, long length, int from_alpha, int to_alpha)
+{
+	unsigned char flip = from_alpha & COLOR_ALPHA_OPACITY ? 0 : 0xff;
+	unsigned char back = to_alpha & COLOR_ALPHA_OPACITY ? 0 : 0xff;
+	int premultiply    = to_alpha & COLOR_ALPHA_PREMULTIPLIED;
+	if ((from_alpha & COLOR_ALPHA_PREMULTIPLIED) == premultiply) {
+		for (long i = 0; i < length; i++) {
+			cRGB color = { from[i].r, from[i].g, from[i].b, (unsigned char)(from[i].alpha ^ flip ^ back) };
+			to[i] = color;
+		}
+	} else if (premultiply) {
+		for (long i = 0; i < length; i++) {
+			int opacity = from[i].alpha ^ flip;
+			cRGB color  = {
+				(unsigned char)color_mul255(from[i].r, opacity),
+				(unsigned char)color_mul255(from[i].g, opacity),
+				(unsigned char)color_mul255(from[i].b, opacity),
+				(unsigned char)(opacity ^ back)
+			};
+			to[i] = color;
+		}
+	} else {
+		for (long i = 0; i < length; i++) {
+			int   opacity = from[i].alpha ^ flip;
+			float scale   = 255.0f/(opacity|(opacity == 0));
+			cRGB  color   = {
+				(unsigned char)color_clamp_int((int)(from[i].r*scale+0.5f), 255),
+				(unsigned char)color_clamp_int((int)(from[i].g*scale+0.5f), 255),
+				(unsigned char)color_clamp_int((int)(from[i].b*scale+0.5f), 255),
+				(unsigned char)(opacity ^ back)
+			};
+			to[i] = color;
+		}
+	}
+}
+
+/*
+ * Porter-Duff source over of premultiplied colors in the alpha mode
+ * +alpha+, out = with+color*(1-opacity of with), no division.
+ */
+COLOR_INLINE void
+color_composite_rgb_body(const cRGB *color, const cRGB *with, cRGB *out, long length, int alpha)
+{
+	unsigned char flip = alpha & COLOR_ALPHA_OPACITY ? 0 : 0xff;
+	for (long i = 0; i < length; i++) {
+		int rest = 255-(with[i].alpha ^ flip);
+		cRGB result = {
+			(unsigned char)color_clamp_int(with[i].r+color_mul255(color[i].r, rest), 255),
+			(unsigned char)color_clamp_int(with[i].g+color_mul255(color[i].g, rest), 255),
+			(unsigned char)color_clamp_int(with[i].b+color_mul255(color[i].b, rest), 255),
+			(unsigned char)((255-rest+color_mul255(color[i].alpha ^ flip, rest)) ^ flip)
+		};
+		out[i] = result;
+	}
+}
+
+#define COLOR_ALPHA_KERNELS(suffix, attributes) \
+	attributes static void \
+	color_alpha_rgb_##suffix(const cRGB *from, cRGB *to, long length, int from_alpha, int to_alpha) \
+	{ \
+		color_alpha_rgb_body(from, to, length, from_alpha, to_alpha); \
+	} \
+	attributes static void \
+	color_composite_rgb_##suffix(const cRGB *color, const cRGB *with, cRGB *out, long length, int alpha) \
+	{ \
+		color_composite_rgb_body(color, with, out, length, alpha); \
+	}
+
+COLOR_ALPHA_KERNELS(generic, )
+
+/*
+ * Integer distances of two RGB buffers, see diff.c for the scale of each
+ * metric. Integers keep the results identical on every level.
+ */
+COLOR_INLINE void
+color_diff_rgb_body(const cRGB *color, const cRGB *with, int *out, long length, int metric)
+{
+	switch(metric) {
+		case COLOR_DIFF_EUCLIDEAN:
+			for (long i = 0; i < length; i++) {
+				int r = color[i].r-with[i].r, g = color[i].g-with[i].g;
+				int b = color[i].b-with[i].b, a = color[i].alpha-with[i].alpha;
+				out[i] = r*r+g*g+b*b+a*a;
+			}
+			break;
+		case COLOR_DIFF_MAX:
+			for (long i = 0; i < length; i++) {
+				int r = abs(color[i].r-with[i].r), g = abs(color[i].g-with[i].g);
+				int b = abs(color[i].b-with[i].b), a = abs(color[i].alpha-with[i].alpha);
+				int x = r > g ? r : g, y = b > a ? b : a;
+				out[i] = x > y ? x : y;
+			}
+			break;
+		case COLOR_DIFF_LUMA:
+			for (long i = 0; i < length; i++) {
+				out[i] = abs(77*(color[i].r-with[i].r)+150*(color[i].g-with[i].g)+29*(color[i].b-with[i].b));
+			}
+			break;
+	}
+}
+
+#define COLOR_DIFF_KERNELS(suffix, attributes) \
+	attributes static void \
+	color_diff_rgb_##suffix(const cRGB *color, const cRGB *with, int *out, long length, int metric) \
+	{ \
+		color_diff_rgb_body(color, with, out, length, metric); \
+	}
+
+COLOR_DIFF_KERNELS(generic, )
+
+#ifdef COLOR_SIMD_DISPATCH
+
+// lowest index of the smallest sum over the lanes
+static long
+color_nearest_reduce(float *sums, int *indices, int lanes)
+{
+	long best = 0;
+	for (int i = 1; i < lanes; i++) {
+		if (sums[i] < sums[best] || (sums[i] == sums[best] && indices[i] < indices[best])) best = i;
+	}
+	return indices[best];
+}
+
+/* SSE2 kernels */
+
+COLOR_TARGET("sse2") static void
+color_expand_rgb_sse2(cRGB *from, cRGBF *to, long length)
+{
+	__m128  scale = _mm_set1_ps(255.0f);
+	__m128i zero  = _mm_setzero_si128();
+	for (long i = 0; i < length; i++) {
+		int packed;
+		memcpy(&packed, &from[i], sizeof(cRGB));
+		__m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+		_mm_storeu_ps(&to[i].r, _mm_div_ps(_mm_cvtepi32_ps(v), scale));
+	}
+}
+
+COLOR_TARGET("sse2") static void
+color_quantize_rgbf_sse2(cRGBF *from, cRGB *to, long length)
+{
+	__m128 zero  = _mm_setzero_ps();
+	__m128 one   = _mm_set1_ps(1.0f);
+	__m128 scale = _mm_set1_ps(255.0f);
+	__m128 half  = _mm_set1_ps(0.5f);
+	for (long i = 0; i < length; i++) {
+		// max first, so NaN becomes 0 like in color_unitf
+		__m128  v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&from[i].r), zero), one);
+		__m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+		q = _mm_packs_epi32(q, q);
+		q = _mm_packus_epi16(q, q);
+		int packed = _mm_cvtsi128_si32(q);
+		memcpy(&to[i], &packed, sizeof(cRGB));
+	}
+}
+
+COLOR_TARGET("sse2") static long
+color_nearest_sse2(cPalette *palette, float r, float g, float b, float alpha)
+{
+	__m128  vr = _mm_set1_ps(r), vg = _mm_set1_ps(g), vb = _mm_set1_ps(b), va = _mm_set1_ps(alpha);
+	__m128  best       = _mm_set1_ps(INFINITY);
+	__m128i best_index = _mm_setzero_si128();
+	__m128i index      = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i step       = _mm_set1_epi32(4);
+	float sums[4];
+	int   indices[4];
+	for (long i = 0; i < palette->size; i += 4) {
+		__m128 dr   = _mm_sub_ps(vr, _mm_loadu_ps(palette->r+i));
+		__m128 dg   = _mm_sub_ps(vg, _mm_loadu_ps(palette->g+i));
+		__m128 db   = _mm_sub_ps(vb, _mm_loadu_ps(palette->b+i));
+		__m128 da   = _mm_sub_ps(va, _mm_loadu_ps(palette->alpha+i));
+		__m128 sum  = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db)), _mm_mul_ps(da, da));
+		__m128 less = _mm_cmplt_ps(sum, best);
+		best       = _mm_or_ps(_mm_and_ps(less, sum), _mm_andnot_ps(less, best));
+		best_index = _mm_or_si128(_mm_and_si128(_mm_castps_si128(less), index), _mm_andnot_si128(_mm_castps_si128(less), best_index));
+		index      = _mm_add_epi32(index, step);
+	}
+	_mm_storeu_ps(sums, best);
+	_mm_storeu_si128((__m128i *)indices, best_index);
+	return color_nearest_reduce(sums, indices, 4);
+}
+
+/*
+ * SSE2 has no byte shuffle: four pixels per register as little endian
+ * ints, every output byte is its source byte shifted into place.
+ */
+COLOR_TARGET("sse2") static void
+color_swizzle_sse2(const unsigned char *from, unsigned char *to, long length, const cSwizzle *swizzle)
+{
+	__m128i keep[4], right[4], left[4];
+	unsigned int flip;
+	for (int k = 0; k < 4; k++) {
+		keep[k]  = _mm_set1_epi32(swizzle->order[k] < 0 ? 0 : 0xff);
+		right[k] = _mm_cvtsi32_si128(swizzle->order[k] < 0 ? 0 : 8*swizzle->order[k]);
+		left[k]  = _mm_cvtsi32_si128(8*k);
+	}
+	memcpy(&flip, swizzle->flip, 4);
+	__m128i vflip = _mm_set1_epi32((int)flip);
+	long i = 0;
+	for (; i+4 <= length; i += 4) {
+		__m128i v   = _mm_loadu_si128((const __m128i *)(from+i*4));
+		__m128i out = vflip;
+		for (int k = 0; k < 4; k++) {
+			out = _mm_xor_si128(out, _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(v, right[k]), keep[k]), left[k]));
+		}
+		_mm_storeu_si128((__m128i *)(to+i*4), out);
+	}
+	color_swizzle_generic(from+i*4, to+i*4, length-i, swizzle);
+}
+
+COLOR_RGB16_KERNELS(sse2, COLOR_TARGET("sse2"))
+COLOR_YCBCR_KERNELS(sse2, COLOR_TARGET("sse2"))
+COLOR_ALPHA_KERNELS(sse2, COLOR_TARGET("sse2"))
+COLOR_DIFF_KERNELS(sse2, COLOR_TARGET("sse2"))
+
+/* AVX2 kernels, two colors per register */
+
+COLOR_TARGET("avx2") static void
+color_expand_rgb_avx2(cRGB *from, cRGBF *to, long length)
+{
+	__m256 scale = _mm256_set1_ps(255.0f);
+	long i = 0;
+	for (; i+2 <= length; i += 2) {
+		__m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *)&from[i]));
+		_mm256_storeu_ps(&to[i].r, _mm256_div_ps(_mm256_cvtepi32_ps(v), scale));
+	}
+	color_expand_rgb_sse2(from+i, to+i, length-i);
+}
+
+COLOR_TARGET("avx2") static void
+color_quantize_rgbf_avx2(cRGBF *from, cRGB *to, long length)
+{
+	__m256 zero  = _mm256_setzero_ps();
+	__m256 one   = _mm256_set1_ps(1.0f);
+	__m256 scale = _mm256_set1_ps(255.0f);
+	__m256 half  = _mm256_set1_ps(0.5f);
+	long i = 0;
+	for (; i+2 <= length; i += 2) {
+		__m256  v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(&from[i].r), zero), one);
+		__m256i q = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half));
+		__m128i p = _mm_packs_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+		_mm_storel_epi64((__m128i *)&to[i], _mm_packus_epi16(p, p));
+	}
+	color_quantize_rgbf_sse2(from+i, to+i, length-i);
+}
+
+COLOR_TARGET("avx2") static long
+color_nearest_avx2(cPalette *palette, float r, float g, float b, float alpha)
+{
+	__m256  vr = _mm256_set1_ps(r), vg = _mm256_set1_ps(g), vb = _mm256_set1_ps(b), va = _mm256_set1_ps(alpha);
+	__m256  best       = _mm256_set1_ps(INFINITY);
+	__m256i best_index = _mm256_setzero_si256();
+	__m256i index      = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i step       = _mm256_set1_epi32(8);
+	for (long i = 0; i < palette->size; i += 8) {
+		__m256 dr   = _mm256_sub_ps(vr, _mm256_loadu_ps(palette->r+i));
+		__m256 dg   = _mm256_sub_ps(vg, _mm256_loadu_ps(palette->g+i));
+		__m256 db   = _mm256_sub_ps(vb, _mm256_loadu_ps(palette->b+i));
+		__m256 da   = _mm256_sub_ps(va, _mm256_loadu_ps(palette->alpha+i));
+		__m256 sum  = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dr, dr), _mm256_mul_ps(dg, dg)), _mm256_mul_ps(db, db)), _mm256_mul_ps(da, da));
+		__m256 less = _mm256_cmp_ps(sum, best, _CMP_LT_OQ);
+		best       = _mm256_blendv_ps(best, sum, less);
+		best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(less));
+		index      = _mm256_add_epi32(index, step);
+	}
+	// smallest sum into all lanes, then the lowest index holding it
+	__m256 least = _mm256_min_ps(best, _mm256_permute2f128_ps(best, best, 1));
+	least = _mm256_min_ps(least, _mm256_shuffle_ps(least, least, 0x4e));
+	least = _mm256_min_ps(least, _mm256_shuffle_ps(least, least, 0xb1));
+	__m256i candidates = _mm256_blendv_epi8(_mm256_set1_epi32(INT_MAX), best_index, _mm256_castps_si256(_mm256_cmp_ps(best, least, _CMP_EQ_OQ)));
+	__m128i lowest = _mm_min_epi32(_mm256_castsi256_si128(candidates), _mm256_extracti128_si256(candidates, 1));
+	lowest = _mm_min_epi32(lowest, _mm_shuffle_epi32(lowest, 0x4e));
+	lowest = _mm_min_epi32(lowest, _mm_shuffle_epi32(lowest, 0xb1));
+	return _mm_cvtsi128_si32(lowest);
+}
+
+COLOR_TARGET("avx2") static void
+color_interpolate_rgb_avx2(cRGB *from, cRGB *to, cRGB *out, long length, float pos)
+{
+	color_interpolate_rgb_body(from, to, out, length, pos);
+}
+
+COLOR_TARGET("avx2") static void
+color_blend_rgb_avx2(cRGB *color, cRGB *with, cRGB *out, long length, float opacity)
+{
+	color_blend_rgb_body(color, with, out, length, opacity);
+}
+
+// eight pixels per shuffle, a control byte with the high bit set reads 0
+COLOR_TARGET("avx2") static void
+color_swizzle_avx2(const unsigned char *from, unsigned char *to, long length, const cSwizzle *swizzle)
+{
+	char control[32], flip[32];
+	for (int i = 0; i < 32; i++) {
+		int k = i & 3;
+		control[i] = (char)(swizzle->order[k] < 0 ? 0x80 : (i & 12)+swizzle->order[k]);
+		flip[i]    = (char)swizzle->flip[k];
+	}
+	__m256i vcontrol = _mm256_loadu_si256((__m256i *)control), vflip = _mm256_loadu_si256((__m256i *)flip);
+	long i = 0;
+	for (; i+8 <= length; i += 8) {
+		__m256i v = _mm256_loadu_si256((__m256i *)(from+i*4));
+		_mm256_storeu_si256((__m256i *)(to+i*4), _mm256_xor_si256(_mm256_shuffle_epi8(v, vcontrol), vflip));
+	}
+	color_swizzle_sse2(from+i*4, to+i*4, length-i, swizzle);
+}
+
+COLOR_RGB16_KERNELS(avx2, COLOR_TARGET("avx2"))
+COLOR_YCBCR_KERNELS(avx2, COLOR_TARGET("avx2"))
+COLOR_ALPHA_KERNELS(avx2, COLOR_TARGET("avx2"))
+COLOR_DIFF_KERNELS(avx2, COLOR_TARGET("avx2"))
+
+/* AVX-512 kernels, four colors per register */
+
+COLOR_TARGET("avx512f") static void
+color_expand_rgb_avx512(cRGB *from, cRGBF *to, long length)
+{
+	__m512 scale = _mm512_set1_ps(255.0f);
+	long i = 0;
+	for (; i+4 <= length; i += 4) {
+		__m512i v = _mm512_cvtepu8_epi32(_mm_loadu_si128((__m128i *)&from[i]));
+		_mm512_storeu_ps(&to[i].r, _mm512_div_ps(_mm512_cvtepi32_ps(v), scale));
+	}
+	color_expand_rgb_sse2(from+i, to+i, length-i);
+}
+
+COLOR_TARGET("avx512f") static void
+color_quantize_rgbf_avx512(cRGBF *from, cRGB *to, long length)
+{
+	__m512 zero  = _mm512_setzero_ps();
+	__m512 one   = _mm512_set1_ps(1.0f);
+	__m512 scale = _mm512_set1_ps(255.0f);
+	__m512 half  = _mm512_set1_ps(0.5f);
+	long i = 0;
+	for (; i+4 <= length; i += 4) {
+		__m512  v = _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(&from[i].r), zero), one);
+		__m512i q = _mm512_cvttps_epi32(_mm512_add_ps(_mm512_mul_ps(v, scale), half));
+		_mm_storeu_si128((__m128i *)&to[i], _mm512_cvtepi32_epi8(q));
+	}
+	color_quantize_rgbf_sse2(from+i, to+i, length-i);
+}
+
+COLOR_TARGET("avx512f") static long
+color_nearest_avx512(cPalette *palette, float r, float g, float b, float alpha)
+{
+	__m512  vr = _mm512_set1_ps(r), vg = _mm512_set1_ps(g), vb = _mm512_set1_ps(b), va = _mm512_set1_ps(alpha);
+	__m512  best       = _mm512_set1_ps(INFINITY);
+	__m512i best_index = _mm512_setzero_si512();
+	__m512i index      = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	__m512i step       = _mm512_set1_epi32(16);
+	for (long i = 0; i < palette->size; i += 16) {
+		__m512 dr = _mm512_sub_ps(vr, _mm512_loadu_ps(palette->r+i));
+		__m512 dg = _mm512_sub_ps(vg, _mm512_loadu_ps(palette->g+i));
+		__m512 db = _mm512_sub_ps(vb, _mm512_loadu_ps(palette->b+i));
+		__m512 da = _mm512_sub_ps(va, _mm512_loadu_ps(palette->alpha+i));
+		__m512 sum = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dr, dr), _mm512_mul_ps(dg, dg)), _mm512_mul_ps(db, db)), _mm512_mul_ps(da, da));
+		__mmask16 less = _mm512_cmp_ps_mask(sum, best, _CMP_LT_OQ);
+		best       = _mm512_mask_blend_ps(less, best, sum);
+		best_index = _mm512_mask_blend_epi32(less, best_index, index);
+		index      = _mm512_add_epi32(index, step);
+	}
+	__mmask16 least = _mm512_cmp_ps_mask(best, _mm512_set1_ps(_mm512_reduce_min_ps(best)), _CMP_EQ_OQ);
+	return _mm512_mask_reduce_min_epi32(least, best_index);
+}
+
+COLOR_TARGET("avx512f") static void
+color_interpolate_rgb_avx512(cRGB *from, cRGB *to, cRGB *out, long length, float pos)
+{
+	color_interpolate_rgb_body(from, to, out, length, pos);
+}
+
+COLOR_TARGET("avx512f") static void
+color_blend_rgb_avx512(cRGB *color, cRGB *with, cRGB *out, long length, float opacity)
+{
+	color_blend_rgb_body(color, with, out, length, opacity);
+}
+
+// byte shuffles need AVX-512BW, swizzles stay with the AVX2 kernel
+COLOR_RGB16_KERNELS(avx512, COLOR_TARGET("avx512f"))
+COLOR_YCBCR_KERNELS(avx512, COLOR_TARGET("avx512f"))
+COLOR_ALPHA_KERNELS(avx512, COLOR_TARGET("avx512f"))
+COLOR_DIFF_KERNELS(avx512, COLOR_TARGET("avx512f"))
+
+#endif
+
+static void
+color_dispatch_fill(cKernels *kernels, int level)
+{
+	kernels->level           = COLOR_SIMD_NONE;
+	kernels->expand_rgb      = color_expand_rgb_generic;
+	kernels->quantize_rgbf   = color_quantize_rgbf_generic;
+	kernels->nearest         = color_nearest_generic;
+	kernels->interpolate_rgb = color_interpolate_rgb_generic;
+	kernels->blend_rgb       = color_blend_rgb_generic;
+	kernels->swizzle         = color_swizzle_generic;
+	kernels->pack_rgb16      = color_pack_rgb16_generic;
+	kernels->unpack_rgb16    = color_unpack_rgb16_generic;
+	kernels->ycbcr_to_rgb    = color_ycbcr_to_rgb_generic;
+	kernels->rgb_to_ycbcr    = color_rgb_to_ycbcr_generic;
+	kernels->alpha_rgb       = color_alpha_rgb_generic;
+	kernels->composite_rgb   = color_composite_rgb_generic;
+	kernels->diff_rgb        = color_diff_rgb_generic;
+#ifdef COLOR_SIMD_DISPATCH
+	if (level >= COLOR_SIMD_SSE2) {
+		kernels->level           = COLOR_SIMD_SSE2;
+		kernels->expand_rgb      = color_expand_rgb_sse2;
+		kernels->quantize_rgbf   = color_quantize_rgbf_sse2;
+		kernels->nearest         = color_nearest_sse2;
+		kernels->swizzle         = color_swizzle_sse2;
+		kernels->pack_rgb16      = color_pack_rgb16_sse2;
+		kernels->unpack_rgb16    = color_unpack_rgb16_sse2;
+		kernels->ycbcr_to_rgb    = color_ycbcr_to_rgb_sse2;
+		kernels->rgb_to_ycbcr    = color_rgb_to_ycbcr_sse2;
+		kernels->alpha_rgb       = color_alpha_rgb_sse2;
+		kernels->composite_rgb   = color_composite_rgb_sse2;
+		kernels->diff_rgb        = color_diff_rgb_sse2;
+	}
+	if (level >= COLOR_SIMD_AVX2) {
+		kernels->level           = COLOR_SIMD_AVX2;
+		kernels->expand_rgb      = color_expand_rgb_avx2;
+		kernels->quantize_rgbf   = color_quantize_rgbf_avx2;
+		kernels->nearest         = color_nearest_avx2;
+		kernels->interpolate_rgb = color_interpolate_rgb_avx2;
+		kernels->blend_rgb       = color_blend_rgb_avx2;
+		kernels->swizzle         = color_swizzle_avx2;
+		kernels->pack_rgb16      = color_pack_rgb16_avx2;
+		kernels->unpack_rgb16    = color_unpack_rgb16_avx2;
+		kernels->ycbcr_to_rgb    = color_ycbcr_to_rgb_avx2;
+		kernels->rgb_to_ycbcr    = color_rgb_to_ycbcr_avx2;
+		kernels->alpha_rgb       = color_alpha_rgb_avx2;
+		kernels->composite_rgb   = color_composite_rgb_avx2;
+		kernels->diff_rgb        = color_diff_rgb_avx2;
+	}
+	if (level >= COLOR_SIMD_AVX512) {
+		kernels->level           = COLOR_SIMD_AVX512;
+		kernels->expand_rgb      = color_expand_rgb_avx512;
+		kernels->quantize_rgbf   = color_quantize_rgbf_avx512;
+		kernels->nearest         = color_nearest_avx512;
+		kernels->interpolate_rgb = color_interpolate_rgb_avx512;
+		kernels->blend_rgb       = color_blend_rgb_avx512;
+		kernels->pack_rgb16      = color_pack_rgb16_avx512;
+		kernels->unpack_rgb16    = color_unpack_rgb16_avx512;
+		kernels->ycbcr_to_rgb    = color_ycbcr_to_rgb_avx512;
+		kernels->rgb_to_ycbcr    = color_rgb_to_ycbcr_avx512;
+		kernels->alpha_rgb       = color_alpha_rgb_avx512;
+		kernels->composite_rgb   = color_composite_rgb_avx512;
+		kernels->diff_rgb        = color_diff_rgb_avx512;
+	}
+#endif
+}
+
+static int
+color_simd_level_named(const char *name)
+{
+	for (int level = 0; level < COLOR_SIMD_COUNT; level++) {
+		if (strcmp(name, color_simd_names[level]) == 0) return level;
+	}
+	return -1;
+}
+
+/*
+ * Detects the instruction sets of this cpu and selects the best kernels.
+ * COLOR_SIMD=none|sse2|avx2|avx512 in the environment caps the level.
+ */
+extern void
+color_dispatch_init(void)
+{
+	const char *forced = getenv("COLOR_SIMD");
+#ifdef COLOR_SIMD_DISPATCH
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))    color_simd_supported = COLOR_SIMD_SSE2;
+	if (__builtin_cpu_supports("avx2"))    color_simd_supported = COLOR_SIMD_AVX2;
+	if (__builtin_cpu_supports("avx512f")) color_simd_supported = COLOR_SIMD_AVX512;
+#endif
+	int level = color_simd_supported;
+	if (forced && *forced && strcmp(forced, "auto") != 0) {
+		int wanted = color_simd_level_named(forced);
+		if (wanted < 0) {
+			rb_warn("COLOR_SIMD=%s is unknown, must be none, sse2, avx2 or avx512", forced);
+		} else if (wanted > color_simd_supported) {
+			rb_warn("COLOR_SIMD=%s is not supported by this cpu, using %s", forced, color_simd_names[level]);
+		} else {
+			level = wanted;
+		}
+	}
+	for (int table = 0; table < COLOR_SIMD_COUNT; table++) {
+		color_dispatch_fill(&color_kernel_levels[table], table);
+	}
+	color_kernels = &color_kernel_levels[level];
+}
+
+/*
+ *  call-seq:
+ *     Color.simd_level -> symbol
+ *
+ *  The instruction set used by the batch kernels of the native extension,
+ *  one of :none, :sse2, :avx2 or :avx512. Chosen when the extension is
+ *  loaded, the environment variable COLOR_SIMD lowers it.
+ */
+extern VALUE
+rb_color__simd_level(VALUE module)
+{
+	return ID2SYM(rb_intern(color_simd_names[color_kernels->level]));
+}
+
+/*
+ *  call-seq:
+ *     Color.simd_level = level
+ *
+ *  Switches the batch kernels to another level of Color.simd_levels, e.g.
+ *  to compare them. Raises ArgumentError for levels this cpu lacks.
+ *  The level is shared by all threads and ractors of the process.
+ */
+extern VALUE
+rb_color__set_simd_level(VALUE module, VALUE level)
+{
+	Check_Type(level, T_SYMBOL);
+	int wanted = color_simd_level_named(rb_id2name(SYM2ID(level)));
+	if (wanted < 0 || wanted > color_simd_supported) {
+		VALUE inspect = rb_inspect(level);
+		rb_raise(rb_eArgError, "Unsupported simd level %s", RSTRING_PTR(inspect));
+	}
+	color_kernels = &color_kernel_levels[wanted];
+	return level;
+}
+
+/*
+ *  call-seq:
+ *     Color.simd_levels -> array
+ *
+ *  All levels this cpu and build support, lowest first.
+ */
+extern VALUE
+rb_color__simd_levels(VALUE module)
+{
+	VALUE levels = rb_ary_new();
+	for (int level = 0; level <= color_simd_supported; level++) {
+		rb_ary_push(levels, ID2SYM(rb_intern(color_simd_names[level])));
+	}
+	return levels;
+}
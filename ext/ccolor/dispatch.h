@@ -0,0 +1,57 @@
+// instruction set levels, each includes the ones before
+enum {
+	COLOR_SIMD_NONE,
+	COLOR_SIMD_SSE2,
+	COLOR_SIMD_AVX2,
+	COLOR_SIMD_AVX512,
+	COLOR_SIMD_COUNT
+};
+
+// a reordering of 4 byte pixels, to[i] = from[order[i]] ^ flip[i], an order
+// of -1 reads 0
+typedef struct _cSwizzle {
+	signed char   order[4];
+	unsigned char flip[4];
+} cSwizzle;
+
+// fixed point Y'CbCr coefficients, scaled by 1 << 14, see planar.c
+typedef struct _cYCbCrMatrix {
+	int y[3];           // weights of R, G and B in Y'
+	int cb[3];          // in Cb
+	int cr[3];          // in Cr
+	int y_offset;       // black level, 16 for limited range
+	int luma;           // Y' back to full range
+	int cr_r, cb_g, cr_g, cb_b;
+} cYCbCrMatrix;
+
+// metrics of Buffer#diff
+enum {
+	COLOR_DIFF_EUCLIDEAN,
+	COLOR_DIFF_MAX,
+	COLOR_DIFF_LUMA
+};
+
+// the hot kernels of the selected level, see dispatch.c
+typedef struct _cKernels {
+	int level;
+	void (*expand_rgb)(cRGB *from, cRGBF *to, long length);
+	void (*quantize_rgbf)(cRGBF *from, cRGB *to, long length);
+	long (*nearest)(cPalette *palette, float r, float g, float b, float alpha);
+	void (*interpolate_rgb)(cRGB *from, cRGB *to, cRGB *out, long length, float pos);
+	void (*blend_rgb)(cRGB *color, cRGB *with, cRGB *out, long length, float opacity);
+	void (*swizzle)(const unsigned char *from, unsigned char *to, long length, const cSwizzle *swizzle);
+	void (*pack_rgb16)(const cRGB *from, unsigned short *to, long length, int green_bits, int swap);
+	void (*unpack_rgb16)(const unsigned short *from, cRGB *to, long length, int green_bits, int swap);
+	void (*ycbcr_to_rgb)(const unsigned char *y, const unsigned char *cb, const unsigned char *cr, cRGB *to, long length, const cYCbCrMatrix *matrix);
+	void (*rgb_to_ycbcr)(const cRGB *from, unsigned char *y, unsigned short *cb, unsigned short *cr, long length, const cYCbCrMatrix *matrix);
+	void (*alpha_rgb)(const cRGB *from, cRGB *to, long length, int from_alpha, int to_alpha);
+	void (*composite_rgb)(const cRGB *color, const cRGB *with, cRGB *out, long length, int alpha);
+	void (*diff_rgb)(const cRGB *color, const cRGB *with, int *out, long length, int metric);
+} cKernels;
+
+extern const cKernels *volatile color_kernels;
+
+extern void color_dispatch_init(void);
+extern VALUE rb_color__simd_level(VALUE module);
+extern VALUE rb_color__set_simd_level(VALUE module, VALUE level);
+extern VALUE rb_color__simd_levels(VALUE module);
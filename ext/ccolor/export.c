@@ -0,0 +1,488 @@
+#include <ruby.h>
+#include <string.h>
+#include "color.h"
+#include "buffer.h"
+#include "convert.h"
+#include "css.h"
+#include "export.h"
+
+#define COLOR_EXPORT_CHUNK  32768 // bytes collected before they go to the target
+#define COLOR_EXPORT_RECORD 256   // room for one color, names are written apart
+
+// where the output goes, in chunks
+typedef struct _cExport {
+	VALUE to;                       // a String, or anything responding to write
+	int   string;
+	long  used;
+	char  chunk[COLOR_EXPORT_CHUNK];
+} cExport;
+
+// the colors, an array of any models or a buffer
+typedef struct _cExportSource {
+	VALUE      colors;
+	cBuffer   *buffer;
+	cConverter rgb;                 // buffer model to RGB
+	cConverter hsl;                 // buffer model to HSL
+	long       length;
+	VALUE      names;               // nil or an array of as many names
+} cExportSource;
+
+enum {
+	COLOR_COLUMN_NAME,
+	COLOR_COLUMN_RED,
+	COLOR_COLUMN_GREEN,
+	COLOR_COLUMN_BLUE,
+	COLOR_COLUMN_ALPHA,
+	COLOR_COLUMN_CSS,
+	COLOR_COLUMN_COUNT
+};
+
+static const char *color_column_names[COLOR_COLUMN_COUNT] = {
+	"name", "red", "green", "blue", "alpha", "css"
+};
+
+// the decimal digits of every byte, the first char is their count
+static char color_export_decimal[256][4];
+
+extern void
+color_export_init(void)
+{
+	for (int i = 0; i < 256; i++) {
+		char *digits = color_export_decimal[i];
+		digits[0] = i < 10 ? 1 : (i < 100 ? 2 : 3);
+		for (int d = digits[0], value = i; d > 0; d--, value /= 10) {
+			digits[d] = (char)('0'+value%10);
+		}
+	}
+}
+
+/* output */
+
+static void
+color_export_flush(cExport *out)
+{
+	if (!out->used) return;
+	if (out->string) {
+		rb_str_cat(out->to, out->chunk, out->used);
+	} else {
+		rb_funcall(out->to, rb_intern("write"), 1, rb_str_new(out->chunk, out->used));
+	}
+	out->used = 0;
+}
+
+// the position to write at least size bytes to, flushing if necessary
+static inline char *
+color_export_room(cExport *out, long size)
+{
+	if (out->used+size > COLOR_EXPORT_CHUNK) color_export_flush(out);
+	return out->chunk+out->used;
+}
+
+static void
+color_export_bytes(cExport *out, const char *bytes, long length)
+{
+	while (length > 0) {
+		long part = length < COLOR_EXPORT_CHUNK ? length : COLOR_EXPORT_CHUNK;
+		memcpy(color_export_room(out, part), bytes, part);
+		out->used += part;
+		bytes     += part;
+		length    -= part;
+	}
+}
+
+static inline void
+color_export_text(cExport *out, const char *text)
+{
+	color_export_bytes(out, text, (long)strlen(text));
+}
+
+static inline char *
+color_export_byte(char *to, unsigned char value)
+{
+	const char *digits = color_export_decimal[value];
+	memcpy(to, digits+1, 3);
+	return to+digits[0];
+}
+
+static char *
+color_export_index(char *to, long index)
+{
+	char digits[24];
+	int  count = 0;
+	do {
+		digits[count++] = (char)('0'+index%10);
+		index /= 10;
+	} while (index);
+	while (count) *to++ = digits[--count];
+	return to;
+}
+
+// a name as JSON string, quoted and escaped
+static void
+color_export_json_string(cExport *out, VALUE name)
+{
+	const char *at;
+	long length;
+	name   = rb_obj_as_string(name);
+	at     = RSTRING_PTR(name);
+	length = RSTRING_LEN(name);
+	color_export_bytes(out, "\"", 1);
+	for (long i = 0, start = 0; i <= length; i++) {
+		unsigned char c = i < length ? at[i] : 0;
+		if (i < length && c >= 0x20 && c != '"' && c != '\\') continue;
+		color_export_bytes(out, at+start, i-start);
+		start = i+1;
+		if (i == length) break;
+		char *to = color_export_room(out, 6);
+		to[0] = '\\';
+		switch(c) {
+			case '"':  to[1] = '"';  out->used += 2; break;
+			case '\\': to[1] = '\\'; out->used += 2; break;
+			case '\n': to[1] = 'n';  out->used += 2; break;
+			case '\r': to[1] = 'r';  out->used += 2; break;
+			case '\t': to[1] = 't';  out->used += 2; break;
+			default:
+				memcpy(to+1, "u00", 3);
+				to[4] = color_css_hex[c*2];
+				to[5] = color_css_hex[c*2+1];
+				out->used += 6;
+		}
+	}
+	color_export_bytes(out, "\"", 1);
+}
+
+// a name as CSV field, quoted if it has to be
+static void
+color_export_csv_field(cExport *out, VALUE name)
+{
+	name = rb_obj_as_string(name);
+	const char *at = RSTRING_PTR(name);
+	long length    = RSTRING_LEN(name);
+	if (!memchr(at, ',', length) && !memchr(at, '"', length) && !memchr(at, '\n', length) && !memchr(at, '\r', length)) {
+		color_export_bytes(out, at, length);
+		return;
+	}
+	color_export_bytes(out, "\"", 1);
+	for (long i = 0, start = 0; i <= length; i++) {
+		if (i < length && at[i] != '"') continue;
+		color_export_bytes(out, at+start, i-start+(i < length ? 1 : 0));
+		if (i < length) color_export_bytes(out, "\"", 1);
+		start = i+1;
+	}
+	color_export_bytes(out, "\"", 1);
+}
+
+// a name as part of a CSS identifier, other characters escaped
+static void
+color_export_css_ident(cExport *out, VALUE name)
+{
+	name = rb_obj_as_string(name);
+	const char *at = RSTRING_PTR(name);
+	long length    = RSTRING_LEN(name);
+	for (long i = 0, start = 0; i <= length; i++) {
+		unsigned char c = i < length ? at[i] : 0;
+		if (i < length && (c >= 0x80 || c == '-' || c == '_' || (c >= '0' && c <= '9') || ((c|0x20) >= 'a' && (c|0x20) <= 'z'))) continue;
+		color_export_bytes(out, at+start, i-start);
+		start = i+1;
+		if (i == length) break;
+		char *to = color_export_room(out, 6);
+		to[0] = '\\';
+		if (c == 0) {
+			// not allowed, even escaped
+			memcpy(to+1, "fffd ", 5);
+			out->used += 6;
+		} else if (c < 0x20 || c == 0x7f) {
+			// as hex code point, the space ends it
+			to[1] = color_css_hex[c*2];
+			to[2] = color_css_hex[c*2+1];
+			to[3] = ' ';
+			out->used += 4;
+		} else {
+			to[1] = c;
+			out->used += 2;
+		}
+	}
+}
+
+/* input */
+
+static void
+color_export_source(cExportSource *source, VALUE colors, VALUE options)
+{
+	source->colors = colors;
+	source->buffer = NULL;
+	source->names  = NIL_P(options) ? Qnil : rb_hash_aref(options, ID2SYM(rb_intern("names")));
+	if (CLASS_OF(colors) == rb_cBuffer) {
+		source->buffer = color_buffer_get(colors, -1);
+		source->length = source->buffer->length;
+		color_converter_resolve(&source->rgb, source->buffer->model, COLOR_MODEL_RGB);
+		color_converter_resolve(&source->hsl, source->buffer->model, COLOR_MODEL_HSL);
+	} else {
+		Check_Type(colors, T_ARRAY);
+		source->length = RARRAY_LEN(colors);
+	}
+	if (!NIL_P(source->names)) {
+		Check_Type(source->names, T_ARRAY);
+		if (RARRAY_LEN(source->names) != source->length) {
+			rb_raise(rb_eArgError, "Expected %ld names, got %ld", source->length, RARRAY_LEN(source->names));
+		}
+	}
+}
+
+// the color at index as RGB, and as HSL if hsl is given
+static cRGB *
+color_export_color(cExportSource *source, long index, cAny *tmp, cHSL **hsl)
+{
+	if (source->buffer) {
+		char *color = source->buffer->data+index*color_model_size(source->buffer->model);
+		if (hsl) {
+			color_converter_run(&source->hsl, color, &tmp[1]);
+			*hsl = &tmp[1].hsl;
+		}
+		color_converter_run(&source->rgb, color, &tmp[0]);
+		return &tmp[0].rgb;
+	}
+	if (index >= RARRAY_LEN(source->colors)) {
+		rb_raise(rb_eRuntimeError, "Colors changed during export");
+	}
+	VALUE color = RARRAY_PTR(source->colors)[index];
+	if (hsl) *hsl = color_coerce(color, COLOR_MODEL_HSL, &tmp[1], COLOR_COERCE_FORMAT);
+	return color_coerce(color, COLOR_MODEL_RGB, &tmp[0], COLOR_COERCE_FORMAT);
+}
+
+static VALUE
+color_export_option(VALUE options, const char *name)
+{
+	return NIL_P(options) ? Qnil : rb_hash_aref(options, ID2SYM(rb_intern(name)));
+}
+
+static void
+color_export_start(cExport *out, VALUE options)
+{
+	VALUE to    = color_export_option(options, "to");
+	out->to     = NIL_P(to) ? rb_str_new(NULL, 0) : to;
+	out->string = TYPE(out->to) == T_STRING;
+	out->used   = 0;
+	if (out->string) rb_str_modify(out->to);
+}
+
+/*
+ *  call-seq:
+ *     Color::Export.css(colors[, options]) -> string or io
+ *
+ *  Writes colors (an array of any models or a buffer) as CSS custom
+ *  properties, "--color-0: #ff0099;" and so on, inside ":root { }".
+ *  Options:
+ *  :to::       a String to append to, or an IO (anything with write), a new
+ *              String by default
+ *  :form::     the form of the values, see Color::CSS.format, :hex by default
+ *  :names::    an array of names for the properties, instead of the index,
+ *              characters not allowed in identifiers are escaped
+ *  :prefix::   put before the names, "--color-" by default
+ *  :selector:: the rule the properties go in, ":root" by default, false
+ *              writes the properties alone
+ */
+extern VALUE
+rb_color_export__css(int argc, VALUE *argv, VALUE module)
+{
+	cExport out;
+	cExportSource source;
+	cAny  tmp[2];
+	cHSL *hsl = NULL;
+	VALUE colors, options, selector, prefix;
+	rb_scan_args(argc, argv, "11", &colors, &options);
+	if (!NIL_P(options)) Check_Type(options, T_HASH);
+	color_export_source(&source, colors, options);
+	int form = color_css_form_get(color_export_option(options, "form"));
+	selector = NIL_P(options) || !RTEST(rb_funcall(options, rb_intern("key?"), 1, ID2SYM(rb_intern("selector")))) ?
+		rb_str_new2(":root") : rb_hash_aref(options, ID2SYM(rb_intern("selector")));
+	prefix   = color_export_option(options, "prefix");
+	prefix   = NIL_P(prefix) ? rb_str_new2("--color-") : rb_obj_as_string(prefix);
+	color_export_start(&out, options);
+
+	if (RTEST(selector)) {
+		selector = rb_obj_as_string(selector);
+		color_export_bytes(&out, RSTRING_PTR(selector), RSTRING_LEN(selector));
+		color_export_text(&out, " {\n");
+	}
+	for (long i = 0; i < source.length; i++) {
+		cRGB *rgb = color_export_color(&source, i, tmp, color_css_form_hsl(form) ? &hsl : NULL);
+		if (RTEST(selector)) color_export_bytes(&out, "  ", 2);
+		color_export_bytes(&out, RSTRING_PTR(prefix), RSTRING_LEN(prefix));
+		if (NIL_P(source.names)) {
+			char *to = color_export_room(&out, 24);
+			out.used = color_export_index(to, i)-out.chunk;
+		} else {
+			color_export_css_ident(&out, RARRAY_PTR(source.names)[i]);
+		}
+		char *to = color_export_room(&out, COLOR_EXPORT_RECORD);
+		*to++ = ':';
+		*to++ = ' ';
+		to = color_css_format(to, form, rgb, hsl);
+		*to++ = ';';
+		*to++ = '\n';
+		out.used = to-out.chunk;
+	}
+	if (RTEST(selector)) color_export_text(&out, "}\n");
+	color_export_flush(&out);
+	return out.to;
+}
+
+/*
+ *  call-seq:
+ *     Color::Export.json(colors[, options]) -> string or io
+ *
+ *  Writes colors (an array of any models or a buffer) as JSON, an array
+ *  of CSS strings, ["#ff0099","#000000"], or with :as => :objects of
+ *  objects, [{"red":255,"green":0,"blue":153,"alpha":0},...]. With :names
+ *  it is an object with the names as keys instead of an array.
+ *  Options:
+ *  :to::    a String to append to, or an IO (anything with write), a new
+ *           String by default
+ *  :as::    :strings (default) or :objects
+ *  :form::  the form of the strings, see Color::CSS.format, :hex by default
+ *  :names:: an array of names (as many as colors)
+ */
+extern VALUE
+rb_color_export__json(int argc, VALUE *argv, VALUE module)
+{
+	cExport out;
+	cExportSource source;
+	cAny  tmp[2];
+	cHSL *hsl = NULL;
+	VALUE colors, options, as;
+	rb_scan_args(argc, argv, "11", &colors, &options);
+	if (!NIL_P(options)) Check_Type(options, T_HASH);
+	color_export_source(&source, colors, options);
+	int form    = color_css_form_get(color_export_option(options, "form"));
+	as          = color_export_option(options, "as");
+	int objects = as == ID2SYM(rb_intern("objects"));
+	if (!objects && !NIL_P(as) && as != ID2SYM(rb_intern("strings"))) {
+		rb_raise(rb_eArgError, "Unknown :as, must be :strings or :objects");
+	}
+	color_export_start(&out, options);
+
+	color_export_bytes(&out, NIL_P(source.names) ? "[" : "{", 1);
+	for (long i = 0; i < source.length; i++) {
+		cRGB *rgb = color_export_color(&source, i, tmp, !objects && color_css_form_hsl(form) ? &hsl : NULL);
+		if (i) color_export_bytes(&out, ",", 1);
+		if (!NIL_P(source.names)) {
+			color_export_json_string(&out, RARRAY_PTR(source.names)[i]);
+			color_export_bytes(&out, ":", 1);
+		}
+		char *to = color_export_room(&out, COLOR_EXPORT_RECORD);
+		if (objects) {
+			memcpy(to, "{\"red\":", 7);
+			to = color_export_byte(to+7, rgb->r);
+			memcpy(to, ",\"green\":", 9);
+			to = color_export_byte(to+9, rgb->g);
+			memcpy(to, ",\"blue\":", 8);
+			to = color_export_byte(to+8, rgb->b);
+			memcpy(to, ",\"alpha\":", 9);
+			to = color_export_byte(to+9, rgb->alpha);
+			*to++ = '}';
+		} else {
+			*to++ = '"';
+			to = color_css_format(to, form, rgb, hsl);
+			*to++ = '"';
+		}
+		out.used = to-out.chunk;
+	}
+	color_export_bytes(&out, NIL_P(source.names) ? "]" : "}", 1);
+	color_export_flush(&out);
+	return out.to;
+}
+
+/*
+ *  call-seq:
+ *     Color::Export.csv(colors[, options]) -> string or io
+ *
+ *  Writes colors (an array of any models or a buffer) as CSV, a header
+ *  and a row per color, "red,green,blue,alpha" by default.
+ *  Options:
+ *  :to::      a String to append to, or an IO (anything with write), a new
+ *             String by default
+ *  :columns:: an array of :name, :red, :green, :blue, :alpha (0..255) and
+ *             :css, defaults to [:name, ]:red, :green, :blue, :alpha
+ *  :form::    the form of :css, see Color::CSS.format, :hex by default
+ *  :names::   an array of names (as many as colors), for :name
+ *  :header::  false leaves the header out
+ */
+extern VALUE
+rb_color_export__csv(int argc, VALUE *argv, VALUE module)
+{
+	cExport out;
+	cExportSource source;
+	cAny  tmp[2];
+	cHSL *hsl = NULL;
+	int   columns[COLOR_COLUMN_COUNT*2], count = 0, css = 0;
+	VALUE colors, options, r_columns, header;
+	rb_scan_args(argc, argv, "11", &colors, &options);
+	if (!NIL_P(options)) Check_Type(options, T_HASH);
+	color_export_source(&source, colors, options);
+	int form  = color_css_form_get(color_export_option(options, "form"));
+	r_columns = color_export_option(options, "columns");
+	header    = color_export_option(options, "header");
+	if (NIL_P(r_columns)) {
+		if (!NIL_P(source.names)) columns[count++] = COLOR_COLUMN_NAME;
+		for (int column = COLOR_COLUMN_RED; column <= COLOR_COLUMN_ALPHA; column++) columns[count++] = column;
+	} else {
+		Check_Type(r_columns, T_ARRAY);
+		if (RARRAY_LEN(r_columns) < 1 || RARRAY_LEN(r_columns) > COLOR_COLUMN_COUNT*2) {
+			rb_raise(rb_eArgError, "Expected 1 to %d columns", COLOR_COLUMN_COUNT*2);
+		}
+		for (long i = 0; i < RARRAY_LEN(r_columns); i++) {
+			VALUE spec = RARRAY_PTR(r_columns)[i];
+			int column;
+			for (column = 0; column < COLOR_COLUMN_COUNT; column++) {
+				if (spec == ID2SYM(rb_intern(color_column_names[column]))) break;
+			}
+			if (column == COLOR_COLUMN_COUNT) {
+				rb_raise(rb_eArgError, "Unknown column, must be :name, :red, :green, :blue, :alpha or :css");
+			}
+			if (column == COLOR_COLUMN_NAME && NIL_P(source.names)) {
+				rb_raise(rb_eArgError, "Column :name requires :names");
+			}
+			columns[count++] = column;
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		if (columns[i] == COLOR_COLUMN_CSS) css = 1;
+	}
+	color_export_start(&out, options);
+
+	if (NIL_P(header) || RTEST(header)) {
+		for (int i = 0; i < count; i++) {
+			if (i) color_export_bytes(&out, ",", 1);
+			color_export_text(&out, color_column_names[columns[i]]);
+		}
+		color_export_bytes(&out, "\n", 1);
+	}
+	for (long i = 0; i < source.length; i++) {
+		cRGB *rgb = color_export_color(&source, i, tmp, css && color_css_form_hsl(form) ? &hsl : NULL);
+		for (int c = 0; c < count; c++) {
+			if (columns[c] == COLOR_COLUMN_NAME) {
+				if (c) color_export_bytes(&out, ",", 1);
+				color_export_csv_field(&out, RARRAY_PTR(source.names)[i]);
+				continue;
+			}
+			char *to = color_export_room(&out, COLOR_EXPORT_RECORD);
+			if (c) *to++ = ',';
+			switch(columns[c]) {
+				case COLOR_COLUMN_RED:   to = color_export_byte(to, rgb->r);     break;
+				case COLOR_COLUMN_GREEN: to = color_export_byte(to, rgb->g);     break;
+				case COLOR_COLUMN_BLUE:  to = color_export_byte(to, rgb->b);     break;
+				case COLOR_COLUMN_ALPHA: to = color_export_byte(to, rgb->alpha); break;
+				default:
+					// the css forms with commas are quoted
+					if (form == COLOR_CSS_RGBA || form == COLOR_CSS_HSLA) *to++ = '"';
+					to = color_css_format(to, form, rgb, hsl);
+					if (form == COLOR_CSS_RGBA || form == COLOR_CSS_HSLA) *to++ = '"';
+			}
+			out.used = to-out.chunk;
+		}
+		color_export_bytes(&out, "\n", 1);
+	}
+	color_export_flush(&out);
+	return out.to;
+}
@@ -0,0 +1,4 @@
+extern void color_export_init(void);
+extern VALUE rb_color_export__css(int argc, VALUE *argv, VALUE module);
+extern VALUE rb_color_export__json(int argc, VALUE *argv, VALUE module);
+extern VALUE rb_color_export__csv(int argc, VALUE *argv, VALUE module);
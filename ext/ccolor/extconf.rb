@@ -1,5 +1,23 @@
 $preload=nil
 require 'mkmf'
-with_cflags("-W -Wall -std=c99") {
+# optional, used to spread buffer kernels over several cores
+have_library('pthread', 'pthread_create') and have_header('pthread.h')
+# ruby 3+, marks the extension ractor safe and its colors shareable
+have_func('rb_ext_ractor_safe', 'ruby.h')
+# ruby 2.2+, the names of Color::Named are UTF-8
+have_func('rb_utf8_str_new_cstr', 'ruby.h')
+# gem install color -- --enable-stats, see Color.stats
+$defs.push('-DCOLOR_STATS') if enable_config('stats', false)
+# AVX2/AVX-512 kernels next to the baseline ones, picked at load time,
+# see Color.simd_level
+checking_for('x86 target attributes and cpuid builtins') {
+	try_link(<<-SRC)
+#include <immintrin.h>
+__attribute__((target("avx512f"))) static int wide(void) { return _mm512_reduce_add_epi32(_mm512_set1_epi32(1)); }
+int main(void) { __builtin_cpu_init(); return __builtin_cpu_supports("avx512f") ? wide() : 0; }
+	SRC
+} and $defs.push('-DCOLOR_SIMD_DISPATCH')
+# keep ruby's optimization flags, only add ours
+with_cflags("#{$CFLAGS} -W -Wall -std=c99") {
 	create_makefile("ccolor")
 }
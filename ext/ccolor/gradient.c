@@ -0,0 +1,514 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "buffer.h"
+#include "convert.h"
+#include "threads.h"
+#include "colormaps.h"
+#include "gradient.h"
+
+#define COLOR_GRADIENT_LUT_MAX 4096
+
+typedef struct _cGradient {
+	long   size;      // number of stops
+	float *positions; // ascending, within 0..1
+	cRGB  *colors;
+	int    lut_size;  // entries of the last baked lut, 0 if none
+	cRGB  *lut;
+} cGradient;
+
+typedef struct _cGradientApply {
+	const char *values;
+	int         doubles;  // values are doubles, else floats
+	cRGB       *to;
+	const cRGB *lut;
+	int         last;     // index of the last lut entry
+	double      low;      // value (or its log) mapped to lut[0]
+	double      scale;    // lut entries per value
+	int         log;
+	int         clamp;
+	cRGB        nan;      // for NaN, and out of range values unless clamped
+} cGradientApply;
+
+static void
+color_gradient_clear(cGradient *gradient)
+{
+	if (gradient->positions) xfree(gradient->positions);
+	if (gradient->colors)    xfree(gradient->colors);
+	if (gradient->lut)       xfree(gradient->lut);
+	memset(gradient, 0, sizeof(cGradient));
+}
+
+static void
+color_gradient_free(cGradient *gradient)
+{
+	color_gradient_clear(gradient);
+	xfree(gradient);
+}
+
+/*
+ * The color at +position+ (0..1, beyond the ends the end colors), linear
+ * between the neighbouring stops, see color_rgb_interpolate. Where stops
+ * share a position the later one applies from there on.
+ */
+static void
+color_gradient_sample(cGradient *gradient, double position, cRGB *to)
+{
+	float *positions = gradient->positions;
+	long   low = 0, high = gradient->size-1;
+	// also takes NaN
+	if (!(position > positions[0])) {
+		*to = gradient->colors[0];
+		return;
+	}
+	if (position >= positions[high]) {
+		*to = gradient->colors[high];
+		return;
+	}
+	// positions[low] <= position < positions[high]
+	while (high-low > 1) {
+		long middle = (low+high)/2;
+		if (positions[middle] <= position) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+	color_rgb_interpolate(&gradient->colors[low], &gradient->colors[high], to, (float)((position-positions[low])/(positions[high]-positions[low])));
+}
+
+// replaces the stops of +gradient+ by +size+ uninitialized ones
+static void
+color_gradient_resize(cGradient *gradient, long size)
+{
+	color_gradient_clear(gradient);
+	gradient->positions = ALLOC_N(float, size);
+	gradient->colors    = ALLOC_N(cRGB, size);
+	gradient->size      = size;
+}
+
+static void
+color_gradient_bake(cGradient *gradient, cRGB *lut, int size)
+{
+	for (int i = 0; i < size; i++) {
+		color_gradient_sample(gradient, (double)i/(size-1), &lut[i]);
+	}
+}
+
+static int
+color_gradient_size_get(VALUE size)
+{
+	int entries = NIL_P(size) ? 256 : NUM2INT(size);
+	if (entries < 2 || entries > COLOR_GRADIENT_LUT_MAX) {
+		rb_raise(rb_eArgError, "Invalid size, must be between 2 and %d", COLOR_GRADIENT_LUT_MAX);
+	}
+	return entries;
+}
+
+// the lut of +size+ entries, baked once and kept until another size is used
+static const cRGB *
+color_gradient_lut(cGradient *gradient, int size)
+{
+	if (gradient->lut_size != size) {
+		if (gradient->lut) xfree(gradient->lut);
+		gradient->lut      = ALLOC_N(cRGB, size);
+		gradient->lut_size = size;
+		color_gradient_bake(gradient, gradient->lut, size);
+	}
+	return gradient->lut;
+}
+
+static void
+color_gradient_apply_slice(void *ptr, long from, long to)
+{
+	cGradientApply *apply = ptr;
+	const float    *floats  = (const float *)apply->values;
+	const double   *doubles = (const double *)apply->values;
+	for (long i = from; i < to; i++) {
+		double value = apply->doubles ? doubles[i] : floats[i];
+		// the log of values up to 0 is below any range, NaN stays NaN
+		if (apply->log) value = value > 0 ? log(value) : (value == value ? -HUGE_VAL : value);
+		double t = (value-apply->low)*apply->scale;
+		if (t >= 0 && t <= apply->last) {
+			apply->to[i] = apply->lut[(int)(t+0.5)];
+		} else if (apply->clamp && t < 0) {
+			apply->to[i] = apply->lut[0];
+		} else if (apply->clamp && t > apply->last) {
+			apply->to[i] = apply->lut[apply->last];
+		} else {
+			apply->to[i] = apply->nan;
+		}
+	}
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_gradient__allocate(VALUE class)
+{
+	cGradient *gradient;
+	VALUE rb_gradient = COLOR_MAKE_STRUCT(class, cGradient, NULL, color_gradient_free, gradient);
+	memset(gradient, 0, sizeof(cGradient));
+	return rb_gradient;
+}
+
+/*
+ *  call-seq:
+ *     Color::Gradient.new(colors)
+ *
+ *  Create a gradient through +colors+ (any model, or a buffer), evenly
+ *  spaced from 0 to 1. A stop can also be given as [position, color], the
+ *  positions must ascend within 0..1, before the first and after the last
+ *  stop the gradient keeps their colors.
+ *
+ *  Example:
+ *    Color::Gradient.new([Color.rgb(0, 0, 128), [0.8, Color.rgb(255, 255, 0)], Color.rgb(255, 0, 0)])
+ */
+extern VALUE
+rb_color_gradient_initialize(VALUE self, VALUE stops)
+{
+	cGradient *gradient;
+	COLOR_GET_STRUCT(self, cGradient, gradient);
+	if (CLASS_OF(stops) == rb_cBuffer) stops = rb_funcall(stops, rb_intern("to_a"), 0);
+	Check_Type(stops, T_ARRAY);
+	long size = RARRAY_LEN(stops);
+	if (size < 1) {
+		rb_raise(rb_eArgError, "A gradient needs at least one color");
+	}
+	// owned by the gradient right away, so nothing leaks when a stop raises
+	color_gradient_resize(gradient, size);
+	gradient->size = 0;
+	for (long i = 0; i < size; i++) {
+		VALUE  stop     = RARRAY_PTR(stops)[i];
+		double position = size > 1 ? (double)i/(size-1) : 0;
+		if (TYPE(stop) == T_ARRAY) {
+			if (RARRAY_LEN(stop) != 2) {
+				rb_raise(rb_eArgError, "Invalid stop, must be a color or [position, color]");
+			}
+			position = NUM2DBL(RARRAY_PTR(stop)[0]);
+			stop     = RARRAY_PTR(stop)[1];
+		}
+		if (!(position >= 0 && position <= 1) || (i > 0 && position < gradient->positions[i-1])) {
+			rb_raise(rb_eArgError, "Invalid position %f, positions must ascend within 0..1", position);
+		}
+		gradient->positions[i] = (float)position;
+		color_buffer_store(COLOR_MODEL_RGB, &gradient->colors[i], stop);
+	}
+	gradient->size = size;
+	return self;
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_gradient_initialize_copy(VALUE self, VALUE original)
+{
+	cGradient *gradient, *source;
+	COLOR_GET_STRUCT(self, cGradient, gradient);
+	COLOR_GET_STRUCT(original, cGradient, source);
+	if (gradient == source) return self;
+	color_gradient_resize(gradient, source->size);
+	memcpy(gradient->positions, source->positions, source->size*sizeof(float));
+	memcpy(gradient->colors, source->colors, source->size*sizeof(cRGB));
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     Color::Gradient[name] -> gradient
+ *
+ *  A new gradient of one of the built in perceptually uniform colormaps
+ *  (see Color::Gradient.colormaps), 256 evenly spaced stops from constant
+ *  tables. A name ending in _r gives the reversed colormap.
+ *
+ *  Example:
+ *    Color::Gradient[:viridis].apply(samples.pack("f*"), :range => 0..peak)
+ *    Color::Gradient["magma_r"].discrete(8)
+ */
+extern VALUE
+rb_color_gradient_s_colormap(VALUE class, VALUE name)
+{
+	cGradient *gradient;
+	const cColormap *colormap;
+	const char *wanted = SYMBOL_P(name) ? rb_id2name(SYM2ID(name)) : StringValueCStr(name);
+	size_t length   = strlen(wanted);
+	int    reversed = length > 2 && !strcmp(wanted+length-2, "_r");
+	if (reversed) length -= 2;
+	for (colormap = color_colormaps; colormap->name; colormap++) {
+		if (strlen(colormap->name) == length && !strncmp(colormap->name, wanted, length)) break;
+	}
+	if (!colormap->name) {
+		rb_raise(rb_eArgError, "Unknown colormap %s", wanted);
+	}
+	VALUE rb_gradient = rb_color_gradient__allocate(class);
+	COLOR_GET_STRUCT(rb_gradient, cGradient, gradient);
+	color_gradient_resize(gradient, COLOR_COLORMAP_SIZE);
+	for (int i = 0; i < COLOR_COLORMAP_SIZE; i++) {
+		unsigned int value = colormap->values[reversed ? COLOR_COLORMAP_SIZE-1-i : i];
+		gradient->positions[i]    = (float)i/(COLOR_COLORMAP_SIZE-1);
+		gradient->colors[i].r     = (unsigned char)(value >> 16);
+		gradient->colors[i].g     = (unsigned char)(value >> 8);
+		gradient->colors[i].b     = (unsigned char)value;
+		gradient->colors[i].alpha = 0;
+	}
+	return rb_gradient;
+}
+
+/*
+ *  call-seq:
+ *     Color::Gradient.colormaps -> array
+ *
+ *  The names of the built in colormaps: viridis, magma, inferno, plasma,
+ *  cividis and turbo.
+ */
+extern VALUE
+rb_color_gradient_s_colormaps(VALUE class)
+{
+	VALUE names = rb_ary_new();
+	for (const cColormap *colormap = color_colormaps; colormap->name; colormap++) {
+		rb_ary_push(names, ID2SYM(rb_intern(colormap->name)));
+	}
+	return names;
+}
+
+/*
+ *  call-seq:
+ *     gradient.size -> integer
+ *
+ *  The number of stops.
+ */
+extern VALUE
+rb_color_gradient_size(VALUE self)
+{
+	cGradient *gradient;
+	COLOR_GET_STRUCT(self, cGradient, gradient);
+	return LONG2NUM(gradient->size);
+}
+
+/*
+ *  call-seq:
+ *     gradient.stops -> array
+ *
+ *  The stops as [position, rgb] pairs.
+ */
+extern VALUE
+rb_color_gradient_stops(VALUE self)
+{
+	cGradient *gradient;
+	COLOR_GET_STRUCT(self, cGradient, gradient);
+	VALUE stops = rb_ary_new2(gradient->size);
+	for (long i = 0; i < gradient->size; i++) {
+		cRGB *color;
+		VALUE rb_color = color_model_new(COLOR_MODEL_RGB, (void **)&color);
+		*color = gradient->colors[i];
+		rb_ary_push(stops, rb_ary_new3(2, rb_float_new(gradient->positions[i]), rb_color));
+	}
+	return stops;
+}
+
+/*
+ *  call-seq:
+ *     gradient.at(position) -> rgb
+ *
+ *  The color at +position+ (0..1), interpolated between the neighbouring
+ *  stops as Color::RGB#interpolate does.
+ */
+extern VALUE
+rb_color_gradient_at(VALUE self, VALUE position)
+{
+	cGradient *gradient;
+	cRGB *color;
+	COLOR_GET_STRUCT(self, cGradient, gradient);
+	VALUE rb_color = color_model_new(COLOR_MODEL_RGB, (void **)&color);
+	color_gradient_sample(gradient, NUM2DBL(position), color);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     gradient.reverse -> gradient
+ *
+ *  A new gradient running from the last stop to the first.
+ */
+extern VALUE
+rb_color_gradient_reverse(VALUE self)
+{
+	cGradient *gradient, *source;
+	COLOR_GET_STRUCT(self, cGradient, source);
+	VALUE rb_gradient = rb_color_gradient__allocate(CLASS_OF(self));
+	COLOR_GET_STRUCT(rb_gradient, cGradient, gradient);
+	color_gradient_resize(gradient, source->size);
+	for (long i = 0, j = source->size-1; i < source->size; i++, j--) {
+		gradient->positions[i] = 1.0f-source->positions[j];
+		gradient->colors[i]    = source->colors[j];
+	}
+	return rb_gradient;
+}
+
+/*
+ *  call-seq:
+ *     gradient.discrete(n) -> gradient
+ *
+ *  A new gradient of +n+ equally wide bands of solid color, the colors of
+ *  this gradient at 0, 1/(n-1) ... 1. A value on the border between two
+ *  bands gets the upper one.
+ *
+ *  Example:
+ *    Color::Gradient[:viridis].discrete(5).apply(scores, :range => [0, 100])
+ */
+extern VALUE
+rb_color_gradient_discrete(VALUE self, VALUE bands)
+{
+	cGradient *gradient, *source;
+	long n = NUM2LONG(bands);
+	if (n < 1 || n > COLOR_GRADIENT_LUT_MAX) {
+		rb_raise(rb_eArgError, "Invalid number of bands, must be between 1 and %d", COLOR_GRADIENT_LUT_MAX);
+	}
+	COLOR_GET_STRUCT(self, cGradient, source);
+	VALUE rb_gradient = rb_color_gradient__allocate(CLASS_OF(self));
+	COLOR_GET_STRUCT(rb_gradient, cGradient, gradient);
+	// every band is a pair of stops of the same color at its borders
+	color_gradient_resize(gradient, 2*n);
+	for (long i = 0; i < n; i++) {
+		color_gradient_sample(source, n > 1 ? (double)i/(n-1) : 0, &gradient->colors[2*i]);
+		gradient->colors[2*i+1]    = gradient->colors[2*i];
+		gradient->positions[2*i]   = (float)i/n;
+		gradient->positions[2*i+1] = (float)(i+1)/n;
+	}
+	return rb_gradient;
+}
+
+/*
+ *  call-seq:
+ *     gradient.bake([size]) -> buffer
+ *
+ *  Samples the gradient at +size+ (2 to 4096, default 256, typically 256,
+ *  1024 or 4096) evenly spaced positions from 0 to 1 into an RGB buffer,
+ *  entry i is the color at i/(size-1). Its data is the packed lookup table.
+ */
+extern VALUE
+rb_color_gradient_bake(int argc, VALUE *argv, VALUE self)
+{
+	cGradient *gradient;
+	cBuffer *buffer;
+	VALUE size;
+	rb_scan_args(argc, argv, "01", &size);
+	COLOR_GET_STRUCT(self, cGradient, gradient);
+	int entries  = color_gradient_size_get(size);
+	VALUE result = color_buffer_new(COLOR_MODEL_RGB, entries, &buffer);
+	memcpy(buffer->data, color_gradient_lut(gradient, entries), entries*sizeof(cRGB));
+	return result;
+}
+
+/*
+ *  call-seq:
+ *     gradient.apply(values[, options]) -> buffer
+ *
+ *  Maps numbers onto the gradient, through a lookup table baked once per
+ *  size (see #bake), into an RGB buffer of the same length. +values+ is a
+ *  binary String of packed native floats, or doubles with
+ *  <code>:type => :double</code>, or an Array of Numerics (nil is NaN).
+ *  Options:
+ *  :range::   the values mapped to 0 and 1, [min, max] or a Range,
+ *             defaults to 0..1, a reversed range reverses the gradient
+ *  :scale::   :linear (default) or :log, with :log the range must be
+ *             positive and values up to 0 are below it
+ *  :clamp::   values outside of the range get the end colors (default), if
+ *             false they get the :nan color
+ *  :nan::     the color of NaN, defaults to fully transparent black
+ *  :size::    entries of the lookup table, defaults to 256
+ *  :type::    :float (default) or :double, for packed values
+ *  :threads:: splits the values over n native threads
+ *
+ *  Example:
+ *    heat  = Color::Gradient.new([Color.rgb(0, 0, 0), Color.rgb(255, 0, 0), Color.rgb(255, 255, 0)])
+ *    image = heat.apply(samples.pack("f*"), :range => [0, peak], :size => 1024)
+ *    image.pack(:rgba)
+ */
+extern VALUE
+rb_color_gradient_apply(int argc, VALUE *argv, VALUE self)
+{
+	cGradient *gradient;
+	cGradientApply apply;
+	cBuffer *result;
+	VALUE values, options, r_range = Qnil, r_scale = Qnil, r_clamp = Qnil, r_nan = Qnil, r_size = Qnil, r_type = Qnil;
+	volatile VALUE doubles = Qnil;
+	long length;
+	rb_scan_args(argc, argv, "11", &values, &options);
+	COLOR_GET_STRUCT(self, cGradient, gradient);
+	int threads = color_threads_get(options);
+	if (!NIL_P(options)) {
+		r_range = rb_hash_aref(options, ID2SYM(rb_intern("range")));
+		r_scale = rb_hash_aref(options, ID2SYM(rb_intern("scale")));
+		r_clamp = rb_hash_aref(options, ID2SYM(rb_intern("clamp")));
+		r_nan   = rb_hash_aref(options, ID2SYM(rb_intern("nan")));
+		r_size  = rb_hash_aref(options, ID2SYM(rb_intern("size")));
+		r_type  = rb_hash_aref(options, ID2SYM(rb_intern("type")));
+	}
+	int entries = color_gradient_size_get(r_size);
+	double low  = NIL_P(r_range) ? 0.0 : NUM2DBL(rb_funcall(r_range, rb_intern("first"), 0));
+	double high = NIL_P(r_range) ? 1.0 : NUM2DBL(rb_funcall(r_range, rb_intern("last"), 0));
+	if (NIL_P(r_scale) || r_scale == ID2SYM(rb_intern("linear"))) {
+		apply.log = 0;
+	} else if (r_scale == ID2SYM(rb_intern("log"))) {
+		if (!(low > 0 && high > 0)) {
+			rb_raise(rb_eArgError, "Invalid range, must be positive for :log");
+		}
+		apply.log = 1;
+		low       = log(low);
+		high      = log(high);
+	} else {
+		rb_raise(rb_eArgError, "Unknown scale, must be :linear or :log");
+	}
+	if (!(high != low) || isinf(low) || isinf(high)) {
+		rb_raise(rb_eArgError, "Invalid range, must be finite and not empty");
+	}
+
+	if (TYPE(values) == T_ARRAY) {
+		length  = RARRAY_LEN(values);
+		doubles = rb_str_new(NULL, length*sizeof(double));
+		double *to = (double *)RSTRING_PTR(doubles);
+		for (long i = 0; i < length; i++) {
+			VALUE value = RARRAY_PTR(values)[i];
+			to[i] = NIL_P(value) ? NAN : NUM2DBL(value);
+		}
+		apply.values  = RSTRING_PTR(doubles);
+		apply.doubles = 1;
+	} else {
+		Check_Type(values, T_STRING);
+		if (NIL_P(r_type) || r_type == ID2SYM(rb_intern("float"))) {
+			apply.doubles = 0;
+		} else if (r_type == ID2SYM(rb_intern("double"))) {
+			apply.doubles = 1;
+		} else {
+			rb_raise(rb_eArgError, "Unknown type, must be :float or :double");
+		}
+		size_t size = apply.doubles ? sizeof(double) : sizeof(float);
+		if (RSTRING_LEN(values) % size) {
+			rb_raise(rb_eArgError, "Invalid data, the length must be a multiple of %d", (int)size);
+		}
+		length       = RSTRING_LEN(values)/size;
+		apply.values = RSTRING_PTR(values);
+	}
+	if (NIL_P(r_nan)) {
+		cRGB transparent = { 0, 0, 0, 255 };
+		apply.nan = transparent;
+	} else {
+		color_buffer_store(COLOR_MODEL_RGB, &apply.nan, r_nan);
+	}
+	apply.clamp = NIL_P(r_clamp) || RTEST(r_clamp);
+	apply.last  = entries-1;
+	apply.low   = low;
+	apply.scale = apply.last/(high-low);
+	apply.lut   = color_gradient_lut(gradient, entries);
+
+	VALUE rb_result = color_buffer_new(COLOR_MODEL_RGB, length, &result);
+	apply.to = (cRGB *)result->data;
+	COLOR_STAT_KERNEL(COLOR_KERNEL_GRADIENT, length);
+	color_parallel(color_gradient_apply_slice, &apply, length, threads);
+	return rb_result;
+}
@@ -0,0 +1,12 @@
+extern VALUE rb_color_gradient__allocate(VALUE class);
+extern VALUE rb_color_gradient_initialize(VALUE self, VALUE stops);
+extern VALUE rb_color_gradient_initialize_copy(VALUE self, VALUE original);
+extern VALUE rb_color_gradient_s_colormap(VALUE class, VALUE name);
+extern VALUE rb_color_gradient_s_colormaps(VALUE class);
+extern VALUE rb_color_gradient_size(VALUE self);
+extern VALUE rb_color_gradient_stops(VALUE self);
+extern VALUE rb_color_gradient_at(VALUE self, VALUE position);
+extern VALUE rb_color_gradient_reverse(VALUE self);
+extern VALUE rb_color_gradient_discrete(VALUE self, VALUE bands);
+extern VALUE rb_color_gradient_bake(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_gradient_apply(int argc, VALUE *argv, VALUE self);
@@ -2,6 +2,7 @@
 #include <math.h>
 #include "color.h"
 #include "tools.h"
+#include "convert.h"
 #include "rgb.h"
 #include "hsv.h"
 #include "hsl.h"
@@ -15,7 +16,7 @@ extern VALUE
 rb_color_gray__allocate(VALUE class)
 {
 	cGray *color;
-	VALUE rb_color = Data_Make_Struct(class, cGray, NULL, free, color);
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cGray, color);
 	color->white = 0;
 	color->alpha = 0;
 	return rb_color;
@@ -33,8 +34,9 @@ rb_color_gray__allocate(VALUE class)
 extern VALUE
 rb_color_gray_initialize(int argc, VALUE *argv, VALUE self)
 {
+	COLOR_CHECK_FROZEN(self);
 	cGray *color;
-	Data_Get_Struct(self, cGray, color);
+	COLOR_GET_STRUCT(self, cGray, color);
 	VALUE white, alpha;
 	rb_scan_args(argc, argv, "11", &white, &alpha);
 
@@ -52,7 +54,7 @@ rb_color_gray_initialize(int argc, VALUE *argv, VALUE self)
 	color->white = w;
 	color->alpha = a;
 
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -61,11 +63,12 @@ rb_color_gray_initialize(int argc, VALUE *argv, VALUE self)
 extern VALUE
 rb_color_gray_initialize_copy(VALUE self, VALUE original)
 {
+	COLOR_CHECK_FROZEN(self);
 	cGray *color1, *color2;
-	Data_Get_Struct(self, cGray, color1);
-	Data_Get_Struct(original, cGray, color2);
+	COLOR_GET_STRUCT(self, cGray, color1);
+	COLOR_GET_STRUCT(original, cGray, color2);
 	*color1 = *color2;
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -80,7 +83,7 @@ extern VALUE
 rb_color_gray_white(VALUE self)
 {
 	cGray *color;
-	Data_Get_Struct(self, cGray, color);
+	COLOR_GET_STRUCT(self, cGray, color);
 	return CHR2FIX(color->white);
 }
 
@@ -95,7 +98,7 @@ extern VALUE
 rb_color_gray_alpha(VALUE self)
 {
 	cGray *color;
-	Data_Get_Struct(self, cGray, color);
+	COLOR_GET_STRUCT(self, cGray, color);
 	return CHR2FIX(color->alpha);
 }
 
@@ -108,10 +111,11 @@ rb_color_gray_alpha(VALUE self)
 extern VALUE
 rb_color_gray_add(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cGray *color1, *color2, *color3;
-	Data_Get_Struct(self, cGray, color1);
-	Data_Get_Struct(other, cGray, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cGray, cGray, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cGray, color1);
+	color2 = color_coerce(other, COLOR_MODEL_GRAY, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cGray, cGray, color3);
 	color3->white = color_cap(CHR2LONG(color1->white) + CHR2LONG(color2->white), 0, 255);
 	color3->alpha = color_cap(CHR2LONG(color1->alpha) + CHR2LONG(color2->alpha), 0, 255);
 	return rb_color;
@@ -126,10 +130,11 @@ rb_color_gray_add(VALUE self, VALUE other)
 extern VALUE
 rb_color_gray_sub(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cGray *color1, *color2, *color3;
-	Data_Get_Struct(self, cGray, color1);
-	Data_Get_Struct(other, cGray, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cGray, cGray, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cGray, color1);
+	color2 = color_coerce(other, COLOR_MODEL_GRAY, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cGray, cGray, color3);
 	color3->white = color_cap(CHR2LONG(color1->white) - CHR2LONG(color2->white), 0, 255);
 	color3->alpha = color_cap(CHR2LONG(color1->alpha) - CHR2LONG(color2->alpha), 0, 255);
 	return rb_color;
@@ -147,11 +152,11 @@ extern VALUE
 rb_color_gray_to_i(int argc, VALUE *argv, VALUE self)
 {
 	cGray *color;
-	Data_Get_Struct(self, cGray, color);
+	COLOR_GET_STRUCT(self, cGray, color);
 	VALUE alpha;
 	rb_scan_args(argc, argv, "01", &alpha);
 
-	if RTEST(alpha) {
+	if (RTEST(alpha)) {
 		return UINT2NUM(
 			(CHR2LONG(color->alpha) << 8) |
 			(CHR2LONG(color->white))
@@ -172,8 +177,9 @@ rb_color_gray_to_cmyk(VALUE self)
 {
 	cGray *gray;
 	cCMYK *cmyk;
-	Data_Get_Struct(self, cGray, gray);
-	VALUE rb_color = Data_Make_Struct(rb_cCMYK, cCMYK, NULL, free, cmyk);
+	COLOR_GET_STRUCT(self, cGray, gray);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cCMYK, cCMYK, cmyk);
+	COLOR_STAT_CONVERT(COLOR_MODEL_GRAY, COLOR_MODEL_CMYK, 1);
 	color_convert_gray_to_cmyk(gray, cmyk);
 	return rb_color;
 }
@@ -189,8 +195,9 @@ rb_color_gray_to_rgb(VALUE self)
 {
 	cGray *gray;
 	cRGB *rgb;
-	Data_Get_Struct(self, cGray, gray);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, rgb);
+	COLOR_GET_STRUCT(self, cGray, gray);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, rgb);
+	COLOR_STAT_CONVERT(COLOR_MODEL_GRAY, COLOR_MODEL_RGB, 1);
 	color_convert_gray_to_rgb(gray, rgb);
 	return rb_color;
 }
@@ -207,9 +214,10 @@ rb_color_gray_to_rgb(VALUE self)
 extern VALUE
 rb_color_gray_distance(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cGray *color1, *color2;
-	Data_Get_Struct(self, cGray, color1);
-	Data_Get_Struct(other, cGray, color2);
+	COLOR_GET_STRUCT(self, cGray, color1);
+	color2 = color_coerce(other, COLOR_MODEL_GRAY, &tmp, COLOR_COERCE_DISTANCE);
 	return rb_float_new(sqrtf((
 		powf(CHR2FLOAT(color1->white) - CHR2FLOAT(color2->white), 2) +
 		powf(CHR2FLOAT(color1->alpha) - CHR2FLOAT(color2->alpha), 2)
@@ -230,8 +238,8 @@ rb_color_gray_eql(VALUE self, VALUE other)
 		return Qfalse;
 	}
 	cGray *color1, *color2;
-	Data_Get_Struct(self, cGray, color1);
-	Data_Get_Struct(other, cGray, color2);
+	COLOR_GET_STRUCT(self, cGray, color1);
+	COLOR_GET_STRUCT(other, cGray, color2);
 	return (
 		color1->white == color2->white &&
 		color1->alpha == color2->alpha
@@ -249,7 +257,7 @@ extern VALUE
 rb_color_gray_hash(VALUE self)
 {
 	cGray *color;
-	Data_Get_Struct(self, cGray, color);
+	COLOR_GET_STRUCT(self, cGray, color);
 
 	return INT2FIX(
 		(8) ^
@@ -2,6 +2,7 @@
 #include <math.h>
 #include "color.h"
 #include "tools.h"
+#include "convert.h"
 #include "rgb.h"
 #include "hsv.h"
 #include "hsl.h"
@@ -12,7 +13,7 @@ extern VALUE
 rb_color_hsl__allocate(VALUE class)
 {
 	cHSL *color;
-	VALUE rb_color = Data_Make_Struct(class, cHSL, NULL, free, color);
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cHSL, color);
 	color->h     = 0;
 	color->s     = 0;
 	color->l     = 0;
@@ -31,8 +32,9 @@ rb_color_hsl__allocate(VALUE class)
 extern VALUE
 rb_color_hsl_initialize(int argc, VALUE *argv, VALUE self)
 {
+	COLOR_CHECK_FROZEN(self);
 	cHSL *color;
-	Data_Get_Struct(self, cHSL, color);
+	COLOR_GET_STRUCT(self, cHSL, color);
 	VALUE hue, saturation, luminance, alpha;
 	rb_scan_args(argc, argv, "31", &hue, &saturation, &luminance, &alpha);
 
@@ -61,7 +63,7 @@ rb_color_hsl_initialize(int argc, VALUE *argv, VALUE self)
 	color->l     = color_capf(l,0,1);
 	color->alpha = a;
 
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -70,18 +72,19 @@ rb_color_hsl_initialize(int argc, VALUE *argv, VALUE self)
 extern VALUE
 rb_color_hsl_initialize_copy(VALUE self, VALUE original)
 {
+	COLOR_CHECK_FROZEN(self);
 	cHSL *color1, *color2;
-	Data_Get_Struct(self, cHSL, color1);
-	Data_Get_Struct(original, cHSL, color2);
+	COLOR_GET_STRUCT(self, cHSL, color1);
+	COLOR_GET_STRUCT(original, cHSL, color2);
 	*color1 = *color2;
-	return self;
+	return rb_obj_freeze(self);
 }
 
 extern VALUE
 rb_color_hsl_hue(VALUE self)
 {
 	cHSL *color;
-	Data_Get_Struct(self, cHSL, color);
+	COLOR_GET_STRUCT(self, cHSL, color);
 	return rb_float_new(color->h);
 }
 
@@ -89,7 +92,7 @@ extern VALUE
 rb_color_hsl_saturation(VALUE self)
 {
 	cHSL *color;
-	Data_Get_Struct(self, cHSL, color);
+	COLOR_GET_STRUCT(self, cHSL, color);
 	return rb_float_new(color->s);
 }
 
@@ -97,7 +100,7 @@ extern VALUE
 rb_color_hsl_luminance(VALUE self)
 {
 	cHSL *color;
-	Data_Get_Struct(self, cHSL, color);
+	COLOR_GET_STRUCT(self, cHSL, color);
 	return rb_float_new(color->l);
 }
 
@@ -105,7 +108,7 @@ extern VALUE
 rb_color_hsl_alpha(VALUE self)
 {
 	cHSL *color;
-	Data_Get_Struct(self, cHSL, color);
+	COLOR_GET_STRUCT(self, cHSL, color);
 	return CHR2FIX(color->alpha);
 }
 
@@ -113,8 +116,8 @@ extern VALUE
 rb_color_hsl_complement(VALUE self)
 {
 	cHSL *color1, *color2;
-	Data_Get_Struct(self, cHSL, color1);
-	VALUE rb_color = Data_Make_Struct(rb_cHSL, cHSL, NULL, free, color2);
+	COLOR_GET_STRUCT(self, cHSL, color1);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSL, cHSL, color2);
 	*color2 = *color1;
 	color2->h = fmodf(color2->h+0.5, 1);
 	return rb_color;
@@ -123,10 +126,11 @@ rb_color_hsl_complement(VALUE self)
 extern VALUE
 rb_color_hsl_add(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cHSL *color1, *color2, *color3;
-	Data_Get_Struct(self, cHSL, color1);
-	Data_Get_Struct(other, cHSL, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cHSL, cHSL, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cHSL, color1);
+	color2 = color_coerce(other, COLOR_MODEL_HSL, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSL, cHSL, color3);
 	color3->h = fmodf(color1->h + color2->h, 1);
 	color3->s = color_capf(color1->s + color2->s, 0, 1);
 	color3->l = color_capf(color1->l + color2->l, 0, 1);
@@ -136,10 +140,11 @@ rb_color_hsl_add(VALUE self, VALUE other)
 extern VALUE
 rb_color_hsl_sub(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cHSL *color1, *color2, *color3;
-	Data_Get_Struct(self, cHSL, color1);
-	Data_Get_Struct(other, cHSL, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cHSL, cHSL, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cHSL, color1);
+	color2 = color_coerce(other, COLOR_MODEL_HSL, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSL, cHSL, color3);
 	color3->h = fmodf(color1->h - color2->h, 1);
 	color3->s = color_capf(color1->s - color2->s, 0, 1);
 	color3->l = color_capf(color1->l - color2->l, 0, 1);
@@ -158,9 +163,10 @@ rb_color_hsl_sub(VALUE self, VALUE other)
 extern VALUE
 rb_color_hsl_distance(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cHSL *color1, *color2;
-	Data_Get_Struct(self, cHSL, color1);
-	Data_Get_Struct(other, cHSL, color2);
+	COLOR_GET_STRUCT(self, cHSL, color1);
+	color2 = color_coerce(other, COLOR_MODEL_HSL, &tmp, COLOR_COERCE_DISTANCE);
 	return rb_float_new(sqrtf((
 		powf(color1->h - color2->h, 2) +
 		powf(color1->s - color2->s, 2) +
@@ -173,8 +179,8 @@ extern VALUE
 rb_color_hsl_eql(VALUE self, VALUE other)
 {
 	cHSL *color1, *color2;
-	Data_Get_Struct(self, cHSL, color1);
-	Data_Get_Struct(other, cHSL, color2);
+	COLOR_GET_STRUCT(self, cHSL, color1);
+	COLOR_GET_STRUCT(other, cHSL, color2);
 	return (
 		color1->alpha == color2->alpha &&
 		color1->h     == color2->h &&
@@ -188,7 +194,7 @@ rb_color_hsl_hash(VALUE self)
 {
 	long h;
 	cHSL *color;
-	Data_Get_Struct(self, cHSL, color);
+	COLOR_GET_STRUCT(self, cHSL, color);
 	
 	h  = 4;
 	h  = (h << 1) | (h<0 ? 1 : 0);
@@ -207,9 +213,45 @@ rb_color_hsl_to_rgb(VALUE self)
 {
 	cHSL *hsl;
 	cRGB *rgb;
-	Data_Get_Struct(self, cHSL, hsl);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, rgb);
+	COLOR_GET_STRUCT(self, cHSL, hsl);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, rgb);
+	COLOR_STAT_CONVERT(COLOR_MODEL_HSL, COLOR_MODEL_RGB, 1);
 	color_convert_hsl_to_rgb(hsl, rgb);
 	return rb_color;
 }
 
+/*
+ *  call-seq:
+ *     hsl.to_rgb16 -> rgb16
+ *
+ *  Returns an RGB16 representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_hsl_to_rgb16(VALUE self)
+{
+	cHSL *hsl;
+	cRGB16 *rgb16;
+	COLOR_GET_STRUCT(self, cHSL, hsl);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB16, cRGB16, rgb16);
+	COLOR_STAT_CONVERT(COLOR_MODEL_HSL, COLOR_MODEL_RGB16, 1);
+	color_convert_hsl_to_rgb16(hsl, rgb16);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     hsl.to_rgbf -> rgbf
+ *
+ *  Returns an RGBF representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_hsl_to_rgbf(VALUE self)
+{
+	cHSL *hsl;
+	cRGBF *rgbf;
+	COLOR_GET_STRUCT(self, cHSL, hsl);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGBF, cRGBF, rgbf);
+	COLOR_STAT_CONVERT(COLOR_MODEL_HSL, COLOR_MODEL_RGBF, 1);
+	color_convert_hsl_to_rgbf(hsl, rgbf);
+	return rb_color;
+}
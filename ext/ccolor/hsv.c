@@ -2,6 +2,7 @@
 #include <math.h>
 #include "color.h"
 #include "tools.h"
+#include "convert.h"
 #include "rgb.h"
 #include "hsv.h"
 #include "hsl.h"
@@ -12,7 +13,7 @@ extern VALUE
 rb_color_hsv__allocate(VALUE class)
 {
 	cHSV *color;
-	VALUE rb_color = Data_Make_Struct(class, cHSV, NULL, free, color);
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cHSV, color);
 	color->h     = 0;
 	color->s     = 0;
 	color->v     = 0;
@@ -31,8 +32,9 @@ rb_color_hsv__allocate(VALUE class)
 extern VALUE
 rb_color_hsv_initialize(int argc, VALUE *argv, VALUE self)
 {
+	COLOR_CHECK_FROZEN(self);
 	cHSV *color;
-	Data_Get_Struct(self, cHSV, color);
+	COLOR_GET_STRUCT(self, cHSV, color);
 	VALUE hue, saturation, value, alpha;
 	rb_scan_args(argc, argv, "31", &hue, &saturation, &value, &alpha);
 
@@ -61,7 +63,7 @@ rb_color_hsv_initialize(int argc, VALUE *argv, VALUE self)
 	color->v     = color_capf(v,0,1);
 	color->alpha = a;
 
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -70,18 +72,19 @@ rb_color_hsv_initialize(int argc, VALUE *argv, VALUE self)
 extern VALUE
 rb_color_hsv_initialize_copy(VALUE self, VALUE original)
 {
+	COLOR_CHECK_FROZEN(self);
 	cHSV *color1, *color2;
-	Data_Get_Struct(self, cHSV, color1);
-	Data_Get_Struct(original, cHSV, color2);
+	COLOR_GET_STRUCT(self, cHSV, color1);
+	COLOR_GET_STRUCT(original, cHSV, color2);
 	*color1 = *color2;
-	return self;
+	return rb_obj_freeze(self);
 }
 
 extern VALUE
 rb_color_hsv_hue(VALUE self)
 {
 	cHSV *color;
-	Data_Get_Struct(self, cHSV, color);
+	COLOR_GET_STRUCT(self, cHSV, color);
 	return rb_float_new(color->h);
 }
 
@@ -89,7 +92,7 @@ extern VALUE
 rb_color_hsv_saturation(VALUE self)
 {
 	cHSV *color;
-	Data_Get_Struct(self, cHSV, color);
+	COLOR_GET_STRUCT(self, cHSV, color);
 	return rb_float_new(color->s);
 }
 
@@ -97,7 +100,7 @@ extern VALUE
 rb_color_hsv_value(VALUE self)
 {
 	cHSV *color;
-	Data_Get_Struct(self, cHSV, color);
+	COLOR_GET_STRUCT(self, cHSV, color);
 	return rb_float_new(color->v);
 }
 
@@ -105,17 +108,18 @@ extern VALUE
 rb_color_hsv_alpha(VALUE self)
 {
 	cHSV *color;
-	Data_Get_Struct(self, cHSV, color);
+	COLOR_GET_STRUCT(self, cHSV, color);
 	return CHR2FIX(color->alpha);
 }
 
 extern VALUE
 rb_color_hsv_add(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cHSV *color1, *color2, *color3;
-	Data_Get_Struct(self, cHSV, color1);
-	Data_Get_Struct(other, cHSV, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cHSV, cHSV, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cHSV, color1);
+	color2 = color_coerce(other, COLOR_MODEL_HSV, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSV, cHSV, color3);
 	color3->h = fmodf(color1->h + color2->h, 1);
 	color3->s = color_capf(color1->s + color2->s, 0, 1);
 	color3->v = color_capf(color1->v + color2->v, 0, 1);
@@ -125,10 +129,11 @@ rb_color_hsv_add(VALUE self, VALUE other)
 extern VALUE
 rb_color_hsv_sub(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cHSV *color1, *color2, *color3;
-	Data_Get_Struct(self, cHSV, color1);
-	Data_Get_Struct(other, cHSV, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cHSV, cHSV, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cHSV, color1);
+	color2 = color_coerce(other, COLOR_MODEL_HSV, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSV, cHSV, color3);
 	color3->h = fmodf(color1->h - color2->h, 1);
 	color3->s = color_capf(color1->s - color2->s, 0, 1);
 	color3->v = color_capf(color1->v - color2->v, 0, 1);
@@ -139,8 +144,8 @@ extern VALUE
 rb_color_hsv_complement(VALUE self)
 {
 	cHSV *color1, *color2;
-	Data_Get_Struct(self, cHSV, color1);
-	VALUE rb_color = Data_Make_Struct(rb_cHSV, cHSV, NULL, free, color2);
+	COLOR_GET_STRUCT(self, cHSV, color1);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSV, cHSV, color2);
 	*color2 = *color1;
 	color2->h = fmodf(color2->h+0.5, 1);
 	return rb_color;
@@ -158,9 +163,10 @@ rb_color_hsv_complement(VALUE self)
 extern VALUE
 rb_color_hsv_distance(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cHSV *color1, *color2;
-	Data_Get_Struct(self, cHSV, color1);
-	Data_Get_Struct(other, cHSV, color2);
+	COLOR_GET_STRUCT(self, cHSV, color1);
+	color2 = color_coerce(other, COLOR_MODEL_HSV, &tmp, COLOR_COERCE_DISTANCE);
 	return rb_float_new(sqrtf((
 		powf(color1->h - color2->h, 2) +
 		powf(color1->s - color2->s, 2) +
@@ -173,8 +179,8 @@ extern VALUE
 rb_color_hsv_eql(VALUE self, VALUE other)
 {
 	cHSV *color1, *color2;
-	Data_Get_Struct(self, cHSV, color1);
-	Data_Get_Struct(other, cHSV, color2);
+	COLOR_GET_STRUCT(self, cHSV, color1);
+	COLOR_GET_STRUCT(other, cHSV, color2);
 	return (
 		color1->alpha == color2->alpha &&
 		color1->h     == color2->h &&
@@ -188,7 +194,7 @@ rb_color_hsv_hash(VALUE self)
 {
 	long h;
 	cHSV *color;
-	Data_Get_Struct(self, cHSV, color);
+	COLOR_GET_STRUCT(self, cHSV, color);
 	
 	h  = 4;
 	h  = (h << 1) | (h<0 ? 1 : 0);
@@ -207,8 +213,45 @@ rb_color_hsv_to_rgb(VALUE self)
 {
 	cHSV *hsv;
 	cRGB *rgb;
-	Data_Get_Struct(self, cHSV, hsv);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, rgb);
+	COLOR_GET_STRUCT(self, cHSV, hsv);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, rgb);
+	COLOR_STAT_CONVERT(COLOR_MODEL_HSV, COLOR_MODEL_RGB, 1);
 	color_convert_hsv_to_rgb(hsv, rgb);
 	return rb_color;
 }
+
+/*
+ *  call-seq:
+ *     hsv.to_rgb16 -> rgb16
+ *
+ *  Returns an RGB16 representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_hsv_to_rgb16(VALUE self)
+{
+	cHSV *hsv;
+	cRGB16 *rgb16;
+	COLOR_GET_STRUCT(self, cHSV, hsv);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB16, cRGB16, rgb16);
+	COLOR_STAT_CONVERT(COLOR_MODEL_HSV, COLOR_MODEL_RGB16, 1);
+	color_convert_hsv_to_rgb16(hsv, rgb16);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     hsv.to_rgbf -> rgbf
+ *
+ *  Returns an RGBF representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_hsv_to_rgbf(VALUE self)
+{
+	cHSV *hsv;
+	cRGBF *rgbf;
+	COLOR_GET_STRUCT(self, cHSV, hsv);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGBF, cRGBF, rgbf);
+	COLOR_STAT_CONVERT(COLOR_MODEL_HSV, COLOR_MODEL_RGBF, 1);
+	color_convert_hsv_to_rgbf(hsv, rgbf);
+	return rb_color;
+}
@@ -12,3 +12,5 @@ extern VALUE rb_color_hsv_eql(VALUE self, VALUE other);
 extern VALUE rb_color_hsv_distance(VALUE self, VALUE other);
 extern VALUE rb_color_hsv_hash(VALUE self);
 extern VALUE rb_color_hsv_to_rgb(VALUE self);
+extern VALUE rb_color_hsv_to_rgb16(VALUE self);
+extern VALUE rb_color_hsv_to_rgbf(VALUE self);
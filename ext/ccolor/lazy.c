@@ -0,0 +1,141 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "buffer.h"
+#include "linear.h"
+#include "threads.h"
+#include "adjust.h"
+#include "lazy.h"
+
+// same block size as adjust, two blocks of scratch memory per thread
+#define COLOR_PIPELINE_BLOCK 256
+
+static void
+color_stage_operand(cStage *stage, VALUE rb_buffer, long length)
+{
+	cBuffer *operand = color_buffer_get(rb_buffer, -1);
+	if (operand->length != length) {
+		rb_raise(rb_eArgError, "Buffers differ in length");
+	}
+	color_converter_resolve(&stage->decode, operand->model, COLOR_MODEL_RGBF);
+	stage->data = operand->data;
+	stage->size = color_model_size(operand->model);
+}
+
+static void
+color_stage_compile(cStage *stage, VALUE spec, int model, long length)
+{
+	Check_Type(spec, T_ARRAY);
+	VALUE *arg = RARRAY_PTR(spec);
+	long argc  = RARRAY_LEN(spec);
+	VALUE type = argc > 0 ? arg[0] : Qnil;
+
+	memset(stage, 0, sizeof(cStage));
+	if (type == ID2SYM(rb_intern("adjust")) && argc == 2) {
+		stage->type = COLOR_STAGE_ADJUST;
+		color_adjust_compile(&stage->adjust, model, arg[1]);
+	} else if (type == ID2SYM(rb_intern("blend")) && argc == 5) {
+		// [:blend, overlay, with_alpha, using, space]
+		stage->type   = COLOR_STAGE_BLEND;
+		stage->amount = color_blend_opacity_get(arg[2]);
+		stage->mode   = color_blend_mode_get(arg[3]);
+		stage->space  = color_space_named(arg[4]);
+		color_stage_operand(stage, arg[1], length);
+	} else if (type == ID2SYM(rb_intern("interpolate")) && argc == 4) {
+		// [:interpolate, other, pos, space]
+		stage->type   = COLOR_STAGE_INTERPOLATE;
+		stage->amount = NUM2DBL(arg[2]);
+		stage->space  = color_space_named(arg[3]);
+		color_stage_operand(stage, arg[1], length);
+	} else {
+		VALUE inspect = rb_inspect(spec);
+		rb_raise(rb_eArgError, "Invalid stage %s", RSTRING_PTR(inspect));
+	}
+}
+
+static void
+color_stage_run(cStage *stage, cRGBF *block, cRGBF *scratch, long start, long length)
+{
+	if (stage->type == COLOR_STAGE_ADJUST) {
+		color_adjust_rgbf(&stage->adjust, block, length);
+		return;
+	}
+	color_converter_run_buffer(&stage->decode, stage->data+start*stage->size, (char *)scratch, length);
+	if (stage->type == COLOR_STAGE_BLEND) {
+		for (long i = 0; i < length; i++) {
+			float opacity = stage->amount < 0 ? 1-scratch[i].alpha : stage->amount;
+			color_rgbf_blend(&block[i], &scratch[i], &block[i], opacity, stage->mode, stage->space);
+		}
+	} else {
+		for (long i = 0; i < length; i++) {
+			color_rgbf_interpolate_in(&block[i], &scratch[i], &block[i], stage->amount, stage->space);
+		}
+	}
+}
+
+/*
+ * Runs all stages over elements from...to, block by block. Every element
+ * is decoded once, passes all stages as float RGB and is encoded once.
+ */
+extern void
+color_pipeline_run(cPipeline *pipeline, long from, long to)
+{
+	cRGBF  block[COLOR_PIPELINE_BLOCK], scratch[COLOR_PIPELINE_BLOCK];
+	size_t from_size = color_model_size(pipeline->decode.from);
+	size_t to_size   = color_model_size(pipeline->encode.to);
+	for (long start = from; start < to; start += COLOR_PIPELINE_BLOCK) {
+		long length = to-start < COLOR_PIPELINE_BLOCK ? to-start : COLOR_PIPELINE_BLOCK;
+		color_converter_run_buffer(&pipeline->decode, pipeline->from+start*from_size, (char *)block, length);
+		for (long i = 0; i < pipeline->count; i++) {
+			color_stage_run(&pipeline->stages[i], block, scratch, start, length);
+		}
+		color_converter_run_buffer(&pipeline->encode, (char *)block, pipeline->to+start*to_size, length);
+	}
+}
+
+static void
+color_pipeline_slice(void *pipeline, long from, long to)
+{
+	color_pipeline_run((cPipeline *)pipeline, from, to);
+}
+
+/*
+ *  call-seq:
+ *     buffer._pipeline(stages, model[, options]) -> buffer
+ *
+ *  :nodoc:
+ *  Runs compiled stages of a Color::Buffer::Lazy and returns a buffer of
+ *  +model+. Stages are [:adjust, spec], [:blend, overlay, with_alpha, using,
+ *  space] and [:interpolate, other, pos, space].
+ */
+extern VALUE
+rb_color_buffer_pipeline(int argc, VALUE *argv, VALUE self)
+{
+	cPipeline pipeline;
+	cBuffer *result;
+	VALUE stages, model, options;
+	rb_scan_args(argc, argv, "21", &stages, &model, &options);
+	Check_Type(stages, T_ARRAY);
+	cBuffer *buffer = color_buffer_get(self, -1);
+	int threads     = color_threads_get(options);
+
+	// the stages live in a string, so the GC frees them if compiling raises
+	volatile VALUE memory = rb_str_new(NULL, (RARRAY_LEN(stages)+1)*sizeof(cStage));
+	pipeline.stages = (cStage *)RSTRING_PTR(memory);
+	pipeline.count  = RARRAY_LEN(stages);
+	for (long i = 0; i < pipeline.count; i++) {
+		color_stage_compile(&pipeline.stages[i], RARRAY_PTR(stages)[i], buffer->model, buffer->length);
+	}
+	color_converter_resolve(&pipeline.decode, buffer->model, COLOR_MODEL_RGBF);
+	color_converter_resolve(&pipeline.encode, COLOR_MODEL_RGBF, color_model_get(model));
+
+	VALUE rb_result = color_buffer_new(pipeline.encode.to, buffer->length, &result);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PIPELINE, buffer->length);
+	pipeline.from   = buffer->data;
+	pipeline.to     = result->data;
+	color_parallel(color_pipeline_slice, &pipeline, buffer->length, threads);
+	return rb_result;
+}
@@ -0,0 +1,28 @@
+enum {
+	COLOR_STAGE_ADJUST,
+	COLOR_STAGE_BLEND,
+	COLOR_STAGE_INTERPOLATE
+};
+
+typedef struct _cStage {
+	int        type;   // COLOR_STAGE_*
+	cAdjust    adjust; // edits of COLOR_STAGE_ADJUST
+	cConverter decode; // operand model -> RGBF
+	char      *data;   // operand buffer
+	size_t     size;   // operand element size
+	float      amount; // interpolation position, or blend opacity (< 0: operand alpha)
+	int        mode;   // COLOR_BLEND_*
+	int        space;  // COLOR_SPACE_*
+} cStage;
+
+typedef struct _cPipeline {
+	cStage    *stages;
+	long       count;
+	cConverter decode; // source model -> RGBF
+	cConverter encode; // RGBF -> target model
+	char      *from;
+	char      *to;
+} cPipeline;
+
+extern void color_pipeline_run(cPipeline *pipeline, long from, long to);
+extern VALUE rb_color_buffer_pipeline(int argc, VALUE *argv, VALUE self);
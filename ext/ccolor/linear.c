@@ -0,0 +1,231 @@
+#include <ruby.h>
+#include <math.h>
+#include "color.h"
+#include "tools.h"
+#include "linear.h"
+
+float color_srgb_to_linear_lut[256];
+unsigned char color_linear_to_srgb_lut[COLOR_LINEAR_STEPS];
+
+extern float
+color_srgb_to_linear(float value)
+{
+	return value <= 0.04045 ? value/12.92 : powf((value+0.055)/1.055, 2.4);
+}
+
+extern float
+color_linear_to_srgb(float value)
+{
+	return value <= 0.0031308 ? value*12.92 : 1.055*powf(value, 1/2.4)-0.055;
+}
+
+/*
+ * Fills the lookup tables, must run before any linear light kernel.
+ */
+extern void
+color_linear_init(void)
+{
+	for (int i = 0; i < 256; i++) {
+		color_srgb_to_linear_lut[i] = color_srgb_to_linear(i/255.0);
+	}
+	for (int i = 0; i < COLOR_LINEAR_STEPS; i++) {
+		color_linear_to_srgb_lut[i] = FLOAT2CHR(color_linear_to_srgb((float)i/(COLOR_LINEAR_STEPS-1)));
+	}
+}
+
+/*
+ * Accepts :srgb or :linear (nil is :srgb), raises ArgumentError otherwise.
+ */
+extern int
+color_space_named(VALUE space)
+{
+	if (NIL_P(space) || space == ID2SYM(rb_intern("srgb"))) return COLOR_SPACE_SRGB;
+	if (space == ID2SYM(rb_intern("linear")))               return COLOR_SPACE_LINEAR;
+	rb_raise(rb_eArgError, "Unknown space, must be :srgb or :linear");
+	return COLOR_SPACE_SRGB;
+}
+
+/*
+ * Reads :space from an options hash (or nil), :srgb is the default.
+ */
+extern int
+color_space_get(VALUE options)
+{
+	VALUE space;
+	if (NIL_P(options)) return COLOR_SPACE_SRGB;
+	Check_Type(options, T_HASH);
+	space = rb_hash_aref(options, ID2SYM(rb_intern("space")));
+	return color_space_named(space);
+}
+
+/*
+ * Like color_rgb_interpolate, but red, green and blue are interpolated in
+ * linear light. Alpha is not gamma encoded and interpolated as is.
+ */
+extern void
+color_rgb_interpolate_linear(cRGB *color1, cRGB *color2, cRGB *color3, float pos)
+{
+	float r1,g1,b1, r2,g2,b2, a1,a2;
+
+	r1 = SRGB2LINEAR(color1->r);
+	g1 = SRGB2LINEAR(color1->g);
+	b1 = SRGB2LINEAR(color1->b);
+	a1 = CHR2FLOAT(color1->alpha);
+
+	r2 = SRGB2LINEAR(color2->r);
+	g2 = SRGB2LINEAR(color2->g);
+	b2 = SRGB2LINEAR(color2->b);
+	a2 = CHR2FLOAT(color2->alpha);
+
+	color3->r     = LINEAR2SRGB(r1+(r2-r1)*pos);
+	color3->g     = LINEAR2SRGB(g1+(g2-g1)*pos);
+	color3->b     = LINEAR2SRGB(b1+(b2-b1)*pos);
+	color3->alpha = FLOAT2CHR(a1+(a2-a1)*pos);
+}
+
+extern void
+color_rgb_interpolate_in(cRGB *color1, cRGB *color2, cRGB *color3, float pos, int space)
+{
+	if (space == COLOR_SPACE_LINEAR) {
+		color_rgb_interpolate_linear(color1, color2, color3, pos);
+	} else {
+		color_rgb_interpolate(color1, color2, color3, pos);
+	}
+}
+
+/*
+ * Accepts :interpolate, :multiply or :negative_multiply (nil is
+ * :interpolate), raises ArgumentError otherwise.
+ */
+extern int
+color_blend_mode_get(VALUE using)
+{
+	if (NIL_P(using) || using == ID2SYM(rb_intern("interpolate"))) return COLOR_BLEND_INTERPOLATE;
+	if (using == ID2SYM(rb_intern("multiply")))                     return COLOR_BLEND_MULTIPLY;
+	if (using == ID2SYM(rb_intern("negative_multiply")))            return COLOR_BLEND_NEGATIVE_MULTIPLY;
+	VALUE inspect = rb_inspect(using);
+	rb_raise(rb_eArgError, "Unknown mode, %s", RSTRING_PTR(inspect));
+	return COLOR_BLEND_INTERPOLATE;
+}
+
+/*
+ * The opacity for an :alpha option of a buffer blend (0 opaque, 255
+ * transparent), -1 for nil, which means the alpha of each overlay color.
+ * Raises ArgumentError outside of 0..255.
+ */
+extern float
+color_blend_opacity_get(VALUE alpha)
+{
+	if (NIL_P(alpha)) return -1;
+	int value = NUM2INT(alpha);
+	if (value < 0 || value > 255) {
+		rb_raise(rb_eArgError, "Invalid alpha, must be between 0 and 255");
+	}
+	return (255-value)/255.0f;
+}
+
+static inline float
+color_decode(unsigned char value, int space)
+{
+	return space == COLOR_SPACE_LINEAR ? SRGB2LINEAR(value) : CHR2FLOAT(value);
+}
+
+static inline unsigned char
+color_encode(float value, int space)
+{
+	return space == COLOR_SPACE_LINEAR ? LINEAR2SRGB(value) : FLOAT2CHR(color_unitf(value));
+}
+
+static inline float
+color_blend_channel(float value, float with, float opacity, int mode)
+{
+	switch(mode) {
+		case COLOR_BLEND_MULTIPLY:
+			return value*(with+opacity-opacity*with);
+		case COLOR_BLEND_NEGATIVE_MULTIPLY:
+			with = 1-with;
+			return 1-(1-value)*(with+opacity-opacity*with);
+	}
+	return value+(with-value)*opacity;
+}
+
+/*
+ * Puts +with+ on top of +color+, with the given opacity (0..1). The result
+ * keeps the alpha of +color+, see Color::RGB#blend.
+ */
+extern void
+color_rgb_blend(cRGB *color, cRGB *with, cRGB *result, float opacity, int mode, int space)
+{
+	if (mode == COLOR_BLEND_INTERPOLATE) {
+		unsigned char alpha = color->alpha;
+		color_rgb_interpolate_in(color, with, result, opacity, space);
+		result->alpha = alpha;
+		return;
+	}
+	result->r = color_encode(color_blend_channel(color_decode(color->r, space), color_decode(with->r, space), opacity, mode), space);
+	result->g = color_encode(color_blend_channel(color_decode(color->g, space), color_decode(with->g, space), opacity, mode), space);
+	result->b = color_encode(color_blend_channel(color_decode(color->b, space), color_decode(with->b, space), opacity, mode), space);
+	result->alpha = color->alpha;
+}
+
+static inline float
+color_decodef(float value, int space)
+{
+	return space == COLOR_SPACE_LINEAR ? color_srgb_to_linear(color_unitf(value)) : value;
+}
+
+static inline float
+color_encodef(float value, int space)
+{
+	return space == COLOR_SPACE_LINEAR ? color_linear_to_srgb(color_unitf(value)) : value;
+}
+
+/*
+ * Float variant of color_rgb_interpolate_in, alpha is interpolated too.
+ */
+extern void
+color_rgbf_interpolate_in(cRGBF *color1, cRGBF *color2, cRGBF *color3, float pos, int space)
+{
+	float r1 = color_decodef(color1->r, space), r2 = color_decodef(color2->r, space);
+	float g1 = color_decodef(color1->g, space), g2 = color_decodef(color2->g, space);
+	float b1 = color_decodef(color1->b, space), b2 = color_decodef(color2->b, space);
+	color3->r     = color_encodef(r1+(r2-r1)*pos, space);
+	color3->g     = color_encodef(g1+(g2-g1)*pos, space);
+	color3->b     = color_encodef(b1+(b2-b1)*pos, space);
+	color3->alpha = color1->alpha+(color2->alpha-color1->alpha)*pos;
+}
+
+/*
+ * Float variant of color_rgb_blend.
+ */
+extern void
+color_rgbf_blend(cRGBF *color, cRGBF *with, cRGBF *result, float opacity, int mode, int space)
+{
+	float alpha = color->alpha;
+	result->r     = color_encodef(color_blend_channel(color_decodef(color->r, space), color_decodef(with->r, space), opacity, mode), space);
+	result->g     = color_encodef(color_blend_channel(color_decodef(color->g, space), color_decodef(with->g, space), opacity, mode), space);
+	result->b     = color_encodef(color_blend_channel(color_decodef(color->b, space), color_decodef(with->b, space), opacity, mode), space);
+	result->alpha = alpha;
+}
+
+/*
+ * Relative luminance (0..1) as defined by WCAG 2.x, alpha is ignored.
+ * The lookup table uses the sRGB threshold 0.04045 instead of WCAG's
+ * 0.03928, which only differs below 8 bit precision.
+ */
+extern float
+color_rgb_luminance(cRGB *color)
+{
+	return 0.2126f*SRGB2LINEAR(color->r) + 0.7152f*SRGB2LINEAR(color->g) + 0.0722f*SRGB2LINEAR(color->b);
+}
+
+/*
+ * WCAG contrast ratio (1..21) of two relative luminances, in either order.
+ */
+extern float
+color_contrast(float luminance1, float luminance2)
+{
+	return luminance1 > luminance2 ?
+		(luminance1+0.05f)/(luminance2+0.05f) :
+		(luminance2+0.05f)/(luminance1+0.05f);
+}
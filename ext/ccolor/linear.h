@@ -0,0 +1,31 @@
+#define COLOR_LINEAR_STEPS 4096
+#define SRGB2LINEAR(x) (color_srgb_to_linear_lut[(x)&0xff])
+#define LINEAR2SRGB(x) (color_linear_to_srgb_lut[(int)(color_unitf(x)*(COLOR_LINEAR_STEPS-1)+0.5f)])
+
+enum {
+	COLOR_SPACE_SRGB,
+	COLOR_SPACE_LINEAR
+};
+
+enum {
+	COLOR_BLEND_INTERPOLATE,
+	COLOR_BLEND_MULTIPLY,
+	COLOR_BLEND_NEGATIVE_MULTIPLY
+};
+
+extern float color_srgb_to_linear_lut[256];
+extern unsigned char color_linear_to_srgb_lut[COLOR_LINEAR_STEPS];
+extern float color_srgb_to_linear(float value);
+extern float color_linear_to_srgb(float value);
+extern void color_linear_init(void);
+extern int color_space_named(VALUE space);
+extern int color_space_get(VALUE options);
+extern void color_rgb_interpolate_linear(cRGB *color1, cRGB *color2, cRGB *color3, float pos);
+extern void color_rgb_interpolate_in(cRGB *color1, cRGB *color2, cRGB *color3, float pos, int space);
+extern int color_blend_mode_get(VALUE using);
+extern float color_blend_opacity_get(VALUE alpha);
+extern void color_rgb_blend(cRGB *color, cRGB *with, cRGB *result, float opacity, int mode, int space);
+extern void color_rgbf_interpolate_in(cRGBF *color1, cRGBF *color2, cRGBF *color3, float pos, int space);
+extern void color_rgbf_blend(cRGBF *color, cRGBF *with, cRGBF *result, float opacity, int mode, int space);
+extern float color_rgb_luminance(cRGB *color);
+extern float color_contrast(float luminance1, float luminance2);
@@ -0,0 +1 @@
+extern VALUE rb_color_named__names(VALUE class);
@@ -0,0 +1,284 @@
+#include <ruby.h>
+#include <string.h>
+#include "color.h"
+#include "buffer.h"
+#include "depth.h"
+#include "dispatch.h"
+#include "packed.h"
+
+#define COLOR_PACKED_CHUNK 2048  // pixels repacked through the stack at once
+
+// a packed pixel format, either 16 bit with 5 or 6 bits of green, or 4
+// bytes with the offsets of red, green, blue and alpha
+typedef struct _cPackedFormat {
+	const char *name;
+	int size;
+	int green_bits;
+	signed char offsets[4];
+} cPackedFormat;
+
+static const cPackedFormat color_packed_formats[] = {
+	{ "rgb565", 2, 6, { 0, 0, 0, 0 } },
+	{ "rgb555", 2, 5, { 0, 0, 0, 0 } },
+	{ "rgba",   4, 0, { 0, 1, 2, 3 } },
+	{ "bgra",   4, 0, { 2, 1, 0, 3 } },
+	{ "argb",   4, 0, { 1, 2, 3, 0 } },
+	{ "abgr",   4, 0, { 3, 2, 1, 0 } },
+};
+
+#define COLOR_PACKED_FORMATS (long)(sizeof(color_packed_formats)/sizeof(cPackedFormat))
+
+typedef struct _cPackOptions {
+	int  swap;      // 16 bit values are big endian
+	int  opaque;    // ignore the alpha of 4 byte pixels
+	int  premultiplied; // 4 byte pixels are premultiplied
+	int  rounding;  // narrowing to 5/6 bits
+	long width;     // rows of the dither matrix
+} cPackOptions;
+
+static const cPackedFormat *
+color_packed_format_get(VALUE name)
+{
+	if (SYMBOL_P(name)) {
+		const char *wanted = rb_id2name(SYM2ID(name));
+		for (long i = 0; i < COLOR_PACKED_FORMATS; i++) {
+			if (!strcmp(wanted, color_packed_formats[i].name)) return &color_packed_formats[i];
+		}
+	}
+	rb_raise(rb_eArgError, "Unknown pixel format, must be :rgb565, :rgb555, :rgba, :bgra, :argb or :abgr");
+	return NULL;
+}
+
+static void
+color_pack_options_get(VALUE options, cPackOptions *pack)
+{
+	VALUE endian = Qnil, width = Qnil, rounding = Qnil;
+	pack->opaque = 0;
+	pack->premultiplied = 0;
+	if (!NIL_P(options)) {
+		Check_Type(options, T_HASH);
+		endian       = rb_hash_aref(options, ID2SYM(rb_intern("endian")));
+		width        = rb_hash_aref(options, ID2SYM(rb_intern("width")));
+		rounding     = rb_hash_aref(options, ID2SYM(rb_intern("rounding")));
+		pack->opaque = RTEST(rb_hash_aref(options, ID2SYM(rb_intern("opaque"))));
+		pack->premultiplied = RTEST(rb_hash_aref(options, ID2SYM(rb_intern("premultiplied"))));
+	}
+	if (NIL_P(endian) || endian == ID2SYM(rb_intern("little"))) {
+		pack->swap = 0;
+	} else if (endian == ID2SYM(rb_intern("big"))) {
+		pack->swap = 1;
+	} else {
+		rb_raise(rb_eArgError, "Invalid endian, must be :little or :big");
+	}
+#ifdef WORDS_BIGENDIAN
+	pack->swap = !pack->swap;
+#endif
+	pack->rounding = color_rounding_get(rounding);
+	pack->width    = NIL_P(width) ? 0 : NUM2LONG(width);
+	if (pack->width < 0) {
+		rb_raise(rb_eArgError, "Invalid width, must be positive");
+	}
+}
+
+// from the format into the layout of cRGB, alpha turns from opacity into
+// transparency
+static void
+color_swizzle_unpack(const cPackedFormat *format, int opaque, cSwizzle *swizzle)
+{
+	for (int k = 0; k < 4; k++) {
+		swizzle->order[k] = format->offsets[k];
+		swizzle->flip[k]  = 0;
+	}
+	if (opaque) swizzle->order[3] = -1;
+	else        swizzle->flip[3]  = 0xff;
+}
+
+// from cRGB into the format, see color_swizzle_unpack
+static void
+color_swizzle_pack(const cPackedFormat *format, cSwizzle *swizzle)
+{
+	for (int k = 0; k < 4; k++) {
+		swizzle->order[(int)format->offsets[k]] = (signed char)k;
+		swizzle->flip[(int)format->offsets[k]]  = k == 3 ? 0xff : 0;
+	}
+}
+
+// the swizzle doing first and then second
+static void
+color_swizzle_combine(const cSwizzle *first, const cSwizzle *second, cSwizzle *swizzle)
+{
+	for (int k = 0; k < 4; k++) {
+		int from = second->order[k];
+		swizzle->order[k] = from < 0 ? -1 : first->order[from];
+		swizzle->flip[k]  = (from < 0 ? 0 : first->flip[from]) ^ second->flip[k];
+	}
+}
+
+static inline unsigned int
+color_narrow(unsigned char value, int bits, int rounding, float threshold)
+{
+	int top = (1 << bits)-1;
+	if (rounding == COLOR_ROUND_FLOOR) return value*top/255;
+	int narrow = (int)(value*top/255.0f+threshold);
+	return narrow > top ? top : narrow;
+}
+
+/*
+ * Packs length colors into 16 bit pixels, first is the index of from[0]
+ * in the image, it places the dither matrix with pack->width.
+ */
+static void
+color_pack_rgb16(const cRGB *from, unsigned short *to, long length, int green_bits, cPackOptions *pack, long first)
+{
+	if (pack->rounding == COLOR_ROUND_NEAREST) {
+		color_kernels->pack_rgb16(from, to, length, green_bits, pack->swap);
+		return;
+	}
+	for (long i = 0; i < length; i++) {
+		float threshold = pack->rounding == COLOR_ROUND_DITHER ? color_dither_threshold(first+i, pack->width) : 0;
+		unsigned int v  = color_narrow(from[i].r, 5, pack->rounding, threshold) << (5+green_bits)
+			| color_narrow(from[i].g, green_bits, pack->rounding, threshold) << 5
+			| color_narrow(from[i].b, 5, pack->rounding, threshold);
+		to[i] = (unsigned short)(pack->swap ? (v >> 8 | v << 8) : v);
+	}
+}
+
+static void
+color_pack_pixels(const cRGB *from, char *to, long length, const cPackedFormat *format, cPackOptions *pack, long first)
+{
+	cSwizzle swizzle;
+	if (format->size == 2) {
+		color_pack_rgb16(from, (unsigned short *)to, length, format->green_bits, pack, first);
+		return;
+	}
+	color_swizzle_pack(format, &swizzle);
+	color_kernels->swizzle((const unsigned char *)from, (unsigned char *)to, length, &swizzle);
+}
+
+static void
+color_unpack_pixels(const char *from, cRGB *to, long length, const cPackedFormat *format, cPackOptions *pack)
+{
+	cSwizzle swizzle;
+	if (format->size == 2) {
+		color_kernels->unpack_rgb16((const unsigned short *)from, to, length, format->green_bits, pack->swap);
+		return;
+	}
+	color_swizzle_unpack(format, pack->opaque, &swizzle);
+	color_kernels->swizzle((const unsigned char *)from, (unsigned char *)to, length, &swizzle);
+}
+
+static long
+color_packed_length(VALUE data, const cPackedFormat *format)
+{
+	StringValue(data);
+	if (RSTRING_LEN(data) % format->size) {
+		rb_raise(rb_eArgError, "Data is not a multiple of %d bytes", format->size);
+	}
+	return RSTRING_LEN(data)/format->size;
+}
+
+/*
+ *  call-seq:
+ *     Color::Buffer.unpack(data, format[, options]) -> buffer
+ *
+ *  An RGB buffer of the pixels in +data+, a binary String as it comes from
+ *  a framebuffer, screen capture or display. +format+ is one of
+ *  :rgb565, :rgb555:: 16 bit ints, red in the top bits, the top bit of
+ *                     555 is ignored
+ *  :rgba, :bgra, :argb, :abgr:: 4 bytes in this order, the alpha byte is
+ *                               the opacity (255 is opaque)
+ *  5 and 6 bit fields are scaled to 8 bit with correct rounding.
+ *  Options:
+ *  :endian:: byte order of 16 bit ints, :little (default) or :big
+ *  :opaque:: if true, the alpha byte is ignored (XRGB and the like)
+ *  :premultiplied:: if true, the pixels are premultiplied (Cairo, most
+ *                   GPU surfaces), the buffer keeps them so, see
+ *                   Color::Buffer#with_alpha
+ */
+extern VALUE
+rb_color_buffer__unpack(int argc, VALUE *argv, VALUE class)
+{
+	cBuffer *buffer;
+	cPackOptions pack;
+	VALUE data, r_format, options;
+	rb_scan_args(argc, argv, "21", &data, &r_format, &options);
+	const cPackedFormat *format = color_packed_format_get(r_format);
+	color_pack_options_get(options, &pack);
+	long length     = color_packed_length(data, format);
+	VALUE rb_buffer = color_buffer_new(COLOR_MODEL_RGB, length, &buffer);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PACK, length);
+	color_unpack_pixels(RSTRING_PTR(data), (cRGB *)buffer->data, length, format, &pack);
+	if (pack.premultiplied && format->size == 4) buffer->alpha = COLOR_ALPHA_PREMULTIPLIED;
+	return rb_buffer;
+}
+
+/*
+ *  call-seq:
+ *     buffer.pack(format[, options]) -> string
+ *
+ *  The colors of this RGB buffer as pixels of +format+, see
+ *  Color::Buffer::unpack. 8 bit channels are narrowed to 5 and 6 bits
+ *  with correct rounding. A premultiplied buffer (see #with_alpha) gives
+ *  premultiplied pixels.
+ *  Options:
+ *  :endian:: byte order of 16 bit ints, :little (default) or :big
+ *  :rounding:: narrowing to 16 bit, :round (default), :floor or :dither
+ *  :width:: the row width, places the 4x4 dither matrix
+ */
+extern VALUE
+rb_color_buffer_pack(int argc, VALUE *argv, VALUE self)
+{
+	cPackOptions pack;
+	VALUE r_format, options;
+	rb_scan_args(argc, argv, "11", &r_format, &options);
+	cBuffer *buffer             = color_buffer_get_alpha(self, COLOR_MODEL_RGB, COLOR_ALPHA_PREMULTIPLIED);
+	const cPackedFormat *format = color_packed_format_get(r_format);
+	color_pack_options_get(options, &pack);
+	VALUE data = rb_str_new(NULL, buffer->length*format->size);
+	if (!pack.width) pack.width = buffer->length > 0 ? buffer->length : 1;
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PACK, buffer->length);
+	color_pack_pixels((cRGB *)buffer->data, RSTRING_PTR(data), buffer->length, format, &pack, 0);
+	return data;
+}
+
+/*
+ *  call-seq:
+ *     Color::Buffer.repack(data, from, to[, options]) -> string
+ *
+ *  Converts the pixels in +data+ from one format to another without a
+ *  buffer in between, same as unpack followed by pack. 4 byte formats are
+ *  reordered in a single pass. Takes the options of both.
+ *
+ *  Example:
+ *    Color::Buffer.repack(capture, :bgra, :rgb565, :rounding => :dither, :width => 1920)
+ */
+extern VALUE
+rb_color_buffer__repack(int argc, VALUE *argv, VALUE class)
+{
+	cPackOptions pack;
+	cSwizzle unpack_swizzle, pack_swizzle, swizzle;
+	cRGB chunk[COLOR_PACKED_CHUNK];
+	VALUE data, r_from, r_to, options;
+	rb_scan_args(argc, argv, "31", &data, &r_from, &r_to, &options);
+	const cPackedFormat *from = color_packed_format_get(r_from);
+	const cPackedFormat *to   = color_packed_format_get(r_to);
+	color_pack_options_get(options, &pack);
+	long length = color_packed_length(data, from);
+	VALUE result = rb_str_new(NULL, length*to->size);
+	char *in = RSTRING_PTR(data), *out = RSTRING_PTR(result);
+	if (!pack.width) pack.width = length > 0 ? length : 1;
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PACK, length);
+	if (from->size == 4 && to->size == 4) {
+		color_swizzle_unpack(from, pack.opaque, &unpack_swizzle);
+		color_swizzle_pack(to, &pack_swizzle);
+		color_swizzle_combine(&unpack_swizzle, &pack_swizzle, &swizzle);
+		color_kernels->swizzle((const unsigned char *)in, (unsigned char *)out, length, &swizzle);
+		return result;
+	}
+	for (long i = 0; i < length; i += COLOR_PACKED_CHUNK) {
+		long count = length-i < COLOR_PACKED_CHUNK ? length-i : COLOR_PACKED_CHUNK;
+		color_unpack_pixels(in+i*from->size, chunk, count, from, &pack);
+		color_pack_pixels(chunk, out+i*to->size, count, to, &pack, i);
+	}
+	return result;
+}
@@ -0,0 +1,3 @@
+extern VALUE rb_color_buffer__unpack(int argc, VALUE *argv, VALUE class);
+extern VALUE rb_color_buffer__repack(int argc, VALUE *argv, VALUE class);
+extern VALUE rb_color_buffer_pack(int argc, VALUE *argv, VALUE self);
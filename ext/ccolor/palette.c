@@ -0,0 +1,446 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "color.h"
+#include "buffer.h"
+#include "convert.h"
+#include "quantize.h"
+#include "palette.h"
+#include "threads.h"
+#include "dispatch.h"
+
+typedef struct _cPaletteIndex {
+	cColorPalette *palette;
+	cRGB          *from;
+	unsigned char *to;
+} cPaletteIndex;
+
+static void
+color_palette_grid_free(cPaletteGrid *grid)
+{
+	if (grid->offsets)    xfree(grid->offsets);
+	if (grid->candidates) xfree(grid->candidates);
+	memset(grid, 0, sizeof(cPaletteGrid));
+}
+
+static void
+color_palette_free(cColorPalette *palette)
+{
+	color_palette_grid_free(&palette->grid);
+	xfree(palette);
+}
+
+/*
+ * Fills a palette from an array of colors or a buffer, not compiled.
+ */
+extern void
+color_palette_init(cColorPalette *palette, VALUE colors)
+{
+	long size = color_palette_from(colors, palette->colors);
+	color_palette_planes(palette->colors, size, &palette->planes);
+	memset(&palette->grid, 0, sizeof(cPaletteGrid));
+}
+
+/*
+ * Squared distances from value to the nearest and the farthest point of
+ * every cell [cell*step, (cell+1)*step] of one channel, per entry.
+ */
+static void
+color_palette_axis(cColorPalette *palette, int channel, int cells, int step, long *near, long *far)
+{
+	long size = palette->planes.size;
+	for (int cell = 0; cell < cells; cell++) {
+		long low = cell*step, high = low+step;
+		for (long i = 0; i < size; i++) {
+			cRGB *color = &palette->colors[i];
+			long value  = channel == 0 ? color->r : channel == 1 ? color->g : channel == 2 ? color->b : color->alpha;
+			long in     = value < low ? low-value : (value > high ? value-high : 0);
+			long out    = value-low > high-value ? value-low : high-value;
+			near[cell*size+i] = in*in;
+			far[cell*size+i]  = out*out;
+		}
+	}
+}
+
+/*
+ * Builds the grid. An entry is a candidate of a cell unless its smallest
+ * squared distance to the cell exceeds the largest squared distance of
+ * some other entry, so the nearest entry of every color in the cell is
+ * among the candidates. When all entries share their alpha it adds the
+ * same to every distance and only RGB is split into cells.
+ */
+extern void
+color_palette_compile(cColorPalette *palette, int resolution)
+{
+	clock_t started  = clock();
+	cPaletteGrid *grid = &palette->grid;
+	long size        = palette->planes.size;
+	int  step        = 256/resolution;
+	int  alpha_cells = 1;
+	long cells, capacity, total = 0;
+	int  most = 0;
+
+	for (long i = 1; i < size; i++) {
+		if (palette->colors[i].alpha != palette->colors[0].alpha) alpha_cells = 4;
+	}
+	color_palette_grid_free(grid);
+	cells = (long)resolution*resolution*resolution*alpha_cells;
+
+	long *near     = ALLOC_N(long, 8*resolution*size);
+	long *far      = near+4*resolution*size;
+	long *bound    = ALLOC_N(long, size);
+	unsigned int  *offsets    = ALLOC_N(unsigned int, cells+1);
+	unsigned char *candidates = ALLOC_N(unsigned char, capacity = cells*4);
+	for (int channel = 0; channel < 3; channel++) {
+		color_palette_axis(palette, channel, resolution, step, near+channel*resolution*size, far+channel*resolution*size);
+	}
+	color_palette_axis(palette, 3, alpha_cells, 256/alpha_cells, near+3*resolution*size, far+3*resolution*size);
+
+	long cell = 0;
+	for (int r = 0; r < resolution; r++) {
+		for (int g = 0; g < resolution; g++) {
+			for (int b = 0; b < resolution; b++) {
+				for (int a = 0; a < alpha_cells; a++, cell++) {
+					long *near_r = near+r*size, *near_g = near+(resolution+g)*size, *near_b = near+(2*resolution+b)*size;
+					long *far_r  = far+r*size,  *far_g  = far+(resolution+g)*size,  *far_b  = far+(2*resolution+b)*size;
+					long *near_a = near+(3*resolution+a)*size, *far_a = far+(3*resolution+a)*size;
+					long best    = -1;
+					for (long i = 0; i < size; i++) {
+						long limit = far_r[i]+far_g[i]+far_b[i]+(alpha_cells > 1 ? far_a[i] : 0);
+						bound[i]   = near_r[i]+near_g[i]+near_b[i]+(alpha_cells > 1 ? near_a[i] : 0);
+						if (best < 0 || limit < best) best = limit;
+					}
+					if (total+size > capacity) {
+						capacity = (capacity+size)*2;
+						REALLOC_N(candidates, unsigned char, capacity);
+					}
+					offsets[cell] = (unsigned int)total;
+					for (long i = 0; i < size; i++) {
+						if (bound[i] <= best) candidates[total++] = (unsigned char)i;
+					}
+					if (total-offsets[cell] > most) most = (int)(total-offsets[cell]);
+				}
+			}
+		}
+	}
+	offsets[cells] = (unsigned int)total;
+	xfree(near);
+	xfree(bound);
+
+	grid->resolution  = resolution;
+	grid->shift       = resolution == 16 ? 4 : 3;
+	grid->alpha_cells = alpha_cells;
+	grid->offsets     = offsets;
+	grid->candidates  = candidates;
+	grid->total       = total;
+	grid->most        = most;
+	grid->seconds     = (double)(clock()-started)/CLOCKS_PER_SEC;
+}
+
+// the nearest of the candidates of the cell of a color within 0..255
+static inline long
+color_palette_grid_nearest(cColorPalette *palette, long cell, float r, float g, float b, float alpha)
+{
+	cPaletteGrid *grid       = &palette->grid;
+	unsigned char *candidate = grid->candidates+grid->offsets[cell];
+	unsigned char *end       = grid->candidates+grid->offsets[cell+1];
+	long  best     = *candidate;
+	float best_sum = INFINITY;
+	if (end-candidate == 1) return best;
+	for (; candidate < end; candidate++) {
+		float dr  = r-palette->planes.r[*candidate];
+		float dg  = g-palette->planes.g[*candidate];
+		float db  = b-palette->planes.b[*candidate];
+		float da  = alpha-palette->planes.alpha[*candidate];
+		float sum = dr*dr+dg*dg+db*db+da*da;
+		if (sum < best_sum) {
+			best_sum = sum;
+			best     = *candidate;
+		}
+	}
+	return best;
+}
+
+static inline long
+color_palette_cell(cPaletteGrid *grid, long r, long g, long b, long alpha)
+{
+	long cell = (((r >> grid->shift)*grid->resolution+(g >> grid->shift))*grid->resolution+(b >> grid->shift));
+	return grid->alpha_cells > 1 ? cell*grid->alpha_cells+(alpha >> 6) : cell;
+}
+
+/*
+ * Index of the entry nearest to the given values (0..255), same result as
+ * color_palette_nearest. Compiled palettes only compare the candidates of
+ * the cell, values outside 0..255 (dithering) search all entries.
+ */
+extern long
+color_palette_lookup(cColorPalette *palette, float r, float g, float b, float alpha)
+{
+	cPaletteGrid *grid = &palette->grid;
+	if (grid->resolution && r >= 0 && r < 256 && g >= 0 && g < 256 && b >= 0 && b < 256 && alpha >= 0 && alpha < 256) {
+		return color_palette_grid_nearest(palette, color_palette_cell(grid, (long)r, (long)g, (long)b, (long)alpha), r, g, b, alpha);
+	}
+	return color_palette_nearest(&palette->planes, r, g, b, alpha);
+}
+
+static void
+color_palette_index_slice(void *arg, long from, long to)
+{
+	cPaletteIndex *index   = arg;
+	cColorPalette *palette = index->palette;
+	for (long i = from; i < to; i++) {
+		cRGB *color = &index->from[i];
+		long nearest;
+		if (palette->grid.resolution) {
+			long cell = color_palette_cell(&palette->grid, color->r, color->g, color->b, color->alpha);
+			nearest   = color_palette_grid_nearest(palette, cell, color->r, color->g, color->b, color->alpha);
+		} else {
+			nearest   = color_palette_nearest(&palette->planes, color->r, color->g, color->b, color->alpha);
+		}
+		index->to[i] = (unsigned char)nearest;
+	}
+}
+
+/*
+ * Writes the index of the nearest entry of every color to to.
+ */
+extern void
+color_palette_index_buffer(cColorPalette *palette, cRGB *from, unsigned char *to, long length, int threads)
+{
+	cPaletteIndex index;
+	index.palette = palette;
+	index.from    = from;
+	index.to      = to;
+	color_parallel(color_palette_index_slice, &index, length, threads);
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_palette__allocate(VALUE class)
+{
+	cColorPalette *palette;
+	VALUE rb_palette = COLOR_MAKE_STRUCT(class, cColorPalette, NULL, color_palette_free, palette);
+	memset(palette, 0, sizeof(cColorPalette));
+	return rb_palette;
+}
+
+/*
+ *  call-seq:
+ *     Color::Palette.new(colors)
+ *
+ *  Create a palette of 1 to 256 colors, an array of colors of any model or
+ *  a buffer. The colors are stored as RGB.
+ */
+extern VALUE
+rb_color_palette_initialize(VALUE self, VALUE colors)
+{
+	cColorPalette *palette;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	color_palette_grid_free(&palette->grid);
+	color_palette_init(palette, colors);
+	return self;
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_palette_initialize_copy(VALUE self, VALUE original)
+{
+	cColorPalette *palette, *source;
+	long cells;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	COLOR_GET_STRUCT(original, cColorPalette, source);
+	if (palette == source) return self;
+	color_palette_grid_free(&palette->grid);
+	memcpy(palette, source, sizeof(cColorPalette));
+	if (source->grid.resolution) {
+		cells = (long)source->grid.resolution*source->grid.resolution*source->grid.resolution*source->grid.alpha_cells;
+		palette->grid.offsets    = ALLOC_N(unsigned int, cells+1);
+		palette->grid.candidates = ALLOC_N(unsigned char, source->grid.total > 0 ? source->grid.total : 1);
+		memcpy(palette->grid.offsets, source->grid.offsets, (cells+1)*sizeof(unsigned int));
+		memcpy(palette->grid.candidates, source->grid.candidates, source->grid.total);
+	}
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     palette.size -> integer
+ *
+ *  The number of colors.
+ */
+extern VALUE
+rb_color_palette_size(VALUE self)
+{
+	cColorPalette *palette;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	return LONG2NUM(palette->planes.size);
+}
+
+/*
+ *  call-seq:
+ *     palette[index] -> rgb
+ *
+ *  The color at +index+ as Color::RGB, nil if out of bounds.
+ */
+extern VALUE
+rb_color_palette_aref(VALUE self, VALUE index)
+{
+	cColorPalette *palette;
+	cRGB *color;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	long i = NUM2LONG(index);
+	if (i < 0) i += palette->planes.size;
+	if (i < 0 || i >= palette->planes.size) return Qnil;
+	VALUE rb_color = color_model_new(COLOR_MODEL_RGB, (void **)&color);
+	*color = palette->colors[i];
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     palette.to_a -> array
+ *
+ *  The colors as Color::RGB.
+ */
+extern VALUE
+rb_color_palette_to_a(VALUE self)
+{
+	cColorPalette *palette;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	VALUE colors = rb_ary_new2(palette->planes.size);
+	for (long i = 0; i < palette->planes.size; i++) {
+		rb_ary_push(colors, rb_color_palette_aref(self, LONG2NUM(i)));
+	}
+	return colors;
+}
+
+/*
+ *  call-seq:
+ *     palette.nearest(color) -> integer
+ *
+ *  The index of the color closest to +color+ (any model), same metric as
+ *  Color::RGB#distance, ties go to the lower index.
+ */
+extern VALUE
+rb_color_palette_nearest(VALUE self, VALUE color)
+{
+	cColorPalette *palette;
+	cRGB rgb;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	color_buffer_store(COLOR_MODEL_RGB, &rgb, color);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PALETTE, 1);
+	return LONG2NUM(color_palette_lookup(palette, rgb.r, rgb.g, rgb.b, rgb.alpha));
+}
+
+/*
+ *  call-seq:
+ *     palette.closest(color) -> rgb
+ *
+ *  The color closest to +color+, see Color::Palette#nearest.
+ */
+extern VALUE
+rb_color_palette_closest(VALUE self, VALUE color)
+{
+	return rb_color_palette_aref(self, rb_color_palette_nearest(self, color));
+}
+
+/*
+ *  call-seq:
+ *     palette.indices(buffer[, options]) -> string
+ *
+ *  The index of the closest color for every color of an RGB buffer, as a
+ *  binary String (unpack("C*")), like Color::Buffer#quantize without
+ *  dithering.
+ *  Options:
+ *  :threads:: number of native threads to spread large buffers over
+ */
+extern VALUE
+rb_color_palette_indices(int argc, VALUE *argv, VALUE self)
+{
+	cColorPalette *palette;
+	VALUE rb_buffer, options;
+	rb_scan_args(argc, argv, "11", &rb_buffer, &options);
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	cBuffer *buffer = color_buffer_get(rb_buffer, COLOR_MODEL_RGB);
+	int threads     = color_threads_get(options);
+
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PALETTE, buffer->length);
+	VALUE indices = rb_str_new(NULL, buffer->length);
+	color_palette_index_buffer(palette, (cRGB *)buffer->data, (unsigned char *)RSTRING_PTR(indices), buffer->length, threads);
+	return indices;
+}
+
+/*
+ *  call-seq:
+ *     palette.compile(resolution=16) -> palette
+ *
+ *  Splits RGB into resolution**3 cells (16 or 32) and keeps, per cell, the
+ *  colors which can be the closest to any color in it. Lookups then only
+ *  compare those few candidates, with the same results. Worth it for
+ *  palettes queried many times, see Color::Palette#compile_info for the
+ *  cost.
+ */
+extern VALUE
+rb_color_palette_compile(int argc, VALUE *argv, VALUE self)
+{
+	cColorPalette *palette;
+	VALUE r_resolution;
+	rb_scan_args(argc, argv, "01", &r_resolution);
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	int resolution = NIL_P(r_resolution) ? 16 : NUM2INT(r_resolution);
+	if (resolution != 16 && resolution != 32) {
+		rb_raise(rb_eArgError, "Invalid resolution, must be 16 or 32");
+	}
+	if (palette->planes.size == 0) {
+		rb_raise(rb_eArgError, "Palette is empty");
+	}
+	color_palette_compile(palette, resolution);
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     palette.compiled? -> true or false
+ *
+ *  Whether Color::Palette#compile was called.
+ */
+extern VALUE
+rb_color_palette_compiled(VALUE self)
+{
+	cColorPalette *palette;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	return palette->grid.resolution ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *     palette.compile_info -> hash or nil
+ *
+ *  Describes the grid of a compiled palette: :resolution, :cells (alpha
+ *  is split into 4 when the colors differ in it), :candidates (in total),
+ *  :average and :most candidates per cell, :bytes of memory and the
+ *  :seconds compiling took. nil unless compiled.
+ */
+extern VALUE
+rb_color_palette_compile_info(VALUE self)
+{
+	cColorPalette *palette;
+	COLOR_GET_STRUCT(self, cColorPalette, palette);
+	cPaletteGrid *grid = &palette->grid;
+	if (!grid->resolution) return Qnil;
+	long cells = (long)grid->resolution*grid->resolution*grid->resolution*grid->alpha_cells;
+	VALUE info = rb_hash_new();
+	rb_hash_aset(info, ID2SYM(rb_intern("resolution")), INT2NUM(grid->resolution));
+	rb_hash_aset(info, ID2SYM(rb_intern("cells")),      LONG2NUM(cells));
+	rb_hash_aset(info, ID2SYM(rb_intern("candidates")), LONG2NUM(grid->total));
+	rb_hash_aset(info, ID2SYM(rb_intern("average")),    rb_float_new((double)grid->total/cells));
+	rb_hash_aset(info, ID2SYM(rb_intern("most")),       INT2NUM(grid->most));
+	rb_hash_aset(info, ID2SYM(rb_intern("bytes")),      LONG2NUM((cells+1)*sizeof(unsigned int)+grid->total));
+	rb_hash_aset(info, ID2SYM(rb_intern("seconds")),    rb_float_new(grid->seconds));
+	return info;
+}
@@ -0,0 +1,16 @@
+extern void color_palette_init(cColorPalette *palette, VALUE colors);
+extern void color_palette_compile(cColorPalette *palette, int resolution);
+extern long color_palette_lookup(cColorPalette *palette, float r, float g, float b, float alpha);
+extern void color_palette_index_buffer(cColorPalette *palette, cRGB *from, unsigned char *to, long length, int threads);
+extern VALUE rb_color_palette__allocate(VALUE class);
+extern VALUE rb_color_palette_initialize(VALUE self, VALUE colors);
+extern VALUE rb_color_palette_initialize_copy(VALUE self, VALUE original);
+extern VALUE rb_color_palette_size(VALUE self);
+extern VALUE rb_color_palette_aref(VALUE self, VALUE index);
+extern VALUE rb_color_palette_to_a(VALUE self);
+extern VALUE rb_color_palette_nearest(VALUE self, VALUE color);
+extern VALUE rb_color_palette_closest(VALUE self, VALUE color);
+extern VALUE rb_color_palette_indices(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_palette_compile(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_palette_compiled(VALUE self);
+extern VALUE rb_color_palette_compile_info(VALUE self);
@@ -0,0 +1,229 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "buffer.h"
+#include "dispatch.h"
+#include "planar.h"
+#include "tools.h"
+
+// a planar video frame: Y' at full size, Cb and Cr reduced by 1 << shift
+typedef struct _cPlanar {
+	long width, height;
+	int  shift_x, shift_y;
+	long chroma_width, chroma_height;
+	cYCbCrMatrix matrix;
+} cPlanar;
+
+static inline int
+color_fixed(double value)
+{
+	return (int)floor(value*(1 << 14)+0.5);
+}
+
+/*
+ * The coefficients for luma weights kr and kb, with limited (video) or
+ * full range. Limited range puts Y' into 16..235 and Cb/Cr into 16..240.
+ */
+static void
+color_ycbcr_matrix(cYCbCrMatrix *matrix, double kr, double kb, int limited)
+{
+	double kg     = 1-kr-kb;
+	double scale  = limited ? 219.0/255 : 1;
+	double chroma = limited ? 224.0/255 : 1;
+	matrix->y[0]  = color_fixed(kr*scale);
+	matrix->y[1]  = color_fixed(kg*scale);
+	matrix->y[2]  = color_fixed(kb*scale);
+	matrix->cb[0] = color_fixed(-kr/(2*(1-kb))*chroma);
+	matrix->cb[1] = color_fixed(-kg/(2*(1-kb))*chroma);
+	matrix->cb[2] = color_fixed(0.5*chroma);
+	matrix->cr[0] = color_fixed(0.5*chroma);
+	matrix->cr[1] = color_fixed(-kg/(2*(1-kr))*chroma);
+	matrix->cr[2] = color_fixed(-kb/(2*(1-kr))*chroma);
+	matrix->y_offset = limited ? 16 : 0;
+	matrix->luma  = color_fixed(1/scale);
+	matrix->cr_r  = color_fixed(2*(1-kr)/chroma);
+	matrix->cb_g  = color_fixed(-2*kb*(1-kb)/kg/chroma);
+	matrix->cr_g  = color_fixed(-2*kr*(1-kr)/kg/chroma);
+	matrix->cb_b  = color_fixed(2*(1-kb)/chroma);
+}
+
+static void
+color_planar_init(cPlanar *planar, long width, long height, VALUE options)
+{
+	VALUE subsampling = Qnil, matrix = Qnil, range = Qnil;
+	int limited;
+	if (!NIL_P(options)) {
+		Check_Type(options, T_HASH);
+		subsampling = rb_hash_aref(options, ID2SYM(rb_intern("subsampling")));
+		matrix      = rb_hash_aref(options, ID2SYM(rb_intern("matrix")));
+		range       = rb_hash_aref(options, ID2SYM(rb_intern("range")));
+	}
+	if (width <= 0 || height <= 0) {
+		rb_raise(rb_eArgError, "Invalid size, width and height must be positive");
+	}
+	if (NIL_P(subsampling) || subsampling == ID2SYM(rb_intern("yuv420"))) {
+		planar->shift_x = planar->shift_y = 1;
+	} else if (subsampling == ID2SYM(rb_intern("yuv422"))) {
+		planar->shift_x = 1;
+		planar->shift_y = 0;
+	} else if (subsampling == ID2SYM(rb_intern("yuv444"))) {
+		planar->shift_x = planar->shift_y = 0;
+	} else {
+		rb_raise(rb_eArgError, "Unknown subsampling, must be :yuv420, :yuv422 or :yuv444");
+	}
+	if (NIL_P(range) || range == ID2SYM(rb_intern("limited"))) {
+		limited = 1;
+	} else if (range == ID2SYM(rb_intern("full"))) {
+		limited = 0;
+	} else {
+		rb_raise(rb_eArgError, "Unknown range, must be :limited or :full");
+	}
+	if (NIL_P(matrix) || matrix == ID2SYM(rb_intern("bt601"))) {
+		color_ycbcr_matrix(&planar->matrix, 0.299, 0.114, limited);
+	} else if (matrix == ID2SYM(rb_intern("bt709"))) {
+		color_ycbcr_matrix(&planar->matrix, 0.2126, 0.0722, limited);
+	} else {
+		rb_raise(rb_eArgError, "Unknown matrix, must be :bt601 or :bt709");
+	}
+	// the frame, the RGB buffer and the row scratch space must fit a long
+	color_size_mul(color_size_mul(width, height), 3);
+	color_size_mul(width, 4*sizeof(unsigned short));
+	planar->width         = width;
+	planar->height        = height;
+	planar->chroma_width  = (width+(1 << planar->shift_x)-1) >> planar->shift_x;
+	planar->chroma_height = (height+(1 << planar->shift_y)-1) >> planar->shift_y;
+}
+
+// the plane sizes in bytes
+static inline long
+color_planar_luma_size(cPlanar *planar)
+{
+	return planar->width*planar->height;
+}
+
+static inline long
+color_planar_chroma_size(cPlanar *planar)
+{
+	return planar->chroma_width*planar->chroma_height;
+}
+
+/*
+ *  call-seq:
+ *     Color::Buffer.from_planar(planes, width, height[, options]) -> buffer
+ *
+ *  An RGB buffer of a planar Y'CbCr (YUV) frame, +planes+ is either one
+ *  String with the Y', Cb and Cr planes one after another (I420, I422) or
+ *  an Array of three Strings. Chroma is upsampled by repeating it.
+ *  Options:
+ *  :subsampling:: :yuv420 (default, chroma halved in both directions),
+ *                 :yuv422 (halved horizontally) or :yuv444
+ *  :matrix:: :bt601 (default, SD video and JPEG) or :bt709 (HD video)
+ *  :range:: :limited (default, Y' in 16..235) or :full
+ *  Conversions use fixed point integer math.
+ */
+extern VALUE
+rb_color_buffer__from_planar(int argc, VALUE *argv, VALUE class)
+{
+	cBuffer *buffer;
+	cPlanar  planar;
+	VALUE planes, width, height, options, y, cb, cr;
+	rb_scan_args(argc, argv, "31", &planes, &width, &height, &options);
+	color_planar_init(&planar, NUM2LONG(width), NUM2LONG(height), options);
+	long luma_size = color_planar_luma_size(&planar), chroma_size = color_planar_chroma_size(&planar);
+	if (TYPE(planes) == T_ARRAY) {
+		if (RARRAY_LEN(planes) != 3) {
+			rb_raise(rb_eArgError, "Expected 3 planes, got %ld", RARRAY_LEN(planes));
+		}
+		y  = StringValue(RARRAY_PTR(planes)[0]);
+		cb = StringValue(RARRAY_PTR(planes)[1]);
+		cr = StringValue(RARRAY_PTR(planes)[2]);
+	} else {
+		y = cb = cr = StringValue(planes);
+		if (RSTRING_LEN(y) != luma_size+2*chroma_size) {
+			rb_raise(rb_eArgError, "Expected %ld bytes, got %ld", luma_size+2*chroma_size, RSTRING_LEN(y));
+		}
+	}
+	if (RSTRING_LEN(y) < luma_size || RSTRING_LEN(cb) < chroma_size || RSTRING_LEN(cr) < chroma_size) {
+		rb_raise(rb_eArgError, "Planes are too small for %ldx%ld", planar.width, planar.height);
+	}
+	const unsigned char *luma   = (unsigned char *)RSTRING_PTR(y);
+	const unsigned char *blue   = (unsigned char *)RSTRING_PTR(cb)+(cb == y ? luma_size : 0);
+	const unsigned char *red    = (unsigned char *)RSTRING_PTR(cr)+(cr == y ? luma_size+chroma_size : 0);
+	VALUE rb_buffer = color_buffer_new(COLOR_MODEL_RGB, luma_size, &buffer);
+	cRGB *to        = (cRGB *)buffer->data;
+	unsigned char *row_cb = ALLOC_N(unsigned char, 2*planar.width);
+	unsigned char *row_cr = row_cb+planar.width;
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PLANAR, luma_size);
+	for (long row = 0; row < planar.height; row++) {
+		const unsigned char *from_cb = blue+(row >> planar.shift_y)*planar.chroma_width;
+		const unsigned char *from_cr = red+(row >> planar.shift_y)*planar.chroma_width;
+		if (planar.shift_x) {
+			for (long x = 0; x < planar.width; x++) {
+				row_cb[x] = from_cb[x >> 1];
+				row_cr[x] = from_cr[x >> 1];
+			}
+			from_cb = row_cb;
+			from_cr = row_cr;
+		}
+		color_kernels->ycbcr_to_rgb(luma+row*planar.width, from_cb, from_cr, to+row*planar.width, planar.width, &planar.matrix);
+	}
+	xfree(row_cb);
+	return rb_buffer;
+}
+
+/*
+ *  call-seq:
+ *     buffer.to_planar(width[, options]) -> [y, cb, cr]
+ *
+ *  The Y', Cb and Cr planes of this RGB buffer as an image of +width+
+ *  columns, as binary Strings. Chroma is downsampled by averaging, the
+ *  options are those of Color::Buffer::from_planar.
+ *  <code>buffer.to_planar(640).join</code> is an I420 frame.
+ */
+extern VALUE
+rb_color_buffer_to_planar(int argc, VALUE *argv, VALUE self)
+{
+	cPlanar planar;
+	VALUE width, options;
+	rb_scan_args(argc, argv, "11", &width, &options);
+	cBuffer *buffer = color_buffer_get(self, COLOR_MODEL_RGB);
+	long columns    = NUM2LONG(width);
+	if (columns <= 0 || buffer->length % columns) {
+		rb_raise(rb_eArgError, "Buffer length %ld is not a multiple of the width", buffer->length);
+	}
+	color_planar_init(&planar, columns, buffer->length/columns, options);
+	VALUE y  = rb_str_new(NULL, color_planar_luma_size(&planar));
+	VALUE cb = rb_str_new(NULL, color_planar_chroma_size(&planar));
+	VALUE cr = rb_str_new(NULL, color_planar_chroma_size(&planar));
+	const cRGB *from     = (cRGB *)buffer->data;
+	unsigned char *luma  = (unsigned char *)RSTRING_PTR(y);
+	unsigned char *blue  = (unsigned char *)RSTRING_PTR(cb);
+	unsigned char *red   = (unsigned char *)RSTRING_PTR(cr);
+	// full width Cb and Cr of up to two rows, in 1/64 steps
+	unsigned short *rows = ALLOC_N(unsigned short, 4*planar.width);
+	unsigned short *row_cb[2] = { rows, rows+planar.width };
+	unsigned short *row_cr[2] = { rows+2*planar.width, rows+3*planar.width };
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PLANAR, buffer->length);
+	for (long chroma_row = 0; chroma_row < planar.chroma_height; chroma_row++) {
+		long row   = chroma_row << planar.shift_y;
+		int  count = planar.shift_y && row+1 < planar.height ? 2 : 1;
+		for (int i = 0; i < count; i++) {
+			color_kernels->rgb_to_ycbcr(from+(row+i)*planar.width, luma+(row+i)*planar.width, row_cb[i], row_cr[i], planar.width, &planar.matrix);
+		}
+		unsigned char *to_cb = blue+chroma_row*planar.chroma_width, *to_cr = red+chroma_row*planar.chroma_width;
+		for (long x = 0; x < planar.chroma_width; x++) {
+			long first = x << planar.shift_x, last = planar.shift_x && first+1 < planar.width ? first+1 : first;
+			int  samples = count*(int)(last-first+1);
+			int  sum_cb = 0, sum_cr = 0;
+			for (int i = 0; i < count; i++) {
+				sum_cb += row_cb[i][first]+(last != first ? row_cb[i][last] : 0);
+				sum_cr += row_cr[i][first]+(last != first ? row_cr[i][last] : 0);
+			}
+			to_cb[x] = (unsigned char)((sum_cb+samples*32)/(samples*64));
+			to_cr[x] = (unsigned char)((sum_cr+samples*32)/(samples*64));
+		}
+	}
+	xfree(rows);
+	return rb_ary_new3(3, y, cb, cr);
+}
@@ -0,0 +1,2 @@
+extern VALUE rb_color_buffer__from_planar(int argc, VALUE *argv, VALUE class);
+extern VALUE rb_color_buffer_to_planar(int argc, VALUE *argv, VALUE self);
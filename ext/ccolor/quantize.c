@@ -0,0 +1,207 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "buffer.h"
+#include "depth.h"
+#include "quantize.h"
+#include "palette.h"
+#include "dispatch.h"
+
+typedef struct _cDiffusion {
+	int   dx;     // column offset
+	int   dy;     // row offset, 0..2
+	float weight; // share of the error
+} cDiffusion;
+
+static const cDiffusion color_floyd_steinberg[] = {
+	{ 1, 0, 7/16.0f }, { -1, 1, 3/16.0f }, { 0, 1, 5/16.0f }, { 1, 1, 1/16.0f },
+};
+
+// Atkinson drops 1/4 of the error, which keeps contrast at the cost of detail
+static const cDiffusion color_atkinson[] = {
+	{ 1, 0, 1/8.0f }, { 2, 0, 1/8.0f },
+	{ -1, 1, 1/8.0f }, { 0, 1, 1/8.0f }, { 1, 1, 1/8.0f },
+	{ 0, 2, 1/8.0f },
+};
+
+/*
+ * Accepts nil/:none, :floyd_steinberg, :atkinson or :bayer, raises
+ * ArgumentError otherwise.
+ */
+extern int
+color_dither_get(VALUE spec)
+{
+	if (NIL_P(spec) || spec == ID2SYM(rb_intern("none"))) return COLOR_DITHER_NONE;
+	if (spec == ID2SYM(rb_intern("floyd_steinberg")))     return COLOR_DITHER_FLOYD_STEINBERG;
+	if (spec == ID2SYM(rb_intern("atkinson")))            return COLOR_DITHER_ATKINSON;
+	if (spec == ID2SYM(rb_intern("bayer")))               return COLOR_DITHER_BAYER;
+	rb_raise(rb_eArgError, "Unknown dither, must be :none, :floyd_steinberg, :atkinson or :bayer");
+	return COLOR_DITHER_NONE;
+}
+
+/*
+ * Copies an array of colors or a buffer into to (COLOR_PALETTE_MAX entries),
+ * coercing to RGB. Returns the number of colors.
+ */
+extern long
+color_palette_from(VALUE palette, cRGB *to)
+{
+	long size;
+	if (CLASS_OF(palette) == rb_cBuffer) {
+		palette = rb_funcall(palette, rb_intern("to_a"), 0);
+	}
+	Check_Type(palette, T_ARRAY);
+	size = RARRAY_LEN(palette);
+	if (size < 1 || size > COLOR_PALETTE_MAX) {
+		rb_raise(rb_eArgError, "Palette must have 1 to %d colors", COLOR_PALETTE_MAX);
+	}
+	for (long i = 0; i < size; i++) {
+		color_buffer_store(COLOR_MODEL_RGB, &to[i], RARRAY_PTR(palette)[i]);
+	}
+	return size;
+}
+
+/*
+ * Spreads a palette into float planes for color_palette_nearest.
+ */
+extern void
+color_palette_planes(cRGB *palette, long size, cPalette *planes)
+{
+	long padded = (size+15)&~15L;
+	planes->size = size;
+	for (long i = 0; i < padded; i++) {
+		planes->r[i]     = i < size ? palette[i].r     : NAN;
+		planes->g[i]     = i < size ? palette[i].g     : NAN;
+		planes->b[i]     = i < size ? palette[i].b     : NAN;
+		planes->alpha[i] = i < size ? palette[i].alpha : NAN;
+	}
+}
+
+/*
+ * Index of the palette entry closest to the given values (0..255), same
+ * ordering as color_rgb_distance. Ties go to the lower index.
+ */
+extern long
+color_palette_nearest(cPalette *palette, float r, float g, float b, float alpha)
+{
+	return color_kernels->nearest(palette, r, g, b, alpha);
+}
+
+static void
+color_quantize_diffuse(cRGB *from, unsigned char *to, long length, long width, cColorPalette *palette, const cDiffusion *kernel, int taps)
+{
+	// three rows of r,g,b errors, padded by 2 columns on each side
+	long   stride = (width+4)*3;
+	float *rows   = ALLOC_N(float, stride*3);
+	float *row[3] = { rows, rows+stride, rows+2*stride };
+	memset(rows, 0, stride*3*sizeof(float));
+
+	for (long start = 0; start < length; start += width) {
+		long end = start+width < length ? start+width : length;
+		for (long i = start; i < end; i++) {
+			float *err = row[0]+(i-start+2)*3;
+			float r    = color_capf(from[i].r+err[0], 0, 255);
+			float g    = color_capf(from[i].g+err[1], 0, 255);
+			float b    = color_capf(from[i].b+err[2], 0, 255);
+			long index = color_palette_lookup(palette, r, g, b, from[i].alpha);
+			to[i]      = (unsigned char)index;
+
+			r -= palette->colors[index].r;
+			g -= palette->colors[index].g;
+			b -= palette->colors[index].b;
+			for (int t = 0; t < taps; t++) {
+				float *cell = row[kernel[t].dy]+(i-start+2+kernel[t].dx)*3;
+				cell[0] += r*kernel[t].weight;
+				cell[1] += g*kernel[t].weight;
+				cell[2] += b*kernel[t].weight;
+			}
+		}
+		float *done = row[0];
+		row[0] = row[1];
+		row[1] = row[2];
+		row[2] = done;
+		memset(done, 0, stride*sizeof(float));
+	}
+	xfree(rows);
+}
+
+/*
+ * Maps length colors onto the palette, writing palette indices to to.
+ * Width is the row width for the dither patterns, error diffusion only
+ * keeps three rows of errors around. Compiled palettes look colors up in
+ * their grid.
+ */
+extern void
+color_quantize_buffer(cRGB *from, unsigned char *to, long length, long width, cColorPalette *palette, int dither)
+{
+	switch(dither) {
+		case COLOR_DITHER_FLOYD_STEINBERG:
+			color_quantize_diffuse(from, to, length, width, palette, color_floyd_steinberg, 4);
+			break;
+		case COLOR_DITHER_ATKINSON:
+			color_quantize_diffuse(from, to, length, width, palette, color_atkinson, 6);
+			break;
+		case COLOR_DITHER_BAYER:
+			{
+				// spread the threshold over the average gap between palette levels
+				float spread = 255/cbrtf(palette->planes.size);
+				for (long i = 0; i < length; i++) {
+					float offset = (color_dither_threshold(i, width)-0.5f)*spread;
+					to[i] = (unsigned char)color_palette_lookup(palette,
+						from[i].r+offset, from[i].g+offset, from[i].b+offset, from[i].alpha);
+				}
+			}
+			break;
+		default:
+			color_palette_index_buffer(palette, from, to, length, 1);
+	}
+}
+
+/*
+ *  call-seq:
+ *     buffer.quantize(palette[, options]) -> string
+ *
+ *  Maps every color of this RGB buffer onto the closest color of +palette+
+ *  (an array of up to 256 colors, a buffer, e.g. Color::Term.palette, or a
+ *  Color::Palette, compiled ones are faster).
+ *  Returns a binary String with one palette index per color.
+ *  Options:
+ *  :dither:: :none (default), :floyd_steinberg, :atkinson or :bayer
+ *  :width::  row width of the image, defaults to the buffer length
+ *
+ *  Example:
+ *    indices = buffer.quantize(Color::Term.palette, :dither => :atkinson, :width => 80)
+ *    indices.unpack("C*")
+ */
+extern VALUE
+rb_color_buffer_quantize(int argc, VALUE *argv, VALUE self)
+{
+	cColorPalette local, *palette = &local;
+	VALUE r_palette, options, r_dither = Qnil, r_width = Qnil;
+	rb_scan_args(argc, argv, "11", &r_palette, &options);
+	cBuffer *buffer = color_buffer_get(self, COLOR_MODEL_RGB);
+	if (!NIL_P(options)) {
+		Check_Type(options, T_HASH);
+		r_dither = rb_hash_aref(options, ID2SYM(rb_intern("dither")));
+		r_width  = rb_hash_aref(options, ID2SYM(rb_intern("width")));
+	}
+	int  dither = color_dither_get(r_dither);
+	long width  = NIL_P(r_width) ? 0 : NUM2LONG(r_width);
+	if (CLASS_OF(r_palette) == rb_cPalette) {
+		COLOR_GET_STRUCT(r_palette, cColorPalette, palette);
+	} else {
+		color_palette_init(palette, r_palette);
+	}
+	if (width < 0) {
+		rb_raise(rb_eArgError, "Invalid width, must be positive");
+	}
+	// rows longer than the buffer dither the same as one row of it
+	if (width == 0 || width > buffer->length) width = buffer->length > 0 ? buffer->length : 1;
+
+	COLOR_STAT_KERNEL(COLOR_KERNEL_QUANTIZE, buffer->length);
+	VALUE indices = rb_str_new(NULL, buffer->length);
+	color_quantize_buffer((cRGB *)buffer->data, (unsigned char *)RSTRING_PTR(indices), buffer->length, width, palette, dither);
+	return indices;
+}
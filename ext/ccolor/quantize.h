@@ -0,0 +1,13 @@
+enum {
+	COLOR_DITHER_NONE,
+	COLOR_DITHER_FLOYD_STEINBERG,
+	COLOR_DITHER_ATKINSON,
+	COLOR_DITHER_BAYER
+};
+
+extern int color_dither_get(VALUE spec);
+extern long color_palette_from(VALUE palette, cRGB *to);
+extern void color_palette_planes(cRGB *palette, long size, cPalette *planes);
+extern long color_palette_nearest(cPalette *palette, float r, float g, float b, float alpha);
+extern void color_quantize_buffer(cRGB *from, unsigned char *to, long length, long width, cColorPalette *palette, int dither);
+extern VALUE rb_color_buffer_quantize(int argc, VALUE *argv, VALUE self);
@@ -2,11 +2,13 @@
 #include <math.h>
 #include "color.h"
 #include "tools.h"
+#include "convert.h"
 #include "rgb.h"
 #include "hsv.h"
 #include "hsl.h"
 #include "cmyk.h"
 #include "gray.h"
+#include "linear.h"
 
 /* 
  *  :nodoc:
@@ -15,7 +17,7 @@ extern VALUE
 rb_color_rgb__allocate(VALUE class)
 {
 	cRGB *color;
-	VALUE rb_color = Data_Make_Struct(class, cRGB, NULL, free, color);
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cRGB, color);
 	color->r     = 0;
 	color->g     = 0;
 	color->b     = 0;
@@ -31,11 +33,11 @@ extern VALUE
 rb_color_rgb__from_html(VALUE class, VALUE string)
 {
 	cRGB *color;
-	VALUE rb_color = Data_Make_Struct(class, cRGB, NULL, free, color);
+	VALUE rb_color = COLOR_MAKE_VALUE(class, cRGB, color);
 	u_long k  = 0;
 	u_int  v  = 0;
 	char *s = RubyStringValue(string)
-	for(i=RSTRING(string)->len; i > 0; i--) {
+	for(i=RSTRING_LEN(string); i > 0; i--) {
 		v = s[i] > 57 ? s[i] - 87 : s[i] - 48
 		k = (k << 4) + v;
 	}
@@ -58,7 +60,7 @@ extern VALUE
 rb_color_rgb__from_int(VALUE class, VALUE integer)
 {
 	cRGB *color;
-	VALUE rb_color  = Data_Make_Struct(class, cRGB, NULL, free, color);
+	VALUE rb_color  = COLOR_MAKE_VALUE(class, cRGB, color);
 	unsigned long i = NUM2ULONG(integer);
 	color->alpha    = (i >> 24) & 0xff;
 	color->r        = (i >> 16) & 0xff;
@@ -78,8 +80,9 @@ rb_color_rgb__from_int(VALUE class, VALUE integer)
 extern VALUE
 rb_color_rgb_initialize(int argc, VALUE *argv, VALUE self)
 {
+	COLOR_CHECK_FROZEN(self);
 	cRGB *color;
-	Data_Get_Struct(self, cRGB, color);
+	COLOR_GET_STRUCT(self, cRGB, color);
 	VALUE red, green, blue, alpha;
 	rb_scan_args(argc, argv, "31", &red, &green, &blue, &alpha);
 
@@ -107,7 +110,7 @@ rb_color_rgb_initialize(int argc, VALUE *argv, VALUE self)
 	color->b     = b;
 	color->alpha = a;
 
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -116,11 +119,12 @@ rb_color_rgb_initialize(int argc, VALUE *argv, VALUE self)
 extern VALUE
 rb_color_rgb_initialize_copy(VALUE self, VALUE original)
 {
+	COLOR_CHECK_FROZEN(self);
 	cRGB *color1, *color2;
-	Data_Get_Struct(self, cRGB, color1);
-	Data_Get_Struct(original, cRGB, color2);
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	COLOR_GET_STRUCT(original, cRGB, color2);
 	*color1 = *color2;
-	return self;
+	return rb_obj_freeze(self);
 }
 
 /*
@@ -133,7 +137,7 @@ extern VALUE
 rb_color_rgb_red(VALUE self)
 {
 	cRGB *color;
-	Data_Get_Struct(self, cRGB, color);
+	COLOR_GET_STRUCT(self, cRGB, color);
 	return CHR2FIX(color->r);
 }
 
@@ -147,7 +151,7 @@ extern VALUE
 rb_color_rgb_green(VALUE self)
 {
 	cRGB *color;
-	Data_Get_Struct(self, cRGB, color);
+	COLOR_GET_STRUCT(self, cRGB, color);
 	return CHR2FIX(color->g);
 }
 
@@ -161,7 +165,7 @@ extern VALUE
 rb_color_rgb_blue(VALUE self)
 {
 	cRGB *color;
-	Data_Get_Struct(self, cRGB, color);
+	COLOR_GET_STRUCT(self, cRGB, color);
 	return CHR2FIX(color->b);
 }
 
@@ -176,7 +180,7 @@ extern VALUE
 rb_color_rgb_alpha(VALUE self)
 {
 	cRGB *color;
-	Data_Get_Struct(self, cRGB, color);
+	COLOR_GET_STRUCT(self, cRGB, color);
 	return CHR2FIX(color->alpha);
 }
 
@@ -189,10 +193,11 @@ rb_color_rgb_alpha(VALUE self)
 extern VALUE
 rb_color_rgb_add(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cRGB *color1, *color2, *color3;
-	Data_Get_Struct(self, cRGB, color1);
-	Data_Get_Struct(other, cRGB, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	color2 = color_coerce(other, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, color3);
 	color3->r     = color_cap(CHR2LONG(color1->r) + CHR2LONG(color2->r), 0, 255);
 	color3->g     = color_cap(CHR2LONG(color1->g) + CHR2LONG(color2->g), 0, 255);
 	color3->b     = color_cap(CHR2LONG(color1->b) + CHR2LONG(color2->b), 0, 255);
@@ -209,10 +214,11 @@ rb_color_rgb_add(VALUE self, VALUE other)
 extern VALUE
 rb_color_rgb_sub(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cRGB *color1, *color2, *color3;
-	Data_Get_Struct(self, cRGB, color1);
-	Data_Get_Struct(other, cRGB, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, color3);
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	color2 = color_coerce(other, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_ARITHMETIC);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, color3);
 	color3->r     = color_cap(CHR2LONG(color1->r) - CHR2LONG(color2->r), 0, 255);
 	color3->g     = color_cap(CHR2LONG(color1->g) - CHR2LONG(color2->g), 0, 255);
 	color3->b     = color_cap(CHR2LONG(color1->b) - CHR2LONG(color2->b), 0, 255);
@@ -222,25 +228,31 @@ rb_color_rgb_sub(VALUE self, VALUE other)
 
 /*
  *  call-seq:
- *     rgb.sequence(to, steps) -> array_of_rgb
+ *     rgb.sequence(to, steps[, options]) -> array_of_rgb
  *
+ *  See Color::Common#sequence. With <code>:space => :linear</code> the
+ *  steps are interpolated in linear light.
  *  FIXME doesn't raise ArgumentError (steps >= 1)
  */
 extern VALUE
-rb_color_rgb_sequence(VALUE self, VALUE r_to, VALUE r_steps)
+rb_color_rgb_sequence(int argc, VALUE *argv, VALUE self)
 {
 	cRGB *start, *end, *step;
+	cAny tmp;
+	VALUE r_to, r_steps, options;
+	rb_scan_args(argc, argv, "21", &r_to, &r_steps, &options);
 	int steps    = FIX2INT(r_steps);
+	int space    = color_space_get(options);
 	double delta = 1.0/steps;
 
-	Data_Get_Struct(self, cRGB, start);
-	Data_Get_Struct(r_to, cRGB, end);
+	COLOR_GET_STRUCT(self, cRGB, start);
+	end = color_coerce(r_to, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_INTERPOLATE);
 	
 	VALUE rb_array = rb_ary_new2(steps+1);
 	rb_ary_push(rb_array, self);
 	for (int i = 1; i < steps; i++) {
-		VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, step);
-		color_rgb_interpolate(start, end, step, i*delta);
+		VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, step);
+		color_rgb_interpolate_in(start, end, step, i*delta, space);
 		rb_ary_push(rb_array, rb_color);
 	}
 	rb_ary_push(rb_array, r_to);
@@ -258,30 +270,19 @@ extern VALUE
 rb_color_rgb_closest(VALUE self, VALUE r_ary_out_of)
 {
 	cRGB *color, *compare;
-	VALUE closest, other_rgb, other;
-	float value;
-	ID rb_coerce;
-	rb_coerce = rb_intern("coerce");
-	closest   = rb_ary_entry(r_ary_out_of, 0);
-	other_rgb = closest;
-	if (CLASS_OF(other_rgb) != rb_cRGB) {
-		other_rgb = rb_funcall(self, rb_coerce, 1, other_rgb);
-	}
-	Data_Get_Struct(self, cRGB, color);
-	Data_Get_Struct(other_rgb, cRGB, compare);
-	value     = color_rgb_distance(color, compare);
-	
-	for (long i = 1; i < RARRAY(r_ary_out_of)->len; i++) {
-		other     = rb_ary_entry(r_ary_out_of, i);
-		if (CLASS_OF(other) != rb_cRGB) {
-			other_rgb = rb_funcall(self, rb_coerce, 1, other);
-		} else {
-			other_rgb = other;
-		}
-		Data_Get_Struct(other_rgb, cRGB, compare);
-		float tmp = color_rgb_distance(color, compare);
-		if (tmp < value) {
-			value   = tmp;
+	cAny tmp;
+	VALUE closest = Qnil;
+	float value   = INFINITY;
+	Check_Type(r_ary_out_of, T_ARRAY);
+	COLOR_GET_STRUCT(self, cRGB, color);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_CLOSEST, RARRAY_LEN(r_ary_out_of));
+
+	for (long i = 0; i < RARRAY_LEN(r_ary_out_of); i++) {
+		VALUE other = RARRAY_PTR(r_ary_out_of)[i];
+		compare     = color_coerce(other, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_CLOSEST);
+		float distance = color_rgb_distance(color, compare);
+		if (i == 0 || distance < value) {
+			value   = distance;
 			closest = other;
 		}
 	}
@@ -291,21 +292,28 @@ rb_color_rgb_closest(VALUE self, VALUE r_ary_out_of)
 
 /*
  *  call-seq:
- *     rgb.interpolate(to, steps) -> new_rgb
+ *     rgb.interpolate(to[, pos[, options]]) -> new_rgb
  *
+ *  See Color::Common#interpolate, +pos+ defaults to 0.5. With
+ *  <code>:space => :linear</code> red, green and blue are interpolated in
+ *  linear light, which avoids the dark, muddy midpoints of interpolating
+ *  the gamma encoded values.
  *  FIXME doesn't raise ArgumentError (pos 0..1)
  */
 extern VALUE
-rb_color_rgb_interpolate(VALUE self, VALUE r_other, VALUE r_pos)
+rb_color_rgb_interpolate(int argc, VALUE *argv, VALUE self)
 {
-	double pos = NUM2DBL(r_pos);
+	VALUE r_other, r_pos, options;
+	rb_scan_args(argc, argv, "12", &r_other, &r_pos, &options);
+	double pos = NIL_P(r_pos) ? 0.5 : NUM2DBL(r_pos);
 	
 	cRGB *color1, *color2, *color3;
-	Data_Get_Struct(self, cRGB, color1);
-	Data_Get_Struct(r_other, cRGB, color2);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, color3);
+	cAny tmp;
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	color2 = color_coerce(r_other, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_INTERPOLATE);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, color3);
 	
-	color_rgb_interpolate(color1, color2, color3, pos);
+	color_rgb_interpolate_in(color1, color2, color3, pos, color_space_get(options));
 	
 	return rb_color;
 }
@@ -322,9 +330,10 @@ rb_color_rgb_interpolate(VALUE self, VALUE r_other, VALUE r_pos)
 extern VALUE
 rb_color_rgb_distance(VALUE self, VALUE other)
 {
+	cAny tmp;
 	cRGB *color1, *color2;
-	Data_Get_Struct(self, cRGB, color1);
-	Data_Get_Struct(other, cRGB, color2);
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	color2 = color_coerce(other, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_DISTANCE);
 	return rb_float_new(color_rgb_distance(color1, color2));
 }
 
@@ -339,8 +348,8 @@ rb_color_rgb_complement(VALUE self)
 {
 	cRGB *color1, *color2;
 	cHSV hsv;
-	Data_Get_Struct(self, cRGB, color1);
-	VALUE rb_color = Data_Make_Struct(rb_cRGB, cRGB, NULL, free, color2);
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, color2);
 	color_convert_rgb_to_hsv(color1, &hsv);
 	hsv.h = fmodf(hsv.h+0.5, 1);
 	color_convert_hsv_to_rgb(&hsv, color2);
@@ -359,11 +368,11 @@ extern VALUE
 rb_color_rgb_to_i(int argc, VALUE *argv, VALUE self)
 {
 	cRGB *color;
-	Data_Get_Struct(self, cRGB, color);
+	COLOR_GET_STRUCT(self, cRGB, color);
 	VALUE alpha;
 	rb_scan_args(argc, argv, "01", &alpha);
 
-	if RTEST(alpha) {
+	if (RTEST(alpha)) {
 		return UINT2NUM(
 			(CHR2LONG(color->alpha) << 24) |
 			(CHR2LONG(color->r) << 16) |
@@ -390,8 +399,9 @@ rb_color_rgb_to_hsv(VALUE self)
 {
 	cRGB *rgb;
 	cHSV *hsv;
-	Data_Get_Struct(self, cRGB, rgb);
-	VALUE rb_color = Data_Make_Struct(rb_cHSV, cHSV, NULL, free, hsv);
+	COLOR_GET_STRUCT(self, cRGB, rgb);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSV, cHSV, hsv);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB, COLOR_MODEL_HSV, 1);
 	color_convert_rgb_to_hsv(rgb, hsv);
 	return rb_color;
 }
@@ -407,8 +417,9 @@ rb_color_rgb_to_hsl(VALUE self)
 {
 	cRGB *rgb;
 	cHSL *hsl;
-	Data_Get_Struct(self, cRGB, rgb);
-	VALUE rb_color = Data_Make_Struct(rb_cHSL, cHSL, NULL, free, hsl);
+	COLOR_GET_STRUCT(self, cRGB, rgb);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSL, cHSL, hsl);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB, COLOR_MODEL_HSL, 1);
 	color_convert_rgb_to_hsl(rgb, hsl);
 	return rb_color;
 }
@@ -424,8 +435,9 @@ rb_color_rgb_to_gray(VALUE self)
 {
 	cRGB *rgb;
 	cGray *gray;
-	Data_Get_Struct(self, cRGB, rgb);
-	VALUE rb_color = Data_Make_Struct(rb_cGray, cGray, NULL, free, gray);
+	COLOR_GET_STRUCT(self, cRGB, rgb);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cGray, cGray, gray);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB, COLOR_MODEL_GRAY, 1);
 	color_convert_rgb_to_gray(rgb, gray);
 	return rb_color;
 }
@@ -441,8 +453,9 @@ rb_color_rgb_to_cmyk(VALUE self)
 {
 	cRGB *rgb;
 	cCMYK *cmyk;
-	Data_Get_Struct(self, cRGB, rgb);
-	VALUE rb_color = Data_Make_Struct(rb_cCMYK, cCMYK, NULL, free, cmyk);
+	COLOR_GET_STRUCT(self, cRGB, rgb);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cCMYK, cCMYK, cmyk);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB, COLOR_MODEL_CMYK, 1);
 	color_convert_rgb_to_cmyk(rgb, cmyk);
 	return rb_color;
 }
@@ -461,8 +474,8 @@ rb_color_rgb_eql(VALUE self, VALUE other)
 		return Qfalse;
 	}
 	cRGB *color1, *color2;
-	Data_Get_Struct(self, cRGB, color1);
-	Data_Get_Struct(other, cRGB, color2);
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	COLOR_GET_STRUCT(other, cRGB, color2);
 	return (
 		color1->r     == color2->r &&
 		color1->g     == color2->g &&
@@ -482,7 +495,7 @@ extern VALUE
 rb_color_rgb_hash(VALUE self)
 {
 	cRGB *color;
-	Data_Get_Struct(self, cRGB, color);
+	COLOR_GET_STRUCT(self, cRGB, color);
 
 	return INT2FIX(
 		(8) ^
@@ -492,3 +505,114 @@ rb_color_rgb_hash(VALUE self)
 		(CHR2LONG(color->b << 7))
 	);
 }
+
+/*
+ *  call-seq:
+ *     rgb.to_rgb16 -> rgb16
+ *
+ *  Returns an RGB16 representation of this color.
+ */
+extern VALUE
+rb_color_rgb_to_rgb16(VALUE self)
+{
+	cRGB *rgb;
+	cRGB16 *rgb16;
+	COLOR_GET_STRUCT(self, cRGB, rgb);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB16, cRGB16, rgb16);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB, COLOR_MODEL_RGB16, 1);
+	color_convert_rgb_to_rgb16(rgb, rgb16);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgb.to_rgbf -> rgbf
+ *
+ *  Returns an RGBF representation of this color.
+ */
+extern VALUE
+rb_color_rgb_to_rgbf(VALUE self)
+{
+	cRGB *rgb;
+	cRGBF *rgbf;
+	COLOR_GET_STRUCT(self, cRGB, rgb);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGBF, cRGBF, rgbf);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB, COLOR_MODEL_RGBF, 1);
+	color_convert_rgb_to_rgbf(rgb, rgbf);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgb.to_ycbcr -> ycbcr
+ *
+ *  Returns a YCbCr representation of this color.
+ */
+extern VALUE
+rb_color_rgb_to_ycbcr(VALUE self)
+{
+	cRGB *rgb;
+	cYCbCr *ycbcr;
+	COLOR_GET_STRUCT(self, cRGB, rgb);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cYCbCr, cYCbCr, ycbcr);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB, COLOR_MODEL_YCBCR, 1);
+	color_convert_rgb_to_ycbcr(rgb, ycbcr);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgb.blend(with[, with_alpha[, using[, options]]]) -> new_rgb
+ *
+ *  See Color::RGB#blend, +using+ is :interpolate, :multiply or
+ *  :negative_multiply. With <code>:space => :linear</code> all modes
+ *  operate in linear light.
+ */
+extern VALUE
+rb_color_rgb_blend(int argc, VALUE *argv, VALUE self)
+{
+	cRGB *color1, *color2, *color3;
+	cAny tmp;
+	VALUE r_with, r_alpha, using, options;
+	rb_scan_args(argc, argv, "13", &r_with, &r_alpha, &using, &options);
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	color2 = color_coerce(r_with, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_BLEND);
+	int alpha = NIL_P(r_alpha) ? color2->alpha : NUM2INT(r_alpha);
+	int mode  = color_blend_mode_get(using);
+	int space = color_space_get(options);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, color3);
+	color_rgb_blend(color1, color2, color3, (255-alpha)/255.0f, mode, space);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgb.relative_luminance -> float
+ *
+ *  The relative luminance as defined by WCAG 2.x, a Float between 0 (black)
+ *  and 1 (white). Alpha is ignored.
+ */
+extern VALUE
+rb_color_rgb_relative_luminance(VALUE self)
+{
+	cRGB *color;
+	COLOR_GET_STRUCT(self, cRGB, color);
+	return rb_float_new(color_rgb_luminance(color));
+}
+
+/*
+ *  call-seq:
+ *     rgb.contrast(other) -> float
+ *
+ *  The WCAG 2.x contrast ratio between this and another color, a Float
+ *  between 1 and 21. WCAG AA requires 4.5 for normal text.
+ */
+extern VALUE
+rb_color_rgb_contrast(VALUE self, VALUE other)
+{
+	cRGB *color1, *color2;
+	cAny tmp;
+	COLOR_GET_STRUCT(self, cRGB, color1);
+	color2 = color_coerce(other, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_CONTRAST);
+	return rb_float_new(color_contrast(color_rgb_luminance(color1), color_rgb_luminance(color2)));
+}
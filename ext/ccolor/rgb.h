@@ -18,5 +18,11 @@ extern VALUE rb_color_rgb_hash(VALUE self);
 extern VALUE rb_color_rgb_closest(VALUE self, VALUE r_ary_out_of);
 extern VALUE rb_color_rgb_distance(VALUE self, VALUE other);
 extern VALUE rb_color_rgb_complement(VALUE self);
-extern VALUE rb_color_rgb_sequence(VALUE self, VALUE r_to, VALUE r_steps);
-extern VALUE rb_color_rgb_interpolate(VALUE self, VALUE r_other, VALUE r_pos);
+extern VALUE rb_color_rgb_sequence(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_rgb_interpolate(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_rgb_blend(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_rgb_relative_luminance(VALUE self);
+extern VALUE rb_color_rgb_contrast(VALUE self, VALUE other);
+extern VALUE rb_color_rgb_to_rgb16(VALUE self);
+extern VALUE rb_color_rgb_to_rgbf(VALUE self);
+extern VALUE rb_color_rgb_to_ycbcr(VALUE self);
@@ -0,0 +1,284 @@
+#include <ruby.h>
+#include <math.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "rgb.h"
+#include "hsv.h"
+#include "hsl.h"
+#include "cmyk.h"
+#include "gray.h"
+#include "rgb16.h"
+#include "rgbf.h"
+
+/* 
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_rgb16__allocate(VALUE class)
+{
+	cRGB16 *color;
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cRGB16, color);
+	color->r     = 0;
+	color->g     = 0;
+	color->b     = 0;
+	color->alpha = 0;
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     Color::RGB16.new(red, green, blue[, alpha])
+ *
+ *  Create a new RGB16 instance. Red, green, blue and alpha are
+ *  Integers within 0 and 65535 each, where for alpha 0 means
+ *  opaque and 65535 fully transparent.
+ */
+extern VALUE
+rb_color_rgb16_initialize(int argc, VALUE *argv, VALUE self)
+{
+	COLOR_CHECK_FROZEN(self);
+	cRGB16 *color;
+	COLOR_GET_STRUCT(self, cRGB16, color);
+	VALUE red, green, blue, alpha;
+	rb_scan_args(argc, argv, "31", &red, &green, &blue, &alpha);
+
+	long  r,g,b,a;
+	r = (NUM2LONG(red));
+	g = (NUM2LONG(green));
+	b = (NUM2LONG(blue));
+	a = (NIL_P(alpha) ? 0 : NUM2LONG(alpha));
+	
+	if (0 > r || r > 65535) {
+		rb_raise(rb_eArgError, "Invalid value for red, must be between 0 and 65535");
+	}
+	if (0 > g || g > 65535) {
+		rb_raise(rb_eArgError, "Invalid value for green, must be between 0 and 65535");
+	}
+	if (0 > b || b > 65535) {
+		rb_raise(rb_eArgError, "Invalid value for blue, must be between 0 and 65535");
+	}
+	if (0 > a || a > 65535) {
+		rb_raise(rb_eArgError, "Invalid value for alpha, must be between 0 and 65535");
+	}
+
+	color->r     = r;
+	color->g     = g;
+	color->b     = b;
+	color->alpha = a;
+
+	return rb_obj_freeze(self);
+}
+
+/*
+ * :nodoc:
+ */
+extern VALUE
+rb_color_rgb16_initialize_copy(VALUE self, VALUE original)
+{
+	COLOR_CHECK_FROZEN(self);
+	cRGB16 *color1, *color2;
+	COLOR_GET_STRUCT(self, cRGB16, color1);
+	COLOR_GET_STRUCT(original, cRGB16, color2);
+	*color1 = *color2;
+	return rb_obj_freeze(self);
+}
+
+/*
+ *  call-seq:
+ *     rgb16.red -> fixnum
+ *
+ *  The red portion of this color. A value between 0 and 65535.
+ */
+extern VALUE
+rb_color_rgb16_red(VALUE self)
+{
+	cRGB16 *color;
+	COLOR_GET_STRUCT(self, cRGB16, color);
+	return INT2FIX(color->r);
+}
+
+/*
+ *  call-seq:
+ *     rgb16.green -> fixnum
+ *
+ *  The green portion of this color. A value between 0 and 65535.
+ */
+extern VALUE
+rb_color_rgb16_green(VALUE self)
+{
+	cRGB16 *color;
+	COLOR_GET_STRUCT(self, cRGB16, color);
+	return INT2FIX(color->g);
+}
+
+/*
+ *  call-seq:
+ *     rgb16.blue -> fixnum
+ *
+ *  The blue portion of this color. A value between 0 and 65535.
+ */
+extern VALUE
+rb_color_rgb16_blue(VALUE self)
+{
+	cRGB16 *color;
+	COLOR_GET_STRUCT(self, cRGB16, color);
+	return INT2FIX(color->b);
+}
+
+/*
+ *  call-seq:
+ *     rgb16.alpha -> fixnum
+ *
+ *  The transparency of this color. A value between 0 and 65535, where
+ *  0 means opaque and 65535 fully transparent.
+ */
+extern VALUE
+rb_color_rgb16_alpha(VALUE self)
+{
+	cRGB16 *color;
+	COLOR_GET_STRUCT(self, cRGB16, color);
+	return INT2FIX(color->alpha);
+}
+
+/*
+ *  call-seq:
+ *     rgb16.distance(other) -> float
+ *
+ *  Returns the distance to another color of the same class.
+ *  Distance is a Float between 0 and 1, where 1 is the maximum
+ *  distance. Be aware that this is purely mathematical and human
+ *  perception may differ.
+ */
+extern VALUE
+rb_color_rgb16_distance(VALUE self, VALUE other)
+{
+	cAny tmp;
+	cRGB16 *color1, *color2;
+	COLOR_GET_STRUCT(self, cRGB16, color1);
+	color2 = color_coerce(other, COLOR_MODEL_RGB16, &tmp, COLOR_COERCE_DISTANCE);
+	return rb_float_new(sqrtf((
+		powf(SHORT2FLOAT(color1->r) - SHORT2FLOAT(color2->r), 2) +
+		powf(SHORT2FLOAT(color1->g) - SHORT2FLOAT(color2->g), 2) +
+		powf(SHORT2FLOAT(color1->b) - SHORT2FLOAT(color2->b), 2) +
+		powf(SHORT2FLOAT(color1->alpha) - SHORT2FLOAT(color2->alpha), 2)
+	)/4));
+}
+
+/*
+ *  call-seq:
+ *     rgb16.eql?(other) -> true/false
+ *
+ *  Compares two RGB16 color instances for equality. Two RGB16 colors are eql?
+ *  if their red, green, blue and alpha values are equal.
+ */
+extern VALUE
+rb_color_rgb16_eql(VALUE self, VALUE other)
+{
+	if (CLASS_OF(self) != CLASS_OF(other)) {
+		return Qfalse;
+	}
+	cRGB16 *color1, *color2;
+	COLOR_GET_STRUCT(self, cRGB16, color1);
+	COLOR_GET_STRUCT(other, cRGB16, color2);
+	return (
+		color1->r     == color2->r &&
+		color1->g     == color2->g &&
+		color1->b     == color2->b &&
+		color1->alpha == color2->alpha
+	) ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *     rgb16.hash   -> fixnum
+ *
+ *  Compute a hash-code for this color. Two colors with the same components
+ *  will have the same hash code (and will compare using <code>eql?</code>).
+ */
+extern VALUE
+rb_color_rgb16_hash(VALUE self)
+{
+	cRGB16 *color;
+	COLOR_GET_STRUCT(self, cRGB16, color);
+
+	return LONG2FIX(
+		(16) ^
+		((long)color->alpha << 24) ^
+		((long)color->r << 16) ^
+		((long)color->g << 8) ^
+		((long)color->b)
+	);
+}
+
+/*
+ *  call-seq:
+ *     rgb16.to_rgb -> rgb
+ *
+ *  Returns an RGB representation of this color, rounded to 8 bit.
+ */
+extern VALUE
+rb_color_rgb16_to_rgb(VALUE self)
+{
+	cRGB16 *rgb16;
+	cRGB *rgb;
+	COLOR_GET_STRUCT(self, cRGB16, rgb16);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, rgb);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB16, COLOR_MODEL_RGB, 1);
+	color_convert_rgb16_to_rgb(rgb16, rgb);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgb16.to_rgbf -> rgbf
+ *
+ *  Returns an RGBF representation of this color.
+ */
+extern VALUE
+rb_color_rgb16_to_rgbf(VALUE self)
+{
+	cRGB16 *rgb16;
+	cRGBF *rgbf;
+	COLOR_GET_STRUCT(self, cRGB16, rgb16);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGBF, cRGBF, rgbf);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB16, COLOR_MODEL_RGBF, 1);
+	color_convert_rgb16_to_rgbf(rgb16, rgbf);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgb16.to_hsv -> hsv
+ *
+ *  Returns a HSV representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_rgb16_to_hsv(VALUE self)
+{
+	cRGB16 *rgb16;
+	cHSV *hsv;
+	COLOR_GET_STRUCT(self, cRGB16, rgb16);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSV, cHSV, hsv);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB16, COLOR_MODEL_HSV, 1);
+	color_convert_rgb16_to_hsv(rgb16, hsv);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgb16.to_hsl -> hsl
+ *
+ *  Returns a HSL representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_rgb16_to_hsl(VALUE self)
+{
+	cRGB16 *rgb16;
+	cHSL *hsl;
+	COLOR_GET_STRUCT(self, cRGB16, rgb16);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSL, cHSL, hsl);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGB16, COLOR_MODEL_HSL, 1);
+	color_convert_rgb16_to_hsl(rgb16, hsl);
+	return rb_color;
+}
@@ -0,0 +1,14 @@
+extern VALUE rb_color_rgb16__allocate(VALUE class);
+extern VALUE rb_color_rgb16_initialize(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_rgb16_initialize_copy(VALUE self, VALUE original);
+extern VALUE rb_color_rgb16_red(VALUE self);
+extern VALUE rb_color_rgb16_green(VALUE self);
+extern VALUE rb_color_rgb16_blue(VALUE self);
+extern VALUE rb_color_rgb16_alpha(VALUE self);
+extern VALUE rb_color_rgb16_distance(VALUE self, VALUE other);
+extern VALUE rb_color_rgb16_eql(VALUE self, VALUE other);
+extern VALUE rb_color_rgb16_hash(VALUE self);
+extern VALUE rb_color_rgb16_to_rgb(VALUE self);
+extern VALUE rb_color_rgb16_to_rgbf(VALUE self);
+extern VALUE rb_color_rgb16_to_hsv(VALUE self);
+extern VALUE rb_color_rgb16_to_hsl(VALUE self);
@@ -0,0 +1,291 @@
+#include <ruby.h>
+#include <math.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "rgb.h"
+#include "hsv.h"
+#include "hsl.h"
+#include "cmyk.h"
+#include "gray.h"
+#include "rgb16.h"
+#include "rgbf.h"
+
+/* 
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_rgbf__allocate(VALUE class)
+{
+	cRGBF *color;
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cRGBF, color);
+	color->r     = 0;
+	color->g     = 0;
+	color->b     = 0;
+	color->alpha = 0;
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     Color::RGBF.new(red, green, blue[, alpha])
+ *
+ *  Create a new RGBF instance. Red, green and blue are floats of
+ *  at least 0, where 1 is full intensity. Values above 1 are kept
+ *  (HDR) and clipped when converting to other models.
+ *  Alpha is a float between 0 and 1, where 0 means opaque and 1
+ *  fully transparent.
+ */
+extern VALUE
+rb_color_rgbf_initialize(int argc, VALUE *argv, VALUE self)
+{
+	COLOR_CHECK_FROZEN(self);
+	cRGBF *color;
+	COLOR_GET_STRUCT(self, cRGBF, color);
+	VALUE red, green, blue, alpha;
+	rb_scan_args(argc, argv, "31", &red, &green, &blue, &alpha);
+
+	double r,g,b,a;
+	r = (NUM2DBL(red));
+	g = (NUM2DBL(green));
+	b = (NUM2DBL(blue));
+	a = (NIL_P(alpha) ? 0 : NUM2DBL(alpha));
+	
+	if (!(r >= 0) || isinf(r)) {
+		rb_raise(rb_eArgError, "Invalid value for red, must be a finite value of at least 0");
+	}
+	if (!(g >= 0) || isinf(g)) {
+		rb_raise(rb_eArgError, "Invalid value for green, must be a finite value of at least 0");
+	}
+	if (!(b >= 0) || isinf(b)) {
+		rb_raise(rb_eArgError, "Invalid value for blue, must be a finite value of at least 0");
+	}
+	if (-1e-6 > a || a > (1+1e-6) || a != a) {
+		rb_raise(rb_eArgError, "Invalid value for alpha, must be between 0 and 1");
+	}
+
+	color->r     = r;
+	color->g     = g;
+	color->b     = b;
+	color->alpha = color_capf(a,0,1);
+
+	return rb_obj_freeze(self);
+}
+
+/*
+ * :nodoc:
+ */
+extern VALUE
+rb_color_rgbf_initialize_copy(VALUE self, VALUE original)
+{
+	COLOR_CHECK_FROZEN(self);
+	cRGBF *color1, *color2;
+	COLOR_GET_STRUCT(self, cRGBF, color1);
+	COLOR_GET_STRUCT(original, cRGBF, color2);
+	*color1 = *color2;
+	return rb_obj_freeze(self);
+}
+
+/*
+ *  call-seq:
+ *     rgbf.red -> float
+ *
+ *  The red portion of this color, 1.0 is full intensity.
+ */
+extern VALUE
+rb_color_rgbf_red(VALUE self)
+{
+	cRGBF *color;
+	COLOR_GET_STRUCT(self, cRGBF, color);
+	return rb_float_new(color->r);
+}
+
+/*
+ *  call-seq:
+ *     rgbf.green -> float
+ *
+ *  The green portion of this color, 1.0 is full intensity.
+ */
+extern VALUE
+rb_color_rgbf_green(VALUE self)
+{
+	cRGBF *color;
+	COLOR_GET_STRUCT(self, cRGBF, color);
+	return rb_float_new(color->g);
+}
+
+/*
+ *  call-seq:
+ *     rgbf.blue -> float
+ *
+ *  The blue portion of this color, 1.0 is full intensity.
+ */
+extern VALUE
+rb_color_rgbf_blue(VALUE self)
+{
+	cRGBF *color;
+	COLOR_GET_STRUCT(self, cRGBF, color);
+	return rb_float_new(color->b);
+}
+
+/*
+ *  call-seq:
+ *     rgbf.alpha -> float
+ *
+ *  The transparency of this color. A value between 0 and 1, where
+ *  0 means opaque and 1 fully transparent.
+ */
+extern VALUE
+rb_color_rgbf_alpha(VALUE self)
+{
+	cRGBF *color;
+	COLOR_GET_STRUCT(self, cRGBF, color);
+	return rb_float_new(color->alpha);
+}
+
+/*
+ *  call-seq:
+ *     rgbf.distance(other) -> float
+ *
+ *  Returns the distance to another color of the same class.
+ *  Distance is a Float between 0 and 1 for colors without HDR
+ *  values, where 1 is the maximum distance. Be aware that this
+ *  is purely mathematical and human perception may differ.
+ */
+extern VALUE
+rb_color_rgbf_distance(VALUE self, VALUE other)
+{
+	cAny tmp;
+	cRGBF *color1, *color2;
+	COLOR_GET_STRUCT(self, cRGBF, color1);
+	color2 = color_coerce(other, COLOR_MODEL_RGBF, &tmp, COLOR_COERCE_DISTANCE);
+	return rb_float_new(sqrtf((
+		powf(color1->r - color2->r, 2) +
+		powf(color1->g - color2->g, 2) +
+		powf(color1->b - color2->b, 2) +
+		powf(color1->alpha - color2->alpha, 2)
+	)/4));
+}
+
+/*
+ *  call-seq:
+ *     rgbf.eql?(other) -> true/false
+ *
+ *  Compares two RGBF color instances for equality. Two RGBF colors are eql?
+ *  if their red, green, blue and alpha values are equal.
+ */
+extern VALUE
+rb_color_rgbf_eql(VALUE self, VALUE other)
+{
+	if (CLASS_OF(self) != CLASS_OF(other)) {
+		return Qfalse;
+	}
+	cRGBF *color1, *color2;
+	COLOR_GET_STRUCT(self, cRGBF, color1);
+	COLOR_GET_STRUCT(other, cRGBF, color2);
+	return (
+		color1->r     == color2->r &&
+		color1->g     == color2->g &&
+		color1->b     == color2->b &&
+		color1->alpha == color2->alpha
+	) ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *     rgbf.hash   -> fixnum
+ *
+ *  Compute a hash-code for this color. Two colors with the same components
+ *  will have the same hash code (and will compare using <code>eql?</code>).
+ */
+extern VALUE
+rb_color_rgbf_hash(VALUE self)
+{
+	long h;
+	cRGBF *color;
+	COLOR_GET_STRUCT(self, cRGBF, color);
+	
+	h  = 32;
+	h  = (h << 1) | (h<0 ? 1 : 0);
+	h ^= float_hash(color->r);
+	h  = (h << 1) | (h<0 ? 1 : 0);
+	h ^= float_hash(color->g);
+	h  = (h << 1) | (h<0 ? 1 : 0);
+	h ^= float_hash(color->b);
+	h  = (h << 1) | (h<0 ? 1 : 0);
+	h ^= float_hash(color->alpha);
+	return LONG2FIX(h);
+}
+
+/*
+ *  call-seq:
+ *     rgbf.to_rgb -> rgb
+ *
+ *  Returns an RGB representation of this color, rounded to 8 bit.
+ *  HDR values are clipped.
+ */
+extern VALUE
+rb_color_rgbf_to_rgb(VALUE self)
+{
+	cRGBF *rgbf;
+	cRGB *rgb;
+	COLOR_GET_STRUCT(self, cRGBF, rgbf);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, rgb);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGBF, COLOR_MODEL_RGB, 1);
+	color_convert_rgbf_to_rgb(rgbf, rgb);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgbf.to_rgb16 -> rgb16
+ *
+ *  Returns an RGB16 representation of this color. HDR values are clipped.
+ */
+extern VALUE
+rb_color_rgbf_to_rgb16(VALUE self)
+{
+	cRGBF *rgbf;
+	cRGB16 *rgb16;
+	COLOR_GET_STRUCT(self, cRGBF, rgbf);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB16, cRGB16, rgb16);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGBF, COLOR_MODEL_RGB16, 1);
+	color_convert_rgbf_to_rgb16(rgbf, rgb16);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgbf.to_hsv -> hsv
+ *
+ *  Returns a HSV representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_rgbf_to_hsv(VALUE self)
+{
+	cRGBF *rgbf;
+	cHSV *hsv;
+	COLOR_GET_STRUCT(self, cRGBF, rgbf);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSV, cHSV, hsv);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGBF, COLOR_MODEL_HSV, 1);
+	color_convert_rgbf_to_hsv(rgbf, hsv);
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     rgbf.to_hsl -> hsl
+ *
+ *  Returns a HSL representation of this color, without going through 8 bit.
+ */
+extern VALUE
+rb_color_rgbf_to_hsl(VALUE self)
+{
+	cRGBF *rgbf;
+	cHSL *hsl;
+	COLOR_GET_STRUCT(self, cRGBF, rgbf);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cHSL, cHSL, hsl);
+	COLOR_STAT_CONVERT(COLOR_MODEL_RGBF, COLOR_MODEL_HSL, 1);
+	color_convert_rgbf_to_hsl(rgbf, hsl);
+	return rb_color;
+}
@@ -0,0 +1,14 @@
+extern VALUE rb_color_rgbf__allocate(VALUE class);
+extern VALUE rb_color_rgbf_initialize(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_rgbf_initialize_copy(VALUE self, VALUE original);
+extern VALUE rb_color_rgbf_red(VALUE self);
+extern VALUE rb_color_rgbf_green(VALUE self);
+extern VALUE rb_color_rgbf_blue(VALUE self);
+extern VALUE rb_color_rgbf_alpha(VALUE self);
+extern VALUE rb_color_rgbf_distance(VALUE self, VALUE other);
+extern VALUE rb_color_rgbf_eql(VALUE self, VALUE other);
+extern VALUE rb_color_rgbf_hash(VALUE self);
+extern VALUE rb_color_rgbf_to_rgb(VALUE self);
+extern VALUE rb_color_rgbf_to_rgb16(VALUE self);
+extern VALUE rb_color_rgbf_to_hsv(VALUE self);
+extern VALUE rb_color_rgbf_to_hsl(VALUE self);
@@ -0,0 +1,256 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "buffer.h"
+#include "linear.h"
+#include "sort.h"
+
+#define COLOR_SORT_BLOCK 256
+
+/*
+ * Accepts :hue, :saturation, :value, :luminance, :hilbert or :morton,
+ * raises ArgumentError otherwise.
+ */
+extern int
+color_sort_key_get(VALUE spec)
+{
+	if (spec == ID2SYM(rb_intern("hue")))        return COLOR_SORT_HUE;
+	if (spec == ID2SYM(rb_intern("saturation"))) return COLOR_SORT_SATURATION;
+	if (spec == ID2SYM(rb_intern("value")))      return COLOR_SORT_VALUE;
+	if (spec == ID2SYM(rb_intern("luminance")))  return COLOR_SORT_LUMINANCE;
+	if (spec == ID2SYM(rb_intern("hilbert")))    return COLOR_SORT_HILBERT;
+	if (spec == ID2SYM(rb_intern("morton")))     return COLOR_SORT_MORTON;
+	rb_raise(rb_eArgError, "Unknown key, must be :hue, :saturation, :value, :luminance, :hilbert or :morton");
+	return COLOR_SORT_HUE;
+}
+
+// spreads the bits of a byte to every third bit
+static inline unsigned int
+color_spread(unsigned int x)
+{
+	x = (x | (x << 8)) & 0x0300f00f;
+	x = (x | (x << 4)) & 0x030c30c3;
+	x = (x | (x << 2)) & 0x09249249;
+	return x;
+}
+
+// interleaves the bits of three bytes, most significant first, x leading
+static inline unsigned int
+color_interleave(unsigned int x, unsigned int y, unsigned int z)
+{
+	return (color_spread(x) << 2) | (color_spread(y) << 1) | color_spread(z);
+}
+
+// position on a 3D Hilbert curve of 8 bits per axis (Skilling's transform),
+// written without branches as they are unpredictable on color data
+static unsigned int
+color_hilbert(unsigned int x, unsigned int y, unsigned int z)
+{
+	unsigned int X[3] = { x, y, z };
+	unsigned int t;
+	for (unsigned int Q = 0x80; Q > 1; Q >>= 1) {
+		unsigned int P = Q-1;
+		for (int i = 0; i < 3; i++) {
+			unsigned int set = -((X[i] & Q) != 0);
+			X[0] ^= P & set;
+			t     = (X[0] ^ X[i]) & P & ~set;
+			X[0] ^= t;
+			X[i] ^= t;
+		}
+	}
+	X[1] ^= X[0];
+	X[2] ^= X[1];
+	t = 0;
+	for (unsigned int Q = 0x80; Q > 1; Q >>= 1) {
+		t ^= (Q-1) & -((X[2] & Q) != 0);
+	}
+	return color_interleave(X[0]^t, X[1]^t, X[2]^t);
+}
+
+static inline unsigned int
+color_sort_unit(float value, unsigned int max)
+{
+	return (unsigned int)(color_unitf(value)*max+0.5f);
+}
+
+static inline unsigned int
+color_sort_key_rgb(cRGB *rgb, int key)
+{
+	switch(key) {
+		case COLOR_SORT_LUMINANCE:
+			return (unsigned int)(color_rgb_luminance(rgb)*4294967040.0);
+		case COLOR_SORT_HILBERT:
+			return color_hilbert(rgb->r, rgb->g, rgb->b);
+	}
+	return color_interleave(rgb->r, rgb->g, rgb->b);
+}
+
+static unsigned int
+color_sort_key(cRGBF *color, int key)
+{
+	cHSV hsv;
+	cRGB rgb;
+	switch(key) {
+		case COLOR_SORT_HUE:
+		case COLOR_SORT_SATURATION:
+		case COLOR_SORT_VALUE:
+			// the attribute gets 16 bits, ties are broken by the other two
+			color_convert_rgbf_to_hsv(color, &hsv);
+			unsigned int h = color_sort_unit(hsv.h, 65535), s = color_sort_unit(hsv.s, 65535), v = color_sort_unit(hsv.v, 65535);
+			if (key == COLOR_SORT_HUE)        return (h << 16) | ((s >> 8) << 8) | (v >> 8);
+			if (key == COLOR_SORT_SATURATION) return (s << 16) | ((v >> 8) << 8) | (h >> 8);
+			return (v << 16) | ((h >> 8) << 8) | (s >> 8);
+	}
+	rgb.r = color_sort_unit(color->r, 255);
+	rgb.g = color_sort_unit(color->g, 255);
+	rgb.b = color_sort_unit(color->b, 255);
+	return color_sort_key_rgb(&rgb, key);
+}
+
+/*
+ * One 32 bit sort key per color of a buffer of any model, alpha is ignored.
+ */
+extern void
+color_sort_keys(cBuffer *buffer, int key, unsigned int *keys)
+{
+	cRGBF      block[COLOR_SORT_BLOCK];
+	cConverter decode;
+	size_t     size = color_model_size(buffer->model);
+	if (buffer->model == COLOR_MODEL_RGB && key >= COLOR_SORT_LUMINANCE) {
+		cRGB *colors = (cRGB *)buffer->data;
+		for (long i = 0; i < buffer->length; i++) {
+			keys[i] = color_sort_key_rgb(&colors[i], key);
+		}
+		return;
+	}
+	color_converter_resolve(&decode, buffer->model, COLOR_MODEL_RGBF);
+	for (long start = 0; start < buffer->length; start += COLOR_SORT_BLOCK) {
+		long length = buffer->length-start < COLOR_SORT_BLOCK ? buffer->length-start : COLOR_SORT_BLOCK;
+		color_converter_run_buffer(&decode, buffer->data+start*size, (char *)block, length);
+		for (long i = 0; i < length; i++) {
+			keys[start+i] = color_sort_key(&block[i], key);
+		}
+	}
+}
+
+/*
+ * Stable LSD radix sort, one pass per byte of the keys. Order receives the
+ * original indices in sorted order, keys are sorted along. Passes where all
+ * keys share the same byte are skipped.
+ */
+extern void
+color_radix_sort(unsigned int *keys, unsigned int *order, long length)
+{
+	unsigned int *tmp_keys  = ALLOC_N(unsigned int, length > 0 ? length : 1);
+	unsigned int *tmp_order = ALLOC_N(unsigned int, length > 0 ? length : 1);
+	long count[4][256];
+
+	memset(count, 0, sizeof(count));
+	for (long i = 0; i < length; i++) {
+		order[i] = (unsigned int)i;
+		for (int pass = 0; pass < 4; pass++) count[pass][(keys[i] >> (pass*8)) & 0xff]++;
+	}
+	for (int pass = 0; pass < 4; pass++) {
+		int shift = pass*8;
+		if (length == 0 || count[pass][(keys[0] >> shift) & 0xff] == length) continue;
+		long offset = 0;
+		for (int byte = 0; byte < 256; byte++) {
+			long n = count[pass][byte];
+			count[pass][byte] = offset;
+			offset += n;
+		}
+		for (long i = 0; i < length; i++) {
+			long to        = count[pass][(keys[i] >> shift) & 0xff]++;
+			tmp_keys[to]   = keys[i];
+			tmp_order[to]  = order[i];
+		}
+		memcpy(keys, tmp_keys, length*sizeof(unsigned int));
+		memcpy(order, tmp_order, length*sizeof(unsigned int));
+	}
+	xfree(tmp_keys);
+	xfree(tmp_order);
+}
+
+/*
+ *  call-seq:
+ *     buffer.order(key[, options]) -> string
+ *
+ *  The permutation that sorts this buffer by +key+: a binary String of
+ *  native unsigned 32 bit integers (<code>unpack("L*")</code>), element i
+ *  is the index of the i-th color in sorted order. Keys are :hue,
+ *  :saturation and :value (ties broken by the other HSV attributes),
+ *  :luminance (relative luminance) and :hilbert or :morton (position on a
+ *  space filling curve through RGB, which keeps similar colors close).
+ *  The sort is a stable O(n) radix sort. With :reverse => true the order
+ *  is descending.
+ */
+extern VALUE
+rb_color_buffer_order(int argc, VALUE *argv, VALUE self)
+{
+	VALUE r_key, options;
+	rb_scan_args(argc, argv, "11", &r_key, &options);
+	cBuffer *buffer = color_buffer_get(self, -1);
+	int key         = color_sort_key_get(r_key);
+	int reverse     = !NIL_P(options) && RTEST(rb_hash_aref(options, ID2SYM(rb_intern("reverse"))));
+	if (buffer->length > 0xffffffffL) {
+		rb_raise(rb_eArgError, "Buffer too large to sort");
+	}
+
+	volatile VALUE keys  = rb_str_new(NULL, buffer->length*sizeof(unsigned int));
+	volatile VALUE order = rb_str_new(NULL, buffer->length*sizeof(unsigned int));
+	unsigned int *k     = (unsigned int *)RSTRING_PTR(keys);
+	unsigned int *index = (unsigned int *)RSTRING_PTR(order);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_SORT, buffer->length);
+	color_sort_keys(buffer, key, k);
+	if (reverse) {
+		// inverting the keys keeps equal keys in their original order
+		for (long i = 0; i < buffer->length; i++) k[i] = ~k[i];
+	}
+	color_radix_sort(k, index, buffer->length);
+	return order;
+}
+
+/*
+ *  call-seq:
+ *     buffer.permute(order) -> buffer
+ *
+ *  A new buffer with the colors at the indices in +order+ (a String as
+ *  returned by Color::Buffer#order, or an Array of Integers).
+ */
+extern VALUE
+rb_color_buffer_permute(VALUE self, VALUE order)
+{
+	cBuffer *result;
+	cBuffer *buffer = color_buffer_get(self, -1);
+	size_t size     = color_model_size(buffer->model);
+	if (TYPE(order) == T_ARRAY) {
+		order = rb_funcall(order, rb_intern("pack"), 1, rb_str_new2("L*"));
+	}
+	Check_Type(order, T_STRING);
+	long length         = RSTRING_LEN(order)/sizeof(unsigned int);
+	unsigned int *index = (unsigned int *)RSTRING_PTR(order);
+	VALUE rb_result     = color_buffer_new(buffer->model, length, &result);
+	COLOR_STAT_KERNEL(COLOR_KERNEL_PERMUTE, length);
+	for (long i = 0; i < length; i++) {
+		if ((long)index[i] >= buffer->length) {
+			rb_raise(rb_eIndexError, "index %u out of buffer", index[i]);
+		}
+		memcpy(result->data+i*size, buffer->data+index[i]*size, size);
+	}
+	return rb_result;
+}
+
+/*
+ *  call-seq:
+ *     buffer.sort_by_key(key[, options]) -> buffer
+ *
+ *  A new buffer sorted by +key+, see Color::Buffer#order.
+ */
+extern VALUE
+rb_color_buffer_sort_by_key(int argc, VALUE *argv, VALUE self)
+{
+	return rb_color_buffer_permute(self, rb_color_buffer_order(argc, argv, self));
+}
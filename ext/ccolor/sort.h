@@ -0,0 +1,15 @@
+enum {
+	COLOR_SORT_HUE,
+	COLOR_SORT_SATURATION,
+	COLOR_SORT_VALUE,
+	COLOR_SORT_LUMINANCE,
+	COLOR_SORT_HILBERT,
+	COLOR_SORT_MORTON
+};
+
+extern int color_sort_key_get(VALUE spec);
+extern void color_sort_keys(cBuffer *buffer, int key, unsigned int *keys);
+extern void color_radix_sort(unsigned int *keys, unsigned int *order, long length);
+extern VALUE rb_color_buffer_order(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_buffer_permute(VALUE self, VALUE order);
+extern VALUE rb_color_buffer_sort_by_key(int argc, VALUE *argv, VALUE self);
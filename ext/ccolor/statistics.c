@@ -0,0 +1,698 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "buffer.h"
+#include "linear.h"
+#include "statistics.h"
+
+#define COLOR_SKETCH_DEPTH  4     // rows of the count-min sketch
+#define COLOR_SKETCH_BITS   11    // 2048 counters per row
+#define COLOR_SKETCH_WIDTH  (1 << COLOR_SKETCH_BITS)
+#define COLOR_STATS_TOP_MAX 32
+#define COLOR_STATS_CHUNK   65536 // colors counted before merging into the mean
+#define COLOR_HUE_STEPS     3600  // tenths of a degree
+#define COLOR_STATS_VERSION 1
+
+// fixed, so sketches of other processes can be merged
+static const unsigned int color_sketch_seeds[COLOR_SKETCH_DEPTH] = {
+	0x9e3779b1u, 0x85ebca77u, 0xc2b2ae3du, 0x27d4eb2fu
+};
+
+static float color_hue_cos[COLOR_HUE_STEPS];
+static float color_hue_sin[COLOR_HUE_STEPS];
+
+/*
+ * A Color::Stats, everything in it is fixed size. Channels are linear red,
+ * green, blue and alpha/255, mean and m2 (sum of squared deviations) are
+ * merged with Chan's formula. Dominant colors are keys of +bits+ per channel
+ * counted in the sketch, up to 4*top of them are kept as candidates, the
+ * ones with the largest estimates.
+ */
+typedef struct _cColorStats {
+	long   count;
+	double mean[4];
+	double m2[4];
+	unsigned char min[4];
+	unsigned char max[4];
+	long   hue_count;     // colors with a hue, not gray
+	double hue_cos;
+	double hue_sin;
+	int    top;
+	int    bits;
+	int    candidates;
+	unsigned int keys[4*COLOR_STATS_TOP_MAX];
+	int    lowest;        // candidate with the smallest estimate, -1 if unknown
+	unsigned long long lowest_count; // its estimate when it was found
+	unsigned long long sketch[COLOR_SKETCH_DEPTH][COLOR_SKETCH_WIDTH];
+} cColorStats;
+
+extern void
+color_statistics_init(void)
+{
+	for (int i = 0; i < COLOR_HUE_STEPS; i++) {
+		double angle = 2*3.14159265358979323846*i/COLOR_HUE_STEPS;
+		color_hue_cos[i] = (float)cos(angle);
+		color_hue_sin[i] = (float)sin(angle);
+	}
+}
+
+static inline unsigned int
+color_stats_key(cColorStats *stats, const cRGB *color)
+{
+	int shift = 8-stats->bits;
+	return (unsigned int)(color->r >> shift) << (2*stats->bits) | (color->g >> shift) << stats->bits | (color->b >> shift);
+}
+
+static inline unsigned int
+color_sketch_slot(unsigned int key, int row)
+{
+	return ((key+1)*color_sketch_seeds[row]) >> (32-COLOR_SKETCH_BITS);
+}
+
+static unsigned long long
+color_sketch_estimate(cColorStats *stats, unsigned int key)
+{
+	unsigned long long estimate = stats->sketch[0][color_sketch_slot(key, 0)];
+	for (int row = 1; row < COLOR_SKETCH_DEPTH; row++) {
+		unsigned long long count = stats->sketch[row][color_sketch_slot(key, row)];
+		if (count < estimate) estimate = count;
+	}
+	return estimate;
+}
+
+static void
+color_stats_lowest(cColorStats *stats)
+{
+	unsigned long long lowest = 0;
+	stats->lowest = 0;
+	for (int i = 0; i < stats->candidates; i++) {
+		unsigned long long estimate = color_sketch_estimate(stats, stats->keys[i]);
+		if (i == 0 || estimate < lowest) {
+			lowest        = estimate;
+			stats->lowest = i;
+		}
+	}
+	stats->lowest_count = lowest;
+}
+
+/*
+ * Counts +n+ colors of +key+ and keeps it if it is among the largest. Most
+ * keys are estimated below the lowest candidate and need no search; as
+ * estimates only grow, a stale lowest_count merely searches more often.
+ */
+static void
+color_stats_count_key(cColorStats *stats, unsigned int key, unsigned long long n)
+{
+	int limit = 4*stats->top;
+	for (int row = 0; row < COLOR_SKETCH_DEPTH; row++) {
+		stats->sketch[row][color_sketch_slot(key, row)] += n;
+	}
+	unsigned long long estimate = color_sketch_estimate(stats, key);
+	if (stats->candidates == limit && stats->lowest >= 0 && estimate <= stats->lowest_count) return;
+	for (int i = 0; i < stats->candidates; i++) {
+		if (stats->keys[i] == key) {
+			if (i == stats->lowest) stats->lowest = -1;
+			return;
+		}
+	}
+	if (stats->candidates < limit) {
+		stats->keys[stats->candidates++] = key;
+		stats->lowest = -1;
+		return;
+	}
+	color_stats_lowest(stats);
+	if (estimate > stats->lowest_count) {
+		stats->keys[stats->lowest] = key;
+		stats->lowest = -1;
+	}
+}
+
+// the hue of HSV as index into the cos/sin tables, -1 for grays
+static inline int
+color_stats_hue(const cRGB *color)
+{
+	int r = color->r, g = color->g, b = color->b;
+	int max = max3(r, g, b), min = min3(r, g, b);
+	float hue;
+	if (max == min) return -1;
+	if (max == r)      hue = (float)(g-b)/(max-min)+(g < b ? 6 : 0);
+	else if (max == g) hue = (float)(b-r)/(max-min)+2;
+	else               hue = (float)(r-g)/(max-min)+4;
+	return (int)(hue*(COLOR_HUE_STEPS/6)+0.5f) % COLOR_HUE_STEPS;
+}
+
+// merges count colors with mean and m2 into stats
+static void
+color_stats_merge_moments(cColorStats *stats, long count, const double *mean, const double *m2)
+{
+	long total = stats->count+count;
+	if (!count) return;
+	for (int k = 0; k < 4; k++) {
+		double delta   = mean[k]-stats->mean[k];
+		stats->mean[k] += delta*count/total;
+		stats->m2[k]   += m2[k]+delta*delta*((double)stats->count*count/total);
+	}
+	stats->count = total;
+}
+
+static inline unsigned int
+color_stats_pixel(const cRGB *color)
+{
+	unsigned int pixel;
+	memcpy(&pixel, color, sizeof(cRGB));
+	return pixel;
+}
+
+/*
+ * Channels are counted in histograms, which give the sums for the mean and
+ * variance and min/max per chunk. Runs of equal colors, common on
+ * screens, are looked at once.
+ */
+static void
+color_stats_add_chunk(cColorStats *stats, const cRGB *colors, long length)
+{
+	unsigned int histogram[4][256];
+	double mean[4], m2[4];
+	memset(histogram, 0, sizeof(histogram));
+	for (long i = 0; i < length;) {
+		unsigned int pixel = color_stats_pixel(&colors[i]);
+		long run = i+1;
+		while (run < length && color_stats_pixel(&colors[run]) == pixel) run++;
+		histogram[0][colors[i].r]     += run-i;
+		histogram[1][colors[i].g]     += run-i;
+		histogram[2][colors[i].b]     += run-i;
+		histogram[3][colors[i].alpha] += run-i;
+		int hue = color_stats_hue(&colors[i]);
+		if (hue >= 0) {
+			stats->hue_count += run-i;
+			stats->hue_cos   += (double)color_hue_cos[hue]*(run-i);
+			stats->hue_sin   += (double)color_hue_sin[hue]*(run-i);
+		}
+		color_stats_count_key(stats, color_stats_key(stats, &colors[i]), run-i);
+		i = run;
+	}
+	for (int k = 0; k < 4; k++) {
+		double sum = 0, squares = 0;
+		for (int v = 0; v < 256; v++) {
+			if (!histogram[k][v]) continue;
+			double value = k < 3 ? color_srgb_to_linear_lut[v] : v/255.0;
+			sum     += histogram[k][v]*value;
+			squares += histogram[k][v]*value*value;
+			if (v < stats->min[k]) stats->min[k] = (unsigned char)v;
+			if (v > stats->max[k]) stats->max[k] = (unsigned char)v;
+		}
+		mean[k] = sum/length;
+		m2[k]   = squares-sum*mean[k];
+		if (m2[k] < 0) m2[k] = 0;
+	}
+	color_stats_merge_moments(stats, length, mean, m2);
+}
+
+/*
+ * Adds colors in chunks, so the sums of a chunk stay precise.
+ */
+static void
+color_stats_add(cColorStats *stats, const cRGB *colors, long length)
+{
+	if (!stats->count) {
+		memset(stats->min, 0xff, 4);
+		memset(stats->max, 0, 4);
+	}
+	COLOR_STAT_KERNEL(COLOR_KERNEL_STATISTICS, length);
+	for (long i = 0; i < length; i += COLOR_STATS_CHUNK) {
+		color_stats_add_chunk(stats, colors+i, length-i < COLOR_STATS_CHUNK ? length-i : COLOR_STATS_CHUNK);
+	}
+}
+
+static void
+color_stats_reset(cColorStats *stats, int top, int bits)
+{
+	memset(stats, 0, sizeof(cColorStats));
+	stats->top    = top;
+	stats->bits   = bits;
+	stats->lowest = -1;
+}
+
+static void
+color_stats_free(cColorStats *stats)
+{
+	xfree(stats);
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_stats__allocate(VALUE class)
+{
+	cColorStats *stats;
+	VALUE rb_stats = COLOR_MAKE_STRUCT(class, cColorStats, NULL, color_stats_free, stats);
+	color_stats_reset(stats, 8, 5);
+	return rb_stats;
+}
+
+/*
+ *  call-seq:
+ *     Color::Stats.new([options])
+ *
+ *  An empty accumulator. Options:
+ *  :top:: the number of dominant colors to track, 1 to 32, default 8
+ *  :bits:: bits per channel dominant colors are told apart by, 1 to 8,
+ *          default 5 (32 levels)
+ *  Only stats of the same options can be merged.
+ */
+extern VALUE
+rb_color_stats_initialize(int argc, VALUE *argv, VALUE self)
+{
+	cColorStats *stats;
+	VALUE options, top = Qnil, bits = Qnil;
+	rb_scan_args(argc, argv, "01", &options);
+	COLOR_GET_STRUCT(self, cColorStats, stats);
+	if (!NIL_P(options)) {
+		Check_Type(options, T_HASH);
+		top  = rb_hash_aref(options, ID2SYM(rb_intern("top")));
+		bits = rb_hash_aref(options, ID2SYM(rb_intern("bits")));
+	}
+	int c_top  = NIL_P(top) ? 8 : NUM2INT(top);
+	int c_bits = NIL_P(bits) ? 5 : NUM2INT(bits);
+	if (c_top < 1 || c_top > COLOR_STATS_TOP_MAX) {
+		rb_raise(rb_eArgError, "Invalid top, must be between 1 and %d", COLOR_STATS_TOP_MAX);
+	}
+	if (c_bits < 1 || c_bits > 8) {
+		rb_raise(rb_eArgError, "Invalid bits, must be between 1 and 8");
+	}
+	color_stats_reset(stats, c_top, c_bits);
+	return self;
+}
+
+/*
+ * :nodoc:
+ */
+extern VALUE
+rb_color_stats_initialize_copy(VALUE self, VALUE original)
+{
+	cColorStats *stats, *source;
+	COLOR_GET_STRUCT(self, cColorStats, stats);
+	COLOR_GET_STRUCT(original, cColorStats, source);
+	if (stats != source) memcpy(stats, source, sizeof(cColorStats));
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     stats.add(colors) -> stats
+ *
+ *  Adds a color, an array of colors of any model or an RGB buffer.
+ */
+extern VALUE
+rb_color_stats_add(VALUE self, VALUE colors)
+{
+	cColorStats *stats;
+	cAny tmp;
+	COLOR_CHECK_FROZEN(self);
+	COLOR_GET_STRUCT(self, cColorStats, stats);
+	if (CLASS_OF(colors) == rb_cBuffer) {
+		cBuffer *buffer = color_buffer_get(colors, COLOR_MODEL_RGB);
+		color_stats_add(stats, (cRGB *)buffer->data, buffer->length);
+	} else if (TYPE(colors) == T_ARRAY) {
+		long length = RARRAY_LEN(colors);
+		cRGB *rgb   = ALLOC_N(cRGB, length+1);
+		for (long i = 0; i < length; i++) {
+			color_buffer_store(COLOR_MODEL_RGB, &rgb[i], RARRAY_PTR(colors)[i]);
+		}
+		color_stats_add(stats, rgb, length);
+		xfree(rgb);
+	} else {
+		color_stats_add(stats, color_coerce(colors, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_STORE), 1);
+	}
+	return self;
+}
+
+static cColorStats *
+color_stats_get(VALUE rb_stats)
+{
+	cColorStats *stats;
+	if (CLASS_OF(rb_stats) != rb_cStats) {
+		rb_raise(rb_eTypeError, "Expected a Color::Stats");
+	}
+	COLOR_GET_STRUCT(rb_stats, cColorStats, stats);
+	return stats;
+}
+
+static void
+color_stats_merge(cColorStats *stats, cColorStats *other)
+{
+	unsigned int keys[8*COLOR_STATS_TOP_MAX];
+	int count = 0;
+	if (stats->top != other->top || stats->bits != other->bits) {
+		rb_raise(rb_eArgError, "Stats differ in their :top or :bits");
+	}
+	if (!other->count) return;
+	for (int k = 0; k < 4; k++) {
+		if (!stats->count || other->min[k] < stats->min[k]) stats->min[k] = other->min[k];
+		if (!stats->count || other->max[k] > stats->max[k]) stats->max[k] = other->max[k];
+	}
+	color_stats_merge_moments(stats, other->count, other->mean, other->m2);
+	stats->hue_count += other->hue_count;
+	stats->hue_cos   += other->hue_cos;
+	stats->hue_sin   += other->hue_sin;
+	for (int row = 0; row < COLOR_SKETCH_DEPTH; row++) {
+		for (int i = 0; i < COLOR_SKETCH_WIDTH; i++) {
+			stats->sketch[row][i] += other->sketch[row][i];
+		}
+	}
+	// the candidates of both, the ones with the largest merged estimates stay
+	memcpy(keys, stats->keys, stats->candidates*sizeof(unsigned int));
+	count = stats->candidates;
+	for (int i = 0; i < other->candidates; i++) {
+		int known = 0;
+		for (int j = 0; j < stats->candidates; j++) {
+			if (keys[j] == other->keys[i]) known = 1;
+		}
+		if (!known) keys[count++] = other->keys[i];
+	}
+	stats->candidates = 0;
+	stats->lowest     = -1;
+	for (int i = 0; i < count; i++) {
+		color_stats_count_key(stats, keys[i], 0);
+	}
+}
+
+/*
+ *  call-seq:
+ *     stats.merge!(other) -> stats
+ *
+ *  Adds the colors summarized in +other+, e.g. of another thread or
+ *  process, as if they had been added to this one.
+ */
+extern VALUE
+rb_color_stats_merge_bang(VALUE self, VALUE other)
+{
+	COLOR_CHECK_FROZEN(self);
+	color_stats_merge(color_stats_get(self), color_stats_get(other));
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     stats.merge(other) -> stats
+ *
+ *  Same as #merge!, but returns a new Color::Stats.
+ */
+extern VALUE
+rb_color_stats_merge(VALUE self, VALUE other)
+{
+	return rb_color_stats_merge_bang(rb_obj_dup(self), other);
+}
+
+/*
+ *  call-seq:
+ *     stats.count -> integer
+ *
+ *  The number of colors added.
+ */
+extern VALUE
+rb_color_stats_count(VALUE self)
+{
+	return LONG2NUM(color_stats_get(self)->count);
+}
+
+/*
+ *  call-seq:
+ *     stats.mean -> rgb or nil
+ *
+ *  The mean color, averaged in linear light, nil if empty.
+ */
+extern VALUE
+rb_color_stats_mean(VALUE self)
+{
+	cColorStats *stats = color_stats_get(self);
+	cRGB *mean;
+	if (!stats->count) return Qnil;
+	VALUE rb_mean = COLOR_MAKE_VALUE(rb_cRGB, cRGB, mean);
+	mean->r     = LINEAR2SRGB((float)stats->mean[0]);
+	mean->g     = LINEAR2SRGB((float)stats->mean[1]);
+	mean->b     = LINEAR2SRGB((float)stats->mean[2]);
+	mean->alpha = (unsigned char)color_cap((int)(stats->mean[3]*255+0.5), 0, 255);
+	return rb_mean;
+}
+
+/*
+ *  call-seq:
+ *     stats.variance -> [red, green, blue, alpha]
+ *
+ *  The variance of linear red, green and blue (0..1) and of alpha scaled
+ *  to 0..1, nil if empty.
+ */
+extern VALUE
+rb_color_stats_variance(VALUE self)
+{
+	cColorStats *stats = color_stats_get(self);
+	if (!stats->count) return Qnil;
+	return rb_ary_new3(4,
+		rb_float_new(stats->m2[0]/stats->count), rb_float_new(stats->m2[1]/stats->count),
+		rb_float_new(stats->m2[2]/stats->count), rb_float_new(stats->m2[3]/stats->count));
+}
+
+static VALUE
+color_stats_bound(VALUE self, int max)
+{
+	cColorStats *stats = color_stats_get(self);
+	cRGB *color;
+	if (!stats->count) return Qnil;
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, color);
+	memcpy(color, max ? stats->max : stats->min, sizeof(cRGB));
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     stats.min -> rgb or nil
+ *
+ *  The smallest red, green, blue and alpha, each of its own.
+ */
+extern VALUE
+rb_color_stats_min(VALUE self)
+{
+	return color_stats_bound(self, 0);
+}
+
+/*
+ *  call-seq:
+ *     stats.max -> rgb or nil
+ *
+ *  The largest red, green, blue and alpha, each of its own.
+ */
+extern VALUE
+rb_color_stats_max(VALUE self)
+{
+	return color_stats_bound(self, 1);
+}
+
+/*
+ *  call-seq:
+ *     stats.hue -> float or nil
+ *
+ *  The circular mean of the HSV hue of all colors but grays, 0...1 like
+ *  Color::HSV#hue, nil if there were none or their hues cancel out.
+ */
+extern VALUE
+rb_color_stats_hue(VALUE self)
+{
+	cColorStats *stats = color_stats_get(self);
+	if (!stats->hue_count || hypot(stats->hue_cos, stats->hue_sin) < 1e-6*stats->hue_count) return Qnil;
+	double turns = atan2(stats->hue_sin, stats->hue_cos)/(2*3.14159265358979323846);
+	return rb_float_new(turns < 0 ? turns+1 : turns);
+}
+
+/*
+ *  call-seq:
+ *     stats.hue_concentration -> float
+ *
+ *  How closely the hues gather around #hue, 1 for a single hue, near 0 for
+ *  hues all around the circle.
+ */
+extern VALUE
+rb_color_stats_hue_concentration(VALUE self)
+{
+	cColorStats *stats = color_stats_get(self);
+	if (!stats->hue_count) return rb_float_new(0);
+	return rb_float_new(hypot(stats->hue_cos, stats->hue_sin)/stats->hue_count);
+}
+
+/*
+ *  call-seq:
+ *     stats.luminance -> float or nil
+ *
+ *  The mean relative luminance (0..1), see Color::RGB#relative_luminance.
+ */
+extern VALUE
+rb_color_stats_luminance(VALUE self)
+{
+	cColorStats *stats = color_stats_get(self);
+	if (!stats->count) return Qnil;
+	return rb_float_new(0.2126*stats->mean[0]+0.7152*stats->mean[1]+0.0722*stats->mean[2]);
+}
+
+/*
+ *  call-seq:
+ *     stats.top([n]) -> [[rgb, count], ...]
+ *
+ *  The +n+ (default and at most :top) most frequent colors with their
+ *  estimated counts, most frequent first. Colors are the centers of
+ *  their :bits cells, counts may be too large by about 0.15% of #count.
+ */
+extern VALUE
+rb_color_stats_top(int argc, VALUE *argv, VALUE self)
+{
+	unsigned long long estimates[4*COLOR_STATS_TOP_MAX];
+	int order[4*COLOR_STATS_TOP_MAX];
+	VALUE limit;
+	rb_scan_args(argc, argv, "01", &limit);
+	cColorStats *stats = color_stats_get(self);
+	int n = NIL_P(limit) ? stats->top : NUM2INT(limit);
+	if (n > stats->top) n = stats->top;
+	if (n > stats->candidates) n = stats->candidates;
+	for (int i = 0; i < stats->candidates; i++) {
+		estimates[i] = color_sketch_estimate(stats, stats->keys[i]);
+		order[i]     = i;
+	}
+	// few candidates, insertion sort by estimate, then key
+	for (int i = 1; i < stats->candidates; i++) {
+		for (int j = i; j > 0; j--) {
+			int a = order[j-1], b = order[j];
+			if (estimates[a] > estimates[b] || (estimates[a] == estimates[b] && stats->keys[a] < stats->keys[b])) break;
+			order[j-1] = b;
+			order[j]   = a;
+		}
+	}
+	VALUE result = rb_ary_new2(n < 0 ? 0 : n);
+	int shift = 8-stats->bits, mask = (1 << stats->bits)-1, center = shift ? 1 << (shift-1) : 0;
+	for (int i = 0; i < n; i++) {
+		unsigned int key = stats->keys[order[i]];
+		cRGB *color;
+		VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, color);
+		color->r     = (unsigned char)(((key >> (2*stats->bits)) & mask) << shift | center);
+		color->g     = (unsigned char)(((key >> stats->bits) & mask) << shift | center);
+		color->b     = (unsigned char)((key & mask) << shift | center);
+		color->alpha = 0;
+		rb_ary_push(result, rb_ary_new3(2, rb_color, ULL2NUM(estimates[order[i]])));
+	}
+	return result;
+}
+
+// little endian, so dumps load on any platform
+static void
+color_stats_put(VALUE string, unsigned long long value, int bytes)
+{
+	char data[8];
+	for (int i = 0; i < bytes; i++) data[i] = (char)(value >> (8*i));
+	rb_str_cat(string, data, bytes);
+}
+
+static unsigned long long
+color_stats_take(const unsigned char **data, int bytes)
+{
+	unsigned long long value = 0;
+	for (int i = 0; i < bytes; i++) value |= (unsigned long long)(*data)[i] << (8*i);
+	*data += bytes;
+	return value;
+}
+
+static unsigned long long
+color_stats_double_bits(double value)
+{
+	unsigned long long bits;
+	memcpy(&bits, &value, 8);
+	return bits;
+}
+
+static double
+color_stats_bits_double(unsigned long long bits)
+{
+	double value;
+	memcpy(&value, &bits, 8);
+	return value;
+}
+
+/*
+ *  call-seq:
+ *     stats._dump(level) -> string
+ *
+ *  Used by Marshal.dump, the format is the same on all platforms.
+ */
+extern VALUE
+rb_color_stats_dump(VALUE self, VALUE level)
+{
+	cColorStats *stats = color_stats_get(self);
+	VALUE data = rb_str_new(NULL, 0);
+	color_stats_put(data, COLOR_STATS_VERSION, 1);
+	color_stats_put(data, stats->top, 1);
+	color_stats_put(data, stats->bits, 1);
+	color_stats_put(data, stats->candidates, 1);
+	color_stats_put(data, stats->count, 8);
+	for (int k = 0; k < 4; k++) {
+		color_stats_put(data, color_stats_double_bits(stats->mean[k]), 8);
+		color_stats_put(data, color_stats_double_bits(stats->m2[k]), 8);
+		color_stats_put(data, stats->min[k], 1);
+		color_stats_put(data, stats->max[k], 1);
+	}
+	color_stats_put(data, stats->hue_count, 8);
+	color_stats_put(data, color_stats_double_bits(stats->hue_cos), 8);
+	color_stats_put(data, color_stats_double_bits(stats->hue_sin), 8);
+	for (int i = 0; i < stats->candidates; i++) {
+		color_stats_put(data, stats->keys[i], 4);
+	}
+	for (int row = 0; row < COLOR_SKETCH_DEPTH; row++) {
+		for (int i = 0; i < COLOR_SKETCH_WIDTH; i++) {
+			color_stats_put(data, stats->sketch[row][i], 8);
+		}
+	}
+	return data;
+}
+
+/*
+ *  call-seq:
+ *     Color::Stats._load(string) -> stats
+ *
+ *  Used by Marshal.load.
+ */
+extern VALUE
+rb_color_stats__load(VALUE class, VALUE data)
+{
+	cColorStats *stats;
+	StringValue(data);
+	VALUE rb_stats = rb_color_stats__allocate(class);
+	COLOR_GET_STRUCT(rb_stats, cColorStats, stats);
+	const unsigned char *ptr = (unsigned char *)RSTRING_PTR(data);
+	long length = RSTRING_LEN(data);
+	if (length < 4 || ptr[0] != COLOR_STATS_VERSION || ptr[1] < 1 || ptr[1] > COLOR_STATS_TOP_MAX || ptr[2] < 1 || ptr[2] > 8 || ptr[3] > 4*ptr[1]
+		|| length != 4+8+4*18+24+4*ptr[3]+8*COLOR_SKETCH_DEPTH*COLOR_SKETCH_WIDTH) {
+		rb_raise(rb_eArgError, "Invalid Color::Stats dump");
+	}
+	color_stats_reset(stats, ptr[1], ptr[2]);
+	stats->candidates = ptr[3];
+	ptr += 4;
+	stats->count = (long)color_stats_take(&ptr, 8);
+	for (int k = 0; k < 4; k++) {
+		stats->mean[k] = color_stats_bits_double(color_stats_take(&ptr, 8));
+		stats->m2[k]   = color_stats_bits_double(color_stats_take(&ptr, 8));
+		stats->min[k]  = (unsigned char)color_stats_take(&ptr, 1);
+		stats->max[k]  = (unsigned char)color_stats_take(&ptr, 1);
+	}
+	stats->hue_count = (long)color_stats_take(&ptr, 8);
+	stats->hue_cos   = color_stats_bits_double(color_stats_take(&ptr, 8));
+	stats->hue_sin   = color_stats_bits_double(color_stats_take(&ptr, 8));
+	for (int i = 0; i < stats->candidates; i++) {
+		stats->keys[i] = (unsigned int)color_stats_take(&ptr, 4);
+	}
+	for (int row = 0; row < COLOR_SKETCH_DEPTH; row++) {
+		for (int i = 0; i < COLOR_SKETCH_WIDTH; i++) {
+			stats->sketch[row][i] = color_stats_take(&ptr, 8);
+		}
+	}
+	return rb_stats;
+}
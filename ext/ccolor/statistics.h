@@ -0,0 +1,18 @@
+extern void color_statistics_init(void);
+extern VALUE rb_color_stats__allocate(VALUE class);
+extern VALUE rb_color_stats_initialize(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_stats_initialize_copy(VALUE self, VALUE original);
+extern VALUE rb_color_stats_add(VALUE self, VALUE colors);
+extern VALUE rb_color_stats_merge_bang(VALUE self, VALUE other);
+extern VALUE rb_color_stats_merge(VALUE self, VALUE other);
+extern VALUE rb_color_stats_count(VALUE self);
+extern VALUE rb_color_stats_mean(VALUE self);
+extern VALUE rb_color_stats_variance(VALUE self);
+extern VALUE rb_color_stats_min(VALUE self);
+extern VALUE rb_color_stats_max(VALUE self);
+extern VALUE rb_color_stats_hue(VALUE self);
+extern VALUE rb_color_stats_hue_concentration(VALUE self);
+extern VALUE rb_color_stats_luminance(VALUE self);
+extern VALUE rb_color_stats_top(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_stats_dump(VALUE self, VALUE level);
+extern VALUE rb_color_stats__load(VALUE class, VALUE data);
@@ -0,0 +1,254 @@
+#include <ruby.h>
+#include <string.h>
+#include <stddef.h>
+#include "color.h"
+#include "convert.h"
+#include "stats.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#ifdef COLOR_STATS
+
+// allocation slots: the color models, then buffer, converter and others
+enum {
+	COLOR_ALLOC_BUFFER = COLOR_MODEL_COUNT,
+	COLOR_ALLOC_CONVERTER,
+	COLOR_ALLOC_OTHER,
+	COLOR_ALLOC_COUNT
+};
+
+static const char *color_kernel_names[COLOR_KERNEL_COUNT] = {
+	"closest", "quantize", "adjust", "pipeline", "blend", "interpolate",
+	"luminance", "contrast", "best_foreground", "sort", "permute", "palette", "pack", "planar", "alpha", "statistics", "diff", "gradient"
+};
+
+static const char *color_coerce_names[COLOR_COERCE_COUNT] = {
+	"closest", "blend", "contrast", "store", "arithmetic", "distance", "interpolate", "format"
+};
+
+// counters of one native thread, only ever written by that thread
+typedef struct _cStats {
+	unsigned long alloc[COLOR_ALLOC_COUNT];
+	unsigned long convert[COLOR_MODEL_COUNT][COLOR_MODEL_COUNT];
+	unsigned long calls[COLOR_KERNEL_COUNT];
+	unsigned long elements[COLOR_KERNEL_COUNT];
+	unsigned long coerce[COLOR_COERCE_COUNT];
+	struct _cStats *next;
+} cStats;
+
+static __thread cStats *color_stats_local = NULL;
+static cStats *color_stats_all = NULL;
+#ifdef HAVE_PTHREAD_H
+// counters of threads which exited, their blocks are freed
+static cStats color_stats_retired;
+static pthread_mutex_t color_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t  color_stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t   color_stats_key;
+#endif
+
+static void
+color_stats_add_to(cStats *total, cStats *stats)
+{
+	unsigned long *sum    = (unsigned long *)total;
+	unsigned long *values = (unsigned long *)stats;
+	size_t count          = offsetof(cStats, next)/sizeof(unsigned long);
+	for (size_t i = 0; i < count; i++) sum[i] += values[i];
+}
+
+#ifdef HAVE_PTHREAD_H
+// thread exit: moves the counts into the retired total, unlinks the block
+static void
+color_stats_retire(void *block)
+{
+	cStats *stats = block;
+	pthread_mutex_lock(&color_stats_lock);
+	color_stats_add_to(&color_stats_retired, stats);
+	for (cStats **link = &color_stats_all; *link; link = &(*link)->next) {
+		if (*link == stats) {
+			*link = stats->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&color_stats_lock);
+	color_stats_local = NULL;
+	free(stats);
+}
+
+static void
+color_stats_key_create(void)
+{
+	pthread_key_create(&color_stats_key, color_stats_retire);
+}
+#endif
+
+/*
+ * The counters of the calling thread, registered on first use. Only the
+ * thread itself writes them, readers and thread exit hold the lock.
+ */
+static cStats *
+color_stats(void)
+{
+	if (color_stats_local) return color_stats_local;
+	cStats *stats = calloc(1, sizeof(cStats));
+	if (!stats) {
+		// counting is best effort, never fail the operation counted
+		static __thread cStats fallback;
+		return color_stats_local = &fallback;
+	}
+#ifdef HAVE_PTHREAD_H
+	pthread_once(&color_stats_once, color_stats_key_create);
+	pthread_setspecific(color_stats_key, stats);
+	pthread_mutex_lock(&color_stats_lock);
+#endif
+	stats->next     = color_stats_all;
+	color_stats_all = stats;
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_unlock(&color_stats_lock);
+#endif
+	return color_stats_local = stats;
+}
+
+extern void
+color_stats_alloc(VALUE class)
+{
+	int slot = color_model_of(class);
+	if (slot < 0) {
+		if (class == rb_cBuffer)         slot = COLOR_ALLOC_BUFFER;
+		else if (class == rb_cConverter) slot = COLOR_ALLOC_CONVERTER;
+		else                             slot = COLOR_ALLOC_OTHER;
+	}
+	color_stats()->alloc[slot]++;
+}
+
+extern void
+color_stats_convert(int from, int to, long elements)
+{
+	color_stats()->convert[from][to] += elements;
+}
+
+extern void
+color_stats_kernel(int kernel, long elements)
+{
+	cStats *stats = color_stats();
+	stats->calls[kernel]++;
+	stats->elements[kernel] += elements;
+}
+
+extern void
+color_stats_coerce(int site)
+{
+	color_stats()->coerce[site]++;
+}
+
+static void
+color_stats_sum(cStats *sum)
+{
+	memset(sum, 0, sizeof(cStats));
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_lock(&color_stats_lock);
+	color_stats_add_to(sum, &color_stats_retired);
+#endif
+	for (cStats *stats = color_stats_all; stats; stats = stats->next) {
+		color_stats_add_to(sum, stats);
+	}
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_unlock(&color_stats_lock);
+#endif
+}
+
+#define NAME2SYM(name) ID2SYM(rb_intern(name))
+
+/*
+ *  call-seq:
+ *     Color.stats -> hash or nil
+ *
+ *  Counters of the native extension, summed over all threads, or nil if
+ *  it was built without --enable-stats. The hash has the keys
+ *  :allocations:: color objects, buffers and converters created, by class
+ *  :conversions:: converted colors, by [from, to] class pair
+ *  :kernels::     calls and processed elements of the batch kernels, by name
+ *  :coerce::      arguments of another class coerced through ruby, by method
+ */
+extern VALUE
+rb_color__stats(VALUE module)
+{
+	cStats sum;
+	VALUE  allocations = rb_hash_new(), conversions = rb_hash_new();
+	VALUE  kernels     = rb_hash_new(), coerce      = rb_hash_new();
+	VALUE  result      = rb_hash_new();
+	color_stats_sum(&sum);
+
+	for (int i = 0; i < COLOR_MODEL_COUNT; i++) {
+		rb_hash_aset(allocations, color_model_class(i), ULONG2NUM(sum.alloc[i]));
+	}
+	rb_hash_aset(allocations, rb_cBuffer,    ULONG2NUM(sum.alloc[COLOR_ALLOC_BUFFER]));
+	rb_hash_aset(allocations, rb_cConverter, ULONG2NUM(sum.alloc[COLOR_ALLOC_CONVERTER]));
+	rb_hash_aset(allocations, ID2SYM(rb_intern("other")), ULONG2NUM(sum.alloc[COLOR_ALLOC_OTHER]));
+	for (int from = 0; from < COLOR_MODEL_COUNT; from++) {
+		for (int to = 0; to < COLOR_MODEL_COUNT; to++) {
+			if (!sum.convert[from][to]) continue;
+			rb_hash_aset(conversions,
+				rb_assoc_new(color_model_class(from), color_model_class(to)),
+				ULONG2NUM(sum.convert[from][to]));
+		}
+	}
+	for (int i = 0; i < COLOR_KERNEL_COUNT; i++) {
+		VALUE kernel = rb_hash_new();
+		rb_hash_aset(kernel, NAME2SYM("calls"),    ULONG2NUM(sum.calls[i]));
+		rb_hash_aset(kernel, NAME2SYM("elements"), ULONG2NUM(sum.elements[i]));
+		rb_hash_aset(kernels, NAME2SYM(color_kernel_names[i]), kernel);
+	}
+	for (int i = 0; i < COLOR_COERCE_COUNT; i++) {
+		rb_hash_aset(coerce, NAME2SYM(color_coerce_names[i]), ULONG2NUM(sum.coerce[i]));
+	}
+	rb_hash_aset(result, NAME2SYM("allocations"), allocations);
+	rb_hash_aset(result, NAME2SYM("conversions"), conversions);
+	rb_hash_aset(result, NAME2SYM("kernels"),     kernels);
+	rb_hash_aset(result, NAME2SYM("coerce"),      coerce);
+	return result;
+}
+
+/*
+ *  call-seq:
+ *     Color.reset_stats -> nil
+ *
+ *  Sets all counters of Color.stats to 0.
+ */
+extern VALUE
+rb_color__reset_stats(VALUE module)
+{
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_lock(&color_stats_lock);
+	memset(&color_stats_retired, 0, sizeof(cStats));
+#endif
+	for (cStats *stats = color_stats_all; stats; stats = stats->next) {
+		memset(stats, 0, offsetof(cStats, next));
+	}
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_unlock(&color_stats_lock);
+#endif
+	return Qnil;
+}
+
+#else
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color__stats(VALUE module)
+{
+	return Qnil;
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color__reset_stats(VALUE module)
+{
+	return Qnil;
+}
+
+#endif
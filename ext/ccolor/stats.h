@@ -0,0 +1,2 @@
+extern VALUE rb_color__stats(VALUE module);
+extern VALUE rb_color__reset_stats(VALUE module);
@@ -0,0 +1,430 @@
+#include <ruby.h>
+#include <string.h>
+#include "color.h"
+#include "convert.h"
+#include "term.h"
+
+#define COLOR_TERM_CHUNK 8192  // bytes collected before they are written to an IO
+
+// attributes of select graphic rendition (SGR)
+enum {
+	COLOR_SGR_BOLD      = 1,
+	COLOR_SGR_UNDERLINE = 2,
+	COLOR_SGR_BLINK     = 4,
+	COLOR_SGR_INVERT    = 8
+};
+
+// how a color is sent to the terminal
+enum {
+	COLOR_SGR_DEFAULT,  // the terminal's own
+	COLOR_SGR_BASIC,    // one of the 8 ANSI colors, 30+index
+	COLOR_SGR_INDEXED,  // one of 256, 38;5;index
+	COLOR_SGR_TRUE      // 24 bit, 38;2;r;g;b
+};
+
+typedef struct _cSgrColor {
+	int kind;
+	int value;          // index, or 0xrrggbb
+} cSgrColor;
+
+typedef struct _cSgr {
+	cSgrColor fg;
+	cSgrColor bg;
+	int attributes;
+} cSgr;
+
+typedef struct _cTermWriter {
+	VALUE to;           // a String, or anything responding to write
+	int   string;
+	int   depth;        // 8, 256 or 0x1000000 colors
+	cSgr  state;        // what the terminal shows now
+	long  used;
+	char  chunk[COLOR_TERM_CHUNK];
+} cTermWriter;
+
+// the terminal colors by ANSI index, see Color::Term::Palette
+static const char *color_term_names[8] = {
+	"black", "red", "green", "yellow", "blue", "purple", "cyan", "white"
+};
+
+// codes to turn the attributes on and off, by bit
+static const int color_sgr_on[4]  = { 1, 4, 5, 7 };
+static const int color_sgr_off[4] = { 22, 24, 25, 27 };
+
+// the levels of the 6x6x6 cube of the 256 color palette
+static const int color_cube_levels[6] = { 0, 95, 135, 175, 215, 255 };
+
+static void
+color_term_writer_mark(cTermWriter *writer)
+{
+	rb_gc_mark(writer->to);
+}
+
+/*
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_term_writer__allocate(VALUE class)
+{
+	cTermWriter *writer;
+	VALUE rb_writer = COLOR_MAKE_STRUCT(class, cTermWriter, color_term_writer_mark, free, writer);
+	memset(writer, 0, sizeof(cTermWriter));
+	writer->to    = Qnil;
+	writer->depth = 256;
+	return rb_writer;
+}
+
+static void
+color_term_flush(cTermWriter *writer)
+{
+	if (!writer->used) return;
+	rb_funcall(writer->to, rb_intern("write"), 1, rb_str_new(writer->chunk, writer->used));
+	writer->used = 0;
+}
+
+static void
+color_term_bytes(cTermWriter *writer, const char *bytes, long length)
+{
+	if (writer->string) {
+		rb_str_cat(writer->to, bytes, length);
+		return;
+	}
+	if (writer->used+length > COLOR_TERM_CHUNK) color_term_flush(writer);
+	if (length > COLOR_TERM_CHUNK) {
+		rb_funcall(writer->to, rb_intern("write"), 1, rb_str_new(bytes, length));
+		return;
+	}
+	memcpy(writer->chunk+writer->used, bytes, length);
+	writer->used += length;
+}
+
+static inline long
+color_term_square(long value)
+{
+	return value*value;
+}
+
+// nearest of the 8 ANSI colors, which are 0 or 255 per channel
+static int
+color_term_basic(cRGB *rgb)
+{
+	int best = 0;
+	long best_distance = -1;
+	for (int i = 0; i < 8; i++) {
+		long distance = color_term_square(rgb->r-(i & 1 ? 255 : 0))
+			+color_term_square(rgb->g-(i & 2 ? 255 : 0))
+			+color_term_square(rgb->b-(i & 4 ? 255 : 0));
+		if (best_distance < 0 || distance < best_distance) {
+			best_distance = distance;
+			best          = i;
+		}
+	}
+	return best;
+}
+
+static inline int
+color_cube_index(int value)
+{
+	return value < 48 ? 0 : (value < 115 ? 1 : (value-35)/40);
+}
+
+// nearest of the 6x6x6 cube and the 24 grays of the 256 color palette
+static int
+color_term_indexed(cRGB *rgb)
+{
+	int r = color_cube_index(rgb->r), g = color_cube_index(rgb->g), b = color_cube_index(rgb->b);
+	int average = (rgb->r+rgb->g+rgb->b)/3;
+	int gray    = average > 238 ? 23 : (average < 3 ? 0 : (average-3)/10);
+	int level   = 8+gray*10;
+	long cube_distance = color_term_square(rgb->r-color_cube_levels[r])
+		+color_term_square(rgb->g-color_cube_levels[g])
+		+color_term_square(rgb->b-color_cube_levels[b]);
+	long gray_distance = color_term_square(rgb->r-level)+color_term_square(rgb->g-level)+color_term_square(rgb->b-level);
+	return gray_distance < cube_distance ? 232+gray : 16+36*r+6*g+b;
+}
+
+/*
+ * A color as the terminal gets it: nil is the default, a symbol one of the
+ * 8 ANSI colors (like Color::Term), anything else a color of any model,
+ * reduced to what the depth allows.
+ */
+static void
+color_sgr_color(VALUE color, int depth, cSgrColor *sgr)
+{
+	cAny tmp;
+	cRGB *rgb;
+	if (NIL_P(color)) {
+		sgr->kind  = COLOR_SGR_DEFAULT;
+		sgr->value = 0;
+		return;
+	}
+	if (RTEST(rb_obj_is_kind_of(color, rb_cTerm))) color = rb_ivar_get(color, rb_intern("@name"));
+	if (SYMBOL_P(color)) {
+		const char *name = rb_id2name(SYM2ID(color));
+		for (int i = 0; i < 8; i++) {
+			if (!strcmp(name, color_term_names[i])) {
+				sgr->kind  = COLOR_SGR_BASIC;
+				sgr->value = i;
+				return;
+			}
+		}
+		rb_raise(rb_eArgError, "Unknown terminal color :%s", name);
+	}
+	rgb = color_coerce(color, COLOR_MODEL_RGB, &tmp, COLOR_COERCE_FORMAT);
+	switch(depth) {
+		case 8:
+			sgr->kind  = COLOR_SGR_BASIC;
+			sgr->value = color_term_basic(rgb);
+			break;
+		case 256:
+			sgr->kind  = COLOR_SGR_INDEXED;
+			sgr->value = color_term_indexed(rgb);
+			break;
+		default:
+			sgr->kind  = COLOR_SGR_TRUE;
+			sgr->value = rgb->r << 16 | rgb->g << 8 | rgb->b;
+	}
+}
+
+static inline int
+color_sgr_color_eql(cSgrColor *a, cSgrColor *b)
+{
+	return a->kind == b->kind && a->value == b->value;
+}
+
+/*
+ * Reads a style, a hash with :fg, :bg and the attributes :bold,
+ * :underline, :blink and :invert, or a symbol as :fg. nil is the plain
+ * style.
+ */
+static void
+color_sgr_style(VALUE style, int depth, cSgr *sgr)
+{
+	memset(sgr, 0, sizeof(cSgr));
+	if (NIL_P(style)) return;
+	if (TYPE(style) != T_HASH) {
+		color_sgr_color(style, depth, &sgr->fg);
+		return;
+	}
+	color_sgr_color(rb_hash_aref(style, ID2SYM(rb_intern("fg"))), depth, &sgr->fg);
+	color_sgr_color(rb_hash_aref(style, ID2SYM(rb_intern("bg"))), depth, &sgr->bg);
+	if (RTEST(rb_hash_aref(style, ID2SYM(rb_intern("bold")))))      sgr->attributes |= COLOR_SGR_BOLD;
+	if (RTEST(rb_hash_aref(style, ID2SYM(rb_intern("underline"))))) sgr->attributes |= COLOR_SGR_UNDERLINE;
+	if (RTEST(rb_hash_aref(style, ID2SYM(rb_intern("blink")))))     sgr->attributes |= COLOR_SGR_BLINK;
+	if (RTEST(rb_hash_aref(style, ID2SYM(rb_intern("invert")))))    sgr->attributes |= COLOR_SGR_INVERT;
+}
+
+static char *
+color_sgr_number(char *to, int value)
+{
+	char digits[12];
+	int  count = 0;
+	do {
+		digits[count++] = (char)('0'+value%10);
+		value /= 10;
+	} while (value);
+	while (count) *to++ = digits[--count];
+	*to++ = ';';
+	return to;
+}
+
+static char *
+color_sgr_color_codes(char *to, cSgrColor *color, int base)
+{
+	switch(color->kind) {
+		case COLOR_SGR_DEFAULT:
+			return color_sgr_number(to, base+9);
+		case COLOR_SGR_BASIC:
+			return color_sgr_number(to, base+color->value);
+		case COLOR_SGR_INDEXED:
+			to = color_sgr_number(to, base+8);
+			to = color_sgr_number(to, 5);
+			return color_sgr_number(to, color->value);
+		default:
+			to = color_sgr_number(to, base+8);
+			to = color_sgr_number(to, 2);
+			to = color_sgr_number(to, color->value >> 16);
+			to = color_sgr_number(to, color->value >> 8 & 0xff);
+			return color_sgr_number(to, color->value & 0xff);
+	}
+}
+
+/*
+ * Writes the one sequence which takes the terminal from its state to sgr,
+ * nothing if they are the same. Going back to the plain style is a reset.
+ */
+static void
+color_sgr_change(cTermWriter *writer, cSgr *sgr)
+{
+	char sequence[64], *to = sequence;
+	cSgr *state = &writer->state;
+	int plain   = sgr->fg.kind == COLOR_SGR_DEFAULT && sgr->bg.kind == COLOR_SGR_DEFAULT && !sgr->attributes;
+
+	*to++ = '\033';
+	*to++ = '[';
+	if (plain) {
+		if (state->fg.kind == COLOR_SGR_DEFAULT && state->bg.kind == COLOR_SGR_DEFAULT && !state->attributes) return;
+		*to++ = '0';
+		*to++ = ';';
+	} else {
+		for (int i = 0; i < 4; i++) {
+			int bit = 1 << i;
+			if ((state->attributes & bit) != (sgr->attributes & bit)) {
+				to = color_sgr_number(to, sgr->attributes & bit ? color_sgr_on[i] : color_sgr_off[i]);
+			}
+		}
+		if (!color_sgr_color_eql(&state->fg, &sgr->fg)) to = color_sgr_color_codes(to, &sgr->fg, 30);
+		if (!color_sgr_color_eql(&state->bg, &sgr->bg)) to = color_sgr_color_codes(to, &sgr->bg, 40);
+		if (to == sequence+2) return;
+	}
+	to[-1] = 'm';
+	color_term_bytes(writer, sequence, to-sequence);
+	*state = *sgr;
+}
+
+/*
+ *  call-seq:
+ *     Color::Term::Writer.new(to=nil[, options])
+ *
+ *  Create a writer appending to +to+, a String or an IO (anything with
+ *  write), a new String by default. Writes to an IO are collected and
+ *  passed on in chunks, see Color::Term::Writer#flush.
+ *  Options:
+ *  :depth:: the colors of the terminal, 8, 256 (default) or :truecolor
+ */
+extern VALUE
+rb_color_term_writer_initialize(int argc, VALUE *argv, VALUE self)
+{
+	cTermWriter *writer;
+	VALUE to, options, depth = Qnil;
+	rb_scan_args(argc, argv, "02", &to, &options);
+	COLOR_GET_STRUCT(self, cTermWriter, writer);
+	if (TYPE(to) == T_HASH && NIL_P(options)) {
+		options = to;
+		to      = Qnil;
+	}
+	if (!NIL_P(options)) {
+		Check_Type(options, T_HASH);
+		depth = rb_hash_aref(options, ID2SYM(rb_intern("depth")));
+	}
+	if (NIL_P(depth) || depth == INT2FIX(256)) {
+		writer->depth = 256;
+	} else if (depth == INT2FIX(8)) {
+		writer->depth = 8;
+	} else if (depth == ID2SYM(rb_intern("truecolor"))) {
+		writer->depth = 0x1000000;
+	} else {
+		rb_raise(rb_eArgError, "Invalid depth, must be 8, 256 or :truecolor");
+	}
+	writer->to     = NIL_P(to) ? rb_str_new(NULL, 0) : to;
+	writer->string = TYPE(writer->to) == T_STRING;
+	writer->used   = 0;
+	memset(&writer->state, 0, sizeof(cSgr));
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     writer.write(text[, style]) -> writer
+ *
+ *  Writes +text+ in +style+, a hash with :fg and :bg (a symbol like :red,
+ *  a Color::Term or a color of any model) and :bold, :underline, :blink
+ *  and :invert. A symbol or color alone is taken as :fg, no style is the
+ *  terminal's default.
+ *  Only the attributes which differ from what the writer wrote before are
+ *  sent, in one sequence.
+ *
+ *  Example:
+ *    writer.write("ERROR", :fg => :red, :bold => true).write(" disk full\n")
+ */
+extern VALUE
+rb_color_term_writer_write(int argc, VALUE *argv, VALUE self)
+{
+	cTermWriter *writer;
+	cSgr  sgr;
+	VALUE text, style;
+	rb_scan_args(argc, argv, "11", &text, &style);
+	COLOR_GET_STRUCT(self, cTermWriter, writer);
+	text = rb_obj_as_string(text);
+	color_sgr_style(style, writer->depth, &sgr);
+	color_sgr_change(writer, &sgr);
+	color_term_bytes(writer, RSTRING_PTR(text), RSTRING_LEN(text));
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     writer << text -> writer
+ *
+ *  Writes +text+ in the style written last.
+ */
+extern VALUE
+rb_color_term_writer_append(VALUE self, VALUE text)
+{
+	cTermWriter *writer;
+	COLOR_GET_STRUCT(self, cTermWriter, writer);
+	text = rb_obj_as_string(text);
+	color_term_bytes(writer, RSTRING_PTR(text), RSTRING_LEN(text));
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     writer.reset -> writer
+ *
+ *  Returns the terminal to its default style, if it isn't already.
+ */
+extern VALUE
+rb_color_term_writer_reset(VALUE self)
+{
+	cTermWriter *writer;
+	cSgr plain;
+	COLOR_GET_STRUCT(self, cTermWriter, writer);
+	memset(&plain, 0, sizeof(cSgr));
+	color_sgr_change(writer, &plain);
+	return self;
+}
+
+/*
+ *  call-seq:
+ *     writer.flush -> to
+ *
+ *  Passes what is collected on to the IO (strings are written to right
+ *  away) and returns it.
+ */
+extern VALUE
+rb_color_term_writer_flush(VALUE self)
+{
+	cTermWriter *writer;
+	COLOR_GET_STRUCT(self, cTermWriter, writer);
+	if (!writer->string) color_term_flush(writer);
+	return writer->to;
+}
+
+/*
+ *  call-seq:
+ *     writer.to -> string or io
+ *
+ *  What the writer writes to.
+ */
+extern VALUE
+rb_color_term_writer_to(VALUE self)
+{
+	cTermWriter *writer;
+	COLOR_GET_STRUCT(self, cTermWriter, writer);
+	return writer->to;
+}
+
+/*
+ *  call-seq:
+ *     writer.depth -> 8, 256 or :truecolor
+ *
+ *  The colors of the terminal.
+ */
+extern VALUE
+rb_color_term_writer_depth(VALUE self)
+{
+	cTermWriter *writer;
+	COLOR_GET_STRUCT(self, cTermWriter, writer);
+	return writer->depth > 256 ? ID2SYM(rb_intern("truecolor")) : INT2FIX(writer->depth);
+}
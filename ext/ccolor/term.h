@@ -0,0 +1,8 @@
+extern VALUE rb_color_term_writer__allocate(VALUE class);
+extern VALUE rb_color_term_writer_initialize(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_term_writer_write(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_term_writer_append(VALUE self, VALUE text);
+extern VALUE rb_color_term_writer_reset(VALUE self);
+extern VALUE rb_color_term_writer_flush(VALUE self);
+extern VALUE rb_color_term_writer_to(VALUE self);
+extern VALUE rb_color_term_writer_depth(VALUE self);
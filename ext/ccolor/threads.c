@@ -0,0 +1,81 @@
+#include <ruby.h>
+#include "color.h"
+#include "threads.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+// below this many elements per thread, starting threads costs more than it saves
+#define COLOR_PARALLEL_MIN 16384
+#define COLOR_PARALLEL_MAX 64
+
+typedef struct _cSlice {
+	color_parallel_fn fn;
+	void *arg;
+	long  from;
+	long  to;
+} cSlice;
+
+/*
+ * Reads :threads from an options hash (or nil), defaults to 1.
+ */
+extern int
+color_threads_get(VALUE options)
+{
+	VALUE threads;
+	int   count;
+	if (NIL_P(options)) return 1;
+	Check_Type(options, T_HASH);
+	threads = rb_hash_aref(options, ID2SYM(rb_intern("threads")));
+	if (NIL_P(threads)) return 1;
+	count = NUM2INT(threads);
+	if (count < 1 || count > COLOR_PARALLEL_MAX) {
+		rb_raise(rb_eArgError, "Invalid number of threads, must be between 1 and %d", COLOR_PARALLEL_MAX);
+	}
+	return count;
+}
+
+#ifdef HAVE_PTHREAD_H
+static void *
+color_parallel_slice(void *ptr)
+{
+	cSlice *slice = ptr;
+	slice->fn(slice->arg, slice->from, slice->to);
+	return NULL;
+}
+#endif
+
+/*
+ * Calls fn on disjoint ranges covering 0...length, using up to threads
+ * native threads. fn must not call into ruby. Without pthreads, or for
+ * small lengths, fn runs once on the calling thread.
+ */
+extern void
+color_parallel(color_parallel_fn fn, void *arg, long length, int threads)
+{
+#ifdef HAVE_PTHREAD_H
+	if (threads > length/COLOR_PARALLEL_MIN) threads = length/COLOR_PARALLEL_MIN;
+	if (threads > 1) {
+		pthread_t thread[COLOR_PARALLEL_MAX];
+		cSlice    slice[COLOR_PARALLEL_MAX];
+		int       started[COLOR_PARALLEL_MAX];
+		long      step = (length+threads-1)/threads;
+		for (int i = 0; i < threads; i++) {
+			slice[i].fn   = fn;
+			slice[i].arg  = arg;
+			slice[i].from = i*step;
+			slice[i].to   = (i+1)*step < length ? (i+1)*step : length;
+			// the calling thread takes the first slice
+			started[i]    = i > 0 && pthread_create(&thread[i], NULL, color_parallel_slice, &slice[i]) == 0;
+		}
+		for (int i = 0; i < threads; i++) {
+			if (!started[i]) fn(arg, slice[i].from, slice[i].to);
+		}
+		for (int i = 1; i < threads; i++) {
+			if (started[i]) pthread_join(thread[i], NULL);
+		}
+		return;
+	}
+#endif
+	fn(arg, 0, length);
+}
@@ -0,0 +1,4 @@
+typedef void (*color_parallel_fn)(void *arg, long from, long to);
+
+extern int color_threads_get(VALUE options);
+extern void color_parallel(color_parallel_fn fn, void *arg, long length, int threads);
@@ -48,6 +48,19 @@ float_hash(float num)
 	return hash;
 }
 
+// count*size, raises ArgumentError instead of overflowing
+extern long
+color_size_mul(long count, long size)
+{
+	if (count < 0 || size < 0) {
+		rb_raise(rb_eArgError, "Invalid size, must be positive");
+	}
+	if (size > 0 && count > LONG_MAX/size) {
+		rb_raise(rb_eArgError, "Invalid size, too large");
+	}
+	return count*size;
+}
+
 extern int
 color_cap(int value, int min, int max)
 {
@@ -72,6 +85,13 @@ color_capf(float value, float min, float max)
 	}
 }
 
+// like color_capf(value, 0, 1), but NaN becomes 0
+extern float
+color_unitf(float value)
+{
+	return value > 0 ? (value < 1 ? value : 1) : 0;
+}
+
 extern float
 color_rgb_distance(cRGB *color1, cRGB *color2)
 {
@@ -104,13 +124,14 @@ color_rgb_interpolate(cRGB *color1, cRGB *color2, cRGB *color3, float pos)
 	color3->alpha = FLOAT2CHR(a1+(a2-a1)*pos);
 }
 
+// HDR values are clipped to 0..1
 extern void
-color_convert_rgb_to_hsv(cRGB *rgb, cHSV *hsv)
+color_convert_rgbf_to_hsv(cRGBF *rgb, cHSV *hsv)
 {
 	float red, green, blue, min, max;
-	red   = CHR2FLOAT(rgb->r);
-	green = CHR2FLOAT(rgb->g);
-	blue  = CHR2FLOAT(rgb->b);
+	red   = color_unitf(rgb->r);
+	green = color_unitf(rgb->g);
+	blue  = color_unitf(rgb->b);
 	max   = fmaxf(fmaxf(red, green), blue);
 	min   = fminf(fminf(red, green), blue);
 	
@@ -130,16 +151,26 @@ color_convert_rgb_to_hsv(cRGB *rgb, cHSV *hsv)
 	
 	// value
 	hsv->v = max;
+	hsv->alpha = FLOAT2CHR(color_capf(rgb->alpha, 0, 1));
+}
+
+extern void
+color_convert_rgb_to_hsv(cRGB *rgb, cHSV *hsv)
+{
+	cRGBF rgbf;
+	color_convert_rgb_to_rgbf(rgb, &rgbf);
+	color_convert_rgbf_to_hsv(&rgbf, hsv);
 	hsv->alpha = rgb->alpha;
 }
 
+// HDR values are clipped to 0..1
 extern void
-color_convert_rgb_to_hsl(cRGB *rgb, cHSL *hsl)
+color_convert_rgbf_to_hsl(cRGBF *rgb, cHSL *hsl)
 {
 	float red, green, blue, min, max;
-	red   = CHR2FLOAT(rgb->r);
-	green = CHR2FLOAT(rgb->g);
-	blue  = CHR2FLOAT(rgb->b);
+	red   = color_unitf(rgb->r);
+	green = color_unitf(rgb->g);
+	blue  = color_unitf(rgb->b);
 	max   = fmaxf(fmaxf(red, green), blue);
 	min   = fminf(fminf(red, green), blue);
 	
@@ -167,18 +198,26 @@ color_convert_rgb_to_hsl(cRGB *rgb, cHSL *hsl)
 	}
 	
 	// alpha
+	hsl->alpha = FLOAT2CHR(color_capf(rgb->alpha, 0, 1));
+}
+
+extern void
+color_convert_rgb_to_hsl(cRGB *rgb, cHSL *hsl)
+{
+	cRGBF rgbf;
+	color_convert_rgb_to_rgbf(rgb, &rgbf);
+	color_convert_rgbf_to_hsl(&rgbf, hsl);
 	hsl->alpha = rgb->alpha;
 }
 
 extern void
-color_convert_hsv_to_rgb(cHSV *hsv, cRGB *rgb)
+color_convert_hsv_to_rgbf(cHSV *hsv, cRGBF *rgb)
 {
-	rgb->alpha = hsv->alpha;
+	rgb->alpha = CHR2FLOAT(hsv->alpha);
 	if (IN_DELTA(hsv->s, 0)) {
-		float value = FLOAT2CHR(hsv->v);
-		rgb->r      = value;
-		rgb->g      = value;
-		rgb->b      = value;
+		rgb->r = hsv->v;
+		rgb->g = hsv->v;
+		rgb->b = hsv->v;
 	} else {
 		float hi, f, p, q, t;
 		hi = ((int)(hsv->h*6.0))%6;
@@ -190,34 +229,34 @@ color_convert_hsv_to_rgb(cHSV *hsv, cRGB *rgb)
 		// conversion depends on what sector out of 6 hue is in
 		switch(((int)hi)%6) {
 			case 0:
-				rgb->r = FLOAT2CHR(hsv->v);
-				rgb->g = FLOAT2CHR(t);
-				rgb->b = FLOAT2CHR(p);
+				rgb->r = hsv->v;
+				rgb->g = t;
+				rgb->b = p;
 				break;
 			case 1:
-				rgb->r = FLOAT2CHR(q);
-				rgb->g = FLOAT2CHR(hsv->v);
-				rgb->b = FLOAT2CHR(p);
+				rgb->r = q;
+				rgb->g = hsv->v;
+				rgb->b = p;
 				break;
 			case 2:
-				rgb->r = FLOAT2CHR(p);
-				rgb->g = FLOAT2CHR(hsv->v);
-				rgb->b = FLOAT2CHR(t);
+				rgb->r = p;
+				rgb->g = hsv->v;
+				rgb->b = t;
 				break;
 			case 3:
-				rgb->r = FLOAT2CHR(p);
-				rgb->g = FLOAT2CHR(q);
-				rgb->b = FLOAT2CHR(hsv->v);
+				rgb->r = p;
+				rgb->g = q;
+				rgb->b = hsv->v;
 				break;
 			case 4:
-				rgb->r = FLOAT2CHR(t);
-				rgb->g = FLOAT2CHR(p);
-				rgb->b = FLOAT2CHR(hsv->v);
+				rgb->r = t;
+				rgb->g = p;
+				rgb->b = hsv->v;
 				break;
 			case 5:
-				rgb->r = FLOAT2CHR(hsv->v);
-				rgb->g = FLOAT2CHR(p);
-				rgb->b = FLOAT2CHR(q);
+				rgb->r = hsv->v;
+				rgb->g = p;
+				rgb->b = q;
 				break;
 			default:
 				rb_warn("troubles, my friend: %.2f", hi);
@@ -225,6 +264,17 @@ color_convert_hsv_to_rgb(cHSV *hsv, cRGB *rgb)
 	}
 }
 
+extern void
+color_convert_hsv_to_rgb(cHSV *hsv, cRGB *rgb)
+{
+	cRGBF rgbf;
+	color_convert_hsv_to_rgbf(hsv, &rgbf);
+	rgb->r     = FLOAT2CHR(rgbf.r);
+	rgb->g     = FLOAT2CHR(rgbf.g);
+	rgb->b     = FLOAT2CHR(rgbf.b);
+	rgb->alpha = hsv->alpha;
+}
+
 extern float
 color_hue_to_rgb(float co_var1, float co_var2, float hue)
 {
@@ -244,24 +294,34 @@ color_hue_to_rgb(float co_var1, float co_var2, float hue)
 }
 
 extern void
-color_convert_hsl_to_rgb(cHSL *hsl, cRGB *rgb)
+color_convert_hsl_to_rgbf(cHSL *hsl, cRGBF *rgb)
 {
-	rgb->alpha = hsl->alpha;
+	rgb->alpha = CHR2FLOAT(hsl->alpha);
 	if (IN_DELTA(hsl->s, 0)) {
-		unsigned char luminance = FLOAT2CHR(hsl->l);
-		rgb->r = luminance;
-		rgb->g = luminance;
-		rgb->b = luminance;
+		rgb->r = hsl->l;
+		rgb->g = hsl->l;
+		rgb->b = hsl->l;
 	} else {
 		float co_var1, co_var2;
 		co_var1 = hsl->l < 0.5 ? (hsl->l * (1.0 + hsl->s)) : (hsl->l + hsl->s - hsl->l * hsl->s);
 		co_var2 = 2*hsl->l - co_var1;
-		rgb->r = FLOAT2CHR(color_hue_to_rgb(co_var1, co_var2, (hsl->h + 1.0/3.0)));
-		rgb->g = FLOAT2CHR(color_hue_to_rgb(co_var1, co_var2, hsl->h));
-		rgb->b = FLOAT2CHR(color_hue_to_rgb(co_var1, co_var2, (hsl->h - 1.0/3.0)));
+		rgb->r = color_hue_to_rgb(co_var1, co_var2, (hsl->h + 1.0/3.0));
+		rgb->g = color_hue_to_rgb(co_var1, co_var2, hsl->h);
+		rgb->b = color_hue_to_rgb(co_var1, co_var2, (hsl->h - 1.0/3.0));
 	}
 }
 
+extern void
+color_convert_hsl_to_rgb(cHSL *hsl, cRGB *rgb)
+{
+	cRGBF rgbf;
+	color_convert_hsl_to_rgbf(hsl, &rgbf);
+	rgb->r     = FLOAT2CHR(rgbf.r);
+	rgb->g     = FLOAT2CHR(rgbf.g);
+	rgb->b     = FLOAT2CHR(rgbf.b);
+	rgb->alpha = hsl->alpha;
+}
+
 // "most-black, least color" conversion algorithm
 extern void
 color_convert_rgb_to_cmyk(cRGB *rgb, cCMYK *cmyk)
@@ -344,3 +404,135 @@ color_convert_gray_to_cmyk(cGray *gray, cCMYK *cmyk)
 	cmyk->k     = 255 - gray->white;
 	cmyk->alpha = gray->alpha;
 }
+
+// same result as gray -> rgb -> hsv, without the detour
+extern void
+color_convert_gray_to_hsv(cGray *gray, cHSV *hsv)
+{
+	hsv->h     = 0;
+	hsv->s     = 0;
+	hsv->v     = CHR2FLOAT(gray->white);
+	hsv->alpha = gray->alpha;
+}
+
+// same result as gray -> rgb -> hsl, without the detour
+extern void
+color_convert_gray_to_hsl(cGray *gray, cHSL *hsl)
+{
+	hsl->h     = 0;
+	hsl->s     = 0;
+	hsl->l     = CHR2FLOAT(gray->white);
+	hsl->alpha = gray->alpha;
+}
+
+extern void
+color_convert_rgb_to_rgbf(cRGB *rgb, cRGBF *rgbf)
+{
+	rgbf->r     = CHR2FLOAT(rgb->r);
+	rgbf->g     = CHR2FLOAT(rgb->g);
+	rgbf->b     = CHR2FLOAT(rgb->b);
+	rgbf->alpha = CHR2FLOAT(rgb->alpha);
+}
+
+// values outside of 0..1 (HDR) are clipped
+extern void
+color_convert_rgbf_to_rgb(cRGBF *rgbf, cRGB *rgb)
+{
+	rgb->r     = FLOAT2CHR(color_unitf(rgbf->r));
+	rgb->g     = FLOAT2CHR(color_unitf(rgbf->g));
+	rgb->b     = FLOAT2CHR(color_unitf(rgbf->b));
+	rgb->alpha = FLOAT2CHR(color_unitf(rgbf->alpha));
+}
+
+extern void
+color_convert_rgb16_to_rgbf(cRGB16 *rgb16, cRGBF *rgbf)
+{
+	rgbf->r     = SHORT2FLOAT(rgb16->r);
+	rgbf->g     = SHORT2FLOAT(rgb16->g);
+	rgbf->b     = SHORT2FLOAT(rgb16->b);
+	rgbf->alpha = SHORT2FLOAT(rgb16->alpha);
+}
+
+extern void
+color_convert_rgbf_to_rgb16(cRGBF *rgbf, cRGB16 *rgb16)
+{
+	rgb16->r     = FLOAT2SHORT(color_unitf(rgbf->r));
+	rgb16->g     = FLOAT2SHORT(color_unitf(rgbf->g));
+	rgb16->b     = FLOAT2SHORT(color_unitf(rgbf->b));
+	rgb16->alpha = FLOAT2SHORT(color_unitf(rgbf->alpha));
+}
+
+// 0xab -> 0xabab, exact
+extern void
+color_convert_rgb_to_rgb16(cRGB *rgb, cRGB16 *rgb16)
+{
+	rgb16->r     = rgb->r*257;
+	rgb16->g     = rgb->g*257;
+	rgb16->b     = rgb->b*257;
+	rgb16->alpha = rgb->alpha*257;
+}
+
+extern void
+color_convert_rgb16_to_rgb(cRGB16 *rgb16, cRGB *rgb)
+{
+	rgb->r     = SHORT2CHR(rgb16->r);
+	rgb->g     = SHORT2CHR(rgb16->g);
+	rgb->b     = SHORT2CHR(rgb16->b);
+	rgb->alpha = SHORT2CHR(rgb16->alpha);
+}
+
+extern void
+color_convert_rgb16_to_hsv(cRGB16 *rgb16, cHSV *hsv)
+{
+	cRGBF rgbf;
+	color_convert_rgb16_to_rgbf(rgb16, &rgbf);
+	color_convert_rgbf_to_hsv(&rgbf, hsv);
+}
+
+extern void
+color_convert_rgb16_to_hsl(cRGB16 *rgb16, cHSL *hsl)
+{
+	cRGBF rgbf;
+	color_convert_rgb16_to_rgbf(rgb16, &rgbf);
+	color_convert_rgbf_to_hsl(&rgbf, hsl);
+}
+
+extern void
+color_convert_hsv_to_rgb16(cHSV *hsv, cRGB16 *rgb16)
+{
+	cRGBF rgbf;
+	color_convert_hsv_to_rgbf(hsv, &rgbf);
+	color_convert_rgbf_to_rgb16(&rgbf, rgb16);
+}
+
+extern void
+color_convert_hsl_to_rgb16(cHSL *hsl, cRGB16 *rgb16)
+{
+	cRGBF rgbf;
+	color_convert_hsl_to_rgbf(hsl, &rgbf);
+	color_convert_rgbf_to_rgb16(&rgbf, rgb16);
+}
+
+/*
+ * Y'CbCr of JPEG (JFIF): BT.601 weights, all channels use the full 0..255,
+ * see planar.c for video ranges and BT.709.
+ */
+extern void
+color_convert_rgb_to_ycbcr(cRGB *rgb, cYCbCr *ycbcr)
+{
+	float r = rgb->r, g = rgb->g, b = rgb->b;
+	ycbcr->y     = (unsigned char)color_capf(roundf(0.299f*r+0.587f*g+0.114f*b), 0, 255);
+	ycbcr->cb    = (unsigned char)color_capf(roundf(128-0.168736f*r-0.331264f*g+0.5f*b), 0, 255);
+	ycbcr->cr    = (unsigned char)color_capf(roundf(128+0.5f*r-0.418688f*g-0.081312f*b), 0, 255);
+	ycbcr->alpha = rgb->alpha;
+}
+
+extern void
+color_convert_ycbcr_to_rgb(cYCbCr *ycbcr, cRGB *rgb)
+{
+	float y = ycbcr->y, cb = ycbcr->cb-128.0f, cr = ycbcr->cr-128.0f;
+	rgb->r     = (unsigned char)color_capf(roundf(y+1.402f*cr), 0, 255);
+	rgb->g     = (unsigned char)color_capf(roundf(y-0.344136f*cb-0.714136f*cr), 0, 255);
+	rgb->b     = (unsigned char)color_capf(roundf(y+1.772f*cb), 0, 255);
+	rgb->alpha = ycbcr->alpha;
+}
@@ -2,10 +2,17 @@ int min2(int x, int y);
 int min3(int x, int y, int z);
 int max2(int x, int y);
 int max3(int x, int y, int z);
+extern int float_hash(float num);
+extern long color_size_mul(long count, long size);
 extern int color_cap(int value, int min, int max);
 extern float color_capf(float value, float min, float max);
+extern float color_unitf(float value);
 extern float color_rgb_distance(cRGB *color1, cRGB *color2);
 extern void color_rgb_interpolate(cRGB *color1, cRGB *color2, cRGB *color3, float pos);
+extern void color_convert_rgbf_to_hsv(cRGBF *rgb, cHSV *hsv);
+extern void color_convert_rgbf_to_hsl(cRGBF *rgb, cHSL *hsl);
+extern void color_convert_hsv_to_rgbf(cHSV *hsv, cRGBF *rgb);
+extern void color_convert_hsl_to_rgbf(cHSL *hsl, cRGBF *rgb);
 extern void color_convert_rgb_to_hsv(cRGB *rgb, cHSV *hsv);
 extern void color_convert_rgb_to_hsl(cRGB *rgb, cHSL *hsl);
 extern void color_convert_rgb_to_cmyk(cRGB *rgb, cCMYK *cmyk);
@@ -16,3 +23,17 @@ extern void color_convert_rgb_to_gray(cRGB *rgb, cGray *gray);
 extern void color_convert_cmyk_to_gray(cCMYK *cmyk, cGray *gray);
 extern void color_convert_gray_to_rgb(cGray *gray, cRGB *rgb);
 extern void color_convert_gray_to_cmyk(cGray *gray, cCMYK *cmyk);
+extern void color_convert_gray_to_hsv(cGray *gray, cHSV *hsv);
+extern void color_convert_gray_to_hsl(cGray *gray, cHSL *hsl);
+extern void color_convert_rgb_to_rgbf(cRGB *rgb, cRGBF *rgbf);
+extern void color_convert_rgbf_to_rgb(cRGBF *rgbf, cRGB *rgb);
+extern void color_convert_rgb16_to_rgbf(cRGB16 *rgb16, cRGBF *rgbf);
+extern void color_convert_rgbf_to_rgb16(cRGBF *rgbf, cRGB16 *rgb16);
+extern void color_convert_rgb_to_rgb16(cRGB *rgb, cRGB16 *rgb16);
+extern void color_convert_rgb16_to_rgb(cRGB16 *rgb16, cRGB *rgb);
+extern void color_convert_rgb16_to_hsv(cRGB16 *rgb16, cHSV *hsv);
+extern void color_convert_rgb16_to_hsl(cRGB16 *rgb16, cHSL *hsl);
+extern void color_convert_hsv_to_rgb16(cHSV *hsv, cRGB16 *rgb16);
+extern void color_convert_hsl_to_rgb16(cHSL *hsl, cRGB16 *rgb16);
+extern void color_convert_rgb_to_ycbcr(cRGB *rgb, cYCbCr *ycbcr);
+extern void color_convert_ycbcr_to_rgb(cYCbCr *ycbcr, cRGB *rgb);
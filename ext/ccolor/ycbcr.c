@@ -0,0 +1,228 @@
+#include <ruby.h>
+#include <math.h>
+#include "color.h"
+#include "tools.h"
+#include "convert.h"
+#include "rgb.h"
+#include "ycbcr.h"
+
+/* 
+ *  :nodoc:
+ */
+extern VALUE
+rb_color_ycbcr__allocate(VALUE class)
+{
+	cYCbCr *color;
+	VALUE rb_color = COLOR_ALLOC_VALUE(class, cYCbCr, color);
+	color->y     = 0;
+	color->cb    = 128;
+	color->cr    = 128;
+	color->alpha = 0;
+	return rb_color;
+}
+
+/*
+ *  call-seq:
+ *     Color::YCbCr.new(y, cb, cr[, alpha])
+ *
+ *  Create a new YCbCr instance. Y, cb, cr and alpha are Integers
+ *  within 0 and 255 each, where for cb and cr 128 means no color
+ *  and for alpha 0 means opaque and 255 fully transparent.
+ */
+extern VALUE
+rb_color_ycbcr_initialize(int argc, VALUE *argv, VALUE self)
+{
+	COLOR_CHECK_FROZEN(self);
+	cYCbCr *color;
+	COLOR_GET_STRUCT(self, cYCbCr, color);
+	VALUE luma, blue, red, alpha;
+	rb_scan_args(argc, argv, "31", &luma, &blue, &red, &alpha);
+
+	int   y,cb,cr,a;
+	y  = (NUM2INT(luma));
+	cb = (NUM2INT(blue));
+	cr = (NUM2INT(red));
+	a  = (NIL_P(alpha) ? 0 : NUM2INT(alpha));
+	
+	if (0 > y || y > 255) {
+		rb_raise(rb_eArgError, "Invalid value for y, must be between 0 and 255");
+	}
+	if (0 > cb || cb > 255) {
+		rb_raise(rb_eArgError, "Invalid value for cb, must be between 0 and 255");
+	}
+	if (0 > cr || cr > 255) {
+		rb_raise(rb_eArgError, "Invalid value for cr, must be between 0 and 255");
+	}
+	if (0 > a || a > 255) {
+		rb_raise(rb_eArgError, "Invalid value for alpha, must be between 0 and 255");
+	}
+
+	color->y     = y;
+	color->cb    = cb;
+	color->cr    = cr;
+	color->alpha = a;
+
+	return rb_obj_freeze(self);
+}
+
+/*
+ * :nodoc:
+ */
+extern VALUE
+rb_color_ycbcr_initialize_copy(VALUE self, VALUE original)
+{
+	COLOR_CHECK_FROZEN(self);
+	cYCbCr *color1, *color2;
+	COLOR_GET_STRUCT(self, cYCbCr, color1);
+	COLOR_GET_STRUCT(original, cYCbCr, color2);
+	*color1 = *color2;
+	return rb_obj_freeze(self);
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.y    -> fixnum
+ *     ycbcr.luma -> fixnum
+ *
+ *  The luma of this color. A value between 0 and 255.
+ */
+extern VALUE
+rb_color_ycbcr_y(VALUE self)
+{
+	cYCbCr *color;
+	COLOR_GET_STRUCT(self, cYCbCr, color);
+	return INT2FIX(color->y);
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.cb -> fixnum
+ *
+ *  The blue difference of this color. A value between 0 and 255, 128
+ *  is neutral.
+ */
+extern VALUE
+rb_color_ycbcr_cb(VALUE self)
+{
+	cYCbCr *color;
+	COLOR_GET_STRUCT(self, cYCbCr, color);
+	return INT2FIX(color->cb);
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.cr -> fixnum
+ *
+ *  The red difference of this color. A value between 0 and 255, 128
+ *  is neutral.
+ */
+extern VALUE
+rb_color_ycbcr_cr(VALUE self)
+{
+	cYCbCr *color;
+	COLOR_GET_STRUCT(self, cYCbCr, color);
+	return INT2FIX(color->cr);
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.alpha -> fixnum
+ *
+ *  The transparency of this color. A value between 0 and 255, where
+ *  0 means opaque and 255 fully transparent.
+ */
+extern VALUE
+rb_color_ycbcr_alpha(VALUE self)
+{
+	cYCbCr *color;
+	COLOR_GET_STRUCT(self, cYCbCr, color);
+	return INT2FIX(color->alpha);
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.distance(other) -> float
+ *
+ *  Returns the distance to another color of the same class.
+ *  Distance is a Float between 0 and 1, where 1 is the maximum
+ *  distance. Be aware that this is purely mathematical and human
+ *  perception may differ.
+ */
+extern VALUE
+rb_color_ycbcr_distance(VALUE self, VALUE other)
+{
+	cAny tmp;
+	cYCbCr *color1, *color2;
+	COLOR_GET_STRUCT(self, cYCbCr, color1);
+	color2 = color_coerce(other, COLOR_MODEL_YCBCR, &tmp, COLOR_COERCE_DISTANCE);
+	return rb_float_new(sqrtf((
+		powf(CHR2FLOAT(color1->y) - CHR2FLOAT(color2->y), 2) +
+		powf(CHR2FLOAT(color1->cb) - CHR2FLOAT(color2->cb), 2) +
+		powf(CHR2FLOAT(color1->cr) - CHR2FLOAT(color2->cr), 2) +
+		powf(CHR2FLOAT(color1->alpha) - CHR2FLOAT(color2->alpha), 2)
+	)/4));
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.eql?(other) -> true/false
+ *
+ *  Compares two YCbCr instances for equality. Two YCbCr instances are eql?
+ *  if their y, cb, cr and alpha values are equal.
+ */
+extern VALUE
+rb_color_ycbcr_eql(VALUE self, VALUE other)
+{
+	if (CLASS_OF(self) != CLASS_OF(other)) {
+		return Qfalse;
+	}
+	cYCbCr *color1, *color2;
+	COLOR_GET_STRUCT(self, cYCbCr, color1);
+	COLOR_GET_STRUCT(other, cYCbCr, color2);
+	return (
+		color1->y     == color2->y &&
+		color1->cb    == color2->cb &&
+		color1->cr    == color2->cr &&
+		color1->alpha == color2->alpha
+	) ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.hash   -> fixnum
+ *
+ *  Compute a hash-code for this color. Two colors with the same components
+ *  will have the same hash code (and will compare using <code>eql?</code>).
+ */
+extern VALUE
+rb_color_ycbcr_hash(VALUE self)
+{
+	cYCbCr *color;
+	COLOR_GET_STRUCT(self, cYCbCr, color);
+
+	return LONG2FIX(
+		(64) ^
+		((long)color->alpha << 24) ^
+		((long)color->y << 16) ^
+		((long)color->cb << 8) ^
+		((long)color->cr)
+	);
+}
+
+/*
+ *  call-seq:
+ *     ycbcr.to_rgb -> rgb
+ *
+ *  Returns an RGB representation of this color.
+ */
+extern VALUE
+rb_color_ycbcr_to_rgb(VALUE self)
+{
+	cYCbCr *ycbcr;
+	cRGB *rgb;
+	COLOR_GET_STRUCT(self, cYCbCr, ycbcr);
+	VALUE rb_color = COLOR_MAKE_VALUE(rb_cRGB, cRGB, rgb);
+	COLOR_STAT_CONVERT(COLOR_MODEL_YCBCR, COLOR_MODEL_RGB, 1);
+	color_convert_ycbcr_to_rgb(ycbcr, rgb);
+	return rb_color;
+}
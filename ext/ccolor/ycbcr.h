@@ -0,0 +1,11 @@
+extern VALUE rb_color_ycbcr__allocate(VALUE class);
+extern VALUE rb_color_ycbcr_initialize(int argc, VALUE *argv, VALUE self);
+extern VALUE rb_color_ycbcr_initialize_copy(VALUE self, VALUE original);
+extern VALUE rb_color_ycbcr_y(VALUE self);
+extern VALUE rb_color_ycbcr_cb(VALUE self);
+extern VALUE rb_color_ycbcr_cr(VALUE self);
+extern VALUE rb_color_ycbcr_alpha(VALUE self);
+extern VALUE rb_color_ycbcr_distance(VALUE self, VALUE other);
+extern VALUE rb_color_ycbcr_eql(VALUE self, VALUE other);
+extern VALUE rb_color_ycbcr_hash(VALUE self);
+extern VALUE rb_color_ycbcr_to_rgb(VALUE self);
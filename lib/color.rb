@@ -1,19 +1,35 @@
 require 'color/version'
+begin
+	# this is the C lib, all methods are also implemented in pure ruby, but the
+	# C variant is 5-100x faster with MRI. It is loaded first, the ruby files
+	# below only define what it does not implement, the ruby versions of the
+	# rest are in color/pure and only loaded without it.
+	require 'ccolor'
+rescue LoadError
+	warn "Could not load native extension for Color"
+	require 'color/pure'
+end
 require 'color/common'
 require 'color/rgb'
 require 'color/hsv'
 require 'color/hsl'
 require 'color/cmyk'
 require 'color/gray'
+require 'color/rgb16'
+require 'color/rgbf'
+require 'color/ycbcr'
 require 'color/mixer'
+require 'color/buffer'
+require 'color/palette'
+require 'color/stats'
+require 'color/gradient'
+require 'color/css'
+require 'color/export'
+require 'color/converter'
+require 'color/lazy'
 
 # A module providing multiple color spaces, conversions and tools
 module Color
-	# Whether this is a native build (e.g. C) or plain ruby
-	def native?
-		false
-	end
-
 	# See Color::RGB::new
 	# example:
 	#   include Color
@@ -58,21 +74,46 @@ module Color
 		Term.new(*args)
 	end
 	
+	# Decodes a gamma encoded sRGB value (0..1) to linear light (0..1).
+	# example:
+	#   Color.srgb_to_linear(0.5) # => 0.214041140482232
+	def srgb_to_linear(value)
+		value <= 0.04045 ? value/12.92 : ((value+0.055)/1.055)**2.4
+	end
+	
+	# The inverse of srgb_to_linear.
+	# example:
+	#   Color.linear_to_srgb(0.214041140482232) # => 0.5
+	def linear_to_srgb(value)
+		value = value < 0 ? 0 : value > 1 ? 1 : value
+		value <= 0.0031308 ? value*12.92 : 1.055*value**(1/2.4)-0.055
+	end
+	
+	# The methods +klass+ itself defines (its class methods if +singleton+ is
+	# true) that are implemented by the native extension, e.g. to assert at
+	# boot that no ruby fallback is in use.
+	# Empty without the extension or Method#source_location (ruby 1.9+).
+	# example:
+	#   Color.native_methods(Color::RGB).include?(:to_hsv) # => true
+	def native_methods(klass, singleton=false)
+		methods = singleton ?
+			klass.singleton_methods(false).map { |name| klass.method(name) } :
+			(klass.instance_methods(false)+klass.private_instance_methods(false)).map { |name| klass.instance_method(name) }
+		methods = methods.select { |method| method.respond_to?(:source_location) && !method.source_location }
+		methods.map { |method| method.name.to_sym }.sort_by { |name| name.to_s }
+	end
+	
 	module_function :rgb
 	module_function :cmyk
 	module_function :hsv
 	module_function :hsl
 	module_function :gray
 	module_function :term
+	module_function :srgb_to_linear
+	module_function :linear_to_srgb
+	module_function :native_methods
 end
 
-begin
-	# this is the C lib, all methods are also implemented in pure ruby, but the
-	# C variant is 5-100x faster with MRI.
-	require 'ccolor'
-rescue LoadError
-	warn "Could not load native extension for Color"
-end
 require 'color/term'
 require 'color/named'
 
@@ -0,0 +1,42 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# == Synopsis
+	#   buffer = Color::Buffer.from([Color.rgb(255,0,0), Color.rgb(0,0,255)])
+	#   buffer.length            # => 2
+	#   buffer.convert(:hsv)[1]  # => <HSV: 240°h 100%s, 100%v, 0>
+	#
+	# == Description
+	# A fixed size, packed array of colors of a single model. Elements are stored
+	# as plain structs, not as ruby objects, which makes buffers suitable for
+	# large amounts of colors (images, palettes). Buffer::unpack and #pack
+	# read and write pixel formats like RGB565 or BGRA, Buffer::from_planar
+	# and #to_planar planar Y'CbCr video frames (I420, I422).
+	# RGB buffers can hold their data premultiplied and with opacity instead
+	# of transparency as alpha, see #with_alpha.
+	# Buffers are only available with the native extension.
+	#
+	class Buffer
+		include Enumerable
+
+		class <<self
+			# === Synopsis
+			#   Color::Buffer.sort(colors, :hue)                     # => array
+			#   Color::Buffer.sort(colors, :luminance, :reverse => true)
+			#
+			# === Description
+			# Sorts an array of colors of any class by a packed key, without
+			# creating intermediate color objects. See Color::Buffer#order for
+			# the keys.
+			#
+			def sort(colors, key, options={})
+				from(colors, RGB).order(key, options).unpack("L*").map { |i| colors[i] }
+			end
+		end
+
+		def inspect # :nodoc:
+			"<Buffer: #{model.name.sub(/.*::/, '')} x #{length}>"
+		end
+	end
+end
@@ -2,6 +2,12 @@ require 'color'
 
 module Color
 
+	# Deeply freezes a constant table, with ractors (ruby 3+) it becomes
+	# shareable and can be read from any ractor.
+	def self.shareable(table) # :nodoc:
+		defined?(Ractor) ? Ractor.make_shareable(table) : table.freeze
+	end
+
 	# == Description
 	# Common methods of color classes. Most classes representing a color model
 	# mix this module in.
@@ -14,11 +20,12 @@ module Color
 		# === Description
 		# Creates an array of colors, linearly approaching the color 'to'.
 		# steps defines how many colors are created.
+		# Options are passed on to interpolate.
 		#
-		def sequence(to, steps)
+		def sequence(to, steps, options={})
 			raise ArgumentError, "Steps must be bigger or equal 1" unless steps >= 1
 			l = 1.0/(steps)
-			Array.new(steps+1) { |i| interpolate(to, i*l) }
+			Array.new(steps+1) { |i| interpolate(to, i*l, options) }
 		end
 		
 		# === Synopsis
@@ -28,8 +35,13 @@ module Color
 		# Interpolate a color between self and other, use
 		# pos (0..1) to define where between self and other
 		# the color should be. 0 is equal self, 1 equal other.
-		def interpolate(other, pos=0.5)
+		# With <code>:space => :linear</code> the colors are interpolated in
+		# linear light RGB, see Color::RGB#interpolate.
+		def interpolate(other, pos=0.5, options={})
 			raise ArgumentError, "Position must be between 0 and 1" unless pos.between?(0,1)
+			if options[:space] == :linear then
+				return self.class.from(to_rgb.interpolate(coerce(other).to_rgb, pos, options))
+			end
 			self.class.new(*to_a.zip(coerce(other).to_a).map { |a,b|
 				(a+(b-a)*pos).round
 			})
@@ -66,8 +78,13 @@ module Color
 		# supplied is used
 		# Some color models also offer other methods than
 		# the default :interpolate
+		# With <code>:space => :linear</code> the colors are blended in
+		# linear light RGB.
 		#
-		def blend(with, with_alpha=nil, using=:interpolate)
+		def blend(with, with_alpha=nil, using=:interpolate, options={})
+			if options[:space] == :linear then
+				return self.class.from(to_rgb.blend(coerce(with).to_rgb, with_alpha, using, options))
+			end
 			with_alpha ||= with.alpha
 			opacity = (255-with_alpha)/255.0
 			value   = proc { |v,a| v+a-a*v }
@@ -171,6 +188,33 @@ module Color
 			self.class.floats(*to_a.zip(other.to_a).map { |a,b| a-b })
 		end
 		
+		# === Synopsis
+		#   Color.rgb(255, 255, 255).relative_luminance # => 1.0
+		#
+		# === Description
+		# The relative luminance as defined by WCAG 2.x, a Float between 0 (black)
+		# and 1 (white). Alpha is ignored.
+		#
+		def relative_luminance
+			rgb = to_rgb
+			0.2126*Color.srgb_to_linear(rgb.red/255.0) +
+			0.7152*Color.srgb_to_linear(rgb.green/255.0) +
+			0.0722*Color.srgb_to_linear(rgb.blue/255.0)
+		end
+
+		# === Synopsis
+		#   Color.rgb(0, 0, 0).contrast(Color.rgb(255, 255, 255)) # => 21.0
+		#
+		# === Description
+		# The WCAG 2.x contrast ratio between this and another color, a Float
+		# between 1 and 21. WCAG AA requires 4.5 for normal text.
+		#
+		def contrast(other)
+			a, b = relative_luminance, other.relative_luminance
+			a, b = b, a if b > a
+			(a+0.05)/(b+0.05)
+		end
+
 		# === Synopsis
 		#   somecolor.to_cmyk # => Color::CMYK color
 		# 
@@ -211,6 +255,36 @@ module Color
 			to_rgb.to_hsv
 		end
 
+		# === Synopsis
+		#   somecolor.to_rgb16 # => Color::RGB16 color
+		# 
+		# === Description
+		# Returns a Color::RGB16 representation of this color.
+		#
+		def to_rgb16
+			to_rgb.to_rgb16
+		end
+
+		# === Synopsis
+		#   somecolor.to_rgbf # => Color::RGBF color
+		# 
+		# === Description
+		# Returns a Color::RGBF representation of this color.
+		#
+		def to_rgbf
+			to_rgb.to_rgbf
+		end
+
+		# === Synopsis
+		#   somecolor.to_ycbcr # => Color::YCbCr color
+		# 
+		# === Description
+		# Returns a Color::YCbCr representation of this color.
+		#
+		def to_ycbcr
+			to_rgb.to_ycbcr
+		end
+
 		# === Synopsis
 		#   somecolor.to_html      # => html color string
 		#   rgb(255,127,0).to_html # => "#FF7F00"
@@ -222,6 +296,18 @@ module Color
 			to_rgb.to_html
 		end
 
+		# === Synopsis
+		#   rgb(255,127,0).to_css        # => "#ff7f00"
+		#   rgb(255,127,0).to_css(:rgb)  # => "rgb(255 127 0)"
+		# 
+		# === Description
+		# Returns this color in CSS form, see Color::CSS.format.
+		# Only available with the native extension.
+		#
+		def to_css(form=:hex)
+			CSS.format(self, form)
+		end
+
 		# === Synopsis
 		#   somecolor.to_term # => Color::Term color
 		# 
@@ -242,6 +328,12 @@ module Color
 			Mixer.new(self)
 		end
 		
+		# Colors are frozen, so are their copies
+		def initialize_copy(other) # :nodoc:
+			super
+			freeze
+		end
+		
 		def inspect # :nodoc:
 			"<#{self}>"
 		end		
@@ -0,0 +1,22 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# == Synopsis
+	#   cmyk2hsl = Color::Converter.new(:from => :cmyk, :to => :hsl)
+	#   cmyk2hsl.convert(Color::CMYK.new(0, 255, 255, 0)) # => <HSL: 0°h 100%s, 50%l, 0>
+	#   cmyk2hsl.convert_many(cmyk_colors)                 # => array of HSL colors
+	#
+	# == Description
+	# Converts colors from one model to another. The native variant resolves
+	# the chain of conversions once on creation and reuses it for every call,
+	# intermediate colors never become ruby objects.
+	# Models can be given as class (Color::CMYK) or as symbol (:cmyk).
+	#
+	class Converter
+		Models = Color.shareable({ # :nodoc:
+			:rgb => RGB, :hsv => HSV, :hsl => HSL, :cmyk => CMYK, :gray => Gray, :rgb16 => RGB16, :rgbf => RGBF,
+			:ycbcr => YCbCr
+		})
+	end
+end
@@ -0,0 +1,23 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# == Synopsis
+	#   Color::CSS.parse("rgb(255 0 153 / 50%)")  # => <RGB: 255, 0, 153, 127 (#FF0099)>
+	#   Color::CSS.parse("hsl(120deg, 50%, 25%)") # => <HSL: 120°h 50%s, 25%l, 0>
+	#   Color::CSS.parse("rebeccapurple")         # => <RGB: 102, 51, 153, 0 (#663399)>
+	#   Color::CSS.format(color, :rgb)             # => "rgb(255 0 153 / 0.5)"
+	#
+	# == Description
+	# Reads and writes colors in the notations of CSS Color Level 4. Parsing
+	# runs in a single pass over the bytes of the input, and recurring inputs
+	# are answered from a bounded LRU cache of the parsed (frozen) colors.
+	# Keep in mind that CSS alpha is the opacity, while the alpha of this
+	# library is the transparency: "rgb(0 0 0 / 0.25)" has an alpha of 191.
+	# Only available with the native extension.
+	#
+	module CSS
+		# The forms of Color::CSS.format
+		Forms = Color.shareable([:hex, :rgb, :rgba, :hsl, :hsla, :name])
+	end
+end
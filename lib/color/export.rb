@@ -0,0 +1,19 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# == Synopsis
+	#   Color::Export.css(palette, :names => names)     # => ":root {\n  --color-red: #ff0000;\n..."
+	#   Color::Export.json(buffer, :as => :objects)      # => '[{"red":255,"green":0,...},...]'
+	#   File.open("colors.csv", "w") { |io| Color::Export.csv(buffer, :to => io) }
+	#
+	# == Description
+	# Writes whole collections of colors, arrays of any models or buffers,
+	# as CSS custom properties, JSON or CSV. The output is formatted in C
+	# into chunks which are appended to a String or written to an IO, no
+	# ruby objects are created per color.
+	# Only available with the native extension.
+	#
+	module Export
+	end
+end
@@ -0,0 +1,27 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# == Synopsis
+	#   heat  = Color::Gradient.new([Color.rgb(0, 0, 0), [0.7, Color.rgb(255, 0, 0)], Color.rgb(255, 255, 0)])
+	#   heat.at(0.35)                                  # => <RGB: 128, 0, 0, 0 (#800000)>
+	#   lut   = heat.bake(1024)                        # RGB buffer of 1024 entries
+	#   image = heat.apply(samples.pack("f*"), :range => 0..peak)
+	#   Color::Gradient[:viridis].reverse.discrete(7)  # also :magma, :inferno, :plasma, :cividis, :turbo
+	#
+	# == Description
+	# A color gradient through any number of stops, used to map numbers to
+	# colors, e.g. for heatmaps and plots. The gradient is baked into a
+	# lookup table once, then values are mapped natively, from packed floats
+	# or doubles or an Array, with clamping, linear or logarithmic scaling
+	# and a color for NaN. The perceptually uniform colormaps viridis, magma,
+	# inferno, plasma and cividis and the rainbow-like turbo are built in.
+	# Gradients are only available with the native extension.
+	#
+	class Gradient
+		def inspect # :nodoc:
+			return "<Gradient: #{size} stops>" if size > 8
+			"<Gradient: #{stops.map { |position, color| "#{color.to_html}@#{position}" }.join(' ')}>"
+		end
+	end
+end
@@ -35,39 +35,6 @@ module Color # :nodoc:
 			end			
 		end
 		
-		# The hue of this color. A value between 0 and 1.
-		attr_reader :hue
-
-		# The saturation of this color. A value between 0 and 1.
-		attr_reader :saturation
-
-		# The luminance of this color. A value between 0 and 1.
-		attr_reader :luminance
-
-		# The transparency of this color. A value between 0 and 255, where
-		# 0 means opaque and 255 fully transparent.
-		attr_reader :alpha
-
-		# === Synopsis
-		#   Color::HSL.new(hue, saturation, luminance[, alpha])
-		#
-		# === Description
-		# Create a new HSV instance. Hue, saturation, luminance are floats
-		# between 0 and 1, alpha is an Integer within 0 and 255, where 0
-		# means opaque and 255 fully transparent.
-		#
-		def initialize(hue, saturation, luminance, alpha=0)
-			unless [hue, saturation, luminance].all? { |v| 0 <= v && v <= 1 } # between? fails at NaN
-				raise ArgumentError, "Invalid Value, hue, saturation and luminance must be between 0 and 1"
-			end
-			raise ArgumentError, "Invalid alpha, must be between 0 and 255" unless alpha.between?(0,255)
-
-			@hue        = (hue %  1).to_f
-			@saturation = saturation.to_f
-			@luminance  = luminance.to_f
-			@alpha      = alpha.to_i
-		end
-		
 		# === Synopsis
 		#    hsl.to_s # => string
 		# 
@@ -101,20 +68,6 @@ module Color # :nodoc:
 			{ :hue => hue, :saturation => saturation, :luminance => luminance, :alpha => as_floats ? alpha/255.0 : alpha }
 		end
 
-		def to_rgb # :nodoc:
-			if @saturation.in_delta(0) then
-				v = @luminance*255
-				RGB.new(v, v, v, @alpha)
-			else
-				co_var1 = (@luminance < 0.5) ? @luminance * (1.0+@saturation) : (@luminance + @saturation) - (@luminance * @saturation)
-				co_var2 = 2*@luminance - co_var1
-				red     = hue_to_rgb(co_var1, co_var2, (@hue + 1.0/3))
-				green   = hue_to_rgb(co_var1, co_var2, @hue)
-				blue    = hue_to_rgb(co_var1, co_var2, (@hue - 1.0/3))
-				RGB.new(red, green, blue, @alpha)
-			end
-		end
-		
 		def to_hsl # :nodoc:
 			dup
 		end
@@ -130,9 +83,9 @@ module Color # :nodoc:
 			hue += 1 if hue < 0
 			hue -= 1 if hue > 1
 			case
-				when (6*hue < 1): ((co_var1-co_var2)*6*hue+co_var2)
-				when (2*hue < 1): co_var1
-				when (3*hue < 2): (co_var2+(co_var1-co_var2)*(2.0/3-hue)*6)
+				when (6*hue < 1) then ((co_var1-co_var2)*6*hue+co_var2)
+				when (2*hue < 1) then co_var1
+				when (3*hue < 2) then (co_var2+(co_var1-co_var2)*(2.0/3-hue)*6)
 				else co_var2
 			end * 255
 		end
@@ -0,0 +1,147 @@
+require 'color'
+
+module Color # :nodoc:
+	class Buffer
+		# === Synopsis
+		#   buffer.lazy.to_hsv.map_hue { |h| h+0.5 }.to_rgb.blend(overlay).force
+		#
+		# === Description
+		# Returns a Color::Buffer::Lazy, which records operations on this buffer
+		# and runs them in a single pass once forced.
+		#
+		def lazy
+			Lazy.new(self)
+		end
+
+		# == Synopsis
+		#   result = buffer.lazy.
+		#     to_hsv.
+		#     map_hue { |hue| (hue+0.5) % 1 }.
+		#     adjust(:saturation => [:*, 1.2]).
+		#     to_rgb.
+		#     blend(overlay, :space => :linear).
+		#     force
+		#
+		# == Description
+		# A lazy expression over a Color::Buffer. Every method returns a new Lazy
+		# with one more operation, nothing is computed until force is called.
+		#
+		# On force, all operations are fused into one loop: each color is decoded
+		# once to float RGB, passes all operations there and is encoded once into
+		# the result, which is the only buffer allocated. Conversions in between
+		# (to_hsv, to_rgb, ...) only decide the model of the result, the route to
+		# it is the shortest one of the native conversion table.
+		# Because nothing is rounded in between, results can differ from the
+		# eager equivalent by the rounding of the intermediate models.
+		#
+		# The map_* methods sample their block once per step of a lookup table
+		# (4097 steps for hue, saturation, value and luminance, which are 0..1,
+		# 256 for red, green, blue and alpha, which are 0..255), so the block
+		# must only depend on its argument.
+		#
+		class Lazy
+			Attributes = Color.shareable([:hue, :saturation, :value, :luminance, :red, :green, :blue, :alpha]) # :nodoc:
+			Steps      = 4096 # :nodoc:
+
+			# The source buffer
+			attr_reader :source
+
+			# The model of the buffer force will return
+			attr_reader :model
+
+			# The recorded stages, see Color::Buffer#_pipeline
+			attr_reader :stages # :nodoc:
+
+			def initialize(source, model=source.model, stages=[])
+				@source = source
+				@model  = model
+				@stages = stages
+			end
+
+			# Changes the model of the result, see Color::Buffer#convert
+			def convert(model)
+				self.class.new(@source, Converter::Models[model] || model, @stages)
+			end
+
+			def to_rgb;   convert(RGB);   end
+			def to_hsv;   convert(HSV);   end
+			def to_hsl;   convert(HSL);   end
+			def to_cmyk;  convert(CMYK);  end
+			def to_gray;  convert(Gray);  end
+			def to_rgb16; convert(RGB16); end
+			def to_rgbf;  convert(RGBF);  end
+			def to_ycbcr; convert(YCbCr); end
+
+			# Records Color::Buffer#adjust. Consecutive adjustments of different
+			# attributes are merged into one stage where the order allows it.
+			def adjust(spec)
+				last = @stages.last
+				if last && last[0] == :adjust && mergeable?(last[1], spec) then
+					self.class.new(@source, @model, @stages[0..-2] << [:adjust, last[1].merge(spec)])
+				else
+					self.class.new(@source, @model, @stages+[[:adjust, spec.dup]])
+				end
+			end
+
+			# === Synopsis
+			#   lazy.map_attribute(:hue) { |hue| (hue+0.5) % 1 }
+			#   lazy.map_hue { |hue| (hue+0.5) % 1 }
+			#
+			# === Description
+			# Replaces an attribute (see Color::Buffer#adjust) by the result of the
+			# block, which is sampled into a lookup table right away.
+			#
+			def map_attribute(attribute, &block)
+				raise ArgumentError, "Unknown attribute #{attribute.inspect}" unless Attributes.include?(attribute)
+				unit  = Attributes.index(attribute) < 4
+				steps = unit ? Steps : 255
+				table = Array.new(steps+1) { |i|
+					unit ? block.call(i.to_f/steps).to_f : block.call(i)/255.0
+				}
+				adjust(attribute => [:map, table.pack("f*")])
+			end
+
+			Attributes.each { |attribute|
+				class_eval <<-CODE
+					def map_#{attribute}(&block)
+						map_attribute(:#{attribute}, &block)
+					end
+				CODE
+			}
+
+			# Records Color::Buffer#blend, +overlay+ is a buffer of any model with
+			# the same length. Options are :alpha, :using and :space.
+			def blend(overlay, options={})
+				self.class.new(@source, @model, @stages+[[:blend, overlay, options[:alpha], options[:using], options[:space]]])
+			end
+
+			# Records Color::Buffer#interpolate, +other+ is a buffer of any model
+			# with the same length.
+			def interpolate(other, pos=0.5, options={})
+				raise ArgumentError, "Position must be between 0 and 1" unless pos.between?(0,1)
+				self.class.new(@source, @model, @stages+[[:interpolate, other, pos, options[:space]]])
+			end
+
+			# Runs all operations and returns the resulting buffer.
+			# With :threads => n the work is split over n native threads.
+			def force(options={})
+				@source._pipeline(@stages, @model, options)
+			end
+			alias to_buffer force
+
+			def inspect # :nodoc:
+				ops = @stages.map { |stage| stage[0] }
+				"<Lazy: #{@source.inspect} -> #{@model.name.sub(/.*::/, '')} (#{ops.join(', ')})>"
+			end
+
+		private
+			# HSV attributes are independent of each other, so are the channels,
+			# but luminance and channels see the result of earlier groups.
+			def mergeable?(previous, spec)
+				group = proc { |attribute| [0, 0, 0, 1, 2, 2, 2, 2][Attributes.index(attribute) || 0] }
+				return false if spec.keys.any? { |key| previous.has_key?(key) }
+				previous.keys.map(&group).max <= spec.keys.map(&group).min
+			end
+		end
+	end
+end
@@ -0,0 +1,33 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# == Synopsis
+	#   palette = Color::Palette.new(Color::Named::Names.values).compile
+	#   palette.closest(Color.rgb(250, 128, 114)) # => <RGB: #FA8072>
+	#   palette.indices(buffer).unpack("C*")       # => [17, 3, ...]
+	#   palette.compile_info[:bytes]               # => 18544
+	#
+	# == Description
+	# A fixed set of up to 256 colors to look the closest color up in, with
+	# the same metric as Color::RGB#distance. Palettes queried many times
+	# (terminal colors, named colors, brand colors) can be compiled into a
+	# grid over RGB which keeps, per cell, the few colors that can be the
+	# closest, lookups then compare only those.
+	# Palettes can be passed to Color::Buffer#quantize.
+	# Palettes are only available with the native extension.
+	#
+	class Palette
+		include Enumerable
+
+		# Iterates over the colors, as Color::RGB
+		def each(&block)
+			to_a.each(&block)
+			self
+		end
+
+		def inspect # :nodoc:
+			"<Palette: #{size} colors#{', compiled' if compiled?}>"
+		end
+	end
+end
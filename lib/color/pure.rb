@@ -0,0 +1,47 @@
+require 'color/pure/rgb'
+require 'color/pure/hsv'
+require 'color/pure/hsl'
+require 'color/pure/cmyk'
+require 'color/pure/gray'
+require 'color/pure/rgb16'
+require 'color/pure/rgbf'
+require 'color/pure/ycbcr'
+require 'color/pure/converter'
+
+# The pure ruby versions of what the native extension implements, only
+# loaded without it, see color.rb.
+module Color
+	# Whether this is a native build (e.g. C) or plain ruby
+	def native?
+		false
+	end
+
+	# Counters of the native extension, nil unless it was built with
+	# --enable-stats (gem install color -- --enable-stats).
+	def stats
+		nil
+	end
+	
+	# Sets all counters of Color.stats to 0.
+	def reset_stats
+		nil
+	end
+	
+	# The instruction set used by the native batch kernels, nil without the
+	# native extension.
+	def simd_level
+		nil
+	end
+	
+	# All instruction sets usable on this cpu, empty without the native
+	# extension.
+	def simd_levels
+		[]
+	end
+
+	module_function :native?
+	module_function :stats
+	module_function :reset_stats
+	module_function :simd_level
+	module_function :simd_levels
+end
@@ -0,0 +1,49 @@
+module Color # :nodoc:
+	class CMYK
+		# The cyan portion of this color. A value between 0 and 255.
+		attr_reader :cyan
+
+		# The magenta portion of this color. A value between 0 and 255.
+		attr_reader :magenta
+
+		# The yellow portion of this color. A value between 0 and 255.
+		attr_reader :yellow
+
+		# The key (black) portion of this color. A value between 0 and 255.
+		attr_reader :key
+
+		# The transparency of this color. A value between 0 and 255, where
+		# 0 means opaque and 255 fully transparent.
+		attr_reader :alpha
+		alias black key
+
+		# === Synopsis
+		#   Color::CMYK.new(cyan, magenta, yellow, key[, alpha])
+		#
+		# === Description
+		# Create a new CMYK instance. cyan, magenta, yellow, key and alpha are
+		# Integers within 0 and 255 each, where for alpha 0 means
+		# opaque and 255 fully transparent.
+		#
+		def initialize(cyan, magenta, yellow, key, alpha=0)
+			@cyan    = cyan.round
+			@magenta = magenta.round
+			@yellow  = yellow.round
+			@key     = key.round
+			@alpha   = alpha.round
+			
+			unless [cyan, magenta, yellow, key, alpha].all? { |v| v.between?(0,255) }
+				raise ArgumentError, "Value must be between 0 and 255"
+			end
+			freeze
+		end
+
+		def to_rgb # :nodoc:
+			key     = @key/255.0
+			cyan    = 1-(@cyan/255.0*(1-key)+key)
+			magenta = 1-(@magenta/255.0*(1-key)+key)
+			yellow  = 1-(@yellow/255.0*(1-key)+key)
+			RGB.new(cyan*255, magenta*255, yellow*255, @alpha)
+		end
+	end
+end
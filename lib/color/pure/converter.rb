@@ -0,0 +1,31 @@
+module Color # :nodoc:
+	class Converter
+		# The color class this converter converts from.
+		attr_reader :from
+
+		# The color class this converter converts to.
+		attr_reader :to
+
+		def initialize(options)
+			@from = Models[options[:from]] || options[:from]
+			@to   = Models[options[:to]] || options[:to]
+			raise ArgumentError, "Converter requires :from and :to" unless @from && @to
+		end
+
+		# Converts a single color.
+		def convert(color)
+			raise TypeError, "Expected #{@from}, got #{color.class}" unless color.class == @from
+			@to.from(color)
+		end
+
+		# Converts all colors in an array.
+		def convert_many(colors)
+			colors.map { |color| convert(color) }
+		end
+
+		# Converts a Color::Buffer, returning a new buffer of the target model.
+		def convert_buffer(buffer)
+			buffer.convert(@to)
+		end
+	end
+end
@@ -0,0 +1,29 @@
+module Color # :nodoc:
+	class Gray
+		# The white portion of this color. A value between 0 and 255.
+		attr_reader :white
+
+		# The transparency of this color. A value between 0 and 255, where
+		# 0 means opaque and 255 fully transparent.
+		attr_reader :alpha
+		alias value white
+
+		# === Synopsis
+		#   Color::Gray.new(white[, alpha])
+		#
+		# Create a new Gray instance. +White+ and +alpha+ are Integers
+		# within 0 and 255 each, where for white 0 means black and
+		# 255 means white, for alpha 0 means opaque and 255 fully
+		# transparent.
+		#
+		def initialize(white, alpha=0)
+			@white = white.round
+			@alpha = alpha.round
+
+			unless [white, alpha].all? { |v| v.between?(0,255) }
+				raise ArgumentError, "Value must be between 0 and 255"
+			end
+			freeze
+		end
+	end
+end
@@ -0,0 +1,51 @@
+module Color # :nodoc:
+	class HSL
+		# The hue of this color. A value between 0 and 1.
+		attr_reader :hue
+
+		# The saturation of this color. A value between 0 and 1.
+		attr_reader :saturation
+
+		# The luminance of this color. A value between 0 and 1.
+		attr_reader :luminance
+
+		# The transparency of this color. A value between 0 and 255, where
+		# 0 means opaque and 255 fully transparent.
+		attr_reader :alpha
+
+		# === Synopsis
+		#   Color::HSL.new(hue, saturation, luminance[, alpha])
+		#
+		# === Description
+		# Create a new HSV instance. Hue, saturation, luminance are floats
+		# between 0 and 1, alpha is an Integer within 0 and 255, where 0
+		# means opaque and 255 fully transparent.
+		#
+		def initialize(hue, saturation, luminance, alpha=0)
+			unless [hue, saturation, luminance].all? { |v| 0 <= v && v <= 1 } # between? fails at NaN
+				raise ArgumentError, "Invalid Value, hue, saturation and luminance must be between 0 and 1"
+			end
+			raise ArgumentError, "Invalid alpha, must be between 0 and 255" unless alpha.between?(0,255)
+
+			@hue        = (hue %  1).to_f
+			@saturation = saturation.to_f
+			@luminance  = luminance.to_f
+			@alpha      = alpha.to_i
+			freeze
+		end
+
+		def to_rgb # :nodoc:
+			if @saturation.in_delta(0) then
+				v = @luminance*255
+				RGB.new(v, v, v, @alpha)
+			else
+				co_var1 = (@luminance < 0.5) ? @luminance * (1.0+@saturation) : (@luminance + @saturation) - (@luminance * @saturation)
+				co_var2 = 2*@luminance - co_var1
+				red     = hue_to_rgb(co_var1, co_var2, (@hue + 1.0/3))
+				green   = hue_to_rgb(co_var1, co_var2, @hue)
+				blue    = hue_to_rgb(co_var1, co_var2, (@hue - 1.0/3))
+				RGB.new(red, green, blue, @alpha)
+			end
+		end
+	end
+end
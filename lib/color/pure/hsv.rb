@@ -0,0 +1,60 @@
+module Color # :nodoc:
+	class HSV
+		# The hue of this color. A value between 0 and 1.
+		attr_reader :hue
+
+		# The saturation of this color. A value between 0 and 1.
+		attr_reader :saturation
+
+		# The value of this color. A value between 0 and 1.
+		attr_reader :value
+
+		# The transparency of this color. A value between 0 and 255, where
+		# 0 means opaque and 255 fully transparent.
+		attr_reader :alpha
+
+		# === Synopsis
+		#   Color::HSV.new(hue, saturation, value[, alpha])
+		#
+		# === Description
+		# Create a new HSV instance. Hue, saturation, value are floats
+		# between 0 and 1, alpha is an Integer within 0 and 255, where 0
+		# means opaque and 255 fully transparent.
+		#
+		def initialize(hue, saturation, value, alpha=0)
+			unless [hue, saturation, value].all? { |v| 0 <= v && v <= 1 } # between? fails at NaN
+				raise ArgumentError, "Invalid Value, hue, saturation and value must be between 0 and 1"
+			end
+			raise ArgumentError, "Invalid alpha, must be between 0 and 255" unless alpha.between?(0,255)
+
+			@hue        = (hue %  1).to_f
+			@saturation = saturation.to_f
+			@value      = value.to_f
+			@alpha      = alpha.to_i
+			freeze
+		end
+
+		def to_rgb # :nodoc:
+			if @saturation.in_delta(0) then
+				RGB.new(@value*255, @value*255, @value*255, @alpha)
+			else
+				hi = (@hue*6.0).to_i % 6
+				f  = (@hue*6.0)-hi
+				p  = @value*(1.0-@saturation)
+				q  = @value*(1.0-f*@saturation)
+				t  = @value*(1.0-(1.0-f)*@saturation)
+				r,g,b = *(case hi
+					when 0 then [@value, t, p]
+					when 1 then [q, @value, p]
+					when 2 then [p, @value, t]
+					when 3 then [p, q, @value]
+					when 4 then [t, p, @value]
+					when 5 then [@value, p, q]
+					else
+						raise "Error, #{hi} should be 0..5"
+				end)
+				RGB.new(r*255,g*255,b*255,@alpha)
+			end
+		end
+	end
+end
@@ -0,0 +1,219 @@
+module Color # :nodoc:
+	class RGB
+		class <<self
+			# === Synopsis
+			#   Color::RGB.from_int(integer) -> RGB instance
+			#
+			# === Description
+			# Create an RGB color from an integer of the form 0xaarrggbb.
+			# See Color::RGB#to_i.
+			#
+			def from_int(value)
+				new(value >> 16 & 0xff, value >> 8 & 0xff, value & 0xff, value >> 24 & 0xff)
+			end
+		end
+
+		# The red portion of this color. A value between 0 and 255.
+		attr_reader :red
+
+		# The green portion of this color. A value between 0 and 255.
+		attr_reader :green
+
+		# The blue portion of this color. A value between 0 and 255.
+		attr_reader :blue
+
+		# The transparency of this color. A value between 0 and 255, where
+		# 0 means opaque and 255 fully transparent.
+		attr_reader :alpha
+
+		# === Synopsis
+		#   Color::RGB.new(red, green, blue[, alpha])
+		# 
+		# === Description
+		# Create a new RGB instance. Red, green, blue and alpha are
+		# Integers within 0 and 255 each, where for alpha 0 means
+		# opaque and 255 fully transparent.
+		def initialize(red, green, blue, alpha=0)
+			@red   = red.round
+			@green = green.round
+			@blue  = blue.round
+			@alpha = alpha.round
+
+			unless [red, green, blue, alpha].all? { |v| v.between?(0,255) }
+				raise ArgumentError, "Value must be between 0 and 255"
+			end
+			freeze
+		end
+
+		# See Color::Common#interpolate
+		# With <code>:space => :linear</code> red, green and blue are
+		# interpolated in linear light, which avoids the dark, muddy midpoints
+		# of interpolating the gamma encoded values.
+		def interpolate(other, pos=0.5, options={})
+			return super unless options[:space] == :linear
+			raise ArgumentError, "Position must be between 0 and 1" unless pos.between?(0,1)
+			other = coerce(other)
+			mix   = proc { |a,b|
+				a = Color.srgb_to_linear(a/255.0)
+				b = Color.srgb_to_linear(b/255.0)
+				(Color.linear_to_srgb(a+(b-a)*pos)*255).round
+			}
+			self.class.new(
+				mix[red, other.red],
+				mix[green, other.green],
+				mix[blue, other.blue],
+				(alpha+(other.alpha-alpha)*pos).round
+			)
+		end
+
+		# See Color::Common#blend
+		# Color::RGB#blend adds the additional modes: :multiply, :negative_multiply
+		# With <code>:space => :linear</code> all modes operate in linear light.
+		def blend(with, with_alpha=nil, using=:interpolate, options={})
+			with_alpha ||= with.alpha
+			opacity = (255-with_alpha)/255.0
+			linear  = options[:space] == :linear
+			value   = proc { |v,a| v+a-a*v }
+			decode  = proc { |v| linear ? Color.srgb_to_linear(v/255.0) : v/255.0 }
+			encode  = proc { |v| ((linear ? Color.linear_to_srgb(v) : v)*255).round }
+			case using
+				when :interpolate
+					mixed = linear ? interpolate(with, opacity, options) : nil
+					self.class.new(
+						linear ? mixed.red   : (red+(with.red-red)*opacity).round,
+						linear ? mixed.green : (green+(with.green-green)*opacity).round,
+						linear ? mixed.blue  : (blue+(with.blue-blue)*opacity).round,
+						alpha
+					)
+				when :multiply
+					self.class.new(
+						encode[decode[red]*value[decode[with.red], opacity]],
+						encode[decode[green]*value[decode[with.green], opacity]],
+						encode[decode[blue]*value[decode[with.blue], opacity]],
+						alpha
+					)
+				when :negative_multiply
+					self.class.new(
+						encode[1-(1-decode[red])*value[1-decode[with.red], opacity]],
+						encode[1-(1-decode[green])*value[1-decode[with.green], opacity]],
+						encode[1-(1-decode[blue])*value[1-decode[with.blue], opacity]],
+						alpha
+					)
+				else
+					raise ArgumentError, "Unknown mode, #{using}"
+			end
+		end
+
+		# === Synopsis
+		#    rgb.to_i                                # => integer
+		#    Color::RGB.from_int(rgb.to_i).eql?(rgb) # => true
+		#
+		# === Description
+		# Returns an Integer representation of this color.
+		# The format is 0xaarrggbb. If with_alpha is false/nil,
+		# the aa part is 0.
+		#
+		def to_i(with_alpha=nil)
+			(with_alpha ? (@alpha << 24) : 0) + (@red << 16) + (@green << 8) + @blue
+		end
+
+		def to_cmyk # :nodoc:
+			red, green, blue = @red/255.0, @green/255.0, @blue/255.0
+			if red.in_delta(green) && green.in_delta(blue) then
+				cyan, magenta, yellow = 0.0, 0.0, 0.0
+				key     = 1.0-red
+			else
+				cyan    = 1.0-red
+				magenta = 1.0-green
+				yellow  = 1.0-blue
+				key     = [cyan, magenta, yellow].min
+				if key == 1.0 then
+					cyan, magenta, yellow = 0.0, 0.0, 0.0
+				else
+					cyan    = (cyan-key)/(1.0-key)
+					magenta = (magenta-key)/(1.0-key)
+					yellow  = (yellow-key)/(1.0-key)
+				end
+			end
+			CMYK.new(cyan, magenta, yellow, key, @alpha)
+		end
+
+		def to_hsv # :nodoc:
+			red, green, blue = @red/255.0, @green/255.0, @blue/255.0
+			max = [red, green, blue].max
+			min = [red, green, blue].min
+
+			# hue
+			if max.in_delta(min) then
+				hue = 0
+			elsif (max == red) then
+				hue = 1.0/6*(green-blue)/(max-min)
+				hue += 1 if (green < blue)
+			elsif (max == green) then
+				hue = 1.0/6*(blue-red)/(max-min)+1.0/3
+			elsif (max == blue) then
+				hue = 1.0/6*(red-green)/(max-min)+2.0/3
+			end
+			
+			# saturation
+			saturation = max.in_delta(0) ? 0 : (max-min)/max
+			
+			# value
+			value      = max
+			
+			HSV.new(hue, saturation, value, @alpha)
+		end
+
+		def to_hsl # :nodoc:
+			red, green, blue = @red/255.0, @green/255.0, @blue/255.0
+			max = [red, green, blue].max
+			min = [red, green, blue].min
+
+			# hue
+			if max.in_delta(min) then
+				hue = 0
+			elsif max == red then
+				hue = 1.0/6*(green-blue)/(max-min)
+				hue += 1 if (green < blue)
+			elsif max == green then
+				hue = 1.0/6*(blue-red)/(max-min)+1.0/3
+			elsif max == blue then
+				hue = 1.0/6*(red-green)/(max-min)+2.0/3
+			end
+			
+			# luminance
+			luminance = 0.5*(min+max)
+
+			# saturation
+			if max.in_delta(min) then
+				saturation = 0
+			elsif luminance <= 0.5 then
+				saturation = (max-min)/(max+min)
+			else
+				saturation = (max-min)/(2-(max+min))
+			end
+			
+			HSL.new(hue, saturation, luminance, @alpha)
+		end
+
+		def to_gray # :nodoc:
+			Gray.new(((@red+@green+@blue)/3.0).round, @alpha)
+		end
+
+		def to_rgb16 # :nodoc:
+			RGB16.new(@red*257, @green*257, @blue*257, @alpha*257)
+		end
+
+		def to_rgbf # :nodoc:
+			RGBF.new(*to_a(true))
+		end
+
+		def to_ycbcr # :nodoc:
+			y = 0.299*@red+0.587*@green+0.114*@blue
+			values = [y, 128+(@blue-y)/1.772, 128+(@red-y)/1.402].map { |v|
+				v < 0 ? 0 : v > 255 ? 255 : v.round
+			}
+			YCbCr.new(*values << @alpha)
+		end
+	end
+end
@@ -0,0 +1,51 @@
+module Color # :nodoc:
+	class RGB16
+		# The red portion of this color. A value between 0 and 65535.
+		attr_reader :red
+
+		# The green portion of this color. A value between 0 and 65535.
+		attr_reader :green
+
+		# The blue portion of this color. A value between 0 and 65535.
+		attr_reader :blue
+
+		# The transparency of this color. A value between 0 and 65535, where
+		# 0 means opaque and 65535 fully transparent.
+		attr_reader :alpha
+
+		# === Synopsis
+		#   Color::RGB16.new(red, green, blue[, alpha])
+		# 
+		# === Description
+		# Create a new RGB16 instance. Red, green, blue and alpha are
+		# Integers within 0 and 65535 each, where for alpha 0 means
+		# opaque and 65535 fully transparent.
+		def initialize(red, green, blue, alpha=0)
+			@red   = red.round
+			@green = green.round
+			@blue  = blue.round
+			@alpha = alpha.round
+
+			unless [red, green, blue, alpha].all? { |v| v.between?(0,65535) }
+				raise ArgumentError, "Value must be between 0 and 65535"
+			end
+			freeze
+		end
+
+		def to_rgb # :nodoc:
+			RGB.new(*to_a.map { |v| (v*255/65535.0).round })
+		end
+
+		def to_rgbf # :nodoc:
+			RGBF.new(*to_a(true))
+		end
+
+		def to_hsv # :nodoc:
+			to_rgbf.to_hsv
+		end
+
+		def to_hsl # :nodoc:
+			to_rgbf.to_hsl
+		end
+	end
+end
@@ -0,0 +1,54 @@
+module Color # :nodoc:
+	class RGBF
+		# The red portion of this color, 1.0 is full intensity.
+		attr_reader :red
+
+		# The green portion of this color, 1.0 is full intensity.
+		attr_reader :green
+
+		# The blue portion of this color, 1.0 is full intensity.
+		attr_reader :blue
+
+		# The transparency of this color. A value between 0 and 1, where
+		# 0 means opaque and 1 fully transparent.
+		attr_reader :alpha
+
+		# === Synopsis
+		#   Color::RGBF.new(red, green, blue[, alpha])
+		# 
+		# === Description
+		# Create a new RGBF instance. Red, green and blue are floats of
+		# at least 0, where 1 is full intensity. Values above 1 are kept
+		# (HDR) and clipped when converting to other models.
+		# Alpha is a float between 0 and 1, where 0 means opaque and 1
+		# fully transparent.
+		def initialize(red, green, blue, alpha=0)
+			unless [red, green, blue].all? { |v| v >= 0 && v.to_f.finite? }
+				raise ArgumentError, "Value must be a finite value of at least 0"
+			end
+			raise ArgumentError, "Invalid alpha, must be between 0 and 1" unless alpha.between?(0,1)
+
+			@red   = red.to_f
+			@green = green.to_f
+			@blue  = blue.to_f
+			@alpha = alpha.to_f
+			freeze
+		end
+
+		def to_rgb # :nodoc:
+			RGB.new(*to_a.map { |v| ([v, 1.0].min*255).round })
+		end
+
+		def to_rgb16 # :nodoc:
+			RGB16.new(*to_a.map { |v| ([v, 1.0].min*65535).round })
+		end
+
+		def to_hsv # :nodoc:
+			to_rgb.to_hsv
+		end
+
+		def to_hsl # :nodoc:
+			to_rgb.to_hsl
+		end
+	end
+end
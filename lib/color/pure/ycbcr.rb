@@ -0,0 +1,48 @@
+module Color # :nodoc:
+	class YCbCr
+		# The luma of this color. A value between 0 and 255.
+		attr_reader :y
+		alias luma y
+
+		# The blue difference of this color. A value between 0 and 255, 128
+		# is neutral.
+		attr_reader :cb
+
+		# The red difference of this color. A value between 0 and 255, 128
+		# is neutral.
+		attr_reader :cr
+
+		# The transparency of this color. A value between 0 and 255, where
+		# 0 means opaque and 255 fully transparent.
+		attr_reader :alpha
+
+		# === Synopsis
+		#   Color::YCbCr.new(y, cb, cr[, alpha])
+		# 
+		# === Description
+		# Create a new YCbCr instance. Y', Cb, Cr and alpha are Integers
+		# within 0 and 255 each, where for alpha 0 means opaque and 255
+		# fully transparent.
+		def initialize(y, cb, cr, alpha=0)
+			unless [y, cb, cr, alpha].all? { |v| v.between?(0,255) }
+				raise ArgumentError, "Value must be between 0 and 255"
+			end
+
+			@y     = y.round
+			@cb    = cb.round
+			@cr    = cr.round
+			@alpha = alpha.round
+			freeze
+		end
+
+		def to_rgb # :nodoc:
+			blue, red = cb-128, cr-128
+			RGB.new(
+				cap(y+1.402*red),
+				cap(y-0.344136*blue-0.714136*red),
+				cap(y+1.772*blue),
+				alpha
+			)
+		end
+	end
+end
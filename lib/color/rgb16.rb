@@ -0,0 +1,88 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# === Synopsis
+	#   deep = Color::RGB16.new(65535, 32768, 0)
+	#   deep.to_rgb # => <RGB: 255, 128, 0, 0 (#FF8000)>
+	#
+	# === Description
+	# RGB representation of color with 16 bits per channel.
+	# Conversions to HSV and HSL don't go through 8 bit, so no precision
+	# is lost on the way.
+	class RGB16
+		include Common
+
+		class <<self
+			# used to load with Marshal.load
+			def _load(marshalled) # :nodoc:
+				new(*marshalled.unpack("n4"))
+			end
+
+			# === Synopsis
+			#   Color::RGB16.from(Color::RGB.new(255,0,0)) # => <RGB16: 65535, 0, 0, 0>
+			#
+			# === Description
+			# Coerces +value+ to RGB16.
+			# 
+			def from(value)
+				value.to_rgb16
+			end
+			
+			# === Synopsis
+			#   Color::RGB16.floats(0, 0.5, 0.75, 1) # => <RGB16: 0, 32768, 49151, 65535>
+			#
+			# === Description
+			# Create an RGB16 color from float values. Counterpart to Color::RGB16#to_a(true).
+			# 
+			def floats(red, green, blue, alpha=0)
+				new((red*65535).round, (green*65535).round, (blue*65535).round, (alpha*65535).round)
+			end			
+		end
+		
+		# === Synopsis
+		#    rgb16.to_s # => string
+		# 
+		# === Description
+		# Returns a String representation of this color.
+		#
+		def to_s
+			"RGB16: %d, %d, %d, %d" %  [red, green, blue, alpha]
+		end
+
+		# === Synopsis
+		#   rgb16.to_a # => array
+		#
+		# === Description
+		# Returns all values in an array. If +as_floats+ is true, the values
+		# are converted to float values between 0 and 1.
+		#
+		def to_a(as_floats=false)
+			as_floats ?
+				[red/65535.0, green/65535.0, blue/65535.0, alpha/65535.0] :
+				[red, green, blue, alpha]
+		end
+		
+		# === Synopsis
+		#   rgb16.to_hash # => hash
+		#
+		# === Description
+		# Returns all values in a hash with keys :red, :green, :blue and :alpha.
+		# If +as_floats+ is true, the values are converted to float
+		# values between 0 and 1.
+		#
+		def to_hash(as_floats=false)
+			values = to_a(as_floats)
+			{ :red => values[0], :green => values[1], :blue => values[2], :alpha => values[3] }
+		end
+
+		def to_rgb16 # :nodoc:
+			dup
+		end
+
+		# Used with Marshal.dump to create a dump of this color.
+		def _dump(*a) # :nodoc:
+			[red, green, blue, alpha].pack("n4")
+		end
+	end
+end
@@ -0,0 +1,85 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# === Synopsis
+	#   hdr = Color::RGBF.new(2.0, 0.5, 0.25)
+	#   hdr.to_rgb # => <RGB: 255, 128, 64, 0 (#FF8040)>
+	#
+	# === Description
+	# RGB representation of color with float channels, 1.0 is full intensity.
+	# Red, green and blue may exceed 1.0 (HDR), such values are clipped when
+	# converting to other models.
+	# Conversions to HSV and HSL don't go through 8 bit, so no precision
+	# is lost on the way.
+	class RGBF
+		include Common
+
+		class <<self
+			# used to load with Marshal.load
+			def _load(marshalled) # :nodoc:
+				new(*marshalled.unpack("g4"))
+			end
+
+			# === Synopsis
+			#   Color::RGBF.from(Color::RGB.new(255,0,0)) # => <RGBF: 1.0000, 0.0000, 0.0000, 0.0000>
+			#
+			# === Description
+			# Coerces +value+ to RGBF.
+			# 
+			def from(value)
+				value.to_rgbf
+			end
+			
+			# === Synopsis
+			#   Color::RGBF.floats(0, 0.5, 0.75, 1) # => <RGBF: 0.0000, 0.5000, 0.7500, 1.0000>
+			#
+			# === Description
+			# Same as Color::RGBF::new.
+			# 
+			def floats(red, green, blue, alpha=0)
+				new(red, green, blue, alpha)
+			end			
+		end
+		
+		# === Synopsis
+		#    rgbf.to_s # => string
+		# 
+		# === Description
+		# Returns a String representation of this color.
+		#
+		def to_s
+			"RGBF: %.4f, %.4f, %.4f, %.4f" %  [red, green, blue, alpha]
+		end
+
+		# === Synopsis
+		#   rgbf.to_a # => array
+		#
+		# === Description
+		# Returns all values in an array. The values are floats already,
+		# +as_floats+ exists for compatibility with the other models.
+		#
+		def to_a(as_floats=false)
+			[red, green, blue, alpha]
+		end
+		
+		# === Synopsis
+		#   rgbf.to_hash # => hash
+		#
+		# === Description
+		# Returns all values in a hash with keys :red, :green, :blue and :alpha.
+		#
+		def to_hash(as_floats=false)
+			{ :red => red, :green => green, :blue => blue, :alpha => alpha }
+		end
+
+		def to_rgbf # :nodoc:
+			dup
+		end
+
+		# Used with Marshal.dump to create a dump of this color.
+		def _dump(*a) # :nodoc:
+			[red, green, blue, alpha].pack("g4")
+		end
+	end
+end
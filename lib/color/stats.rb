@@ -0,0 +1,35 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# == Synopsis
+	#   stats = Color::Stats.new
+	#   frames.each { |frame| stats.add(frame) }   # buffers, arrays or colors
+	#   stats.mean                                 # => <RGB: 98, 104, 121, 0 (#626879)>
+	#   stats.top(3)                               # => [[<RGB: ...>, 182044], ...]
+	#   total = Marshal.load(dump).merge(stats)
+	#
+	# == Description
+	# A single pass summary of any number of colors in constant memory: the
+	# mean color in linear light with the variance of every channel, min and
+	# max, the circular mean of the hue, the mean luminance and the most
+	# frequent colors, counted approximately in a count-min sketch.
+	# Stats of other threads or processes merge as if all colors had been
+	# added to one, Marshal dumps load on any platform.
+	# Stats are only available with the native extension.
+	#
+	class Stats
+		# All results in a Hash with keys :count, :mean, :variance, :min,
+		# :max, :hue, :hue_concentration, :luminance and :top.
+		def to_hash
+			{
+				:count => count, :mean => mean, :variance => variance, :min => min, :max => max,
+				:hue => hue, :hue_concentration => hue_concentration, :luminance => luminance, :top => top
+			}
+		end
+
+		def inspect # :nodoc:
+			"<Stats: #{count} colors#{", mean #{mean.to_html}" if count > 0}>"
+		end
+	end
+end
@@ -27,10 +27,23 @@ module Color # :nodoc:
 			def floats(*values)
 				RGB.floats(*values).to_term
 			end
+
+			# === Synopsis
+			#   indices = buffer.quantize(Color::Term.palette, :dither => :floyd_steinberg)
+			#   Color::Term.new(Color::Term::Palette[indices[0]]).to_s
+			#
+			# === Description
+			# The terminal colors as RGB, ordered by their ANSI code (30+index
+			# for foreground, 40+index for background). Also see Buffer#quantize.
+			#
+			def palette
+				Palette.map { |name| RGB.from_int(Term::Values[name]) }
+			end
 		end
 		
 		def initialize(name)
 			@name = name
+			freeze
 		end
 		
 		# The transparency of this color. A value between 0 and 255, where
@@ -47,7 +60,7 @@ module Color # :nodoc:
 		# === Description
 		# Returns the ANSI sequence for this color in the foreground, or if +background+
 		# is true, for the background.
-		# Also see: Color::Term::StringColoring
+		# Also see: Color::Term::StringColoring, Color::Term::Writer
 		#
 		def to_s(background=false)
 			background ? "\e[#{Background[@name]}m" : "\e[#{Foreground[@name]}m"
@@ -86,7 +99,7 @@ module Color # :nodoc:
 		end
 		
 		def to_rgb # :nodoc:
-			RGB.from_int(Value[@name])
+			RGB.from_int(Values[@name])
 		end
 		
 		def inspect # :nodoc:
@@ -98,46 +111,30 @@ module Color # :nodoc:
 			@name.to_s
 		end
 
-		Mapping = {
-			RGB.from_int(0x000000) => :black,
-			RGB.from_int(0xff0000) => :red,
-			RGB.from_int(0x00ff00) => :green,
-			RGB.from_int(0x0000ff) => :blue,
-			RGB.from_int(0xffff00) => :yellow,
-			RGB.from_int(0xff00ff) => :purple,
-			RGB.from_int(0x00ffff) => :cyan,
-			RGB.from_int(0xffffff) => :white,
-		}
-		Values = {
-			:black  => 0x000000,
-			:red    => 0xff0000,
-			:green  => 0x00ff00,
-			:blue   => 0x0000ff,
-			:yellow => 0xffff00,
-			:purple => 0xff00ff,
-			:cyan   => 0x00ffff,
-			:white  => 0xffffff,
-		}
-		Foreground = {
-			:black  => 30,
-			:red    => 31,
-			:green  => 32,
-			:yellow => 33,
-			:blue   => 34,
-			:purple => 35,
-			:cyan   => 36,
-			:white  => 37,
-		}
-		Background = {
-			:black  => 40,
-			:red    => 41,
-			:green  => 42,
-			:yellow => 43,
-			:blue   => 44,
-			:purple => 45,
-			:cyan   => 46,
-			:white  => 47,
-		}
+		# The color names ordered by ANSI code
+		Palette = Color.shareable([:black, :red, :green, :yellow, :blue, :purple, :cyan, :white])
+
+		# Values (name => 0xRRGGBB), Mapping (Color::RGB => name), Foreground
+		# and Background (name => SGR code) follow from the ANSI index of a
+		# name (bit 0 is red, bit 1 green, bit 2 blue) and are only built on
+		# first use.
+		def self.const_missing(name) # :nodoc:
+			table = {}
+			Palette.each_with_index { |color, index|
+				if name == :Values
+					table[color] = (index & 1)*0xff0000 + (index >> 1 & 1)*0x00ff00 + (index >> 2)*0x0000ff
+				elsif name == :Mapping
+					table[RGB.from_int(Values[color])] = color
+				elsif name == :Foreground
+					table[color] = 30+index
+				elsif name == :Background
+					table[color] = 40+index
+				else
+					return super
+				end
+			}
+			const_set(name, Color.shareable(table))
+		end
 
 		# A helper module for using class Color::Term
 		#
@@ -151,19 +148,43 @@ module Color # :nodoc:
 		# see Term::Foreground for names of foreground colors, Term::Background
 		# for background colors (the methods for background colors are "on_" + name,
 		# e.g. :red -> #on_red.
+		# Every call creates a new String with its own reset, use
+		# Color::Term::Writer to colorize large amounts of text.
 		#
 		module StringColoring
-			(Foreground.merge({
+			Palette.each_with_index { |name, index|
+				define_method(name) { "\e[#{30+index}m#{self}\e[0m" }
+				define_method("on_#{name}") { "\e[#{40+index}m#{self}\e[0m" }
+			}
+			{
 				:bold      => 1,
 				:underline => 4,
 				:blink     => 5,
 				:invert    => 7,
-			})).each { |name, value|
+			}.each { |name, value|
 				define_method(name) { "\e[#{value}m#{self}\e[0m" }
 			}
-			Background.each { |name, value|
-				define_method("on_#{name}") { "\e[#{value}m#{self}\e[0m" }
-			}
+		end
+
+		# == Synopsis
+		#   writer = Color::Term::Writer.new($stdout, :depth => :truecolor)
+		#   writer.write("ERROR", :fg => :red, :bold => true)
+		#   writer.write(" disk full", :fg => Color.rgb(255, 128, 0)).reset << "\n"
+		#   writer.flush
+		#
+		# == Description
+		# Appends styled text to one String or IO. The writer knows the style
+		# the terminal is in and sends only the attributes that change, in a
+		# single escape sequence, and a reset only when going back to the
+		# plain style. Colors other than the 8 terminal colors are reduced to
+		# what the terminal can show, the closest of the 8 or the 256 color
+		# palette, or sent as they are with :truecolor.
+		# Only available with the native extension.
+		#
+		class Writer
+			def inspect # :nodoc:
+				"<Term::Writer: #{depth} colors>"
+			end
 		end
 	end
-end
\ No newline at end of file
+end
@@ -0,0 +1,85 @@
+require 'color'
+
+module Color # :nodoc:
+
+	# === Synopsis
+	#   red = Color::YCbCr.new(76, 85, 255)
+	#   red.to_rgb # => <RGB: 254, 0, 0, 0 (#FE0000)>
+	#
+	# === Description
+	# Y'CbCr representation of color as used by JPEG (full range BT.601).
+	# Y' is the luma, Cb and Cr the blue and red difference, 128 being
+	# neutral.
+	# Video frames in planar 4:2:0 or 4:2:2 layouts are converted in bulk
+	# with Color::Buffer::from_planar and Color::Buffer#to_planar.
+	class YCbCr
+		include Common
+
+		class <<self
+			# used to load with Marshal.load
+			def _load(marshalled) # :nodoc:
+				new(*marshalled.unpack("C4"))
+			end
+
+			# === Synopsis
+			#   Color::YCbCr.from(Color::RGB.new(255,0,0)) # => <YCbCr: 76, 85, 255, 0>
+			#
+			# === Description
+			# Coerces +value+ to YCbCr.
+			# 
+			def from(value)
+				value.to_ycbcr
+			end
+		end
+		
+		# === Synopsis
+		#    ycbcr.to_s # => string
+		# 
+		# === Description
+		# Returns a String representation of this color.
+		#
+		def to_s
+			"YCbCr: %d, %d, %d, %d" %  [y, cb, cr, alpha]
+		end
+
+		# === Synopsis
+		#   ycbcr.to_a # => array
+		#
+		# === Description
+		# Returns all values in an array. If +as_floats+ is true, the values
+		# are converted to float values between 0 and 1.
+		#
+		def to_a(as_floats=false)
+			as_floats ?
+				[y/255.0, cb/255.0, cr/255.0, alpha/255.0] :
+				[y, cb, cr, alpha]
+		end
+		
+		# === Synopsis
+		#   ycbcr.to_hash # => hash
+		#
+		# === Description
+		# Returns all values in a hash with keys :y, :cb, :cr and :alpha.
+		# If +as_floats+ is true, the values are converted to float
+		# values between 0 and 1.
+		#
+		def to_hash(as_floats=false)
+			values = to_a(as_floats)
+			{ :y => values[0], :cb => values[1], :cr => values[2], :alpha => values[3] }
+		end
+
+		def to_ycbcr # :nodoc:
+			dup
+		end
+
+		# Used with Marshal.dump to create a dump of this color.
+		def _dump(*a) # :nodoc:
+			to_a.pack("C4")
+		end
+
+		private
+		def cap(value)
+			value < 0 ? 0 : value > 255 ? 255 : value.round
+		end
+	end
+end
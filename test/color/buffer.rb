@@ -0,0 +1,354 @@
+require 'test/unit'
+require 'color'
+
+class TestBuffer < Test::Unit::TestCase
+	def setup
+		@black_white = [Color::RGB.new(0, 0, 0), Color::RGB.new(255, 255, 255)]
+		@gray        = Color::Buffer.from(Array.new(64) { Color::RGB.new(128, 128, 128) })
+	end
+
+	def test_quantize
+		colors  = [Color::RGB.new(250, 10, 10), Color::RGB.new(10, 10, 10), Color::RGB.new(200, 200, 190)]
+		indices = Color::Buffer.from(colors).quantize(Color::Term.palette)
+		assert_equal(3, indices.length)
+		assert_equal([:red, :black, :white], indices.unpack("C*").map { |i| Color::Term::Palette[i] })
+		assert_equal(colors.map { |c| c.closest(Color::Term.palette) }, indices.unpack("C*").map { |i| Color::Term.palette[i] })
+		assert_equal("\1" * 64, @gray.quantize(Color::Buffer.from(@black_white)))
+	end
+
+	def test_dither
+		[:floyd_steinberg, :atkinson, :bayer].each { |dither|
+			indices = @gray.quantize(@black_white, :dither => dither, :width => 8).unpack("C*")
+			assert_equal([0, 1], indices.uniq.sort, dither.to_s)
+		}
+		# error diffusion keeps the average, atkinson loses some of the error
+		assert_equal(32, @gray.quantize(@black_white, :dither => :floyd_steinberg, :width => 8).count("\1"))
+		assert_in_delta(32, @gray.quantize(@black_white, :dither => :bayer, :width => 8).count("\1"), 8)
+	end
+
+	def test_palette
+		srand(7)
+		colors  = Array.new(64) { Color::RGB.new(rand(256), rand(256), rand(256), rand(2)*rand(256)) }
+		buffer  = Color::Buffer.from(Array.new(2000) { Color::RGB.new(rand(256), rand(256), rand(256), rand(2)*rand(256)) })
+		palette = Color::Palette.new(colors)
+		assert_equal(64, palette.size)
+		assert_equal(colors, palette.to_a)
+		assert(!palette.compiled?)
+		assert_nil(palette.compile_info)
+		expected = buffer.quantize(colors)
+		assert_equal(expected, palette.indices(buffer))
+		[16, 32].each { |resolution|
+			compiled = Color::Palette.new(colors).compile(resolution)
+			assert(compiled.compiled?)
+			assert_equal(expected, compiled.indices(buffer), resolution.to_s)
+			assert_equal(buffer.quantize(colors, :dither => :atkinson, :width => 40), buffer.quantize(compiled, :dither => :atkinson, :width => 40))
+			assert_equal(colors[compiled.nearest(buffer[5])], compiled.closest(buffer[5]))
+			assert_equal(buffer[5].closest(colors), compiled.closest(buffer[5]))
+			info = compiled.compile_info
+			assert_equal(resolution**3*4, info[:cells])
+			assert(info[:bytes] > info[:cells]*4)
+			assert(info[:most] <= 64)
+		}
+		term = Color::Palette.new(Color::Term.palette).compile
+		assert_equal(term.compile_info[:cells], 16**3)
+		assert_equal(Color::Buffer.from(Color::Term.palette).quantize(term), (0..7).to_a.pack("C*"))
+		assert(term.dup.compiled?)
+		assert_raise(ArgumentError) { term.compile(20) }
+		assert_raise(ArgumentError) { Color::Palette.new([]) }
+	end
+
+	def test_invalid
+		assert_raise(ArgumentError) { @gray.quantize([]) }
+		assert_raise(ArgumentError) { @gray.quantize(@black_white, :dither => :foo) }
+		assert_raise(ArgumentError) { @gray.quantize(@black_white, :width => -1) }
+		assert_raise(TypeError) { @gray.convert(:hsv).quantize(@black_white) }
+		assert_raise(ArgumentError) { Color::Buffer.new(:rgbf, 2**60) }
+		assert_raise(ArgumentError) { Color::Buffer.new(:rgb, 2**62) }
+	end
+
+	def test_frozen
+		buffer = Color::Buffer.from([Color::RGB.new(1, 2, 3)]).freeze
+		frozen = [TypeError, RuntimeError]
+		frozen << FrozenError if defined?(FrozenError)
+		assert_raise(*frozen) { buffer[0] = Color::RGB.new(4, 5, 6) }
+		assert_equal(Color::RGB.new(1, 2, 3), buffer[0])
+	end
+
+	def test_adjust
+		colors = [Color::RGB.new(200, 100, 50), Color::RGB.new(0, 0, 0, 10), Color::RGB.new(255, 255, 255)]
+		buffer = Color::Buffer.from(colors)
+		mixed  = colors.map { |color|
+			mixer = color.to_mixer
+			mixer.hue        += 0.1
+			mixer.saturation *= 0.5
+			mixer.color
+		}
+		assert_equal(mixed, buffer.adjust(:hue => 0.1, :saturation => [:*, 0.5]).to_a)
+		assert_equal(colors, buffer.adjust({}).to_a)
+		assert_equal([0, 0, 0], buffer.adjust(:red => [:set, 0], :alpha => [:-, 20]).map { |c| c.red + c.alpha })
+		assert_equal(colors, buffer.to_a)
+		assert_equal(Color::HSV, buffer.convert(:hsv).adjust(:value => 0.1).model)
+		assert_same(buffer, buffer.adjust!(:blue => 255))
+		assert_equal([255, 255, 255], buffer.map { |c| c.blue })
+		assert_raise(ArgumentError) { buffer.adjust(:foo => 1) }
+		assert_raise(ArgumentError) { buffer.adjust(:hue => [:%, 1]) }
+		frozen = [TypeError, RuntimeError]
+		frozen << FrozenError if defined?(FrozenError)
+		assert_raise(*frozen) { Color::Buffer.from(colors).freeze.adjust!(:blue => 255) }
+	end
+
+	def test_adjust_threads
+		buffer = Color::Buffer.from(Array.new(100_000) { |i| Color::RGB.from_int(i*167) })
+		spec   = { :hue => -0.3, :luminance => [:*, 1.1], :green => 12 }
+		assert_equal(buffer.adjust(spec).data, buffer.adjust(spec, :threads => 4).data)
+		assert_raise(ArgumentError) { buffer.adjust(spec, :threads => 0) }
+	end
+
+	def test_lazy
+		colors  = [Color::RGB.new(200, 100, 50), Color::RGB.new(10, 20, 30, 40), Color::RGB.new(90, 200, 120)]
+		buffer  = Color::Buffer.from(colors)
+		overlay = Color::Buffer.from([Color::RGB.new(0, 0, 255, 128), Color::RGB.new(255, 255, 255), Color::RGB.new(0, 0, 0, 200)])
+		lazy    = buffer.lazy.to_hsv.map_hue { |hue| (hue+0.5) % 1 }.adjust(:saturation => [:*, 0.5]).to_rgb.blend(overlay)
+		eager   = colors.map { |color|
+			mixer = color.to_mixer
+			mixer.hue        += 0.5
+			mixer.saturation *= 0.5
+			mixer.color
+		}
+		eager   = Color::Buffer.from(eager).blend(overlay)
+		assert_equal(2, lazy.stages.length)
+		assert_equal(Color::RGB, lazy.model)
+		lazy.force.to_a.zip(eager.to_a) { |a, b| assert_in_delta(0, a.distance(b), 0.005) }
+		assert_equal(buffer.data, buffer.lazy.force.data)
+		assert_equal(buffer.convert(:hsl).to_a, buffer.lazy.to_cmyk.to_hsl.force.to_a)
+		assert_equal(colors.map { |c| 255-c.red }, buffer.lazy.map_red { |r| 255-r }.force.map { |c| c.red })
+		assert_equal(buffer.interpolate(overlay, 0.25).to_a, buffer.lazy.interpolate(overlay, 0.25).force.to_a)
+		assert_equal(lazy.force.data, lazy.force(:threads => 2).data)
+		assert_raise(ArgumentError) { buffer.lazy.blend(Color::Buffer.from(colors[0, 1])).force }
+		assert_equal(buffer.blend(overlay, :alpha => 100).to_a, buffer.lazy.blend(overlay, :alpha => 100).force.to_a)
+		[-1, 256].each { |alpha|
+			assert_raise(ArgumentError) { buffer.blend(overlay, :alpha => alpha) }
+			assert_raise(ArgumentError) { buffer.lazy.blend(overlay, :alpha => alpha).force }
+		}
+		assert_equal(buffer.blend(overlay, :space => :linear).to_a, buffer.lazy.blend(overlay, :space => :linear).force.to_a)
+		assert_equal(buffer.interpolate(overlay, 0.25, :space => :linear).to_a, buffer.lazy.interpolate(overlay, 0.25, :space => :linear).force.to_a)
+		assert_raise(ArgumentError) { buffer.blend(overlay, :space => :lab) }
+		assert_raise(ArgumentError) { buffer.lazy.blend(overlay, :space => :lab).force }
+		assert_raise(ArgumentError) { buffer.lazy.interpolate(overlay, 0.25, :space => :lab).force }
+		assert_raise(ArgumentError) { buffer.lazy.map_attribute(:foo) { |x| x } }
+	end
+
+	def test_contrast
+		colors      = [Color::RGB.new(0, 0, 0), Color::RGB.new(0x77, 0x77, 0x77), Color::RGB.new(255, 255, 255)]
+		backgrounds = [Color::RGB.new(255, 255, 255), Color::RGB.new(20, 40, 60)]
+		buffer      = Color::Buffer.from(colors)
+		matrix      = buffer.contrast_matrix(backgrounds).unpack("f*")
+		assert_equal(6, matrix.length)
+		colors.each_with_index { |color, i|
+			backgrounds.each_with_index { |background, j|
+				assert_in_delta(color.contrast(background), matrix[i*2+j], 0.0001)
+			}
+		}
+		luminance = buffer.relative_luminance.unpack("f*")
+		colors.zip(luminance) { |color, value| assert_in_delta(color.relative_luminance, value, 0.0001) }
+		assert_equal([0, 2], Color::Buffer.from(backgrounds).best_foreground(colors).unpack("C*"))
+		assert_equal([0, 0, 1], buffer.best_foreground(Color::Buffer.from(backgrounds)).unpack("C*"))
+	end
+
+	def test_sort
+		colors = Array.new(500) { |i| Color::RGB.from_int((i*2654435761) & 0xffffff) }
+		buffer = Color::Buffer.from(colors)
+		order  = buffer.order(:hue).unpack("L*")
+		assert_equal((0...500).to_a, order.sort)
+		hues   = order.map { |i| colors[i].to_hsv.hue }
+		hues.each_cons(2) { |a, b| assert(a <= b+1.0/65535) }
+		luminance = buffer.sort_by_key(:luminance, :reverse => true).map { |c| c.relative_luminance }
+		luminance.each_cons(2) { |a, b| assert(a >= b-0.0001) }
+		assert_equal(Color::Buffer.sort(colors, :value), buffer.sort_by_key(:value).to_a)
+		[:saturation, :hilbert, :morton].each { |key|
+			assert_equal((0...500).to_a, buffer.order(key).unpack("L*").sort)
+		}
+		# equal keys keep their order
+		grays = Color::Buffer.from([Color::RGB.new(9, 9, 9), Color::RGB.new(1, 1, 1), Color::RGB.new(9, 9, 9)])
+		assert_equal([1, 0, 2], grays.order(:morton).unpack("L*"))
+		assert_equal([0, 2, 1], grays.order(:morton, :reverse => true).unpack("L*"))
+		assert_equal([grays[2], grays[1]], grays.permute([2, 1]).to_a)
+		assert_raise(IndexError) { grays.permute([3]) }
+		assert_raise(ArgumentError) { grays.order(:foo) }
+	end
+
+	def test_stats
+		stats = Color.stats
+		return assert_nil(stats) unless stats
+		Color.reset_stats
+		buffer = Color::Buffer.from([Color::RGB.new(1, 2, 3), Color::Named.new("Amaranth"), Color::HSV.new(0, 0, 0)])
+		buffer.order(:hue)
+		buffer.convert(Color::HSL)
+		stats = Color.stats
+		assert(stats[:allocations][Color::Buffer] >= 2)
+		assert_equal(1, stats[:coerce][:store])
+		assert_equal({:calls => 1, :elements => 3}, stats[:kernels][:sort])
+		assert_equal(3, stats[:conversions][[Color::RGB, Color::HSL]])
+		Color.reset_stats
+		assert_equal(0, Color.stats[:kernels][:sort][:calls])
+		# counts of threads which exited stay in the total
+		Array.new(4) { Thread.new { buffer.order(:hue) } }.each { |thread| thread.join }
+		assert_equal(4, Color.stats[:kernels][:sort][:calls])
+		Color.reset_stats
+		assert_equal(0, Color.stats[:kernels][:sort][:calls])
+	end
+
+	def test_pack
+		colors = [Color::RGB.new(255, 0, 0), Color::RGB.new(8, 130, 255, 255), Color::RGB.new(1, 2, 3, 64)]
+		buffer = Color::Buffer.from(colors)
+		assert_equal([0xf800, 0x0c1f, 0x0000], buffer.pack(:rgb565).unpack("v*"))
+		assert_equal([0x7c00, 0x061f, 0x0000], buffer.pack(:rgb555, :endian => :big).unpack("n*"))
+		assert_equal([0, 0, 255, 255, 255, 130, 8, 0, 3, 2, 1, 191], buffer.pack(:bgra).unpack("C*"))
+		assert_equal([255, 255, 0, 0, 0, 8, 130, 255], buffer.pack(:argb).unpack("C*").first(8))
+		assert_equal(colors, Color::Buffer.unpack(buffer.pack(:abgr), :abgr).to_a)
+		assert_equal([0, 255, 0, 0], Color::Buffer.unpack([1, 0, 255, 0].pack("C*"), :argb, :opaque => true)[0].to_a)
+		assert_equal([Color::RGB.new(255, 0, 0), Color::RGB.new(8, 130, 255)], Color::Buffer.unpack([0xf800, 0x0c1f].pack("v*"), :rgb565).to_a)
+		(0..255).each { |v|
+			gray = Color::Buffer.from([Color::RGB.new(v, v, v)])
+			assert_equal([(v*31/255.0).round << 10 | (v*31/255.0).round << 5 | (v*31/255.0).round], gray.pack(:rgb555).unpack("v"))
+			assert_equal((((v*63/255.0).round)*255/63.0).round, Color::Buffer.unpack(gray.pack(:rgb565), :rgb565)[0].green)
+		}
+		ramp = Color::Buffer.from(Array.new(64) { Color::RGB.new(100, 100, 100) })
+		dithered = ramp.pack(:rgb565, :rounding => :dither, :width => 8).unpack("v*").map { |v| v & 31 }
+		assert_in_delta(100*31/255.0, dithered.inject(0) { |sum, v| sum+v }/64.0, 0.1)
+		assert_equal([100*31/255], ramp.pack(:rgb565, :rounding => :floor).unpack("v*").map { |v| v & 31 }.uniq)
+		assert_equal(Color::Buffer.repack(buffer.pack(:bgra), :bgra, :rgb565, :rounding => :dither), buffer.pack(:rgb565, :rounding => :dither))
+		assert_equal(buffer.pack(:abgr), Color::Buffer.repack(buffer.pack(:bgra), :bgra, :abgr))
+		assert_raise(ArgumentError) { Color::Buffer.unpack("abc", :rgb565) }
+		assert_raise(ArgumentError) { buffer.pack(:yuv) }
+		assert_raise(TypeError) { buffer.convert(Color::HSL).pack(:rgba) }
+	end
+
+	def test_alpha
+		colors = [Color::RGB.new(200, 100, 50), Color::RGB.new(200, 100, 50, 127), Color::RGB.new(10, 20, 30, 255)]
+		buffer = Color::Buffer.from(colors)
+		assert(!buffer.premultiplied? && !buffer.opacity?)
+		rgba = buffer.with_alpha(:premultiplied => true, :opacity => true)
+		assert(rgba.premultiplied? && rgba.opacity?)
+		assert_equal([200, 100, 50, 255, 100, 50, 25, 128, 0, 0, 0, 0], rgba.data.unpack("C*"))
+		assert_equal(buffer.with_alpha(:opacity => true).data, buffer.pack(:rgba))
+		# elements stay straight transparency
+		assert_equal([colors[0], Color::RGB.new(199, 100, 50, 127), Color::RGB.new(0, 0, 0, 255)], rgba.to_a)
+		rgba[0] = Color::RGB.new(255, 255, 255, 255)
+		assert_equal([0, 0, 0, 0], rgba.data.unpack("C4"))
+		assert_equal(rgba.to_a, rgba.with_alpha(:premultiplied => false, :opacity => false).to_a)
+		assert_equal(rgba.data, rgba.dup.data)
+		assert(rgba.dup.premultiplied?)
+		assert_raise(TypeError) { rgba.convert(Color::HSV) }
+		assert_raise(TypeError) { rgba.pack(:rgba) }
+		assert_raise(TypeError) { buffer.convert(Color::HSV).with_alpha(:opacity => true) }
+		# premultiplying a premultiplied color again gives the same
+		all = []
+		(0..255).step(3) { |a| (0..255).step(5) { |c| all << Color::RGB.new(c, 255-c, c/2, a) } }
+		premultiplied = Color::Buffer.from(all).with_alpha(:premultiplied => true)
+		assert_equal(premultiplied.data, premultiplied.with_alpha(:premultiplied => false).with_alpha!(:premultiplied => true).data)
+		frozen = [TypeError, RuntimeError]
+		frozen << FrozenError if defined?(FrozenError)
+		assert_raise(*frozen) { premultiplied.freeze.with_alpha!(:premultiplied => false) }
+		assert(premultiplied.premultiplied?)
+		# unpack keeps premultiplied pixels, pack writes them back unchanged
+		surface = buffer.with_alpha(:premultiplied => true).pack(:bgra)
+		cairo   = Color::Buffer.unpack(surface, :bgra, :premultiplied => true)
+		assert(cairo.premultiplied? && !cairo.opacity?)
+		assert_equal([50, 100, 200, 255, 25, 50, 100, 128], surface.unpack("C8"))
+		assert_equal(surface, cairo.pack(:bgra))
+		assert_equal(buffer.with_alpha(:premultiplied => true).to_a, cairo.to_a)
+	end
+
+	def test_composite
+		colors = [Color::RGB.new(200, 100, 50), Color::RGB.new(200, 100, 50, 127), Color::RGB.new(10, 20, 30, 255)]
+		under  = Color::Buffer.from(colors)
+		over   = Color::Buffer.from([Color::RGB.new(0, 0, 255, 127)]*3)
+		[{ :premultiplied => true }, { :premultiplied => true, :opacity => true }].each { |mode|
+			result = under.with_alpha(mode).blend(over.with_alpha(mode))
+			assert_equal(under.with_alpha(mode).opacity?, result.opacity?)
+			assert(result.premultiplied?)
+			# over an opaque color source over is the straight blend
+			assert_equal(under.blend(over)[0], result[0])
+			assert_equal([66, 33, 186, 63], result[1].to_a)
+			assert_equal([0, 0, 255, 127], result[2].to_a)
+		}
+		assert_raise(TypeError) { under.blend(over.with_alpha(:premultiplied => true)) }
+		assert_raise(TypeError) { under.with_alpha(:opacity => true).blend(over.with_alpha(:opacity => true)) }
+		assert_raise(ArgumentError) { under.with_alpha(:premultiplied => true).blend(over.with_alpha(:premultiplied => true), :alpha => 0) }
+	end
+
+	def test_diff
+		colors  = Array.new(5000) { |i| Color::RGB.new(i*7 & 255, i*13 & 255, i*31 & 255, i*3 & 255) }
+		changed = colors.dup
+		[1234, 1237, 1300, 2999].each { |i| red, green, blue, alpha = colors[i].to_a; changed[i] = Color::RGB.new(red ^ 64, green, blue, alpha) }
+		expected  = Color::Buffer.from(colors)
+		actual    = Color::Buffer.from(changed)
+		result    = expected.diff(actual, :width => 100, :heatmap => true)
+		distances = result[:distances].unpack("f*")
+		assert_equal(4, result[:mismatches])
+		assert_equal(5000, result[:compared])
+		assert(result[:complete])
+		assert_equal([0, 12, 100, 18], result[:box])
+		assert_equal([34, 12, 4, 1], Color::Buffer.from(colors.first(1300)).diff(Color::Buffer.from(changed.first(1300)), :width => 100)[:box])
+		colors.zip(changed, distances).each { |a, b, d| assert_in_delta(a.distance(b), d, 1e-6) }
+		assert_equal(distances.map { |d| (d*255).round }, result[:heatmap].map { |g| g.white })
+		# a channel off by 64 is 0.125 away in euclidean, 0.251 in max and 0.075 in luma
+		assert_equal(0, expected.diff(actual, :threshold => 0.13)[:mismatches])
+		assert_equal(4, expected.diff(actual, :metric => :max, :threshold => 0.25)[:mismatches])
+		assert_equal(0, expected.diff(actual, :metric => :max, :threshold => 0.26)[:mismatches])
+		assert_equal(4, expected.diff(actual, :metric => :luma, :threshold => 0.07)[:mismatches])
+		assert_equal(5000, expected.diff(actual, :threshold => -1, :distances => false)[:mismatches])
+		assert_nil(expected.diff(actual, :distances => false)[:distances])
+		assert_nil(expected.diff(expected)[:box])
+		early = expected.diff(actual, :threshold => -1, :limit => 10)
+		assert(!early[:complete])
+		assert_equal(4096, early[:compared])
+		assert(early[:distances].unpack("f*").last.nan?)
+		assert_raise(ArgumentError) { expected.diff(Color::Buffer.from(colors.first(3))) }
+		assert_raise(ArgumentError) { expected.diff(actual, :metric => :cie76) }
+		assert_raise(TypeError) { expected.diff(actual.with_alpha(:premultiplied => true)) }
+		assert_raise(TypeError) { expected.diff(actual.convert(Color::RGBF)) }
+	end
+
+	def test_diff_threads
+		expected = Color::Buffer.from(Array.new(100_000) { |i| Color::RGB.from_int(i*167) })
+		actual   = expected.adjust(:red => [:*, 1.01])
+		options  = { :width => 400, :threshold => 0.001 }
+		assert_equal(expected.diff(actual, options), expected.diff(actual, options.merge(:threads => 4)))
+		assert(expected.diff(actual, options.merge(:limit => 1, :threads => 4))[:compared] < 100_000)
+	end
+
+	def test_simd_levels
+		return assert_nil(Color.simd_level) unless Color.native?
+		colors  = Array.new(1003) { |i| Color::RGB.new(i*7 & 255, i*13 & 255, i*31 & 255, i*3 & 255) }
+		buffer  = Color::Buffer.from(colors)
+		other   = Color::Buffer.from(colors.reverse)
+		floats  = buffer.convert(Color::RGBF)
+		palette = colors.first(21)
+		run     = lambda {
+			[
+				buffer.convert(Color::RGBF).data, floats.convert(Color::RGB).data,
+				buffer.quantize(palette), buffer.quantize(Color::Term.palette, :dither => :atkinson, :width => 17),
+				buffer.interpolate(other, 0.3).data, buffer.blend(other).data, buffer.blend(other, :alpha => 100).data,
+				buffer.pack(:rgb565), buffer.pack(:rgb555, :endian => :big), buffer.pack(:bgra),
+				Color::Buffer.unpack(buffer.data, :rgb565).data, Color::Buffer.repack(buffer.data, :abgr, :argb, :opaque => true),
+				buffer.to_planar(17), buffer.to_planar(17, :subsampling => :yuv422, :matrix => :bt709, :range => :full),
+				Color::Buffer.from_planar(buffer.to_planar(17), 17, 59).data,
+				buffer.with_alpha(:premultiplied => true, :opacity => true).data, buffer.with_alpha(:premultiplied => true).with_alpha(:premultiplied => false).data,
+				buffer.with_alpha(:premultiplied => true).blend(other.with_alpha(:premultiplied => true)).data,
+				[:euclidean, :max, :luma].map { |metric| buffer.diff(other, :metric => metric, :threshold => 0.2, :width => 17) },
+			]
+		}
+		level    = Color.simd_level
+		expected = (Color.simd_level = :none; run.call)
+		assert_equal(buffer.interpolate(other, 0.3).to_a, colors.zip(colors.reverse).map { |a, b| a.interpolate(b, 0.3) })
+		Color.simd_levels.each { |simd|
+			Color.simd_level = simd
+			assert_equal(expected, run.call, "simd level #{simd}")
+		}
+		assert_raise(ArgumentError) { Color.simd_level = :mmx }
+	ensure
+		Color.simd_level = level if level
+	end
+end
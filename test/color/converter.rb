@@ -0,0 +1,60 @@
+require 'test/unit'
+require 'color'
+
+class TestConverter < Test::Unit::TestCase
+	def setup
+		@cmyk = [
+			Color::CMYK.new(0, 255, 255, 0),
+			Color::CMYK.new(20, 40, 60, 80, 12),
+			Color::CMYK.new(0, 0, 0, 255),
+		]
+	end
+
+	def test_convert
+		converter = Color::Converter.new(:from => :cmyk, :to => Color::HSL)
+		assert_equal(Color::CMYK, converter.from)
+		assert_equal(Color::HSL, converter.to)
+		@cmyk.each { |cmyk|
+			assert_equal(cmyk.to_rgb.to_hsl, converter.convert(cmyk))
+		}
+		assert_raise(TypeError) { converter.convert(Color::RGB.new(0,0,0)) }
+		assert_raise(ArgumentError) { Color::Converter.new(:from => :cmyk) }
+	end
+
+	def test_route
+		assert_equal(0, Color::Converter.new(:from => :rgb, :to => :rgb).steps)
+		assert_equal(2, Color::Converter.new(:from => :cmyk, :to => :hsl).steps)
+		assert_equal(1, Color::Converter.new(:from => :gray, :to => :hsv).steps)
+		gray = Color::Gray.new(77, 3)
+		assert_equal(gray.to_rgb.to_hsv, Color::Converter.new(:from => :gray, :to => :hsv).convert(gray))
+	end
+
+	def test_convert_many
+		converter = Color::Converter.new(:from => :cmyk, :to => :hsv)
+		assert_equal(@cmyk.map { |c| c.to_rgb.to_hsv }, converter.convert_many(@cmyk))
+	end
+
+	def test_convert_buffer
+		converter = Color::Converter.new(:from => :cmyk, :to => :rgb)
+		buffer    = Color::Buffer.from(@cmyk)
+		converted = converter.convert_buffer(buffer)
+		assert_equal(Color::RGB, converted.model)
+		assert_equal(@cmyk.map { |c| c.to_rgb }, converted.to_a)
+		assert_equal(converted.to_a, buffer.convert(:rgb).to_a)
+		assert_raise(TypeError) { converter.convert_buffer("x") }
+		assert_raise(TypeError) { converter.convert_buffer(Color::CMYK.new(0, 0, 0, 0)) }
+	end
+
+	def test_buffer
+		buffer = Color::Buffer.new(:rgb, 3)
+		assert_equal(3, buffer.length)
+		assert_equal(Color::RGB.new(0,0,0), buffer[0])
+		buffer[1]  = Color::RGB.new(1,2,3,4)
+		buffer[-1] = Color::Gray.new(9)
+		assert_equal(Color::RGB.new(1,2,3,4), buffer[1])
+		assert_equal(Color::RGB.new(9,9,9), buffer[2])
+		assert_equal([0,0,0,0, 1,2,3,4, 9,9,9,0], buffer.data.unpack("C*"))
+		assert_raise(IndexError) { buffer[3] }
+		assert_equal(buffer.to_a, buffer.dup.to_a)
+	end
+end
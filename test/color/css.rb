@@ -0,0 +1,95 @@
+require 'test/unit'
+require 'color'
+
+class TestCSS < Test::Unit::TestCase
+	def setup
+		Color::CSS.clear_cache
+	end
+
+	def test_parse
+		pink = Color::RGB.new(255, 0, 153)
+		["#f09", "#FF0099", "rgb(255, 0, 153)", "rgba(255,0,153,1)", "rgb(100% 0% 60%)", "rgb(255 0 153 / 100%)", " RGB( 255 0 153 ) "].each { |css|
+			assert_equal(pink, Color::CSS.parse(css), css)
+		}
+		assert_equal(Color::RGB.new(255, 0, 153, 127), Color::CSS.parse("#ff009980"))
+		assert_equal(Color::RGB.new(255, 0, 153, 128), Color::CSS.parse("rgba(255, 0, 153, 0.5)"))
+		assert_equal(Color::RGB.new(255, 0, 153, 191), Color::CSS.parse("rgb(255 0 153 / 25%)"))
+		assert_equal(Color::RGB.new(128, 0, 51), Color::CSS.parse("rgb(50%, 0%, 20%)"))
+		assert_equal(Color::RGB.new(102, 51, 153), Color::CSS.parse("RebeccaPurple"))
+		assert_equal(Color::RGB.new(0, 0, 0, 255), Color::CSS.parse("transparent"))
+		assert_equal(Color::RGB.new(255, 0, 0), Color::CSS.parse("rgb(300 -1 1e-3)"))
+
+		hsl = Color::CSS.parse("hsl(330, 100%, 50%)")
+		assert_instance_of(Color::HSL, hsl)
+		assert_in_delta(330/360.0, hsl.hue, 0.0001)
+		assert_equal(1, hsl.saturation)
+		assert_equal(0.5, hsl.luminance)
+		assert_equal(hsl, Color::CSS.parse("hsl(-30deg 100 50)"))
+		assert_equal(hsl, Color::CSS.parse("hsla(0.9166666666666666turn, 100%, 50%, 1)"))
+		assert_equal(Color::CSS.parse("hsl(180 50% 25%)"), Color::CSS.parse("hsl(200grad 50% 25%)"))
+
+		["", "#ff", "#ggg", "rgb(1,2)", "rgb(1 2,3)", "rgb(1,2,3", "rgb(1 2 3 4)", "rgb(none,1,2)", "hsl(10%,1%,1%)", "nocolor", "red blue"].each { |css|
+			assert_raise(ArgumentError, css) { Color::CSS.parse(css) }
+		}
+	end
+
+	def test_format
+		pink = Color::RGB.new(255, 0, 153)
+		assert_equal("#ff0099", pink.to_css)
+		assert_equal("rgb(255 0 153)", pink.to_css(:rgb))
+		assert_equal("rgba(255, 0, 153, 1)", pink.to_css(:rgba))
+		assert_equal("hsl(324 100% 50%)", pink.to_css(:hsl))
+		assert_equal("hsla(324, 100%, 50%, 1)", pink.to_css(:hsla))
+		assert_equal("#ff0099", pink.to_css(:name))
+		assert_equal("deeppink", Color::RGB.new(255, 20, 147).to_css(:name))
+		assert_equal("aqua", Color::RGB.new(0, 255, 255).to_css(:name))
+		assert_equal("#ff009980", Color::RGB.new(255, 0, 153, 127).to_css)
+		assert_equal("rgb(255 0 153 / 0.5)", Color::RGB.new(255, 0, 153, 128).to_css(:rgb))
+		assert_equal("#ff0099", Color::CSS.format(pink.to_hsv))
+		assert_raise(ArgumentError) { pink.to_css(:lab) }
+
+		srand(3)
+		200.times {
+			rgb = Color::RGB.new(rand(256), rand(256), rand(256), rand(256))
+			[:hex, :rgb, :rgba, :name].each { |form|
+				assert_equal(rgb, Color::CSS.parse(rgb.to_css(form)), form.to_s)
+			}
+			[:hsl, :hsla].each { |form|
+				assert_equal(rgb, Color::CSS.parse(rgb.to_hsl.to_css(form)).to_rgb, form.to_s)
+			}
+		}
+	end
+
+	def test_cache
+		first = Color::CSS.parse("#abc")
+		assert(first.frozen?)
+		assert_same(first, Color::CSS.parse("#abc"))
+		assert_equal({:capacity => 1024, :size => 1, :hits => 1, :misses => 1}, Color::CSS.cache_info)
+
+		Color::CSS.cache_size = 2
+		a = Color::CSS.parse("#aaa")
+		b = Color::CSS.parse("#bbb")
+		assert_same(a, Color::CSS.parse("#aaa"))
+		Color::CSS.parse("#ccc") # evicts #bbb, the least recently used
+		assert_same(a, Color::CSS.parse("#aaa"))
+		assert_not_same(b, Color::CSS.parse("#bbb"))
+		assert_equal(2, Color::CSS.cache_info[:size])
+
+		Color::CSS.cache_size = 0
+		assert_not_same(Color::CSS.parse("#aaa"), Color::CSS.parse("#aaa"))
+		assert_raise(ArgumentError) { Color::CSS.cache_size = -1 }
+	ensure
+		Color::CSS.cache_size = 1024
+	end
+
+	def test_ractor_cache
+		return unless defined?(Ractor)
+		pink = Color::CSS.parse("#ff0099")
+		ractor = Ractor.new { [Color::CSS.parse("#ff0099"), Color::CSS.parse("#ff0099"), Color::CSS.cache_info] }
+		colors = ractor.take
+		# a cache of its own: one miss, then a hit
+		assert_equal([pink, pink], colors.first(2))
+		assert_equal([1, 1], [colors.last[:misses], colors.last[:hits]])
+		assert_equal(0, Color::CSS.cache_info[:hits])
+	end
+end
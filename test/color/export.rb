@@ -0,0 +1,51 @@
+require 'test/unit'
+require 'stringio'
+require 'color'
+
+class TestExport < Test::Unit::TestCase
+	def setup
+		@colors = [Color::RGB.new(255, 0, 153), Color::RGB.new(0, 0, 0, 128).to_hsl, Color::Gray.new(200)]
+	end
+
+	def test_css
+		assert_equal(":root {\n  --color-0: #ff0099;\n  --color-1: #0000007f;\n  --color-2: #c8c8c8;\n}\n", Color::Export.css(@colors))
+		assert_equal("--pink: rgb(255 0 153);\n--shade: rgb(0 0 0 / 0.5);\n--gray: rgb(200 200 200);\n",
+			Color::Export.css(@colors, :selector => false, :form => :rgb, :prefix => "--", :names => %w[pink shade gray]))
+		assert_equal(Color::Export.css(@colors), Color::Export.css(Color::Buffer.from(@colors, Color::RGB)))
+		assert_raise(ArgumentError) { Color::Export.css(@colors, :names => %w[pink]) }
+		assert_equal("--color-a\\ b: #ff0099;\n--color-c\\;\\}d: #0000007f;\n--color-x\\0a y\\.z: #c8c8c8;\n",
+			Color::Export.css(@colors, :selector => false, :names => ["a b", "c;}d", "x\ny.z"]))
+	end
+
+	def test_json
+		assert_equal('["#ff0099","#0000007f","#c8c8c8"]', Color::Export.json(@colors))
+		assert_equal('[{"red":255,"green":0,"blue":153,"alpha":0},{"red":0,"green":0,"blue":0,"alpha":128}]',
+			Color::Export.json(@colors.first(2), :as => :objects))
+		assert_equal('{"a\"b":"hsl(324 100% 50%)","c\n\u0001":"hsl(0 0% 0% / 0.5)","d":"hsl(0 0% 78.43%)"}',
+			Color::Export.json(@colors, :form => :hsl, :names => ["a\"b", "c\n\1", :d]))
+		assert_equal("[]", Color::Export.json([]))
+		assert_raise(ArgumentError) { Color::Export.json(@colors, :as => :lists) }
+	end
+
+	def test_csv
+		assert_equal("red,green,blue,alpha\n255,0,153,0\n0,0,0,128\n200,200,200,0\n", Color::Export.csv(@colors))
+		assert_equal("\"x,y\",\"rgba(255, 0, 153, 1)\"\n\"q\"\"\",\"rgba(0, 0, 0, 0.5)\"\nz,\"rgba(200, 200, 200, 1)\"\n",
+			Color::Export.csv(@colors, :columns => [:name, :css], :form => :rgba, :names => ['x,y', 'q"', 'z'], :header => false))
+		assert_raise(ArgumentError) { Color::Export.csv(@colors, :columns => [:name]) }
+		assert_raise(ArgumentError) { Color::Export.csv(@colors, :columns => [:hue]) }
+	end
+
+	def test_targets
+		string = "colors: "
+		assert_same(string, Color::Export.json(@colors, :to => string))
+		assert_equal('colors: ["#ff0099","#0000007f","#c8c8c8"]', string)
+
+		# more than one chunk
+		buffer = Color::Buffer.from(Array.new(5000) { |i| Color::RGB.new(i & 255, i >> 8, 7, i % 3) })
+		io     = StringIO.new
+		Color::Export.csv(buffer, :to => io, :columns => [:css, :red])
+		assert_equal(Color::Export.csv(buffer, :columns => [:css, :red]), io.string)
+		assert_equal(["css,red", "#000007,0", "#010007fe,1"], io.string.split("\n").first(3))
+		assert_equal(5001, io.string.count("\n"))
+	end
+end
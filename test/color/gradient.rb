@@ -0,0 +1,107 @@
+require 'test/unit'
+require 'color'
+
+class TestGradient < Test::Unit::TestCase
+	def heat
+		Color::Gradient.new([Color::RGB.new(0, 0, 0), [0.75, Color::RGB.new(255, 0, 0)], Color::RGB.new(255, 255, 255)])
+	end
+
+	def test_new
+		assert_equal(3, heat.size)
+		assert_equal([0.0, 0.75, 1.0], heat.stops.map { |position, color| position })
+		assert_equal([255, 0, 0, 0], heat.stops[1][1].to_a)
+		assert_equal(2, Color::Gradient.new(Color::Buffer.from([Color::RGB.new(0, 0, 0), Color::Gray.new(255)])).size)
+		assert_equal(heat.stops, heat.dup.stops)
+		assert_raise(ArgumentError) { Color::Gradient.new([]) }
+		assert_raise(ArgumentError) { Color::Gradient.new([[0.5, Color::RGB.new(0, 0, 0)], [0.2, Color::RGB.new(0, 0, 0)]]) }
+		assert_raise(ArgumentError) { Color::Gradient.new([[1.5, Color::RGB.new(0, 0, 0)]]) }
+	end
+
+	def test_at
+		assert_equal([0, 0, 0, 0], heat.at(-1).to_a)
+		assert_equal([128, 0, 0, 0], heat.at(0.375).to_a)
+		assert_equal(Color::RGB.new(255, 0, 0).interpolate(Color::RGB.new(255, 255, 255), 0.5).to_a, heat.at(0.875).to_a)
+		assert_equal([255, 255, 255, 0], heat.at(2).to_a)
+		assert_equal([0, 0, 0, 0], heat.at(0.0/0).to_a)
+	end
+
+	def test_bake
+		[256, 1024, 4096].each { |size|
+			lut = heat.bake(size)
+			assert_equal(size, lut.size)
+			assert_equal(heat.at(0).to_a, lut[0].to_a)
+			assert_equal(heat.at(100.0/(size-1)).to_a, lut[100].to_a)
+			assert_equal(heat.at(1).to_a, lut[size-1].to_a)
+		}
+		assert_equal(256, heat.bake.size)
+		assert_raise(ArgumentError) { heat.bake(1) }
+		assert_raise(ArgumentError) { heat.bake(4097) }
+	end
+
+	def test_apply
+		gradient = heat
+		lut      = gradient.bake
+		values   = [0, 0.2, 0.5, 1, -3, 7]
+		expected = values.map { |v| lut[([[v, 0].max, 1].min*255).round].to_a }
+		assert_equal(expected, gradient.apply(values).to_a.map { |c| c.to_a })
+		assert_equal(expected, gradient.apply(values.pack("f*")).to_a.map { |c| c.to_a })
+		assert_equal(expected, gradient.apply(values.pack("d*"), :type => :double).to_a.map { |c| c.to_a })
+		assert_equal(expected, gradient.apply(values.map { |v| v*10+5 }, :range => 5..15).to_a.map { |c| c.to_a })
+		assert_equal(expected, gradient.apply(values.map { |v| 1-v }, :range => [1, 0]).to_a.map { |c| c.to_a })
+		assert_raise(ArgumentError) { gradient.apply("abc") }
+		assert_raise(ArgumentError) { gradient.apply([1], :range => 1..1) }
+		assert_raise(ArgumentError) { gradient.apply([1].pack("f"), :type => :int) }
+	end
+
+	def test_apply_nan_and_clamp
+		nan    = Color::RGB.new(1, 2, 3, 4)
+		result = heat.apply([nil, 0.0/0, -1, 2, 0.5], :clamp => false, :nan => nan).to_a.map { |c| c.to_a }
+		assert_equal([nan.to_a]*4, result.first(4))
+		assert_equal(heat.bake[128].to_a, result.last)
+		assert_equal([0, 0, 0, 255], heat.apply([nil])[0].to_a)
+	end
+
+	def test_apply_log
+		lut    = heat.bake(1024)
+		result = heat.apply([1, 10, 100, 1000, 0, -5], :scale => :log, :range => 1..1000, :size => 1024).to_a.map { |c| c.to_a }
+		assert_equal([0, 341, 682, 1023, 0, 0].map { |i| lut[i].to_a }, result)
+		assert_raise(ArgumentError) { heat.apply([1], :scale => :log, :range => 0..1) }
+		assert_raise(ArgumentError) { heat.apply([1], :scale => :sqrt) }
+	end
+
+	def test_apply_threads
+		values = Array.new(100_000) { |i| (i % 1000)/999.0 }.pack("f*")
+		assert_equal(heat.apply(values).pack(:rgba), heat.apply(values, :threads => 4).pack(:rgba))
+	end
+
+	def test_colormaps
+		assert_equal([:viridis, :magma, :inferno, :plasma, :cividis, :turbo], Color::Gradient.colormaps)
+		viridis = Color::Gradient[:viridis]
+		assert_equal(256, viridis.size)
+		assert_equal([68, 1, 84, 0], viridis.at(0).to_a)
+		assert_equal(viridis.stops.map { |position, color| color.to_a }, viridis.bake.to_a.map { |c| c.to_a })
+		assert_equal([253, 231, 37, 0], viridis.at(1).to_a)
+		assert_equal([0, 0, 4, 0], Color::Gradient["magma"].at(0).to_a)
+		assert_equal([48, 18, 59, 0], Color::Gradient[:turbo].at(0).to_a)
+		assert_equal(viridis.bake.to_a.reverse.map { |c| c.to_a }, Color::Gradient[:viridis_r].bake.to_a.map { |c| c.to_a })
+		assert_raise(ArgumentError) { Color::Gradient[:jet] }
+	end
+
+	def test_reverse
+		reversed = heat.reverse
+		assert_equal([0.0, 0.25, 1.0], reversed.stops.map { |position, color| position })
+		[0, 0.1, 0.3, 0.6, 1].each { |t| assert_equal(heat.at(1-t).to_a, reversed.at(t).to_a) }
+		assert_equal(Color::Gradient[:magma_r].bake(1024).pack(:rgba), Color::Gradient[:magma].reverse.bake(1024).pack(:rgba))
+	end
+
+	def test_discrete
+		bands = Color::Gradient[:viridis].discrete(4)
+		assert_equal(8, bands.size)
+		colors = [0, 1/3.0, 2/3.0, 1].map { |t| Color::Gradient[:viridis].at(t).to_a }
+		assert_equal(colors, [0.1, 0.3, 0.6, 0.9].map { |t| bands.at(t).to_a })
+		assert_equal(colors[1], bands.at(0.25).to_a)
+		assert_equal(colors, bands.apply([0, 0.26, 0.74, 1]).to_a.map { |c| c.to_a })
+		assert_equal([heat.at(0).to_a]*2, [0, 1].map { |t| heat.discrete(1).at(t).to_a })
+		assert_raise(ArgumentError) { heat.discrete(0) }
+	end
+end
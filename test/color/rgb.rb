@@ -59,6 +59,112 @@ class TestRGB < Test::Unit::TestCase
 		assert_in_delta(a.blend(b, 128).distance(ab128), 0, MaxDistance)
 	end
 	
+	def test_linear_light
+		red   = Color::RGB.new(255, 0, 0)
+		green = Color::RGB.new(0, 255, 0)
+		mid   = red.interpolate(green, 0.5, :space => :linear)
+		assert_equal([188, 188, 0, 0], mid.to_a)
+		assert_equal(red.interpolate(green, 0.5), red.interpolate(green))
+		assert_equal([red, mid, green], red.sequence(green, 2, :space => :linear))
+		assert_equal(red.interpolate(green, 128/255.0, :space => :linear), red.blend(green, 127, :interpolate, :space => :linear))
+		assert_in_delta(red.blend(green, 127, :multiply, :space => :linear).distance(Color::RGB.new(186, 0, 0)), 0, MaxDistance)
+		assert_in_delta(0.214, Color.srgb_to_linear(0.5), 0.001)
+		assert_in_delta(0.5, Color.linear_to_srgb(Color.srgb_to_linear(0.5)), 0.0001)
+		
+		a = Color::Buffer.from([red, green])
+		b = Color::Buffer.from([green, red])
+		assert_equal([mid, mid], a.interpolate(b, 0.5, :space => :linear).to_a)
+		assert_equal([red.blend(green, 127, :multiply, :space => :linear), green.blend(red, 127, :multiply, :space => :linear)],
+			a.blend(b, :alpha => 127, :using => :multiply, :space => :linear).to_a)
+		assert_raise(ArgumentError) { a.blend(Color::Buffer.from([red])) }
+	end
+	
+	def test_contrast
+		black = Color::RGB.new(0, 0, 0)
+		white = Color::RGB.new(255, 255, 255)
+		assert_in_delta(0, black.relative_luminance, 0.0001)
+		assert_in_delta(1, white.relative_luminance, 0.0001)
+		assert_in_delta(0.2126, Color::RGB.new(255, 0, 0).relative_luminance, 0.0001)
+		assert_in_delta(21, black.contrast(white), 0.001)
+		assert_in_delta(21, white.contrast(black), 0.001)
+		assert_in_delta(4.48, Color::RGB.new(0x77, 0x77, 0x77).contrast(white), 0.01)
+		assert_in_delta(1, white.contrast(white), 0.0001)
+	end
+	
+	def test_coerce
+		rgb   = Color::RGB.new(200, 120, 40)
+		other = Color::RGB.new(30, 60, 90, 10)
+		[Color::HSV, Color::HSL, Color::CMYK, Color::RGB16, Color::RGBF].each { |model|
+			mixed = model.from(other)
+			coerced = Color::RGB.from(mixed)
+			assert_equal(rgb+coerced, rgb+mixed, model.name)
+			assert_equal(rgb-coerced, rgb-mixed, model.name)
+			assert_equal(rgb.distance(coerced), rgb.distance(mixed), model.name)
+			assert_equal(rgb.interpolate(coerced, 0.25), rgb.interpolate(mixed, 0.25), model.name)
+			assert_equal(rgb.blend(coerced), rgb.blend(mixed), model.name)
+			assert_equal(rgb.contrast(coerced), rgb.contrast(mixed), model.name)
+			assert_equal(false, coerced.eql?(mixed))
+		}
+		palette = [Color::RGB.new(0, 0, 0).to_hsl, other.to_hsv, Color::Gray.new(255)]
+		assert_same(palette[1], Color::RGB.new(40, 70, 80).closest(palette))
+		assert_nil(rgb.closest([]))
+	end
+	
+	def test_frozen
+		rgb = Color::RGB.new(200, 120, 40)
+		assert(rgb.frozen?)
+		assert(rgb.dup.frozen?)
+		assert_equal(rgb, rgb.dup)
+		assert(rgb.to_hsv.frozen?)
+		assert(Color::Named::Names.frozen?)
+		frozen = [TypeError, RuntimeError]
+		frozen << FrozenError if defined?(FrozenError)
+		assert_raise(*frozen) { rgb.send(:initialize, 1, 2, 3) }
+		assert_equal(Color::RGB.new(200, 120, 40), rgb)
+		if defined?(Ractor) then
+			assert(Ractor.shareable?(rgb))
+			assert(Ractor.shareable?(Color::Named::Names))
+			ractor = Ractor.new(rgb) { |color| [color.to_hsl.to_rgb, Color::Named.new("Amaranth").to_rgb] }
+			assert_equal([rgb, Color::Named::Names["Amaranth"]], ractor.take)
+		end
+	end
+	
+	def test_named
+		amber = Color::RGB.new(255, 191, 0)
+		assert_equal(amber, Color::Named::Names['Amber'])
+		assert_equal('Amber', Color::Named::Values[amber])
+		assert_equal(amber, Color::Named.new('Amber').to_rgb)
+		assert_equal('Red', Color::RGB.new(250, 0, 0).to_named.to_s)
+		assert_raise(NameError) { Color::Named::Unknown }
+		if Color.native? then
+			# the static table of the extension matches the one of the pure ruby version
+			table = File.open(File.join(File.dirname(__FILE__), '../../lib/color/named/table.rb'), 'rb') { |file| file.read }
+			names = {}
+			table.scan(/'(.*)' *=> 0x([0-9A-F]{6})/) { |name, value|
+				name.force_encoding('UTF-8') if name.respond_to?(:force_encoding)
+				names[name] = Color::RGB.from_int(value.hex)
+			}
+			assert_equal(185, names.size)
+			assert_equal(names, Color::Named._names)
+		end
+	end
+
+	def test_native_methods
+		return assert_equal([], Color.native_methods(Color::RGB)) unless Color.native?
+		assert_equal([], $LOADED_FEATURES.grep(/color\/pure/))
+		[:initialize, :red, :alpha, :to_hsv, :to_i, :interpolate, :blend, :distance].each { |name|
+			assert(Color.native_methods(Color::RGB).include?(name), name.to_s)
+		}
+		assert(!Color.native_methods(Color::RGB).include?(:to_html))
+		assert(Color.native_methods(Color::RGB, true).include?(:from_int))
+		assert(!Color.native_methods(Color::RGB, true).include?(:from_html))
+		assert(Color.native_methods(Color, true).include?(:native?))
+		[Color::HSV, Color::HSL, Color::CMYK, Color::Gray, Color::RGB16, Color::RGBF, Color::YCbCr, Color::Converter].each { |klass|
+			assert(Color.native_methods(klass).include?(:initialize), klass.name)
+			assert(Color.native_methods(klass).include?(klass == Color::Converter ? :convert : :alpha), klass.name)
+		}
+	end
+
 	def test_marshalling
 		a = Color::RGB.new(117, 243, 21, 93)
 		assert_equal(Marshal.load(Marshal.dump(a)), a)
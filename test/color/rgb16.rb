@@ -0,0 +1,47 @@
+require 'test/unit'
+require 'color'
+
+class TestRGB16 < Test::Unit::TestCase
+	def test_initialize
+		a = Color::RGB16.new(1, 2, 65535, 4)
+		assert_equal(1, a.red)
+		assert_equal(2, a.green)
+		assert_equal(65535, a.blue)
+		assert_equal(4, a.alpha)
+		assert_equal(a, Color::RGB16.new(1, 2, 65535, 4))
+		assert_not_equal(a, Color::RGB16.new(1, 2, 65535, 5))
+		assert_raise(ArgumentError) { Color::RGB16.new(-1,0,0) }
+		assert_raise(ArgumentError) { Color::RGB16.new(0,65536,0) }
+	end
+
+	def test_conversion
+		a = Color::RGB.new(255, 100, 0, 7)
+		assert_equal(Color::RGB16.new(65535, 25700, 0, 1799), a.to_rgb16)
+		assert_equal(a, a.to_rgb16.to_rgb)
+		assert_equal(Color::RGB.new(128, 0, 0), Color::RGB16.new(32896, 0, 0).to_rgb)
+	end
+
+	def test_precision
+		# differs from its neighbour only below 8 bit
+		a = Color::RGB16.new(40000, 20000, 10000)
+		b = Color::RGB16.new(40000, 20001, 10000)
+		assert_not_equal(a.to_hsv, b.to_hsv)
+		assert_equal(a, a.to_hsv.to_rgb16)
+		assert_equal(a, a.to_hsl.to_rgb16)
+	end
+
+	def test_buffer_rounding
+		buffer = Color::Buffer.new(:rgb16, 16)
+		16.times { |i| buffer[i] = Color::RGB16.new(32896+129, 0, 0) } # 128.502
+		assert_equal([129], buffer.convert(:rgb).map { |c| c.red }.uniq)
+		assert_equal([128], buffer.convert(:rgb, :rounding => :floor).map { |c| c.red }.uniq)
+		dithered = buffer.convert(:rgb, :rounding => :dither, :width => 4).map { |c| c.red }
+		assert_equal([128, 129], dithered.uniq.sort)
+		assert_equal(8, dithered.select { |v| v == 129 }.size)
+	end
+
+	def test_marshalling
+		a = Color::RGB16.new(1170, 24300, 21, 930)
+		assert_equal(Marshal.load(Marshal.dump(a)), a)
+	end
+end
@@ -0,0 +1,35 @@
+require 'test/unit'
+require 'color'
+
+class TestRGBF < Test::Unit::TestCase
+	MaxDistance = 1e-6
+
+	def test_initialize
+		a = Color::RGBF.new(0.25, 0.5, 2.0, 0.125)
+		assert_equal(0.25, a.red)
+		assert_equal(0.5, a.green)
+		assert_equal(2.0, a.blue)
+		assert_equal(0.125, a.alpha)
+		assert_equal(a, Color::RGBF.new(0.25, 0.5, 2.0, 0.125))
+		assert_raise(ArgumentError) { Color::RGBF.new(-0.1, 0, 0) }
+		assert_raise(ArgumentError) { Color::RGBF.new(0, 0, 0, 1.5) }
+	end
+
+	def test_conversion
+		a = Color::RGBF.new(0.3, 0.2, 0.1)
+		assert_in_delta(0, a.to_hsv.to_rgbf.distance(a), MaxDistance)
+		assert_in_delta(0, a.to_hsl.to_rgbf.distance(a), MaxDistance)
+		assert_equal(Color::RGB.new(255, 128, 0), Color::RGBF.new(4.0, 0.5, 0).to_rgb)
+		assert_equal(Color::RGB.new(255, 100, 0, 7), Color::RGB.new(255, 100, 0, 7).to_rgbf.to_rgb)
+	end
+
+	def test_buffer
+		colors = [Color::RGBF.new(1.0, 0.5, 0.25), Color::RGBF.new(0.1, 0.2, 0.3, 1.0), Color::RGBF.new(9.0, 0, 0)]
+		buffer = Color::Buffer.from(colors)
+		assert_equal(Color::RGBF, buffer.model)
+		assert_equal(colors.map { |c| c.to_rgb }, buffer.convert(:rgb).to_a)
+		rgb = buffer.convert(:rgb)
+		assert_equal(rgb.to_a.map { |c| c.to_rgbf }, rgb.convert(:rgbf).to_a)
+		assert_equal(colors.map { |c| c.to_hsv }, buffer.convert(:hsv).to_a)
+	end
+end
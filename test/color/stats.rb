@@ -0,0 +1,94 @@
+require 'test/unit'
+require 'color'
+
+class TestStats < Test::Unit::TestCase
+	def linear(value)
+		Color.srgb_to_linear(value/255.0)
+	end
+
+	def colors
+		Array.new(5000) { |i| Color::RGB.new(i*7 & 255, i*13 & 255, (i/50)*3 & 255, i % 3) }
+	end
+
+	def test_empty
+		stats = Color::Stats.new
+		assert_equal(0, stats.count)
+		assert_nil(stats.mean)
+		assert_nil(stats.min)
+		assert_nil(stats.hue)
+		assert_equal([], stats.top)
+		assert_raise(ArgumentError) { Color::Stats.new(:top => 33) }
+		assert_raise(ArgumentError) { Color::Stats.new(:bits => 0) }
+	end
+
+	def test_moments
+		stats = Color::Stats.new
+		stats.add(colors.first(1000)).add(Color::Buffer.from(colors[1000..-1]))
+		assert_equal(5000, stats.count)
+		reds  = colors.map { |c| linear(c.red) }
+		mean  = reds.inject(0) { |s, v| s+v }/reds.size
+		assert_in_delta(mean, Color.srgb_to_linear(stats.mean.red/255.0), 0.003)
+		assert_in_delta(reds.inject(0) { |s, v| s+(v-mean)**2 }/reds.size, stats.variance[0], 1e-6)
+		assert_in_delta(2/3.0/255**2, stats.variance[3], 1e-8)
+		assert_equal(Color::RGB.new(0, 0, 0, 0), stats.min)
+		assert_equal(Color::RGB.new(255, 255, 255, 2), stats.max)
+		lum = colors.inject(0) { |s, c| s+0.2126*linear(c.red)+0.7152*linear(c.green)+0.0722*linear(c.blue) }/5000
+		assert_in_delta(lum, stats.luminance, 1e-6)
+	end
+
+	def test_hue
+		stats = Color::Stats.new
+		stats << Color::RGB.new(255, 0, 0) << Color::RGB.new(255, 0, 255) << Color::RGB.new(128, 128, 128)
+		assert_in_delta(330/360.0, stats.hue, 1e-5)
+		assert_in_delta(Math.cos(Math::PI/6), stats.hue_concentration, 1e-6)
+		primaries = Color::Stats.new << Color::RGB.new(255, 0, 0) << Color::RGB.new(0, 255, 0) << Color::RGB.new(0, 0, 255)
+		assert_nil(primaries.hue)
+	end
+
+	def test_top
+		stats  = Color::Stats.new(:top => 3, :bits => 8)
+		screen = [Color::RGB.new(20, 30, 40)]*5000+[Color::RGB.new(250, 250, 250)]*3000+colors+[Color::RGB.new(9, 9, 9)]*1000
+		stats.add(Color::Buffer.from(screen))
+		top = stats.top
+		assert_equal([Color::RGB.new(20, 30, 40), Color::RGB.new(250, 250, 250), Color::RGB.new(9, 9, 9)], top.map { |c, n| c })
+		assert(top[0][1] >= 5000 && top[0][1] < 5000+stats.count/500)
+		assert_equal(1, stats.top(1).size)
+		coarse = Color::Stats.new(:bits => 2) << Color::RGB.new(70, 130, 255)
+		assert_equal([[Color::RGB.new(96, 160, 224), 1]], coarse.top)
+	end
+
+	def test_merge
+		whole = Color::Stats.new.add(colors)
+		parts = colors.each_slice(700).map { |slice| Color::Stats.new.add(slice) }
+		merged = parts.inject { |a, b| a.merge(b) }
+		assert_equal(whole.count, merged.count)
+		assert_equal(whole.mean, merged.mean)
+		assert_equal(whole.min, merged.min)
+		assert_equal(whole.max, merged.max)
+		whole.variance.zip(merged.variance) { |a, b| assert_in_delta(a, b, 1e-12) }
+		assert_in_delta(whole.hue, merged.hue, 1e-9)
+		screen = [Color::RGB.new(20, 30, 40)]*3000+colors+[Color::RGB.new(250, 250, 250)]*2000
+		parts  = screen.each_slice(1100).map { |slice| Color::Stats.new.add(slice) }
+		assert_equal(Color::Stats.new.add(screen).top(2), parts.inject { |a, b| a.merge!(b) }.top(2))
+		assert_equal(1100, parts[1].count)
+		assert_raise(ArgumentError) { whole.merge(Color::Stats.new(:bits => 6)) }
+	end
+
+	def test_marshal
+		stats = Color::Stats.new(:top => 4).add(colors)
+		copy  = Marshal.load(Marshal.dump(stats))
+		assert_equal(stats.to_hash, copy.to_hash)
+		assert_equal(stats.merge(stats).to_hash, copy.merge!(stats).to_hash)
+		assert_equal(stats.count, stats.dup.count)
+		assert_raise(ArgumentError) { Color::Stats._load("nope") }
+	end
+
+	def test_frozen
+		stats  = Color::Stats.new.add(colors).freeze
+		frozen = [TypeError, RuntimeError]
+		frozen << FrozenError if defined?(FrozenError)
+		assert_raise(*frozen) { stats.add(colors) }
+		assert_raise(*frozen) { stats.merge!(stats) }
+		assert_equal(2*stats.count, stats.merge(stats).count)
+	end
+end
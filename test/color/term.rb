@@ -0,0 +1,49 @@
+require 'test/unit'
+require 'stringio'
+require 'color'
+
+class TestTerm < Test::Unit::TestCase
+	def test_term
+		assert_equal(Color::RGB.new(255, 255, 0), Color::Term.new(:yellow).to_rgb)
+		assert_equal("\e[43m", Color::Term.new(:yellow).to_s(true))
+		assert_equal(:red, Color::RGB.new(250, 10, 10).to_term)
+		assert_equal("\e[31m", Color::Term.new(Color::RGB.new(250, 10, 10).to_term).to_s)
+		assert_equal({ :black => 0, :red => 0xff0000, :green => 0x00ff00, :yellow => 0xffff00, :blue => 0x0000ff, :purple => 0xff00ff, :cyan => 0x00ffff, :white => 0xffffff }, Color::Term::Values)
+		assert_equal(:cyan, Color::Term::Mapping[Color::RGB.new(0, 255, 255)])
+		colored = "x".extend(Color::Term::StringColoring)
+		assert_equal("\e[1m\e[44mx\e[0m\e[0m", colored.on_blue.extend(Color::Term::StringColoring).bold)
+		assert_equal("\e[37mx\e[0m", colored.white)
+	end
+
+	def test_writer
+		writer = Color::Term::Writer.new
+		writer.write("a", :fg => :yellow, :bold => true).write("b", :fg => :yellow, :bold => true, :bg => :red)
+		writer.write("c", :fg => Color::Term.new(:yellow), :bg => :red) << "d"
+		writer.write("e").write("f").reset
+		assert_equal("\e[1;33ma\e[41mb\e[22mcd\e[0mef", writer.to)
+		assert_equal(256, writer.depth)
+		assert_equal("x", Color::Term::Writer.new.reset.write("x").reset.to)
+	end
+
+	def test_writer_depth
+		orange = Color::RGB.new(255, 96, 0)
+		assert_equal("\e[31mx", Color::Term::Writer.new(:depth => 8).write("x", orange).to)
+		assert_equal("\e[38;5;202mx", Color::Term::Writer.new.write("x", orange).to)
+		assert_equal("\e[48;5;244mx", Color::Term::Writer.new.write("x", :bg => Color::Gray.new(128)).to)
+		assert_equal("\e[38;2;255;96;0mx\e[0my", Color::Term::Writer.new(:depth => :truecolor).write("x", orange.to_hsl).write("y", :underline => false).to)
+		assert_raise(ArgumentError) { Color::Term::Writer.new(:depth => 16) }
+		assert_raise(ArgumentError) { Color::Term::Writer.new.write("x", :pink) }
+	end
+
+	def test_writer_io
+		io     = StringIO.new
+		writer = Color::Term::Writer.new(io)
+		writer.write("x" * 5000, :invert => true).write("y" * 5000, :blink => true)
+		assert_equal(5011, io.string.size)
+		assert_same(io, writer.flush)
+		assert_equal("\e[7m#{'x' * 5000}\e[5;27m#{'y' * 5000}", io.string)
+		buffer = ""
+		assert_same(buffer, Color::Term::Writer.new(buffer).write("z", :fg => :cyan).to)
+		assert_equal("\e[36mz", buffer)
+	end
+end
@@ -0,0 +1,100 @@
+require 'test/unit'
+require 'color'
+
+class TestYCbCr < Test::Unit::TestCase
+	Matrices = { :bt601 => [0.299, 0.114], :bt709 => [0.2126, 0.0722] }
+
+	def test_initialize
+		a = Color::YCbCr.new(76, 85, 255, 7)
+		assert_equal(76, a.y)
+		assert_equal(76, a.luma)
+		assert_equal(85, a.cb)
+		assert_equal(255, a.cr)
+		assert_equal(7, a.alpha)
+		assert_equal(a, Color::YCbCr.new(76, 85, 255, 7))
+		assert_raise(ArgumentError) { Color::YCbCr.new(0, 256, 0) }
+		assert_equal(a, Marshal.load(Marshal.dump(a)))
+	end
+
+	def test_conversion
+		assert_equal(Color::YCbCr.new(76, 85, 255), Color::RGB.new(255, 0, 0).to_ycbcr)
+		assert_equal(Color::YCbCr.new(255, 128, 128, 9), Color::RGB.new(255, 255, 255, 9).to_ycbcr)
+		assert_equal(Color::YCbCr.new(76, 85, 255), Color::YCbCr.from(Color::HSV.new(0, 1, 1)))
+		assert_equal(Color::RGB.new(238, 14, 14), Color::YCbCr.new(81, 90, 240).to_rgb)
+		0.step(255, 15) { |i|
+			rgb = Color::RGB.new(i, 255-i, i/2)
+			back = rgb.to_ycbcr.to_rgb
+			assert(rgb.to_a.zip(back.to_a).all? { |a, b| (a-b).abs <= 1 }, "#{rgb} -> #{back}")
+		}
+		assert_in_delta(0, Color::YCbCr.new(1, 2, 3).distance(Color::YCbCr.new(1, 2, 3)), 1e-6)
+		converter = Color::Converter.new(:from => :hsv, :to => :ycbcr)
+		assert_equal(Color::YCbCr.new(76, 85, 255), converter.convert(Color::HSV.new(0, 1, 1)))
+	end
+
+	def test_to_planar
+		width, height = 5, 3
+		colors = Array.new(width*height) { |i| Color::RGB.new(i*17 & 255, i*40 & 255, 255-(i*13 & 255)) }
+		buffer = Color::Buffer.from(colors)
+		[[:yuv444, 0, 0], [:yuv422, 1, 0], [:yuv420, 1, 1]].each { |subsampling, sx, sy|
+			Matrices.each { |matrix, (kr, kb)|
+				[:limited, :full].each { |range|
+					options = { :subsampling => subsampling, :matrix => matrix, :range => range }
+					y, cb, cr = buffer.to_planar(width, options)
+					expected  = planar(colors, width, height, sx, sy, kr, kb, range == :limited)
+					assert_close(expected[0], y.unpack("C*"), 1, options)
+					assert_close(expected[1], cb.unpack("C*"), 1, options)
+					assert_close(expected[2], cr.unpack("C*"), 1, options)
+				}
+			}
+		}
+		assert_raise(ArgumentError) { buffer.to_planar(4) }
+		assert_raise(ArgumentError) { buffer.to_planar(5, :subsampling => :yuv411) }
+		assert_raise(ArgumentError) { Color::Buffer.from_planar("", 2**32, 2**32) }
+	end
+
+	def test_from_planar
+		width, height = 5, 3
+		colors = Array.new(width*height) { |i| Color::RGB.new(i*17 & 255, i*40 & 255, 255-(i*13 & 255)) }
+		buffer = Color::Buffer.from(colors)
+		Matrices.each_key { |matrix|
+			[:limited, :full].each { |range|
+				options = { :subsampling => :yuv444, :matrix => matrix, :range => range }
+				back    = Color::Buffer.from_planar(buffer.to_planar(width, options), width, height, options)
+				assert_close(buffer.data.unpack("C*"), back.data.unpack("C*"), 2, options)
+			}
+		}
+		# a single chroma sample covers 2x2 pixels, one string is an I420 frame
+		frame = [10, 20, 30, 40, 50, 60].pack("C*")+[90, 200].pack("C*")+[160, 60].pack("C*")
+		rgb   = Color::Buffer.from_planar(frame, 3, 2, :range => :full)
+		assert_equal(Color::RGB, rgb.model)
+		assert_equal(6, rgb.length)
+		expected = [10, 20, 40, 50, 30, 60].zip([0, 0, 0, 0, 1, 1]).map { |y, c| Color::YCbCr.new(y, [90, 200][c], [160, 60][c]).to_rgb }
+		assert_close(expected.map { |c| c.to_a }.flatten, [0, 1, 3, 4, 2, 5].map { |i| rgb[i].to_a }.flatten, 1, :yuv420)
+		assert_raise(ArgumentError) { Color::Buffer.from_planar(frame+"x", 3, 2) }
+		assert_raise(ArgumentError) { Color::Buffer.from_planar([frame, "", ""], 3, 2) }
+	end
+
+	def planar(colors, width, height, sx, sy, kr, kb, limited)
+		kg     = 1-kr-kb
+		scale  = limited ? 219.0/255 : 1
+		chroma = limited ? 224.0/255 : 1
+		luma   = colors.map { |c| kr*c.red+kg*c.green+kb*c.blue }
+		cb     = colors.zip(luma).map { |c, l| 128+chroma*(c.blue-l)/(2*(1-kb)) }
+		cr     = colors.zip(luma).map { |c, l| 128+chroma*(c.red-l)/(2*(1-kr)) }
+		rows   = (height+(1 << sy)-1) >> sy
+		cols   = (width+(1 << sx)-1) >> sx
+		reduce = lambda { |plane|
+			(0...rows*cols).map { |i|
+				xs = ((i % cols) << sx..[((i % cols) << sx)+(1 << sx)-1, width-1].min).to_a
+				ys = ((i / cols) << sy..[((i / cols) << sy)+(1 << sy)-1, height-1].min).to_a
+				(ys.map { |y| xs.map { |x| plane[y*width+x] } }.flatten.inject(0) { |s, v| s+v }/(xs.size*ys.size)).round
+			}
+		}
+		[luma.map { |l| ((limited ? 16 : 0)+l*scale).round }, reduce.call(cb), reduce.call(cr)]
+	end
+
+	def assert_close(expected, actual, delta, message)
+		assert_equal(expected.size, actual.size, message.inspect)
+		assert(expected.zip(actual).all? { |a, b| (a-b).abs <= delta }, "#{message.inspect}: #{expected.inspect} vs #{actual.inspect}")
+	end
+end